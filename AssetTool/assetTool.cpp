@@ -0,0 +1,264 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// assetTool.cpp v1.0
+// Command line tool that builds and reads asset packs, see assetPack.h,
+// and cooks textures, see imageFile.h.
+// Run it in the folder the game runs in, so the packed names are the names
+// used by the game, e.g. NEBULA_IMAGE = "pictures\\orion.jpg".
+//   AssetTool pack <pack file> <file>...     pack the files
+//   AssetTool unpack <pack file> [folder]    write the files back out
+//   AssetTool list <pack file>               list the files in the pack
+//   AssetTool cook <image> <texture> [-frame <width> <height>] [-cols <n>]
+//                  [-key <RRGGBB>|none] [-nomips]
+//                                            cook an image file with its
+//                                            mip levels, or without them
+// A packed file given as name=file is packed as name, so a cooked texture
+// replaces the image the game loads:
+//   AssetTool cook pictures\ship.png ship.tex -frame 32 32 -cols 8
+//   AssetTool pack assets.pak pictures\ship.png=ship.tex
+// Names are packed as given, with '/' for '\', so unpack writes the files
+// back with the same case. On Linux the tool is built by Tests/CMakeLists.txt.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "../EnginePart1/assetPack.h"
+#include "../EnginePart1/imageFile.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#define MAKE_DIR(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define MAKE_DIR(path) mkdir(path, 0777)
+#endif
+
+//=============================================================================
+// Print how to use the tool
+//=============================================================================
+static int usage()
+{
+    printf("usage: AssetTool pack <pack file> <file>|<name>=<file>...\n"
+           "       AssetTool unpack <pack file> [folder]\n"
+           "       AssetTool list <pack file>\n"
+           "       AssetTool cook <image> <texture> [-frame <width> <height>] [-cols <n>]\n"
+           "                      [-key <RRGGBB>|none] [-nomips]\n");
+    return 1;
+}
+
+//=============================================================================
+// Pack the files, each named by its path or by the name before '='
+//=============================================================================
+static int pack(const char *packFile, int count, char **files)
+{
+    AssetPackWriter writer;
+    size_t bytes = 0;
+    for (int i = 0; i < count; i++)
+    {
+        std::string name = files[i];
+        const char *file = files[i];
+        const char *equals = strchr(files[i], '=');
+        if (equals)
+        {
+            name.resize(equals - files[i]);
+            file = equals + 1;
+        }
+        if (!writer.add(name.c_str(), file))
+        {
+            printf("error: %s\n", writer.getError().c_str());
+            return 1;
+        }
+    }
+    if (!writer.write(packFile))
+    {
+        printf("error: %s\n", writer.getError().c_str());
+        return 1;
+    }
+    AssetPack check;
+    if (!check.open(packFile))
+    {
+        printf("error: %s was written but can not be opened\n", packFile);
+        return 1;
+    }
+    for (UINT i = 0; i < check.getSlotCount(); i++)
+    {
+        const char *name;
+        const BYTE *data;
+        size_t size;
+        if (check.getAsset(i, name, data, size))
+            bytes += size;
+    }
+    printf("%s: %u files, %u bytes\n", packFile, check.getAssetCount(), (UINT)bytes);
+    return 0;
+}
+
+//=============================================================================
+// Create the folders in path
+//=============================================================================
+static void makeFolders(const std::string &path)
+{
+    for (size_t i = 1; i < path.size(); i++)
+        if (path[i] == '/')
+            MAKE_DIR(path.substr(0, i).c_str());
+}
+
+//=============================================================================
+// Write every file in the pack into folder
+//=============================================================================
+static int unpack(const char *packFile, const char *folder)
+{
+    AssetPack assets;
+    if (!assets.open(packFile))
+    {
+        printf("error: %s is not an asset pack\n", packFile);
+        return 1;
+    }
+    for (UINT i = 0; i < assets.getSlotCount(); i++)
+    {
+        const char *name;
+        const BYTE *data;
+        size_t size;
+        if (!assets.getAsset(i, name, data, size))
+            continue;
+        if (strstr(name, "..") != NULL || strchr(name, ':') != NULL || name[0] == '/')
+        {
+            printf("error: skipped %s, outside the folder\n", name);
+            continue;
+        }
+        std::string path = std::string(folder) + "/" + name;
+        makeFolders(path);
+        FILE *f = fopen(path.c_str(), "wb");
+        if (f == NULL || fwrite(data, 1, size, f) != size)
+        {
+            printf("error: can not write %s\n", path.c_str());
+            if (f)
+                fclose(f);
+            return 1;
+        }
+        fclose(f);
+        printf("%s\n", path.c_str());
+    }
+    return 0;
+}
+
+//=============================================================================
+// List the files in the pack
+//=============================================================================
+static int list(const char *packFile)
+{
+    AssetPack assets;
+    if (!assets.open(packFile))
+    {
+        printf("error: %s is not an asset pack\n", packFile);
+        return 1;
+    }
+    printf("%-10s %10s  %s\n", "id", "bytes", "name");
+    for (UINT i = 0; i < assets.getSlotCount(); i++)
+    {
+        const char *name;
+        const BYTE *data;
+        size_t size;
+        if (assets.getAsset(i, name, data, size))
+            printf("0x%08X %10u  %s\n", AssetPack::getId(name), (UINT)size, name);
+    }
+    printf("%u files\n", assets.getAssetCount());
+    return 0;
+}
+
+//=============================================================================
+// Cook an image file into a texture in the engine format
+// The color key and premultiplied alpha are applied here instead of at every
+// load, and the frame rects of a sprite sheet and the mip levels are stored
+// with the pixels.
+//=============================================================================
+static int cook(int argc, char **argv)
+{
+    const char *imageFile = argv[0];
+    const char *textureFile = argv[1];
+    UINT frameWidth = 0, frameHeight = 0, cols = 0;
+    COLOR_ARGB transcolor = TRANSCOLOR;
+    bool mips = true;
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-frame") == 0 && i+2 < argc)
+        {
+            frameWidth = (UINT)atoi(argv[++i]);
+            frameHeight = (UINT)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-cols") == 0 && i+1 < argc)
+            cols = (UINT)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-key") == 0 && i+1 < argc)
+        {
+            i++;
+            if (strcmp(argv[i], "none") == 0)
+                transcolor = 0;
+            else
+                transcolor = (COLOR_ARGB)strtoul(argv[i], NULL, 16) & 0x00FFFFFF;
+        }
+        else if (strcmp(argv[i], "-nomips") == 0)
+            mips = false;
+        else
+            return usage();
+    }
+
+    UINT width, height;
+    std::vector<COLOR_ARGB> pixels;
+    if (!ImageFile::load(imageFile, transcolor, width, height, pixels))
+    {
+        printf("error: can not load %s\n", imageFile);
+        return 1;
+    }
+
+    SpriteSheet sheet;
+    if (frameWidth > 0 && frameHeight > 0)
+    {
+        if (frameWidth > width || frameHeight > height)
+        {
+            printf("error: frame is larger than the %ux%u image\n", width, height);
+            return 1;
+        }
+        if (cols == 0 || cols > width/frameWidth)
+            cols = width/frameWidth;
+        sheet.frameWidth = frameWidth;
+        sheet.frameHeight = frameHeight;
+        sheet.cols = cols;
+        UINT frames = cols * (height/frameHeight);
+        for (UINT i = 0; i < frames; i++)
+        {
+            RECT r;
+            r.left = (i % cols) * frameWidth;
+            r.top = (i / cols) * frameHeight;
+            r.right = r.left + frameWidth;
+            r.bottom = r.top + frameHeight;
+            sheet.frames.push_back(r);
+        }
+    }
+    if (!ImageFile::writeCooked(textureFile, width, height, pixels,
+                                sheet.frames.empty() ? NULL : &sheet, mips))
+    {
+        printf("error: can not write %s\n", textureFile);
+        return 1;
+    }
+    printf("%s: %ux%u, %u frames\n", textureFile, width, height, (UINT)sheet.frames.size());
+    return 0;
+}
+
+//=============================================================================
+// main
+//=============================================================================
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+        return usage();
+    if (strcmp(argv[1], "pack") == 0 && argc >= 4)
+        return pack(argv[2], argc-3, argv+3);
+    if (strcmp(argv[1], "unpack") == 0)
+        return unpack(argv[2], argc >= 4 ? argv[3] : ".");
+    if (strcmp(argv[1], "list") == 0)
+        return list(argv[2]);
+    if (strcmp(argv[1], "cook") == 0 && argc >= 4)
+        return cook(argc-2, argv+2);
+    return usage();
+}
@@ -6,6 +6,9 @@
 // Create a TextureManager object for each texture file in the game.
 
 #include "textureManager.h"
+#include "textureLoader.h"
+#include "gameClock.h"
+#include "mipmap.h"
 
 //=============================================================================
 // default constructor
@@ -17,6 +20,21 @@ TextureManager::TextureManager()
     height = 0;
     file = NULL;
     graphics = NULL;
+    atlas = NULL;
+    atlasRect.page = 0;
+    atlasRect.x = 0;
+    atlasRect.y = 0;
+    atlasRect.width = 0;
+    atlasRect.height = 0;
+    cache = NULL;
+    loader = NULL;
+    residency = NULL;
+    evicted = false;
+    priority = 0;
+    loading.store(false);
+    loadFailed = false;
+    resetTime = 0;
+    resetFromCache = false;
     initialized = false;            // set true when successfully initialized
 }
 
@@ -25,6 +43,14 @@ TextureManager::TextureManager()
 //=============================================================================
 TextureManager::~TextureManager()
 {
+    if (loader)
+        loader->cancel(this);           // loader must not set a deleted texture
+    if (residency)
+    {
+        residency->remove(this);
+        if (residency->getTextureLoader())
+            residency->getTextureLoader()->cancel(this);
+    }
     SAFE_RELEASE(texture);
 }
 
@@ -38,7 +64,7 @@ bool TextureManager::initialize(Graphics *g, const char *f)
         graphics = g;                       // the graphics object
         file = f;                           // the texture file
 
-        hr = graphics->loadTexture(file, TRANSCOLOR, width, height, texture);
+        hr = load();
         if (FAILED(hr))
         {
             SAFE_RELEASE(texture);
@@ -50,13 +76,93 @@ bool TextureManager::initialize(Graphics *g, const char *f)
     return true;
 }
 
+//=============================================================================
+// Registers the texture file with the atlas.
+// Post: returns true if successful, false if failed
+//=============================================================================
+bool TextureManager::initialize(Graphics *g, const char *f, TextureAtlas *a)
+{
+    if (a == NULL)
+        return initialize(g, f);
+    graphics = g;                       // the graphics object
+    file = f;                           // the texture file
+    atlas = a;
+    if (!atlas->add(this, file, TRANSCOLOR))
+    {
+        atlas = NULL;
+        return false;
+    }
+    initialized = true;
+    return true;
+}
+
+//=============================================================================
+// Queues the texture file with the loader.
+// Post: returns true if successful, false if failed
+//=============================================================================
+bool TextureManager::initialize(Graphics *g, const char *f, TextureLoader *l, int p)
+{
+    if (l == NULL)
+        return initialize(g, f);
+    graphics = g;                       // the graphics object
+    file = f;                           // the texture file
+    loader = l;
+    priority = p;
+    loadFailed = false;
+    loading.store(true);
+    if (!loader->load(this, file, TRANSCOLOR, priority))
+    {
+        loading.store(false);
+        loader = NULL;
+        return false;
+    }
+    initialized = true;
+    return true;
+}
+
+//=============================================================================
+// Set the texture created by the loader
+// The texture, width and height are stored before loading is cleared, so a
+// thread that sees isLoading() false sees them too.
+//=============================================================================
+void TextureManager::setLoaded(LP_TEXTURE t, UINT w, UINT h, SpriteSheet &s)
+{
+    SAFE_RELEASE(texture);
+    texture = t;
+    width = w;
+    height = h;
+    if (!evicted)                   // keep the sheet of the first load
+    {
+        sheet.frames.swap(s.frames);
+        sheet.frameWidth = s.frameWidth;
+        sheet.frameHeight = s.frameHeight;
+        sheet.cols = s.cols;
+    }
+    evicted = false;
+    if (residency)
+        residency->add(this, getBytes());
+    loadFailed = false;
+    loading.store(false, std::memory_order_release);
+}
+
+//=============================================================================
+// The loader could not load the file
+//=============================================================================
+void TextureManager::setLoadFailed()
+{
+    loadFailed = true;
+    loading.store(false, std::memory_order_release);
+}
+
 //=============================================================================
 // called when graphics device is lost
 //=============================================================================
 void TextureManager::onLostDevice()
 {
-    if (!initialized)
+    if (!initialized || atlas)      // the atlas releases its pages
         return;
+    if (residency && !evicted)
+        residency->remove(this);    // added again by onResetDevice()
     SAFE_RELEASE(texture);
 }
 
@@ -65,9 +171,104 @@ void TextureManager::onLostDevice()
 //=============================================================================
 void TextureManager::onResetDevice()
 {
-    if (!initialized)
+    if (!initialized || atlas || isLoading() || loadFailed)   // the loader creates a loading texture
+        return;
+    if (evicted)                    // loaded when next drawn
         return;
-    graphics->loadTexture(file, TRANSCOLOR, width, height, texture);
+    LONGLONG start = GameClock::ticks();
+    load();
+    resetTime = (float)GameClock::toSeconds(GameClock::ticks() - start);
+}
+
+//=============================================================================
+// Load the texture
+// With a cache the pixels come from the cache if they are there, otherwise
+// the file is decoded. The pixels are added to the cache on the first load
+// only. A miss on reset means the cache is full, adding would remove an image
+// that the next TextureManager reset is about to use.
+// The sprite sheet of a cooked file is read on the first load only.
+//=============================================================================
+HRESULT TextureManager::load()
+{
+    SpriteSheet *s = initialized ? NULL : &sheet;
+    resetFromCache = false;
+    if (cache == NULL)
+    {
+        hr = graphics->loadTexture(file, TRANSCOLOR, width, height, texture, s);
+        if (SUCCEEDED(hr) && residency)
+            residency->add(this, getBytes());
+        return hr;
+    }
+
+    const COLOR_ARGB *cached;
+    UINT w, h;
+    if (cache->find(file, TRANSCOLOR, w, h, cached))
+    {
+        hr = graphics->createTexture(cached, w, h, texture);
+        resetFromCache = SUCCEEDED(hr);
+    }
+    else
+    {
+        std::vector<COLOR_ARGB> pixels;
+        hr = graphics->loadTextureData(file, TRANSCOLOR, w, h, pixels, s);
+        if (FAILED(hr))
+            return hr;
+        hr = graphics->createTexture(&pixels[0], w, h, texture);
+        if (SUCCEEDED(hr) && !initialized)
+            cache->add(file, TRANSCOLOR, w, h, pixels);
+    }
+    if (SUCCEEDED(hr))
+    {
+        width = w;
+        height = h;
+        if (residency)
+            residency->add(this, getBytes());
+    }
+    return hr;
+}
+
+//=============================================================================
+// Return bytes of the texture and its mip levels
+//=============================================================================
+UINT64 TextureManager::getBytes() const
+{
+    UINT64 bytes = (UINT64)width*height*sizeof(COLOR_ARGB);
+    UINT levels = graphics->getMipLevels(width, height);
+    if (levels > 1)
+        bytes += Mipmap::getChainSize(width, height, levels) * sizeof(COLOR_ARGB);
+    return bytes;
+}
+
+//=============================================================================
+// Release the texture to stay in the memory budget
+// Called by TextureResidency on the thread that owns the graphics device.
+//=============================================================================
+void TextureManager::evict()
+{
+    evicted = true;
+    SAFE_RELEASE(texture);
+}
+
+//=============================================================================
+// Load an evicted texture again
+// Queued with the loader of the residency if there is one, else loaded now.
+// Loading without a loader uses the graphics device, so it is only safe on
+// the thread that owns the device.
+//=============================================================================
+void TextureManager::reload()
+{
+    if (isLoading() || loadFailed)  // already queued, or can not be loaded
+        return;
+    TextureLoader *l = residency->getTextureLoader();
+    if (l)
+    {
+        loading.store(true);
+        if (l->load(this, file, TRANSCOLOR, priority))
+            return;
+        loading.store(false);
+    }
+    if (SUCCEEDED(load()))
+        evicted = false;
 }
 
 
@@ -0,0 +1,242 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// animator.cpp v1.0
+// Batched frame animation, see animator.h
+
+#include "animator.h"
+#include "cpuFeatures.h"
+
+//=============================================================================
+// Advance animation i, Image::update() on the arrays
+//=============================================================================
+static inline void update1(float frameTime, UINT i, float *timer, const float *delay,
+                           int *current, const int *start, const int *end,
+                           const int *loop, int *complete)
+{
+    if (end[i] - start[i] > 0)              // if animated
+    {
+        timer[i] += frameTime;
+        if (timer[i] > delay[i])
+        {
+            timer[i] -= delay[i];
+            current[i]++;
+            if (current[i] < start[i] || current[i] > end[i])
+            {
+                if (loop[i])
+                    current[i] = start[i];
+                else
+                {
+                    current[i] = end[i];
+                    complete[i] = -1;
+                }
+            }
+        }
+    }
+}
+
+#ifdef CPU_X86
+
+//=============================================================================
+// Return a where mask is set, else b
+//=============================================================================
+TARGET_SSE2 static inline __m128i select4(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+//=============================================================================
+// Advance 4 animations per loop
+// Every step of update1() is done for all 4 and kept where its condition
+// holds, so the results are the same as update1().
+// Returns number of animations done.
+//=============================================================================
+TARGET_SSE2 static UINT updateSSE2(float frameTime, UINT count, float *timer, const float *delay,
+                                   int *current, const int *start, const int *end,
+                                   const int *loop, int *complete)
+{
+    const __m128 dt = _mm_set1_ps(frameTime);
+    const __m128i zero = _mm_setzero_si128();
+    UINT i = 0;
+    for (; i+4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128((const __m128i*)(start + i));
+        __m128i e = _mm_loadu_si128((const __m128i*)(end + i));
+        __m128i animated = _mm_cmpgt_epi32(_mm_sub_epi32(e, s), zero);
+        if (_mm_movemask_epi8(animated) == 0)
+            continue;                       // none animated
+        __m128 t = _mm_loadu_ps(timer + i);
+        __m128 d = _mm_loadu_ps(delay + i);
+        t = _mm_add_ps(t, _mm_and_ps(_mm_castsi128_ps(animated), dt));
+        __m128i next = _mm_and_si128(animated, _mm_castps_si128(_mm_cmpgt_ps(t, d)));
+        t = _mm_sub_ps(t, _mm_and_ps(_mm_castsi128_ps(next), d));
+        _mm_storeu_ps(timer + i, t);
+        if (_mm_movemask_epi8(next) == 0)
+            continue;                       // no frame changes
+        __m128i c = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(current + i)), next);
+        __m128i outside = _mm_and_si128(next, _mm_or_si128(_mm_cmplt_epi32(c, s),
+                                                           _mm_cmpgt_epi32(c, e)));
+        __m128i lp = _mm_loadu_si128((const __m128i*)(loop + i));
+        c = select4(outside, select4(lp, s, e), c);
+        __m128i done = _mm_loadu_si128((const __m128i*)(complete + i));
+        done = _mm_or_si128(done, _mm_andnot_si128(lp, outside));
+        _mm_storeu_si128((__m128i*)(current + i), c);
+        _mm_storeu_si128((__m128i*)(complete + i), done);
+    }
+    return i;
+}
+
+#endif  // CPU_X86
+
+//=============================================================================
+// Constructor
+//=============================================================================
+Animator::Animator()
+{
+    simd = CpuFeatures::hasSSE2();
+}
+
+//=============================================================================
+// Use SSE2 if the CPU has it
+//=============================================================================
+void Animator::setSimd(bool s)
+{
+    simd = s && CpuFeatures::hasSSE2();
+}
+
+//=============================================================================
+// Return the table of the frame size, adding it if new
+//=============================================================================
+UINT Animator::findTable(int width, int height, int cols)
+{
+    if (cols < 1)
+        cols = 1;
+    for (UINT n = 0; n < tables.size(); n++)
+        if (tables[n].width == width && tables[n].height == height && tables[n].cols == cols)
+            return n;
+    FrameTable t;
+    t.width = width;
+    t.height = height;
+    t.cols = cols;
+    tables.push_back(t);
+    growTable((UINT)tables.size() - 1, 1);
+    return (UINT)tables.size() - 1;
+}
+
+//=============================================================================
+// Make table n hold at least frames rects
+// The rects are the ones Image::setRect() computes.
+//=============================================================================
+void Animator::growTable(UINT n, int frames)
+{
+    FrameTable &t = tables[n];
+    for (int frame = (int)t.rects.size(); frame < frames; frame++)
+    {
+        RECT r;
+        r.left = (frame % t.cols) * t.width;
+        r.right = r.left + t.width;
+        r.top = (frame / t.cols) * t.height;
+        r.bottom = r.top + t.height;
+        t.rects.push_back(r);
+    }
+}
+
+//=============================================================================
+// Add an animation
+// Returns the animation number
+//=============================================================================
+UINT Animator::add(int width, int height, int cols)
+{
+    UINT n;
+    if (!unused.empty())
+    {
+        n = unused.back();
+        unused.pop_back();
+    }
+    else
+    {
+        n = (UINT)current.size();
+        timer.push_back(0);
+        delay.push_back(0);
+        current.push_back(0);
+        start.push_back(0);
+        end.push_back(0);
+        loop.push_back(0);
+        complete.push_back(0);
+        table.push_back(0);
+    }
+    timer[n] = 0;
+    delay[n] = 1.0f;            // the same as a new Image
+    current[n] = 0;
+    start[n] = 0;
+    end[n] = 0;
+    loop[n] = -1;
+    complete[n] = 0;
+    table[n] = findTable(width, height, cols);
+    return n;
+}
+
+//=============================================================================
+// Remove an animation
+// The element stays with end == start, so update() skips it.
+//=============================================================================
+void Animator::remove(UINT n)
+{
+    if (n >= current.size())
+        return;
+    start[n] = 0;
+    end[n] = 0;
+    current[n] = 0;
+    unused.push_back(n);
+}
+
+//=============================================================================
+// Advance every animation
+//=============================================================================
+void Animator::update(float frameTime)
+{
+    UINT count = (UINT)current.size();
+    if (count == 0)
+        return;
+    UINT i = 0;
+#ifdef CPU_X86
+    if (simd)
+        i = updateSSE2(frameTime, count, &timer[0], &delay[0], &current[0], &start[0],
+                       &end[0], &loop[0], &complete[0]);
+#endif
+    for (; i < count; i++)      // remaining animations
+        update1(frameTime, i, &timer[0], &delay[0], &current[0], &start[0], &end[0],
+                &loop[0], &complete[0]);
+}
+
+//=============================================================================
+// Set the frame size of an animation
+//=============================================================================
+void Animator::setFrameSize(UINT n, int width, int height, int cols)
+{
+    table[n] = findTable(width, height, cols);
+    growTable(table[n], (current[n] > end[n] ? current[n] : end[n]) + 1);
+}
+
+//=============================================================================
+// Set first and last frame
+// The table is grown to the last frame, update() never goes past it.
+//=============================================================================
+void Animator::setFrames(UINT n, int s, int e)
+{
+    start[n] = s;
+    end[n] = e;
+    growTable(table[n], e + 1);
+}
+
+//=============================================================================
+// Set current frame and clear animation complete
+//=============================================================================
+void Animator::setCurrentFrame(UINT n, int c)
+{
+    if (c < 0)
+        return;
+    current[n] = c;
+    complete[n] = 0;
+    growTable(table[n], c + 1);
+}
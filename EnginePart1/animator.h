@@ -0,0 +1,118 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// animator.h v1.0
+// An Animator advances the frame animations of many Images in one pass.
+// The animation state is kept in one array per property (structure of
+// arrays), so update() runs through contiguous memory and animates 4
+// Images per SSE2 instruction instead of calling Image::update() on each.
+// Frame rects come from tables shared by every animation with the same
+// frame size and columns, so no divide or modulo is done per frame.
+// The result is the same as Image::update(), including loop and
+// animComplete. Game owns an Animator and updates it every tick, see
+// Game::getAnimator() and Image::setAnimator().
+
+#ifndef _ANIMATOR_H             // Prevent multiple definitions if this
+#define _ANIMATOR_H             // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+#include "spriteData.h"
+
+class Animator
+{
+  private:
+    // Frame rects of a sprite sheet, frame n at rects[n].
+    struct FrameTable
+    {
+        int     width;          // frame size
+        int     height;
+        int     cols;           // frames in a row
+        std::vector<RECT> rects;
+    };
+
+    // Animation state, element n is animation n
+    std::vector<float> timer;       // time since the last frame change
+    std::vector<float> delay;       // time between frames
+    std::vector<int>   current;     // current frame
+    std::vector<int>   start;       // first frame
+    std::vector<int>   end;         // last frame, not animated if end <= start
+    std::vector<int>   loop;        // -1 to loop, 0 to stop at end
+    std::vector<int>   complete;    // -1 when a not looping animation has finished
+    std::vector<UINT>  table;       // index in tables
+    std::vector<UINT>  unused;      // removed animations, reused by add()
+    std::vector<FrameTable> tables;
+    bool    simd;               // true to use SSE2
+
+    // Return the table of the frame size, adding it if new.
+    UINT    findTable(int width, int height, int cols);
+
+    // Make table n hold at least frames rects.
+    void    growTable(UINT n, int frames);
+
+  public:
+    // Constructor
+    Animator();
+
+    // Add an animation of frames width x height, cols frames in a row.
+    // The animation starts the same as a new Image: frames 0 to 0, 1
+    // second per frame, looping.
+    // Returns the animation number.
+    UINT    add(int width, int height, int cols);
+
+    // Remove animation n. The number may be returned by a later add().
+    void    remove(UINT n);
+
+    // Advance every animation by frameTime, the same as Image::update().
+    void    update(float frameTime);
+
+    // Set the frame size of animation n, when the size of an Image changes.
+    void    setFrameSize(UINT n, int width, int height, int cols);
+
+    // Return the rect of the current frame of animation n, relative to the
+    // image. Valid until the next add() or set function.
+    const RECT& getFrameRect(UINT n) const
+    {
+        return tables[table[n]].rects[current[n]];
+    }
+
+    // Set first and last frame of animation n.
+    void    setFrames(UINT n, int s, int e);
+
+    // Set current frame of animation n and clear animation complete, the
+    // same as Image::setCurrentFrame(). c < 0 is ignored.
+    void    setCurrentFrame(UINT n, int c);
+
+    // Set delay between frames of animation n.
+    void    setFrameDelay(UINT n, float d)  {delay[n] = d;}
+
+    // Set loop of animation n.
+    void    setLoop(UINT n, bool lp)        {loop[n] = lp ? -1 : 0;}
+
+    // Set animation complete of animation n.
+    void    setAnimationComplete(UINT n, bool a) {complete[n] = a ? -1 : 0;}
+
+    // Set time since the last frame change of animation n.
+    void    setTimer(UINT n, float t)       {timer[n] = t;}
+
+    // Return state of animation n.
+    int     getCurrentFrame(UINT n) const   {return current[n];}
+    int     getStartFrame(UINT n) const     {return start[n];}
+    int     getEndFrame(UINT n) const       {return end[n];}
+    float   getFrameDelay(UINT n) const     {return delay[n];}
+    bool    getLoop(UINT n) const           {return loop[n] != 0;}
+    bool    getAnimationComplete(UINT n) const {return complete[n] != 0;}
+    float   getTimer(UINT n) const          {return timer[n];}
+
+    // Return number of animations, not counting removed ones.
+    UINT    getCount() const    {return (UINT)(current.size() - unused.size());}
+
+    // Use SSE2 if the CPU has it (default), false for the scalar version.
+    // The results are the same.
+    void    setSimd(bool s);
+
+    // Return true if SSE2 is used.
+    bool    getSimd() const     {return simd;}
+};
+
+#endif
@@ -0,0 +1,438 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// assetPack.cpp v1.0
+// Memory mapped pack of asset files, see assetPack.h
+
+#include "assetPack.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//=============================================================================
+// Constructor
+//=============================================================================
+AssetPack::AssetPack()
+{
+    base = NULL;
+    size = 0;
+    header = NULL;
+    entries = NULL;
+    names = NULL;
+#ifdef _WIN32
+    file = INVALID_HANDLE_VALUE;
+    mapping = NULL;
+#else
+    file = -1;
+#endif
+}
+
+//=============================================================================
+// Destructor
+//=============================================================================
+AssetPack::~AssetPack()
+{
+    close();
+}
+
+//=============================================================================
+// Map the pack file
+// Returns false if the file can not be mapped or is not a valid pack
+//=============================================================================
+bool AssetPack::open(const char *filename)
+{
+    close();
+    if (filename == NULL)
+        return false;
+#ifdef _WIN32
+    file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(PackHeader))
+    {
+        close();
+        return false;
+    }
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL)
+    {
+        close();
+        return false;
+    }
+    base = (const BYTE*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    size = (size_t)fileSize.QuadPart;
+#else
+    file = ::open(filename, O_RDONLY);
+    if (file < 0)
+        return false;
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size < (off_t)sizeof(PackHeader))
+    {
+        close();
+        return false;
+    }
+    void *view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, file, 0);
+    if (view != MAP_FAILED)
+        base = (const BYTE*)view;
+    size = (size_t)info.st_size;
+#endif
+    if (base == NULL)
+    {
+        close();
+        return false;
+    }
+    header = (const PackHeader*)base;
+    entries = (const PackEntry*)(base + sizeof(PackHeader));
+    names = (const char*)(base + header->namesOffset);
+    if (!validate())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+//=============================================================================
+// Unmap the pack file
+//=============================================================================
+void AssetPack::close()
+{
+#ifdef _WIN32
+    if (base)
+        UnmapViewOfFile(base);
+    if (mapping)
+        CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+    mapping = NULL;
+    file = INVALID_HANDLE_VALUE;
+#else
+    if (base)
+        munmap((void*)base, size);
+    if (file >= 0)
+        ::close(file);
+    file = -1;
+#endif
+    base = NULL;
+    size = 0;
+    header = NULL;
+    entries = NULL;
+    names = NULL;
+}
+
+//=============================================================================
+// Check the header and every entry lie inside the file
+// A damaged pack is rejected by open() instead of read out of bounds later.
+// The used entries must match assetCount and leave an unused one, which
+// ends every probe of findEntry().
+//=============================================================================
+bool AssetPack::validate() const
+{
+    if (header->magic != assetPackNS::MAGIC || header->version == 0 ||
+        header->version > assetPackNS::VERSION)
+        return false;
+    if (header->fileSize != size)
+        return false;
+    UINT slots = header->slotCount;
+    if (slots == 0 || (slots & (slots-1)) != 0 || header->assetCount > slots)
+        return false;
+    UINT64 tocEnd = sizeof(PackHeader) + (UINT64)slots*sizeof(PackEntry);
+    if (tocEnd > size || header->namesOffset < tocEnd ||
+        (UINT64)header->namesOffset + header->namesSize > size)
+        return false;
+    if (header->namesSize == 0 || names[header->namesSize-1] != '\0')
+        return false;
+    UINT used = 0;
+    for (UINT i = 0; i < slots; i++)
+    {
+        const PackEntry &e = entries[i];
+        if (e.offset == 0)
+            continue;
+        if (e.offset > size || e.size > size - e.offset || e.nameOffset >= header->namesSize)
+            return false;
+        used++;
+    }
+    return used == header->assetCount && used < slots;
+}
+
+//=============================================================================
+// Return the table entry of id, NULL if not found
+// Linear probing from id. validate() keeps an unused entry, the probe is
+// also limited to one pass over the table.
+//=============================================================================
+const PackEntry* AssetPack::findEntry(UINT id) const
+{
+    if (header == NULL)
+        return NULL;
+    UINT mask = header->slotCount - 1;
+    UINT i = id & mask;
+    for (UINT n = 0; n <= mask; n++, i = (i+1) & mask)
+    {
+        const PackEntry *e = &entries[i];
+        if (e->offset == 0)
+            return NULL;
+        if (e->id == id)
+            return e;
+    }
+    return NULL;
+}
+
+//=============================================================================
+// Find the asset with id
+// Returns false if not found
+//=============================================================================
+bool AssetPack::find(UINT id, const BYTE *&data, size_t &bytes) const
+{
+    const PackEntry *e = findEntry(id);
+    if (e == NULL)
+        return false;
+    data = base + e->offset;
+    bytes = (size_t)e->size;
+    return true;
+}
+
+//=============================================================================
+// Find the asset packed as name
+// The entry with the ID of name must also have the name, another name with
+// the same ID is not the asset.
+// Returns false if not found
+//=============================================================================
+bool AssetPack::find(const char *name, const BYTE *&data, size_t &bytes) const
+{
+    if (name == NULL)
+        return false;
+    const PackEntry *e = findEntry(getId(name));
+    if (e == NULL || !sameName(name, names + e->nameOffset))
+        return false;
+    data = base + e->offset;
+    bytes = (size_t)e->size;
+    return true;
+}
+
+//=============================================================================
+// Get the asset in a table entry
+// Returns false if the entry is not used
+//=============================================================================
+bool AssetPack::getAsset(UINT slot, const char *&name, const BYTE *&data, size_t &bytes) const
+{
+    if (header == NULL || slot >= header->slotCount || entries[slot].offset == 0)
+        return false;
+    const PackEntry &e = entries[slot];
+    name = names + e.nameOffset;
+    data = base + e.offset;
+    bytes = (size_t)e.size;
+    return true;
+}
+
+//=============================================================================
+// Return a character of a name lower case, with '/' for '\'
+//=============================================================================
+static inline char normalChar(char ch)
+{
+    if (ch == '\\')
+        return '/';
+    if (ch >= 'A' && ch <= 'Z')
+        return ch - 'A' + 'a';
+    return ch;
+}
+
+//=============================================================================
+// Return the ID of an asset name
+// FNV-1a of the normalized name
+//=============================================================================
+UINT AssetPack::getId(const char *name)
+{
+    UINT hash = assetPackNS::FNV_OFFSET;
+    for (const char *c = name; *c; c++)
+        hash = (hash ^ (BYTE)normalChar(*c)) * assetPackNS::FNV_PRIME;
+    return hash;
+}
+
+//=============================================================================
+// Return true if a and b are the same name
+// Compares a character at a time, so nothing is allocated.
+//=============================================================================
+bool AssetPack::sameName(const char *a, const char *b)
+{
+    for (;; a++, b++)
+    {
+        char ch = normalChar(*a);
+        if (ch != normalChar(*b))
+            return false;
+        if (ch == '\0')
+            return true;
+    }
+}
+
+//=============================================================================
+// Return name lower case with '/'
+//=============================================================================
+std::string AssetPack::normalizeName(const char *name)
+{
+    std::string s(name);
+    for (size_t i = 0; i < s.size(); i++)
+        s[i] = normalChar(s[i]);
+    return s;
+}
+
+//=============================================================================
+// Return name with '/' for '\'
+//=============================================================================
+std::string AssetPack::packedName(const char *name)
+{
+    std::string s(name);
+    for (size_t i = 0; i < s.size(); i++)
+        if (s[i] == '\\')
+            s[i] = '/';
+    return s;
+}
+
+//=============================================================================
+// Add the file to the pack
+// Returns false if the file can not be read or the name is already used
+//=============================================================================
+bool AssetPackWriter::add(const char *name, const char *filename)
+{
+    FILE *f = fopen(filename, "rb");
+    if (f == NULL)
+    {
+        error = std::string("can not open ") + filename;
+        return false;
+    }
+    std::vector<BYTE> data;
+    fseek(f, 0, SEEK_END);
+    long bytes = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    bool ok = bytes >= 0;
+    if (ok && bytes > 0)
+    {
+        data.resize(bytes);
+        ok = fread(&data[0], 1, bytes, f) == (size_t)bytes;
+    }
+    fclose(f);
+    if (!ok)
+    {
+        error = std::string("can not read ") + filename;
+        return false;
+    }
+    if (!add(name, data.empty() ? NULL : &data[0], 0))
+        return false;
+    assets.back().data.swap(data);
+    return true;
+}
+
+//=============================================================================
+// Add an asset from memory
+// Returns false if the name or its ID is already used
+//=============================================================================
+bool AssetPackWriter::add(const char *name, const BYTE *data, size_t bytes)
+{
+    if (name == NULL || *name == '\0')
+    {
+        error = "asset has no name";
+        return false;
+    }
+    std::string packed = AssetPack::packedName(name);
+    UINT id = AssetPack::getId(name);
+    for (size_t i = 0; i < assets.size(); i++)
+    {
+        if (AssetPack::getId(assets[i].name.c_str()) != id)
+            continue;
+        if (AssetPack::sameName(assets[i].name.c_str(), name))
+            error = "duplicate asset " + packed;
+        else
+            error = "asset ID of " + packed + " is the same as " + assets[i].name + ", rename one";
+        return false;
+    }
+    assets.push_back(Asset());
+    assets.back().name = packed;
+    if (bytes > 0)
+        assets.back().data.assign(data, data + bytes);
+    return true;
+}
+
+//=============================================================================
+// Write the pack file
+// Returns false on error
+//=============================================================================
+bool AssetPackWriter::write(const char *filename)
+{
+    // table at most half full so probes stay short
+    UINT slots = 1;
+    while (slots < assets.size()*2)
+        slots *= 2;
+    std::vector<PackEntry> table(slots);
+    memset(&table[0], 0, slots*sizeof(PackEntry));
+
+    std::string nameData;
+    UINT64 offset = sizeof(PackHeader) + (UINT64)slots*sizeof(PackEntry);
+    UINT namesOffset = (UINT)offset;
+    for (size_t i = 0; i < assets.size(); i++)
+        nameData.append(assets[i].name.c_str(), assets[i].name.size() + 1);
+    if (nameData.empty())
+        nameData.push_back('\0');
+    offset += nameData.size();
+
+    UINT nameOffset = 0;
+    std::vector<UINT64> dataOffset(assets.size());
+    for (size_t i = 0; i < assets.size(); i++)
+    {
+        offset = (offset + assetPackNS::ALIGNMENT-1) & ~(UINT64)(assetPackNS::ALIGNMENT-1);
+        dataOffset[i] = offset;
+        UINT id = AssetPack::getId(assets[i].name.c_str());
+        UINT slot = id & (slots-1);
+        while (table[slot].offset != 0)
+            slot = (slot+1) & (slots-1);
+        table[slot].id = id;
+        table[slot].nameOffset = nameOffset;
+        table[slot].offset = offset;
+        table[slot].size = assets[i].data.size();
+        nameOffset += (UINT)assets[i].name.size() + 1;
+        offset += assets[i].data.size();
+    }
+
+    PackHeader header;
+    header.magic = assetPackNS::MAGIC;
+    header.version = assetPackNS::VERSION;
+    header.slotCount = slots;
+    header.assetCount = (UINT)assets.size();
+    header.namesOffset = namesOffset;
+    header.namesSize = (UINT)nameData.size();
+    header.fileSize = offset;
+
+    FILE *f = fopen(filename, "wb");
+    if (f == NULL)
+    {
+        error = std::string("can not create ") + filename;
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    ok = ok && fwrite(&table[0], sizeof(PackEntry), slots, f) == slots;
+    ok = ok && fwrite(nameData.data(), 1, nameData.size(), f) == nameData.size();
+    UINT64 at = namesOffset + nameData.size();
+    static const BYTE zeros[assetPackNS::ALIGNMENT] = {0};
+    for (size_t i = 0; ok && i < assets.size(); i++)
+    {
+        size_t pad = (size_t)(dataOffset[i] - at);
+        ok = fwrite(zeros, 1, pad, f) == pad;
+        if (ok && !assets[i].data.empty())
+            ok = fwrite(&assets[i].data[0], 1, assets[i].data.size(), f) == assets[i].data.size();
+        at = dataOffset[i] + assets[i].data.size();
+    }
+    if (fclose(f) != 0)
+        ok = false;
+    if (!ok)
+    {
+        error = std::string("can not write ") + filename;
+        remove(filename);
+    }
+    return ok;
+}
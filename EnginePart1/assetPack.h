@@ -0,0 +1,162 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// assetPack.h v1.0
+// An AssetPack is one file holding many asset files. The pack is memory
+// mapped once and each asset is returned as a pointer into the mapping, so
+// loading an asset does not open or copy a file. Processes using the same
+// pack share its pages in the file cache.
+// Assets are found by ID, a hash of the file name the asset was packed as,
+// so the image names in constants.h work unchanged. See Graphics::setAssetPack().
+// Packs are made with the AssetTool program:
+//   AssetTool pack assets.pak pictures\orion.jpg pictures\planet.png
+//
+// File layout, little endian:
+//   PackHeader
+//   PackEntry[slotCount]   table of contents, open addressing by ID
+//   names                  '\0' terminated, as packed with '/' for '\', for
+//                          listing and unpacking
+//   asset data             each starting at a multiple of ALIGNMENT
+
+#ifndef _ASSETPACK_H            // Prevent multiple definitions if this
+#define _ASSETPACK_H            // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <string>
+#include <vector>
+#include "constants.h"
+
+namespace assetPackNS
+{
+    const UINT MAGIC = 0x4B415041;      // "APAK"
+    const UINT VERSION = 2;             // 2 keeps the case of names, 1 stored them lower case
+    const UINT ALIGNMENT = 64;          // of asset data in the file, one cache line
+    const UINT FNV_OFFSET = 2166136261u;
+    const UINT FNV_PRIME = 16777619u;
+}
+
+struct PackHeader
+{
+    UINT    magic;          // assetPackNS::MAGIC
+    UINT    version;        // assetPackNS::VERSION
+    UINT    slotCount;      // entries in the table of contents, a power of 2
+    UINT    assetCount;     // used entries
+    UINT    namesOffset;    // file offset of the names
+    UINT    namesSize;      // bytes of names
+    UINT64  fileSize;       // size of the pack file
+};
+
+struct PackEntry
+{
+    UINT    id;             // AssetPack::getId() of the name
+    UINT    nameOffset;     // offset of the name in the names
+    UINT64  offset;         // file offset of the data, 0 for an unused entry
+    UINT64  size;           // bytes of data
+};
+
+class AssetPack
+{
+  private:
+    const BYTE *base;       // start of the mapped file
+    size_t  size;           // bytes mapped
+    const PackHeader *header;
+    const PackEntry  *entries;
+    const char *names;
+#ifdef _WIN32
+    HANDLE  file;
+    HANDLE  mapping;
+#else
+    int     file;
+#endif
+
+    // Return the entry of id, NULL if not found.
+    const PackEntry* findEntry(UINT id) const;
+
+    // Return false if the mapped file is not a valid pack.
+    bool validate() const;
+
+  public:
+    // Constructor
+    AssetPack();
+
+    // Destructor, closes the pack
+    virtual ~AssetPack();
+
+    // Map the pack file.
+    // Returns false if the file can not be mapped or is not a valid pack.
+    bool open(const char *filename);
+
+    // Unmap the pack file. Pointers to assets are no longer valid.
+    void close();
+
+    // Return true if a pack is open.
+    bool isOpen() const     {return base != NULL;}
+
+    // Find the asset with id.
+    // Post: data points to the asset in the mapped file, size = bytes
+    // Returns false if not found.
+    bool find(UINT id, const BYTE *&data, size_t &size) const;
+
+    // Find the asset packed as name. The ID of name is looked up and the
+    // name packed with it must match.
+    bool find(const char *name, const BYTE *&data, size_t &size) const;
+
+    // Return number of assets.
+    UINT getAssetCount() const  {return header ? header->assetCount : 0;}
+
+    // Return number of table entries, used and unused.
+    UINT getSlotCount() const   {return header ? header->slotCount : 0;}
+
+    // Get the asset in table entry slot, for listing the pack.
+    // Returns false if the entry is not used.
+    bool getAsset(UINT slot, const char *&name, const BYTE *&data, size_t &size) const;
+
+    // Return the ID of an asset name. The name is hashed with FNV-1a,
+    // ignoring case, with '\' and '/' the same.
+    static UINT getId(const char *name);
+
+    // Return name lower case with '/', the form its ID is hashed from.
+    static std::string normalizeName(const char *name);
+
+    // Return name with '/' for '\', the form stored in a pack, so unpacked
+    // files keep the case they were packed with.
+    static std::string packedName(const char *name);
+
+    // Return true if a and b are the same asset name, ignoring case, with
+    // '\' and '/' the same.
+    static bool sameName(const char *a, const char *b);
+};
+
+// Builds pack files, used by AssetTool.
+class AssetPackWriter
+{
+  private:
+    struct Asset
+    {
+        std::string name;       // see AssetPack::packedName()
+        std::vector<BYTE> data;
+    };
+    std::vector<Asset> assets;
+    std::string error;
+
+  public:
+    // Add the file, named name in the pack.
+    // Returns false if the file can not be read or the name is already used.
+    bool add(const char *name, const char *file);
+
+    // Add an asset from memory.
+    // Returns false if the name is already used.
+    bool add(const char *name, const BYTE *data, size_t size);
+
+    // Write the pack file.
+    // Returns false on error.
+    bool write(const char *filename);
+
+    // Return number of assets added.
+    UINT getAssetCount() const  {return (UINT)assets.size();}
+
+    // Return description of the last error.
+    const std::string& getError() const {return error;}
+};
+
+#endif
@@ -0,0 +1,251 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// broadphase.cpp v1.0
+// Spatial hash grid of object bounds, see broadphase.h
+
+#include "broadphase.h"
+#include <cmath>
+
+//=============================================================================
+// Constructor
+//=============================================================================
+Broadphase::Broadphase()
+{
+    tableSize = 0;
+    setCellSize(broadphaseNS::CELL_SIZE);
+}
+
+//=============================================================================
+// Set the size of a grid cell
+//=============================================================================
+void Broadphase::setCellSize(float size)
+{
+    if (size < 1.0f)
+        size = 1.0f;
+    cellSize = size;
+    invCellSize = 1.0f / size;
+}
+
+//=============================================================================
+// Return the cell of a coordinate
+// Clamped before the conversion to int, which is undefined for a float out
+// of range. NaN fails every comparison and becomes -MAX_CELL.
+//=============================================================================
+inline int Broadphase::cell(float v) const
+{
+    float c = floor(v * invCellSize);
+    if (!(c > -broadphaseNS::MAX_CELL))
+        c = -broadphaseNS::MAX_CELL;
+    else if (c > broadphaseNS::MAX_CELL)
+        c = broadphaseNS::MAX_CELL;
+    return (int)c;
+}
+
+//=============================================================================
+// Remove all objects
+// The arrays keep their memory for the next frame.
+//=============================================================================
+void Broadphase::clear()
+{
+    left.clear();
+    top.clear();
+    right.clear();
+    bottom.clear();
+    user.clear();
+    entity.clear();
+}
+
+//=============================================================================
+// Add an object
+// Returns the object number
+//=============================================================================
+UINT Broadphase::add(float l, float t, float r, float b, UINT u)
+{
+    EntityId none = {0, 0};
+    left.push_back(l);
+    top.push_back(t);
+    right.push_back(r);
+    bottom.push_back(b);
+    user.push_back(u);
+    entity.push_back(none);
+    return (UINT)left.size() - 1;
+}
+
+//=============================================================================
+// Add every entity with TRANSFORM and COLLIDER
+//=============================================================================
+void Broadphase::addEntities(EntityStore *store)
+{
+    if (store == NULL)
+        return;
+    for (UINT n = 0; n < store->getArchetypeCount(); n++)
+    {
+        Archetype &a = store->getArchetype(n);
+        if (a.count == 0 || !a.has(entityStoreNS::TRANSFORM | entityStoreNS::COLLIDER))
+            continue;
+        bool sprite = a.has(entityStoreNS::SPRITE);
+        for (UINT i = 0; i < a.count; i++)
+        {
+            float scale = a.scale[i];
+            float cx = a.x[i];                      // collider center
+            float cy = a.y[i];
+            if (sprite)
+            {
+                cx += a.width[i] * scale * 0.5f;
+                cy += a.height[i] * scale * 0.5f;
+            }
+            float ex, ey;                           // half size of the bounds
+            switch (a.colliderType[i])
+            {
+            case entityStoreNS::CIRCLE:
+                ex = ey = a.radius[i] * scale;
+                break;
+            case entityStoreNS::BOX:
+                ex = a.halfWidth[i] * scale;
+                ey = a.halfHeight[i] * scale;
+                break;
+            default:                                // ROTATED_BOX
+                {
+                    float c = fabs(cos(a.angle[i]));
+                    float s = fabs(sin(a.angle[i]));
+                    ex = (a.halfWidth[i]*c + a.halfHeight[i]*s) * scale;
+                    ey = (a.halfWidth[i]*s + a.halfHeight[i]*c) * scale;
+                }
+                break;
+            }
+            UINT obj = add(cx - ex, cy - ey, cx + ex, cy + ey, a.ids[i].index);
+            entity[obj] = a.ids[i];
+        }
+    }
+}
+
+//=============================================================================
+// Add the pair if the bounds of a and b overlap
+//=============================================================================
+inline void Broadphase::testPair(UINT a, UINT b)
+{
+    if (left[a] < right[b] && left[b] < right[a] &&
+        top[a] < bottom[b] && top[b] < bottom[a])
+    {
+        BroadphasePair p;
+        p.a = a < b ? a : b;
+        p.b = a < b ? b : a;
+        pairs.push_back(p);
+    }
+}
+
+//=============================================================================
+// Find the pairs of objects whose bounds overlap
+// Each object is entered in the hash bucket of every cell it covers. Two
+// objects in a bucket are tested if they are in the same cell, and the pair
+// is kept only in the cell of the top left corner of the overlap, so it is
+// found once.
+//=============================================================================
+const std::vector<BroadphasePair>& Broadphase::findPairs()
+{
+    pairs.clear();
+    cellX.clear();
+    cellY.clear();
+    cellObject.clear();
+    large.clear();
+    UINT count = (UINT)left.size();
+    isLarge.assign(count, 0);
+
+    // enter the cells of each object
+    for (UINT n = 0; n < count; n++)
+    {
+        int x0 = cell(left[n]);
+        int x1 = cell(right[n]);
+        int y0 = cell(top[n]);
+        int y1 = cell(bottom[n]);
+        // 64 bit, the cells of huge bounds overflow 32 bits
+        if ((UINT64)(x1 - x0 + 1) * (UINT64)(y1 - y0 + 1) > broadphaseNS::MAX_CELLS)
+        {
+            large.push_back(n);
+            isLarge[n] = 1;
+            continue;
+        }
+        for (int y = y0; y <= y1; y++)
+            for (int x = x0; x <= x1; x++)
+            {
+                cellX.push_back(x);
+                cellY.push_back(y);
+                cellObject.push_back(n);
+            }
+    }
+
+    // counting sort of the entries by bucket
+    UINT entries = (UINT)cellObject.size();
+    UINT size = 64;
+    while (size < entries * 2)
+        size *= 2;
+    tableSize = size;
+    bucketStart.assign(tableSize + 1, 0);
+    cellBucket.resize(entries);
+    for (UINT e = 0; e < entries; e++)
+    {
+        UINT h = ((UINT)cellX[e] * 73856093u) ^ ((UINT)cellY[e] * 19349663u);
+        cellBucket[e] = h & (tableSize - 1);
+        bucketStart[cellBucket[e] + 1]++;
+    }
+    for (UINT b = 0; b < tableSize; b++)
+        bucketStart[b + 1] += bucketStart[b];
+    sortedX.resize(entries);
+    sortedY.resize(entries);
+    sortedObject.resize(entries);
+    for (UINT e = 0; e < entries; e++)
+    {
+        UINT to = bucketStart[cellBucket[e]]++;     // next free entry of the bucket
+        sortedX[to] = cellX[e];
+        sortedY[to] = cellY[e];
+        sortedObject[to] = cellObject[e];
+    }
+    // the scatter moved each start to the start of the next bucket
+    for (UINT b = tableSize; b > 0; b--)
+        bucketStart[b] = bucketStart[b - 1];
+    bucketStart[0] = 0;
+
+    // compare the objects in each bucket
+    for (UINT b = 0; b < tableSize; b++)
+    {
+        UINT end = bucketStart[b + 1];
+        for (UINT i = bucketStart[b]; i + 1 < end; i++)
+        {
+            UINT oi = sortedObject[i];
+            int x = sortedX[i];
+            int y = sortedY[i];
+            for (UINT j = i + 1; j < end; j++)
+            {
+                UINT oj = sortedObject[j];
+                if (oj == oi || sortedX[j] != x || sortedY[j] != y)
+                    continue;                       // same object or another cell
+                // only the cell of the top left corner of the overlap reports the pair
+                if (cell(left[oi] > left[oj] ? left[oi] : left[oj]) != x ||
+                    cell(top[oi] > top[oj] ? top[oi] : top[oj]) != y)
+                    continue;
+                testPair(oi, oj);
+            }
+        }
+    }
+
+    // objects too large for the grid are compared with every object
+    for (UINT i = 0; i < large.size(); i++)
+    {
+        UINT l = large[i];
+        for (UINT n = 0; n < count; n++)
+            if (n != l && (!isLarge[n] || n > l))
+                testPair(l, n);
+    }
+    return pairs;
+}
+
+//=============================================================================
+// Clear, add the entities of store and find the pairs
+//=============================================================================
+const std::vector<BroadphasePair>& Broadphase::update(EntityStore *store)
+{
+    clear();
+    addEntities(store);
+    return findPairs();
+}
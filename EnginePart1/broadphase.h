@@ -0,0 +1,127 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// broadphase.h v1.0
+// A Broadphase finds the pairs of objects whose bounding boxes overlap,
+// the candidates for an exact collision test, without testing every pair.
+// Bounds are entered in a uniform grid of square cells, hashed into a
+// table, and only objects sharing a cell are compared. A pair sharing more
+// than one cell is reported once, by the cell holding the top left corner
+// of the overlap.
+// The grid is rebuilt by findPairs() from the bounds added since clear(),
+// with a counting sort into the hash table, so the cost is linear in the
+// number of objects. The arrays keep their size between frames, and no
+// memory is allocated once the number of objects stops growing.
+// Game owns a Broadphase that is filled from the entities with a COLLIDER
+// before collisions() is called, see Game::getBroadphase(). update()
+// clears it every tick and the Narrowphase of Game relies on its object
+// numbers, so it is read only. Other objects, such as Images, need a
+// Broadphase of their own, filled with add().
+// The cell size should be about the size of the common object: much
+// smaller puts each object in many cells, much larger compares objects
+// that are far apart.
+
+#ifndef _BROADPHASE_H           // Prevent multiple definitions if this
+#define _BROADPHASE_H           // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+#include "entityStore.h"
+
+namespace broadphaseNS
+{
+    const float CELL_SIZE = 64.0f;  // default cell size in pixels
+    // Objects covering more cells than this are not entered in the grid,
+    // they are compared with every object instead.
+    const UINT MAX_CELLS = 256;
+    // Cell coordinates are clamped to +-MAX_CELL, bounds that are not a
+    // number to -MAX_CELL, so they always convert to an int.
+    const float MAX_CELL = 16777216.0f;
+}
+
+// Two overlapping objects, by their number from add(). a < b.
+struct BroadphasePair
+{
+    UINT    a;
+    UINT    b;
+};
+
+class Broadphase
+{
+  private:
+    float   cellSize;
+    float   invCellSize;
+    // objects, element n is object n
+    std::vector<float> left;
+    std::vector<float> top;
+    std::vector<float> right;
+    std::vector<float> bottom;
+    std::vector<UINT>  user;
+    std::vector<EntityId> entity;
+    // grid cells of the objects, entries in the hash table
+    std::vector<int>   cellX;
+    std::vector<int>   cellY;
+    std::vector<UINT>  cellObject;
+    std::vector<UINT>  cellBucket;
+    // entries sorted by bucket
+    std::vector<int>   sortedX;
+    std::vector<int>   sortedY;
+    std::vector<UINT>  sortedObject;
+    std::vector<UINT>  bucketStart;     // first entry of bucket n, tableSize+1 elements
+    std::vector<UINT>  large;           // objects not in the grid
+    std::vector<BYTE>  isLarge;         // by object, 1 if in large
+    std::vector<BroadphasePair> pairs;
+    UINT    tableSize;                  // buckets, a power of 2
+
+    // Return the cell of a coordinate, clamped to +-MAX_CELL.
+    int     cell(float v) const;
+
+    // Add the pair if the bounds of a and b overlap.
+    void    testPair(UINT a, UINT b);
+
+  public:
+    // Constructor
+    Broadphase();
+
+    // Set the size of a grid cell in pixels.
+    void    setCellSize(float size);
+
+    // Return the size of a grid cell.
+    float   getCellSize() const     {return cellSize;}
+
+    // Remove all objects.
+    void    clear();
+
+    // Add an object with bounds left, top to right, bottom.
+    // u = value for the game, see getUser()
+    // Returns the object number used in the pairs.
+    UINT    add(float l, float t, float r, float b, UINT u = 0);
+
+    // Add every entity with TRANSFORM and COLLIDER in store. The bounds
+    // hold the collider at its scale and angle. getUser() of an entity is
+    // its EntityId::index.
+    void    addEntities(EntityStore *store);
+
+    // Return number of objects.
+    UINT    getCount() const        {return (UINT)left.size();}
+
+    // Return the value of object n given to add().
+    UINT    getUser(UINT n) const   {return user[n];}
+
+    // Return the entity of object n, a zero EntityId if it was not added
+    // by addEntities().
+    EntityId getEntity(UINT n) const {return entity[n];}
+
+    // Find the pairs of objects whose bounds overlap. Touching bounds do
+    // not overlap. Returns getPairs().
+    const std::vector<BroadphasePair>& findPairs();
+
+    // Return the pairs found by the last findPairs().
+    const std::vector<BroadphasePair>& getPairs() const {return pairs;}
+
+    // Clear, add the entities of store and find the pairs.
+    // Called by Game::run() before collisions().
+    const std::vector<BroadphasePair>& update(EntityStore *store);
+};
+
+#endif
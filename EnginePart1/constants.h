@@ -6,7 +6,7 @@
 #define _CONSTANTS_H            // file is included in more than one place
 #define WIN32_LEAN_AND_MEAN
 
-#include <windows.h>
+#include "platform.h"
 
 //-----------------------------------------------
 // Useful macros
@@ -29,6 +29,7 @@
 // graphic images
 const char NEBULA_IMAGE[] = "pictures\\orion.jpg";  // photo source NASA/courtesy of nasaimages.org 
 const char PLANET_IMAGE[] = "pictures\\planet.png"; // picture of planet
+const char ASSET_PACK[] = "assets.pak";     // images are loaded from here when it exists, see assetPack.h
 
 // window
 const char CLASS_NAME[] = "Spacewar";
@@ -43,6 +44,7 @@ const float FRAME_RATE  = 200.0f;               // the target frame rate (frames
 const float MIN_FRAME_RATE = 10.0f;             // the minimum frame rate
 const float MIN_FRAME_TIME = 1.0f/FRAME_RATE;   // minimum desired time for 1 frame
 const float MAX_FRAME_TIME = 1.0f/MIN_FRAME_RATE; // maximum time used in calculations
+const float TICK_RATE = 60.0f;                  // simulation updates/sec in fixed time step mode
 
 // key mappings
 // In this game simple constants are used for key mappings. If variables were used
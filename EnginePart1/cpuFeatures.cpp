@@ -0,0 +1,58 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// cpuFeatures.cpp v1.0
+// Instruction sets of the CPU, see cpuFeatures.h
+
+#include "cpuFeatures.h"
+#if defined(CPU_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifdef CPU_X86
+
+//=============================================================================
+// Return true if the CPU has SSE2
+//=============================================================================
+bool CpuFeatures::hasSSE2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2") != 0;
+#endif
+}
+
+//=============================================================================
+// Return true if the CPU has AVX and the OS saves the YMM registers
+//=============================================================================
+bool CpuFeatures::hasAVX()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    // AVX needs CPU support and the OS saving the YMM registers (OSXSAVE)
+    return (info[2] & (1 << 28)) != 0 && (info[2] & (1 << 27)) != 0 &&
+           (_xgetbv(0) & 6) == 6;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx") != 0;
+#endif
+}
+
+#else   // not x86
+
+bool CpuFeatures::hasSSE2()
+{
+    return false;
+}
+
+bool CpuFeatures::hasAVX()
+{
+    return false;
+}
+
+#endif  // CPU_X86
@@ -0,0 +1,40 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// cpuFeatures.h v1.0
+// Instruction sets of the CPU, for the classes with SIMD kernels.
+// CPU_X86 is defined when compiling for x86 or x64, and then the SSE2 and
+// AVX intrinsics are included. GCC and Clang only generate those
+// instructions in functions marked TARGET_SSE2 or TARGET_AVX, so mark each
+// kernel and call it only when the CPU has the instruction set.
+
+#ifndef _CPUFEATURES_H          // Prevent multiple definitions if this
+#define _CPUFEATURES_H          // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define CPU_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX  __attribute__((target("avx")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX
+#endif
+
+class CpuFeatures
+{
+  public:
+    // Return true if the CPU has SSE2. False when not compiled for x86.
+    static bool hasSSE2();
+
+    // Return true if the CPU has AVX and the operating system saves the
+    // YMM registers. False when not compiled for x86.
+    static bool hasAVX();
+};
+
+#endif
@@ -0,0 +1,772 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// entityStore.cpp v1.0
+// Archetype tables of entity components, see entityStore.h
+
+#include "entityStore.h"
+#include <cmath>
+
+using namespace entityStoreNS;
+
+//=============================================================================
+// Move the last element of v into element row and remove the last
+//=============================================================================
+template <class T>
+static void swapRemove(std::vector<T> &v, UINT row)
+{
+    if (v.empty())
+        return;
+    v[row] = v.back();
+    v.pop_back();
+}
+
+//=============================================================================
+// Add a row with default components
+// Returns the row
+//=============================================================================
+UINT Archetype::addRow(EntityId id)
+{
+    ids.push_back(id);
+    flags.push_back(VISIBLE | ((mask & TRANSFORM) ? NEW_ROW : 0));
+    if (mask & TRANSFORM)
+    {
+        x.push_back(0);
+        y.push_back(0);
+        scale.push_back(1);
+        angle.push_back(0);
+        prevX.push_back(0);
+        prevY.push_back(0);
+        prevAngle.push_back(0);
+    }
+    if (mask & SPRITE)
+    {
+        RECT r = {0, 0, 0, 0};
+        texture.push_back(NULL);
+        width.push_back(0);
+        height.push_back(0);
+        rect.push_back(r);
+        layer.push_back(0);
+        color.push_back(graphicsNS::WHITE);
+    }
+    if (mask & ANIMATION)
+    {
+        animation.push_back(0);             // set by EntityStore
+        cols.push_back(1);
+    }
+    if (mask & VELOCITY)
+    {
+        vx.push_back(0);
+        vy.push_back(0);
+        spin.push_back(0);
+    }
+    if (mask & COLLIDER)
+    {
+        colliderType.push_back(CIRCLE);
+        radius.push_back(0);
+        halfWidth.push_back(0);
+        halfHeight.push_back(0);
+    }
+    return count++;
+}
+
+//=============================================================================
+// Remove row by moving the last row into it
+//=============================================================================
+void Archetype::removeRow(UINT row)
+{
+    swapRemove(ids, row);
+    swapRemove(flags, row);
+    swapRemove(x, row);
+    swapRemove(y, row);
+    swapRemove(scale, row);
+    swapRemove(angle, row);
+    swapRemove(prevX, row);
+    swapRemove(prevY, row);
+    swapRemove(prevAngle, row);
+    swapRemove(texture, row);
+    swapRemove(width, row);
+    swapRemove(height, row);
+    swapRemove(rect, row);
+    swapRemove(layer, row);
+    swapRemove(color, row);
+    swapRemove(animation, row);
+    swapRemove(cols, row);
+    swapRemove(vx, row);
+    swapRemove(vy, row);
+    swapRemove(spin, row);
+    swapRemove(colliderType, row);
+    swapRemove(radius, row);
+    swapRemove(halfWidth, row);
+    swapRemove(halfHeight, row);
+    count--;
+}
+
+//=============================================================================
+// Copy the components both Archetypes have from row fromRow of from
+//=============================================================================
+void Archetype::copyRow(UINT row, const Archetype &from, UINT fromRow)
+{
+    UINT both = mask & from.mask;
+    if (both & TRANSFORM)
+    {
+        flags[row] = from.flags[fromRow];
+        x[row] = from.x[fromRow];
+        y[row] = from.y[fromRow];
+        scale[row] = from.scale[fromRow];
+        angle[row] = from.angle[fromRow];
+        prevX[row] = from.prevX[fromRow];
+        prevY[row] = from.prevY[fromRow];
+        prevAngle[row] = from.prevAngle[fromRow];
+    }
+    else    // keep NEW_ROW of a new transform
+        flags[row] = (from.flags[fromRow] & ~NEW_ROW) | (flags[row] & NEW_ROW);
+    if (both & SPRITE)
+    {
+        texture[row] = from.texture[fromRow];
+        width[row] = from.width[fromRow];
+        height[row] = from.height[fromRow];
+        rect[row] = from.rect[fromRow];
+        layer[row] = from.layer[fromRow];
+        color[row] = from.color[fromRow];
+    }
+    if (both & ANIMATION)
+    {
+        animation[row] = from.animation[fromRow];
+        cols[row] = from.cols[fromRow];
+    }
+    if (both & VELOCITY)
+    {
+        vx[row] = from.vx[fromRow];
+        vy[row] = from.vy[fromRow];
+        spin[row] = from.spin[fromRow];
+    }
+    if (both & COLLIDER)
+    {
+        colliderType[row] = from.colliderType[fromRow];
+        radius[row] = from.radius[fromRow];
+        halfWidth[row] = from.halfWidth[fromRow];
+        halfHeight[row] = from.halfHeight[fromRow];
+    }
+}
+
+//=============================================================================
+// Constructor
+//=============================================================================
+EntityStore::EntityStore()
+{
+    graphics = NULL;
+    animator = NULL;
+    count = 0;
+}
+
+//=============================================================================
+// Destructor
+//=============================================================================
+EntityStore::~EntityStore()
+{
+    clear();
+    for (UINT n = 0; n < archetypes.size(); n++)
+        SAFE_DELETE(archetypes[n]);
+    archetypes.clear();
+}
+
+//=============================================================================
+// Initialize the store
+//=============================================================================
+void EntityStore::initialize(Graphics *g, Animator *a)
+{
+    graphics = g;
+    animator = a;
+}
+
+//=============================================================================
+// Return the Archetype of mask, adding it if new
+// There are few Archetypes, a scan is faster than a map.
+//=============================================================================
+Archetype* EntityStore::findArchetype(UINT mask)
+{
+    for (UINT n = 0; n < archetypes.size(); n++)
+        if (archetypes[n]->mask == mask)
+            return archetypes[n];
+    archetypes.push_back(new Archetype(mask));
+    return archetypes.back();
+}
+
+//=============================================================================
+// Return the slot of e, NULL if e is not alive
+//=============================================================================
+EntityStore::Slot* EntityStore::getSlot(EntityId e)
+{
+    if (e.index >= slots.size())
+        return NULL;
+    Slot &s = slots[e.index];
+    if (s.archetype == NULL || s.generation != e.generation)
+        return NULL;
+    return &s;
+}
+
+//=============================================================================
+// Remove row of a, updating the slot of the row moved into it
+//=============================================================================
+void EntityStore::removeRow(Archetype *a, UINT row)
+{
+    EntityId moved = a->ids.back();
+    a->removeRow(row);
+    if (row < a->count)
+        slots[moved.index].row = row;
+}
+
+//=============================================================================
+// Create an entity with default components
+//=============================================================================
+EntityId EntityStore::create(UINT mask)
+{
+    mask &= ALL;
+    EntityId e;
+    if (!freeSlots.empty())
+    {
+        e.index = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        Slot s = {NULL, 0, 1};
+        e.index = (UINT)slots.size();
+        slots.push_back(s);
+    }
+    Slot &s = slots[e.index];
+    e.generation = s.generation;
+    s.archetype = findArchetype(mask);
+    s.row = s.archetype->addRow(e);
+    if ((mask & ANIMATION) && animator)
+        s.archetype->animation[s.row] = animator->add(0, 0, 1);
+    count++;
+    return e;
+}
+
+//=============================================================================
+// Create an entity from an Image
+//=============================================================================
+EntityId EntityStore::create(Image &image, UINT mask)
+{
+    mask |= TRANSFORM | SPRITE;
+    if (image.getEndFrame() > image.getStartFrame())
+        mask |= ANIMATION;
+    EntityId e = create(mask);
+
+    const SpriteData &sd = image.getSpriteInfo();
+    TransformComponent t = {sd.x, sd.y, sd.scale, sd.angle};
+    setTransform(e, t);
+
+    SpriteComponent s;
+    s.texture = image.getTextureManager();
+    s.width = sd.width;
+    s.height = sd.height;
+    s.rect = image.getSpriteDataRect();
+    s.layer = sd.layer;
+    s.color = image.getColorFilter();
+    s.flipHorizontal = sd.flipHorizontal;
+    s.flipVertical = sd.flipVertical;
+    s.visible = image.getVisible();
+    setSprite(e, s);
+
+    if (mask & ANIMATION)
+    {
+        AnimationComponent an;
+        an.cols = image.getColumns();
+        an.startFrame = image.getStartFrame();
+        an.endFrame = image.getEndFrame();
+        an.currentFrame = image.getCurrentFrame();
+        an.frameDelay = image.getFrameDelay();
+        an.loop = image.getLoop();
+        an.complete = image.getAnimationComplete();
+        setAnimation(e, an);
+    }
+    return e;
+}
+
+//=============================================================================
+// Destroy e
+//=============================================================================
+void EntityStore::destroy(EntityId e)
+{
+    Slot *s = getSlot(e);
+    if (s == NULL)
+        return;
+    Archetype *a = s->archetype;
+    if ((a->mask & ANIMATION) && animator)
+        animator->remove(a->animation[s->row]);
+    removeRow(a, s->row);
+    s->archetype = NULL;
+    if (++s->generation == 0)       // 0 is never used
+        s->generation = 1;
+    freeSlots.push_back(e.index);
+    count--;
+}
+
+//=============================================================================
+// Destroy every entity
+//=============================================================================
+void EntityStore::clear()
+{
+    for (UINT n = 0; n < archetypes.size(); n++)
+    {
+        Archetype *a = archetypes[n];
+        while (a->count > 0)
+            destroy(a->ids.back());
+    }
+}
+
+//=============================================================================
+// Return true if e has not been destroyed
+//=============================================================================
+bool EntityStore::isAlive(EntityId e)
+{
+    return getSlot(e) != NULL;
+}
+
+//=============================================================================
+// Return the components of e
+//=============================================================================
+UINT EntityStore::getMask(EntityId e)
+{
+    Slot *s = getSlot(e);
+    return s ? s->archetype->mask : 0;
+}
+
+//=============================================================================
+// Move e to the Archetype of mask
+// Components both Archetypes have are copied. An animation is added to or
+// removed from the Animator with the ANIMATION component.
+//=============================================================================
+void EntityStore::move(EntityId e, UINT mask)
+{
+    Slot *s = getSlot(e);
+    if (s == NULL)
+        return;
+    mask &= ALL;
+    Archetype *from = s->archetype;
+    if (from->mask == mask)
+        return;
+    UINT fromRow = s->row;
+    Archetype *to = findArchetype(mask);
+    UINT row = to->addRow(e);
+    to->copyRow(row, *from, fromRow);
+    if (animator)
+    {
+        if ((mask & ANIMATION) && !(from->mask & ANIMATION))
+        {
+            bool sprite = (mask & SPRITE) != 0;
+            to->animation[row] = animator->add(sprite ? to->width[row] : 0,
+                                               sprite ? to->height[row] : 0, 1);
+        }
+        else if (!(mask & ANIMATION) && (from->mask & ANIMATION))
+            animator->remove(from->animation[fromRow]);
+    }
+    removeRow(from, fromRow);
+    s->archetype = to;
+    s->row = row;
+}
+
+//=============================================================================
+// Add components
+//=============================================================================
+void EntityStore::addComponents(EntityId e, UINT mask)
+{
+    move(e, getMask(e) | mask);
+}
+
+//=============================================================================
+// Remove components
+//=============================================================================
+void EntityStore::removeComponents(EntityId e, UINT mask)
+{
+    move(e, getMask(e) & ~mask);
+}
+
+//=============================================================================
+// Get the transform of e
+//=============================================================================
+bool EntityStore::getTransform(EntityId e, TransformComponent &t)
+{
+    Slot *s = getSlot(e);
+    if (s == NULL || !s->archetype->has(TRANSFORM))
+        return false;
+    Archetype *a = s->archetype;
+    t.x = a->x[s->row];
+    t.y = a->y[s->row];
+    t.scale = a->scale[s->row];
+    t.angle = a->angle[s->row];
+    return true;
+}
+
+//=============================================================================
+// Get the sprite of e
+//=============================================================================
+bool EntityStore::getSprite(EntityId e, SpriteComponent &sp)
+{
+    Slot *s = getSlot(e);
+    if (s == NULL || !s->archetype->has(SPRITE))
+        return false;
+    Archetype *a = s->archetype;
+    UINT row = s->row;
+    sp.texture = a->texture[row];
+    sp.width = a->width[row];
+    sp.height = a->height[row];
+    sp.rect = a->rect[row];
+    sp.layer = a->layer[row];
+    sp.color = a->color[row];
+    sp.flipHorizontal = (a->flags[row] & FLIP_HORIZONTAL) != 0;
+    sp.flipVertical = (a->flags[row] & FLIP_VERTICAL) != 0;
+    sp.visible = (a->flags[row] & VISIBLE) != 0;
+    return true;
+}
+
+//=============================================================================
+// Get the animation of e
+//=============================================================================
+bool EntityStore::getAnimation(EntityId e, AnimationComponent &an)
+{
+    Slot *s = getSlot(e);
+    if (s == NULL || !s->archetype->has(ANIMATION) || animator == NULL)
+        return false;
+    UINT n = s->archetype->animation[s->row];
+    an.cols = s->archetype->cols[s->row];
+    an.startFrame = animator->getStartFrame(n);
+    an.endFrame = animator->getEndFrame(n);
+    an.currentFrame = animator->getCurrentFrame(n);
+    an.frameDelay = animator->getFrameDelay(n);
+    an.loop = animator->getLoop(n);
+    an.complete = animator->getAnimationComplete(n);
+    return true;
+}
+
+//=============================================================================
+// Get the velocity of e
+//=============================================================================
+bool EntityStore::getVelocity(EntityId e, VelocityComponent &v)
+{
+    Slot *s = getSlot(e);
+    if (s == NULL || !s->archetype->has(VELOCITY))
+        return false;
+    v.x = s->archetype->vx[s->row];
+    v.y = s->archetype->vy[s->row];
+    v.spin = s->archetype->spin[s->row];
+    return true;
+}
+
+//=============================================================================
+// Get the collider of e
+//=============================================================================
+bool EntityStore::getCollider(EntityId e, ColliderComponent &c)
+{
+    Slot *s = getSlot(e);
+    if (s == NULL || !s->archetype->has(COLLIDER))
+        return false;
+    c.type = s->archetype->colliderType[s->row];
+    c.radius = s->archetype->radius[s->row];
+    c.halfWidth = s->archetype->halfWidth[s->row];
+    c.halfHeight = s->archetype->halfHeight[s->row];
+    return true;
+}
+
+//=============================================================================
+// Set the transform of e
+//=============================================================================
+void EntityStore::setTransform(EntityId e, const TransformComponent &t)
+{
+    addComponents(e, TRANSFORM);
+    Slot *s = getSlot(e);
+    if (s == NULL)
+        return;
+    Archetype *a = s->archetype;
+    UINT row = s->row;
+    a->x[row] = t.x;
+    a->y[row] = t.y;
+    a->scale[row] = t.scale;
+    a->angle[row] = t.angle;
+    if (a->flags[row] & NEW_ROW)    // nothing to interpolate from yet
+    {
+        a->prevX[row] = t.x;
+        a->prevY[row] = t.y;
+        a->prevAngle[row] = t.angle;
+    }
+}
+
+//=============================================================================
+// Set the sprite of e
+//=============================================================================
+void EntityStore::setSprite(EntityId e, const SpriteComponent &sp)
+{
+    addComponents(e, SPRITE);
+    Slot *s = getSlot(e);
+    if (s == NULL)
+        return;
+    Archetype *a = s->archetype;
+    UINT row = s->row;
+    int w = sp.width;
+    int h = sp.height;
+    if (w == 0 && sp.texture)
+        w = sp.texture->getWidth();         // use full width of texture
+    if (h == 0 && sp.texture)
+        h = sp.texture->getHeight();        // use full height of texture
+    a->texture[row] = sp.texture;
+    a->width[row] = w;
+    a->height[row] = h;
+    a->rect[row] = sp.rect;
+    if (sp.rect.left == 0 && sp.rect.top == 0 && sp.rect.right == 0 && sp.rect.bottom == 0)
+    {
+        a->rect[row].right = w;             // whole frame
+        a->rect[row].bottom = h;
+    }
+    a->layer[row] = sp.layer;
+    a->color[row] = sp.color;
+    BYTE f = a->flags[row] & NEW_ROW;
+    if (sp.visible)
+        f |= VISIBLE;
+    if (sp.flipHorizontal)
+        f |= FLIP_HORIZONTAL;
+    if (sp.flipVertical)
+        f |= FLIP_VERTICAL;
+    a->flags[row] = f;
+    if (a->has(ANIMATION) && animator)
+        animator->setFrameSize(a->animation[row], w, h, a->cols[row]);
+}
+
+//=============================================================================
+// Set the animation of e
+//=============================================================================
+void EntityStore::setAnimation(EntityId e, const AnimationComponent &an)
+{
+    addComponents(e, ANIMATION);
+    Slot *s = getSlot(e);
+    if (s == NULL || animator == NULL)
+        return;
+    Archetype *a = s->archetype;
+    UINT row = s->row;
+    UINT n = a->animation[row];
+    a->cols[row] = an.cols < 1 ? 1 : an.cols;
+    bool sprite = a->has(SPRITE);
+    animator->setFrameSize(n, sprite ? a->width[row] : 0, sprite ? a->height[row] : 0, a->cols[row]);
+    animator->setFrames(n, an.startFrame, an.endFrame);
+    animator->setCurrentFrame(n, an.currentFrame);
+    animator->setFrameDelay(n, an.frameDelay);
+    animator->setLoop(n, an.loop);
+    animator->setAnimationComplete(n, an.complete);
+}
+
+//=============================================================================
+// Set the velocity of e
+//=============================================================================
+void EntityStore::setVelocity(EntityId e, const VelocityComponent &v)
+{
+    addComponents(e, VELOCITY);
+    Slot *s = getSlot(e);
+    if (s == NULL)
+        return;
+    s->archetype->vx[s->row] = v.x;
+    s->archetype->vy[s->row] = v.y;
+    s->archetype->spin[s->row] = v.spin;
+}
+
+//=============================================================================
+// Set the collider of e
+//=============================================================================
+void EntityStore::setCollider(EntityId e, const ColliderComponent &c)
+{
+    addComponents(e, COLLIDER);
+    Slot *s = getSlot(e);
+    if (s == NULL)
+        return;
+    s->archetype->colliderType[s->row] = c.type;
+    s->archetype->radius[s->row] = c.radius;
+    s->archetype->halfWidth[s->row] = c.halfWidth;
+    s->archetype->halfHeight[s->row] = c.halfHeight;
+}
+
+//=============================================================================
+// Fill sd with the position and frame of e
+//=============================================================================
+bool EntityStore::getSpriteData(EntityId e, SpriteData &sd)
+{
+    Slot *s = getSlot(e);
+    if (s == NULL || !s->archetype->has(TRANSFORM | SPRITE))
+        return false;
+    Archetype *a = s->archetype;
+    UINT row = s->row;
+    TextureManager *tm = a->texture[row];
+    sd.width = a->width[row];
+    sd.height = a->height[row];
+    sd.x = a->x[row];
+    sd.y = a->y[row];
+    sd.scale = a->scale[row];
+    sd.angle = a->angle[row];
+    if (a->has(ANIMATION) && animator)
+        sd.rect = animator->getFrameRect(a->animation[row]);
+    else
+        sd.rect = a->rect[row];
+    if (tm)
+    {
+        sd.rect.left += tm->getOffsetX();
+        sd.rect.right += tm->getOffsetX();
+        sd.rect.top += tm->getOffsetY();
+        sd.rect.bottom += tm->getOffsetY();
+    }
+    sd.texture = tm ? tm->getTexture() : NULL;
+    sd.flipHorizontal = (a->flags[row] & FLIP_HORIZONTAL) != 0;
+    sd.flipVertical = (a->flags[row] & FLIP_VERTICAL) != 0;
+    sd.layer = a->layer[row];
+    return true;
+}
+
+//=============================================================================
+// Set the transform and sprite of e from sd
+//=============================================================================
+void EntityStore::setSpriteData(EntityId e, const SpriteData &sd)
+{
+    TransformComponent t = {sd.x, sd.y, sd.scale, sd.angle};
+    setTransform(e, t);
+    SpriteComponent sp;
+    if (!getSprite(e, sp))
+    {
+        sp.texture = NULL;
+        sp.color = graphicsNS::WHITE;
+        sp.visible = true;
+    }
+    sp.width = sd.width;
+    sp.height = sd.height;
+    sp.rect = sd.rect;
+    if (sp.texture)                     // rect relative to the image
+    {
+        sp.rect.left -= sp.texture->getOffsetX();
+        sp.rect.right -= sp.texture->getOffsetX();
+        sp.rect.top -= sp.texture->getOffsetY();
+        sp.rect.bottom -= sp.texture->getOffsetY();
+    }
+    sp.layer = sd.layer;
+    sp.flipHorizontal = sd.flipHorizontal;
+    sp.flipVertical = sd.flipVertical;
+    setSprite(e, sp);
+}
+
+//=============================================================================
+// Save the transforms at the start of a tick
+//=============================================================================
+void EntityStore::beginTick()
+{
+    for (UINT n = 0; n < archetypes.size(); n++)
+    {
+        Archetype *a = archetypes[n];
+        if (a->count == 0)
+            continue;
+        if (a->has(TRANSFORM))
+        {
+            a->prevX = a->x;
+            a->prevY = a->y;
+            a->prevAngle = a->angle;
+        }
+        BYTE *f = &a->flags[0];
+        for (UINT i = 0; i < a->count; i++)
+            f[i] &= ~NEW_ROW;
+    }
+}
+
+//=============================================================================
+// Move entities with VELOCITY
+//=============================================================================
+void EntityStore::update(float frameTime)
+{
+    for (UINT n = 0; n < archetypes.size(); n++)
+    {
+        Archetype *a = archetypes[n];
+        if (a->count == 0 || !a->has(TRANSFORM | VELOCITY))
+            continue;
+        float *x = &a->x[0];
+        float *y = &a->y[0];
+        float *angle = &a->angle[0];
+        const float *vx = &a->vx[0];
+        const float *vy = &a->vy[0];
+        const float *spin = &a->spin[0];
+        for (UINT i = 0; i < a->count; i++)
+        {
+            x[i] += vx[i] * frameTime;
+            y[i] += vy[i] * frameTime;
+            angle[i] += spin[i] * frameTime;
+        }
+    }
+}
+
+//=============================================================================
+// Draw entities with TRANSFORM and SPRITE
+// A TextureManager is touched once for each run of rows that use it, so
+// entities sharing a texture do not lock the residency per sprite.
+// Pre : spriteBegin() is called
+// Post: spriteEnd() is called
+//=============================================================================
+void EntityStore::draw()
+{
+    if (graphics == NULL)
+        return;
+    bool interpolating = graphics->getInterpolating();
+    float alpha = graphics->getInterpolation();
+    SpriteData sd;
+    for (UINT n = 0; n < archetypes.size(); n++)
+    {
+        Archetype *a = archetypes[n];
+        if (a->count == 0 || !a->has(TRANSFORM | SPRITE))
+            continue;
+        bool animated = a->has(ANIMATION) && animator;
+        TextureManager *last = NULL;
+        LP_TEXTURE texture = NULL;
+        int offsetX = 0;
+        int offsetY = 0;
+        for (UINT i = 0; i < a->count; i++)
+        {
+            BYTE f = a->flags[i];
+            if (!(f & VISIBLE) || a->texture[i] == NULL)
+                continue;
+            if (a->texture[i] != last)
+            {
+                last = a->texture[i];
+                last->touch();                  // load again if evicted
+                texture = last->getTexture();
+                offsetX = last->getOffsetX();
+                offsetY = last->getOffsetY();
+            }
+            if (texture == NULL)                // if still loading
+                continue;
+            sd.width = a->width[i];
+            sd.height = a->height[i];
+            sd.scale = a->scale[i];
+            if (interpolating)
+            {
+                // draw between the positions at the last two ticks
+                float turn = a->angle[i] - a->prevAngle[i];
+                if (turn > PI || turn < -PI)    // the angle wrapped around
+                    turn -= (float)(2*PI) * floor(turn / (float)(2*PI) + 0.5f);
+                sd.x = a->prevX[i] + (a->x[i] - a->prevX[i]) * alpha;
+                sd.y = a->prevY[i] + (a->y[i] - a->prevY[i]) * alpha;
+                sd.angle = a->prevAngle[i] + turn * alpha;
+            }
+            else
+            {
+                sd.x = a->x[i];
+                sd.y = a->y[i];
+                sd.angle = a->angle[i];
+            }
+            sd.rect = animated ? animator->getFrameRect(a->animation[i]) : a->rect[i];
+            sd.rect.left += offsetX;
+            sd.rect.right += offsetX;
+            sd.rect.top += offsetY;
+            sd.rect.bottom += offsetY;
+            sd.texture = texture;
+            sd.flipHorizontal = (f & FLIP_HORIZONTAL) != 0;
+            sd.flipVertical = (f & FLIP_VERTICAL) != 0;
+            sd.layer = a->layer[i];
+            if (!graphics->inViewport(sd))      // if off screen
+                continue;
+            graphics->drawSprite(sd, a->color[i]);
+        }
+    }
+}
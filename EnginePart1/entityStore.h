@@ -0,0 +1,299 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// entityStore.h v1.0
+// An EntityStore holds game objects as rows of component arrays instead of
+// one Image object each. Entities with the same set of components (the
+// same mask) are kept together in one Archetype, which has one array per
+// component property (structure of arrays). A system such as update() or
+// draw() runs through the arrays of every Archetype that has the
+// components it needs, without virtual calls or pointer chasing.
+// An EntityId stays valid while the entity moves between Archetypes or
+// rows, and is never reused for another entity.
+// Game owns an EntityStore, see Game::getEntities(). Usage:
+//   EntityId e = entities->create(entityStoreNS::TRANSFORM | entityStoreNS::SPRITE);
+//   entities->setTransform(e, transform);
+//   entities->setSprite(e, sprite);
+//   ...
+//   entities->draw();                  // in render(), after spriteBegin()
+// Systems written by the game loop over the Archetypes:
+//   for (UINT n = 0; n < entities->getArchetypeCount(); n++)
+//   {
+//       Archetype &a = entities->getArchetype(n);
+//       if (!a.has(entityStoreNS::TRANSFORM))
+//           continue;
+//       for (UINT i = 0; i < a.count; i++)
+//           a.x[i] += 1;
+//   }
+// Existing Images move in with create(image), and getSpriteData() returns
+// the SpriteData of an entity for code written for Images.
+
+#ifndef _ENTITYSTORE_H          // Prevent multiple definitions if this
+#define _ENTITYSTORE_H          // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+#include "image.h"
+
+namespace entityStoreNS
+{
+    // Components, an entity has a mask of them
+    const UINT TRANSFORM = 1;       // position, scale and angle
+    const UINT SPRITE    = 2;       // texture and frame, drawn by draw()
+    const UINT ANIMATION = 4;       // frame animation, advanced by the Animator
+    const UINT VELOCITY  = 8;       // moves the transform in update()
+    const UINT COLLIDER  = 16;      // collision shape
+    const UINT ALL       = 31;
+
+    // Row flags
+    const BYTE VISIBLE   = 1;       // sprite is drawn
+    const BYTE FLIP_HORIZONTAL = 2;
+    const BYTE FLIP_VERTICAL = 4;
+    const BYTE NEW_ROW   = 8;       // no tick has started since the transform was added
+
+    enum COLLISION_TYPE {CIRCLE, BOX, ROTATED_BOX};
+}
+
+// Handle of an entity. Generation 0 is never used, so a zero EntityId is
+// no entity.
+struct EntityId
+{
+    UINT    index;          // slot in the EntityStore
+    UINT    generation;     // changes every time the slot is reused
+};
+
+inline bool operator==(const EntityId &a, const EntityId &b)
+{
+    return a.index == b.index && a.generation == b.generation;
+}
+
+inline bool operator!=(const EntityId &a, const EntityId &b)
+{
+    return !(a == b);
+}
+
+// Components, for reading and writing one entity.
+// Position is the top left corner, the same as SpriteData.
+struct TransformComponent
+{
+    float   x;
+    float   y;
+    float   scale;
+    float   angle;          // radians
+};
+
+struct SpriteComponent
+{
+    TextureManager *texture;
+    int     width;          // frame size
+    int     height;
+    RECT    rect;           // frame in the image, not used with ANIMATION
+    int     layer;          // draw order when batching
+    COLOR_ARGB color;       // color filter
+    bool    flipHorizontal;
+    bool    flipVertical;
+    bool    visible;
+};
+
+struct AnimationComponent
+{
+    int     cols;           // frames in a row of the sprite sheet
+    int     startFrame;
+    int     endFrame;
+    int     currentFrame;
+    float   frameDelay;     // seconds between frames
+    bool    loop;
+    bool    complete;       // a not looping animation has finished
+};
+
+struct VelocityComponent
+{
+    float   x;              // pixels per second
+    float   y;
+    float   spin;           // radians per second
+};
+
+// Collision shape, centered on the center of the sprite
+struct ColliderComponent
+{
+    entityStoreNS::COLLISION_TYPE type;
+    float   radius;         // CIRCLE
+    float   halfWidth;      // BOX and ROTATED_BOX, before scale
+    float   halfHeight;
+};
+
+// Entities with the same components. Element i of every array is row i.
+// Arrays of components the Archetype does not have are empty.
+class Archetype
+{
+  public:
+    UINT    mask;           // components
+    UINT    count;          // rows
+    std::vector<EntityId> ids;
+    std::vector<BYTE> flags;        // entityStoreNS row flags
+
+    // TRANSFORM
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> scale;
+    std::vector<float> angle;
+    std::vector<float> prevX;       // at the last tick, for interpolation
+    std::vector<float> prevY;
+    std::vector<float> prevAngle;
+
+    // SPRITE
+    std::vector<TextureManager*> texture;
+    std::vector<int>   width;
+    std::vector<int>   height;
+    std::vector<RECT>  rect;
+    std::vector<int>   layer;
+    std::vector<COLOR_ARGB> color;
+
+    // ANIMATION
+    std::vector<UINT>  animation;   // animation number in the Animator
+    std::vector<int>   cols;
+
+    // VELOCITY
+    std::vector<float> vx;
+    std::vector<float> vy;
+    std::vector<float> spin;
+
+    // COLLIDER
+    std::vector<entityStoreNS::COLLISION_TYPE> colliderType;
+    std::vector<float> radius;
+    std::vector<float> halfWidth;
+    std::vector<float> halfHeight;
+
+    // Constructor
+    Archetype(UINT m) : mask(m), count(0) {}
+
+    // Return true if the Archetype has all components of m.
+    bool has(UINT m) const  {return (mask & m) == m;}
+
+    // Add a row with default components. Returns the row.
+    UINT addRow(EntityId id);
+
+    // Remove row by moving the last row into it.
+    void removeRow(UINT row);
+
+    // Copy the components of from row fromRow that this Archetype has
+    // into row.
+    void copyRow(UINT row, const Archetype &from, UINT fromRow);
+};
+
+class EntityStore
+{
+  private:
+    struct Slot
+    {
+        Archetype *archetype;   // NULL if the slot is free
+        UINT    row;
+        UINT    generation;
+    };
+    std::vector<Slot> slots;            // by EntityId::index
+    std::vector<UINT> freeSlots;
+    std::vector<Archetype*> archetypes;
+    Graphics *graphics;
+    Animator *animator;                 // animates ANIMATION components
+    UINT    count;                      // entities
+
+    // Return the Archetype of mask, adding it if new.
+    Archetype* findArchetype(UINT mask);
+
+    // Return the slot of e, NULL if e is not alive.
+    Slot* getSlot(EntityId e);
+
+    // Remove row of a, updating the slot of the row moved into it.
+    void removeRow(Archetype *a, UINT row);
+
+    // Move e to the Archetype of mask.
+    void move(EntityId e, UINT mask);
+
+  public:
+    // Constructor
+    EntityStore();
+
+    // Destructor
+    virtual ~EntityStore();
+
+    // Initialize the store.
+    // Pre: *g points to Graphics object
+    //      *a = Animator of ANIMATION components, it must outlive the store
+    void initialize(Graphics *g, Animator *a);
+
+    // Create an entity with the components of mask, set to defaults.
+    EntityId create(UINT mask);
+
+    // Create an entity from an Image, with TRANSFORM, SPRITE, ANIMATION if
+    // the Image is animated, and the components of mask. The Image is not
+    // changed and is not drawn by the store.
+    EntityId create(Image &image, UINT mask = 0);
+
+    // Destroy e. Destroyed or NULL ids are ignored.
+    void destroy(EntityId e);
+
+    // Destroy every entity.
+    void clear();
+
+    // Return true if e has not been destroyed.
+    bool isAlive(EntityId e);
+
+    // Return the components of e, 0 if not alive.
+    UINT getMask(EntityId e);
+
+    // Add or remove components. e moves to the Archetype of its new mask.
+    void addComponents(EntityId e, UINT mask);
+    void removeComponents(EntityId e, UINT mask);
+
+    // Get a component of e. Return false if e does not have it.
+    bool getTransform(EntityId e, TransformComponent &t);
+    bool getSprite(EntityId e, SpriteComponent &s);
+    bool getAnimation(EntityId e, AnimationComponent &an);
+    bool getVelocity(EntityId e, VelocityComponent &v);
+    bool getCollider(EntityId e, ColliderComponent &c);
+
+    // Set a component of e, adding it if e does not have it.
+    // The first setTransform() after the component is added also sets the
+    // position at the last tick, so the entity is not drawn moving there.
+    void setTransform(EntityId e, const TransformComponent &t);
+    // A width and height of 0 use the size of the texture, a rect of 0
+    // selects the whole frame.
+    void setSprite(EntityId e, const SpriteComponent &s);
+    void setAnimation(EntityId e, const AnimationComponent &an);
+    void setVelocity(EntityId e, const VelocityComponent &v);
+    void setCollider(EntityId e, const ColliderComponent &c);
+
+    // Fill sd with the position and frame of e, the same as
+    // Image::getSpriteInfo(). Return false if e has no TRANSFORM and SPRITE.
+    bool getSpriteData(EntityId e, SpriteData &sd);
+
+    // Set the transform and sprite of e from sd. The texture of the sprite
+    // is not changed, sd.texture and the atlas offset in sd.rect are ignored.
+    void setSpriteData(EntityId e, const SpriteData &sd);
+
+    // Return number of entities.
+    UINT getCount() const           {return count;}
+
+    // Return number of Archetypes. Archetypes are never removed, so the
+    // number only grows.
+    UINT getArchetypeCount() const  {return (UINT)archetypes.size();}
+
+    // Return Archetype n. Rows move when entities are created or destroyed,
+    // do not keep row numbers across those calls.
+    Archetype& getArchetype(UINT n) {return *archetypes[n];}
+
+    // Save the transforms at the start of a tick, for interpolation.
+    // Called by Game::run() before update().
+    void beginTick();
+
+    // Move entities with VELOCITY. Called by Game::run() after update().
+    void update(float frameTime);
+
+    // Draw entities with TRANSFORM and SPRITE, interpolated between ticks
+    // in fixed time step mode.
+    // Pre : spriteBegin() is called
+    // Post: spriteEnd() is called
+    void draw();
+};
+
+#endif
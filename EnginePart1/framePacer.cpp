@@ -0,0 +1,138 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// framePacer.cpp v1.0
+// Holds the game loop to a target frame rate.
+
+#include "framePacer.h"
+
+//=============================================================================
+// Constructor
+//=============================================================================
+FramePacer::FramePacer()
+{
+    period = 0;
+    deadline = 0;
+    lastFrame = 0;
+    sleepMargin = GameClock::fromSeconds(framePacerNS::START_MARGIN);
+    targetRate = 0;
+    highResolution = false;
+    resetStats();
+}
+
+//=============================================================================
+// Destructor
+//=============================================================================
+FramePacer::~FramePacer()
+{
+    if (highResolution)
+        GameClock::endHighResolution();
+}
+
+//=============================================================================
+// Start pacing at rate frames per second
+//=============================================================================
+void FramePacer::initialize(float rate)
+{
+    if (!highResolution)
+    {
+        GameClock::beginHighResolution();   // for the life of the pacer, not every frame
+        highResolution = true;
+    }
+    lastFrame = GameClock::ticks();
+    setTargetRate(rate);
+    resetStats();
+}
+
+//=============================================================================
+// Change the target rate
+//=============================================================================
+void FramePacer::setTargetRate(float rate)
+{
+    targetRate = rate > 0 ? rate : 0;
+    period = targetRate > 0 ? GameClock::fromSeconds(1.0 / targetRate) : 0;
+    deadline = lastFrame + period;
+}
+
+//=============================================================================
+// Clear the statistics
+//=============================================================================
+void FramePacer::resetStats()
+{
+    frames = 0;
+    missed = 0;
+    overshootSum = 0;
+    overshootMax = 0;
+}
+
+//=============================================================================
+// Wait until the next frame should start
+// Returns the time in seconds since the previous call
+//=============================================================================
+float FramePacer::waitForFrame()
+{
+    LONGLONG now = GameClock::ticks();
+    if (period > 0)
+    {
+        // The margin shrinks a little every frame so one long sleep does not
+        // stop sleeping for good. It grows again if sleep() is late, up to
+        // MAX_MARGIN of the period so a stall (a debugger break, a suspended
+        // process) can not turn the wait into yielding for whole frames.
+        LONGLONG minMargin = GameClock::fromSeconds(framePacerNS::MIN_MARGIN);
+        LONGLONG maxMargin = (LONGLONG)(period * framePacerNS::MAX_MARGIN);
+        sleepMargin -= (sleepMargin - minMargin) / framePacerNS::MARGIN_DECAY;
+        if (sleepMargin > maxMargin)    // the rate was raised
+            sleepMargin = maxMargin;
+
+        // coarse sleep while more than the margin is left
+        LONGLONG msTicks = GameClock::frequency() / 1000;
+        while (deadline - now > sleepMargin + msTicks)
+        {
+            UINT ms = (UINT)((deadline - now - sleepMargin) / msTicks);
+            LONGLONG start = now;
+            GameClock::sleep(ms);
+            now = GameClock::ticks();
+
+            // calibrate, the margin must cover the largest recent sleep error
+            LONGLONG error = (now - start) - ms*msTicks;
+            if (error > sleepMargin)
+                sleepMargin = error < maxMargin ? error : maxMargin;
+        }
+
+        // yield until the deadline
+        while (now < deadline)
+        {
+            GameClock::yield();
+            now = GameClock::ticks();
+        }
+
+        LONGLONG overshoot = now - deadline;
+        if (overshoot >= period)    // a frame or more late, start over from now
+        {
+            missed++;
+            deadline = now + period;
+        }
+        else
+        {
+            overshootSum += overshoot;
+            if (overshoot > overshootMax)
+                overshootMax = overshoot;
+            deadline += period;
+        }
+    }
+    frames++;
+    float frameTime = (float)GameClock::toSeconds(now - lastFrame);
+    lastFrame = now;
+    return frameTime;
+}
+
+//=============================================================================
+// Return average time between the deadline and the start of the frame
+//=============================================================================
+float FramePacer::getOvershootAverage() const
+{
+    UINT count = frames - missed;
+    if (count == 0)
+        return 0;
+    return (float)GameClock::toSeconds(overshootSum) / count;
+}
@@ -0,0 +1,86 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// framePacer.h v1.0
+// A FramePacer holds the game loop to a target frame rate.
+// Sleep() alone is not accurate enough, it often wakes a millisecond or more
+// late, which is a large part of a 5 ms frame. waitForFrame() sleeps until
+// a short margin before the deadline and then yields in a loop until the
+// deadline. The margin is calibrated from the measured sleep error.
+// Deadlines are a fixed period apart so errors do not accumulate.
+
+#ifndef _FRAMEPACER_H           // Prevent multiple definitions if this
+#define _FRAMEPACER_H           // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include "gameClock.h"
+
+namespace framePacerNS
+{
+    const float START_MARGIN = 0.002f;  // seconds, sleep margin before calibration
+    const float MIN_MARGIN = 0.0002f;   // seconds, smallest sleep margin
+    const UINT  MARGIN_DECAY = 64;      // margin moves 1/64 of the way to MIN_MARGIN each frame
+    const float MAX_MARGIN = 0.5f;      // largest sleep margin, fraction of the period
+}
+
+class FramePacer
+{
+  private:
+    LONGLONG period;        // ticks per frame, 0 for no limit
+    LONGLONG deadline;      // start time of next frame
+    LONGLONG lastFrame;     // time waitForFrame() last returned
+    LONGLONG sleepMargin;   // time left when sleeping stops
+    float    targetRate;    // frames per second
+    bool     highResolution;    // true while GameClock::beginHighResolution() is in effect
+
+    // statistics
+    UINT     frames;        // waitForFrame() calls
+    UINT     missed;        // frames started a whole period or more late
+    LONGLONG overshootSum;  // time after the deadline that frames started
+    LONGLONG overshootMax;
+
+  public:
+    // Constructor
+    FramePacer();
+
+    // Destructor
+    virtual ~FramePacer();
+
+    // Start pacing at rate frames per second, 0 for no limit.
+    // The first frame starts now.
+    void initialize(float rate);
+
+    // Change the target rate, 0 for no limit.
+    void setTargetRate(float rate);
+
+    // Return the target rate.
+    float getTargetRate() const {return targetRate;}
+
+    // Wait until the next frame should start.
+    // Returns the time in seconds since the previous call.
+    // If the game falls more than a frame behind, the next deadline is one
+    // period from now instead of trying to catch up.
+    float waitForFrame();
+
+    // Return number of frames.
+    UINT  getFrames() const     {return frames;}
+
+    // Return number of frames that started one period or more late.
+    UINT  getMissed() const     {return missed;}
+
+    // Return average time in seconds between the deadline and the start
+    // of the frame, not counting missed frames.
+    float getOvershootAverage() const;
+
+    // Return largest time in seconds between the deadline and the start
+    // of a frame, not counting missed frames.
+    float getOvershootMax() const {return (float)GameClock::toSeconds(overshootMax);}
+
+    // Return the calibrated sleep margin in seconds.
+    float getSleepMargin() const  {return (float)GameClock::toSeconds(sleepMargin);}
+
+    // Clear the statistics.
+    void  resetStats();
+};
+
+#endif
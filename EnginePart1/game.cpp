@@ -16,6 +16,14 @@ Game::Game()
     // additional initialization is handled in later call to input->initialize()
     paused = false;             // game is not paused
     graphics = NULL;
+    tickTime = 0;               // variable time step
+    accumulator = 0;
+    tick = 0;
+    fps = 100;
+    hwnd = NULL;
+    renderQueue.setTextureLoader(&textureLoader);
+    renderQueue.setTextureResidency(&textureResidency);
+    textureResidency.setTextureLoader(&textureLoader);
     initialized = false;
 }
 
@@ -25,9 +33,12 @@ Game::Game()
 Game::~Game()
 {
     deleteAll();                // free all reserved memory
+#ifdef _WIN32
     ShowCursor(true);           // show cursor
+#endif
 }
 
+#ifdef _WIN32
 //=============================================================================
 // Window message handler
 //=============================================================================
@@ -38,6 +49,7 @@ LRESULT Game::messageHandler( HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam
         switch( msg )
         {
             case WM_DESTROY:
+                renderQueue.stop();                // stop drawing to the window
                 PostQuitMessage(0);        //tell Windows to kill this program
                 return 0;
             case WM_KEYDOWN: case WM_SYSKEYDOWN:    // key down
@@ -84,12 +96,14 @@ LRESULT Game::messageHandler( HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam
                 input->mouseIn(lParam);             // mouse position
                 return 0;
             case WM_DEVICECHANGE:                   // check for controller insert
-                input->checkControllers();
+                if (!inputRecorder.getReplaying())  // else controllers come from the log
+                    input->checkControllers();
                 return 0;
         }
     }
     return DefWindowProc( hwnd, msg, wParam, lParam );    // let Windows handle it
 }
+#endif
 
 //=============================================================================
 // Initializes the game
@@ -99,28 +113,83 @@ void Game::initialize(HWND hw)
 {
     hwnd = hw;                                  // save window handle
 
+#ifndef SOFTWARE_GRAPHICS
+    // Direct3D can not create a device without a window
+    if (hwnd == NULL)
+        throw(GameError(gameErrorNS::FATAL_ERROR,
+            "Error, no window for Direct3D. Build with SOFTWARE_GRAPHICS to replay input without a window"));
+#endif
+
     // initialize graphics
     graphics = new Graphics();
     // throws GameError
     graphics->initialize(hwnd, GAME_WIDTH, GAME_HEIGHT, FULLSCREEN);
+    graphics->setImageTicks(&imageTicks);
 
     // initialize input, do not capture mouse
-    input->initialize(hwnd, false);             // throws GameError
+    // no window when replaying recorded input, see startReplay()
+    if (hwnd)
+        input->initialize(hwnd, false);         // throws GameError
+
+    // load images from the asset pack if there is one, else from loose files
+    if (assetPack.open(ASSET_PACK))
+        graphics->setAssetPack(&assetPack);
 
-    // attempt to set up high resolution timer
-    if(QueryPerformanceFrequency(&timerFreq) == false)
-        throw(GameError(gameErrorNS::FATAL_ERROR, "Error initializing high resolution timer"));
+    // start the texture loader worker threads
+    if (!textureLoader.initialize(graphics))
+        throw(GameError(gameErrorNS::FATAL_ERROR, "Error initializing texture loader"));
+    textureRegistry.initialize(graphics, &textureLoader, &textureResidency, &textureCache);
+    entities.initialize(graphics, &animator);
+    jobs.initialize();                          // a worker for each other core
 
-    QueryPerformanceCounter(&timeStart);        // get starting time
+    framePacer.initialize(FRAME_RATE);          // first frame starts now
 
     initialized = true;
 }
 
+//=============================================================================
+// Run update(), ai() and collisions() for one tick
+// Each of them may add jobs to frameJobs, they are finished before the
+// next one is called.
+//=============================================================================
+void Game::runTick()
+{
+    entities.beginTick();           // save entity positions for interpolation
+    imageTicks.beginTick();         // and Image positions
+    update();                       // update all game items
+    jobs.wait(&frameJobs);
+    entities.update(frameTime);     // move entities with velocity
+    animator.update(frameTime);     // animate Images using the animator
+    ai();                           // artificial intelligence
+    jobs.wait(&frameJobs);
+    broadphase.update(&entities);   // find overlapping colliders
+    narrowphase.update(&entities, broadphase.getPairs());
+    collisions();                   // handle collisions
+    jobs.wait(&frameJobs);
+    input->vibrateControllers(frameTime); // handle controller vibration
+}
+
 //=============================================================================
 // Render game items
 //=============================================================================
 void Game::renderGame()
 {
+    if (graphics->getRecording())   // if the render thread draws this frame
+    {
+        render();                   // call render() in derived object, recorded
+        graphics->setRecording(NULL);
+        renderQueue.endFrame();     // pass the frame to the render thread
+
+        if (renderQueue.getDeviceLost())    // if the render thread found a lost device
+        {
+            renderQueue.finish();   // render thread waits for the next frame
+            handleLostGraphicsDevice();
+            if (SUCCEEDED(graphics->getDeviceState()))
+                renderQueue.clearDeviceLost();
+        }
+        return;
+    }
+
     //start rendering
     if (SUCCEEDED(graphics->beginScene()))
     {
@@ -140,6 +209,7 @@ void Game::renderGame()
 //=============================================================================
 void Game::handleLostGraphicsDevice()
 {
+#ifndef SOFTWARE_GRAPHICS                   // the software device is never lost
     // test for and handle lost device
     hr = graphics->getDeviceState();
     if(FAILED(hr))                  // if graphics device is not in a valid state
@@ -162,6 +232,7 @@ void Game::handleLostGraphicsDevice()
         else
             return;                 // other device error
     }
+#endif
 }
 
 //=============================================================================
@@ -169,6 +240,7 @@ void Game::handleLostGraphicsDevice()
 //=============================================================================
 void Game::setDisplayMode(graphicsNS::DISPLAY_MODE mode)
 {
+    renderQueue.finish();           // render thread must not draw during the change
     releaseAll();                   // free all user created surfaces
     graphics->changeDisplayMode(mode);
     resetAll();                     // recreate surfaces
@@ -177,43 +249,78 @@ void Game::setDisplayMode(graphicsNS::DISPLAY_MODE mode)
 //=============================================================================
 // Call repeatedly by the main message loop in WinMain
 //=============================================================================
-void Game::run(HWND hwnd)
+void Game::run(HWND)
 {
     if(graphics == NULL)            // if graphics not initialized
         return;
 
-    // calculate elapsed time of last frame, save in frameTime
-    QueryPerformanceCounter(&timeEnd);
-    frameTime = (float)(timeEnd.QuadPart - timeStart.QuadPart ) / (float)timerFreq.QuadPart;
-
-    // Power saving code, requires winmm.lib
-    // if not enough time has elapsed for desired frame rate
-    if (frameTime < MIN_FRAME_TIME) 
+    if (inputRecorder.getReplaying())
     {
-        sleepTime = (DWORD)((MIN_FRAME_TIME - frameTime)*1000);
-        timeBeginPeriod(1);         // Request 1mS resolution for windows timer
-        Sleep(sleepTime);           // release cpu for sleepTime
-        timeEndPeriod(1);           // End 1mS timer resolution
-        return;
+        // take frameTime, input and controllers from the log, do not wait
+        if (!inputRecorder.replayFrame(frameTime, replayEvents, replayControllers,
+                                       GameClock::ticks()))
+            return;                 // end of the log
+        input->discardEvents();     // input from the window is not used
+        for (size_t i = 0; i < replayEvents.size(); i++)
+            input->postEvent(replayEvents[i]);
+        input->setControllerInput(replayControllers);
+    }
+    else
+    {
+        // wait for the start of the frame, save elapsed time of last frame in frameTime
+        frameTime = framePacer.waitForFrame();
+    }
+    // apply the key and mouse messages posted since the last frame
+    UINT events = input->processEvents();
+    if (inputRecorder.getRecording())
+    {
+        // the events and the controller state update() sees this frame
+        const std::vector<InputEvent> &all = input->getEvents();
+        ControllerInput controllers[inputRecorderNS::CONTROLLERS];
+        input->getControllerInput(controllers);
+        inputRecorder.recordFrame(frameTime, events ? &all[all.size() - events] : NULL,
+                                  events, controllers, GameClock::ticks());
     }
 
     if (frameTime > 0.0)
         fps = (fps*0.99f) + (0.01f/frameTime);  // average fps
     if (frameTime > MAX_FRAME_TIME)     // if frame rate is very slow
         frameTime = MAX_FRAME_TIME;     // limit maximum frameTime
-    timeStart = timeEnd;
+
+    textureResidency.beginFrame();
+
+    // with a render thread, record this frame while the last one is drawn
+    if (renderQueue.isRunning())
+        graphics->setRecording(&renderQueue.beginFrame());
 
     // update(), ai(), and collisions() are pure virtual functions.
     // These functions must be provided in the class that inherits from Game.
-    if (!paused)                    // if not paused
+    UINT ticks = 1;                 // updates this frame
+    if (tickTime > 0)               // if fixed time step
     {
-        update();                   // update all game items
-        ai();                       // artificial intelligence
-        collisions();               // handle collisions
-        input->vibrateControllers(frameTime); // handle controller vibration
+        // Run as many ticks as fit in the elapsed time. MAX_FRAME_TIME
+        // limits the number of ticks when the game can not keep up.
+        accumulator += frameTime;
+        frameTime = tickTime;       // each update() moves one tick
+        for (ticks = 0; accumulator >= tickTime; ticks++)
+        {
+            accumulator -= tickTime;
+            tick++;
+            if (!paused)
+                runTick();          // update all game items
+        }
+        graphics->setInterpolation(tick, accumulator / tickTime);
+    }
+    else if (!paused)               // if not paused
+        runTick();                  // update all game items
+    if (!renderQueue.isRunning())   // else the render thread uploads
+    {
+        textureLoader.update();     // create textures loaded by the workers
+        textureResidency.update();  // release textures over the memory budget
     }
     renderGame();                   // draw all game items
-    input->readControllers();       // read state of controllers
+    if (!inputRecorder.getReplaying())  // else the next frame sets them from the log
+        input->readControllers();   // read state of controllers
 
     // if Alt+Enter toggle fullscreen/window
     if (input->isKeyDown(ALT_KEY) && input->wasKeyPressed(ENTER_KEY))
@@ -225,7 +332,25 @@ void Game::run(HWND hwnd)
 
     // Clear input
     // Call this after all key checks are done
-    input->clear(inputNS::KEYS_PRESSED);
+    // Keep key presses and events for the next frame if no update() has seen them yet.
+    if (ticks > 0)
+        input->clear(inputNS::KEYS_PRESSED | inputNS::EVENTS);
+}
+
+//=============================================================================
+// Set fixed time step mode, rate = ticks per second, 0 for variable time step
+//=============================================================================
+void Game::setTickRate(float rate)
+{
+    accumulator = 0;
+    if (rate > 0)
+        tickTime = 1.0f/rate;
+    else
+    {
+        tickTime = 0;
+        if (graphics)
+            graphics->clearInterpolation();
+    }
 }
 
 //=============================================================================
@@ -233,19 +358,25 @@ void Game::run(HWND hwnd)
 // Release all reserved video memory so graphics device may be reset.
 //=============================================================================
 void Game::releaseAll()
-{}
+{
+    textureRegistry.onLostDevice();
+}
 
 //=============================================================================
 // Recreate all surfaces and reset all entities.
 //=============================================================================
 void Game::resetAll()
-{}
+{
+    textureRegistry.onResetDevice();
+}
 
 //=============================================================================
 // Delete all reserved memory
 //=============================================================================
 void Game::deleteAll()
 {
+    renderQueue.stop();         // render thread must be done with graphics
+    textureLoader.stop();       // drop textures not yet loaded
     releaseAll();               // call onLostDevice() for every graphics item
     SAFE_DELETE(graphics);
     SAFE_DELETE(input);
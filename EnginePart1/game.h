@@ -13,12 +13,24 @@
 #define _GAME_H                 // file is included in more than one place
 #define WIN32_LEAN_AND_MEAN
 
-#include <windows.h>
-#include <Mmsystem.h>
+#include "platform.h"
 #include "graphics.h"
 #include "input.h"
 #include "constants.h"
 #include "gameError.h"
+#include "renderQueue.h"
+#include "framePacer.h"
+#include "textureLoader.h"
+#include "textureResidency.h"
+#include "textureRegistry.h"
+#include "assetPack.h"
+#include "animator.h"
+#include "image.h"
+#include "entityStore.h"
+#include "broadphase.h"
+#include "narrowphase.h"
+#include "jobSystem.h"
+#include "inputRecorder.h"
 
 class Game
 {
@@ -28,13 +40,29 @@ protected:
     Input   *input;             // pointer to Input
     HWND    hwnd;               // window handle
     HRESULT hr;                 // standard return type
-    LARGE_INTEGER timeStart;    // Performance Counter start value
-    LARGE_INTEGER timeEnd;      // Performance Counter end value
-    LARGE_INTEGER timerFreq;    // Performance Counter frequency
-    float   frameTime;          // time required for last frame
+    FramePacer framePacer;      // holds the frame rate to FRAME_RATE
+    float   frameTime;          // time required for last frame, or one tick in fixed time step mode
+    float   tickTime;           // seconds per simulation tick, 0 for variable time step
+    float   accumulator;        // time not yet simulated in fixed time step mode
+    UINT    tick;               // number of simulation ticks
     float   fps;                // frames per second
-    DWORD   sleepTime;          // number of milli-seconds to sleep between frames
     bool    paused;             // true if game is paused
+    RenderQueue renderQueue;    // draws recorded frames on the render thread
+    TextureLoader textureLoader; // loads textures on worker threads
+    TextureResidency textureResidency; // texture memory budget
+    TextureCache textureCache;  // pixels of registry textures, for a device reset
+    TextureRegistry textureRegistry; // textures shared by file name, deleted before the loader
+    AssetPack assetPack;        // mapped ASSET_PACK file, textures load from it when open
+    Animator animator;          // frame animation of Images, updated after update()
+    ImageTicks imageTicks;      // Images interpolated between ticks, saved before each tick
+    EntityStore entities;       // component arrays of game objects, uses the animator
+    Broadphase broadphase;      // overlapping entity colliders, found before collisions()
+    Narrowphase narrowphase;    // contacts of the broadphase pairs
+    JobSystem jobs;             // worker threads for update(), ai() and collisions()
+    JobCounter frameJobs;       // jobs finished before the next phase of a tick
+    InputRecorder inputRecorder; // frameTime and input of each frame, recorded or replayed
+    std::vector<InputEvent> replayEvents; // events of the frame being replayed
+    ControllerInput replayControllers[inputRecorderNS::CONTROLLERS]; // controllers of the frame being replayed
     bool    initialized;
 
 public:
@@ -45,11 +73,16 @@ public:
 
     // Member functions
 
+#ifdef _WIN32
     // Window message handler
     LRESULT messageHandler( HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam );
+#endif
 
     // Initialize the game
-    // Pre: hwnd is handle to window
+    // Pre: hwnd is handle to window, or NULL to replay recorded input
+    //      without a window, which needs the software Graphics
+    //      (SOFTWARE_GRAPHICS, always on Linux), see startReplay()
+    // Throws GameError
     virtual void initialize(HWND hwnd);
 
     // Call run repeatedly by the main message loop in WinMain
@@ -68,9 +101,23 @@ public:
     // Render game items.
     virtual void renderGame();
 
+    // Run update(), ai() and collisions() and the engine systems between
+    // them for one tick.
+    virtual void runTick();
+
     // Handle lost graphics device
     virtual void handleLostGraphicsDevice();
 
+    // Start a render thread. render() is then recorded on the game thread
+    // and drawn by the render thread while the next frame is simulated.
+    // The graphics device must only be used through Graphics functions that
+    // record; call renderQueue.finish() before any other use.
+    // Returns false on error.
+    bool startRenderThread()    {return renderQueue.start(graphics);}
+
+    // Draw the recorded frames and stop the render thread.
+    void stopRenderThread()     {renderQueue.stop();}
+
     // Set display mode (fullscreen, window or toggle)
     void setDisplayMode(graphicsNS::DISPLAY_MODE mode = graphicsNS::TOGGLE);
 
@@ -80,8 +127,100 @@ public:
     // Return pointer to Input.
     Input* getInput()       {return input;}
 
+    // Set fixed time step mode. update(), ai() and collisions() are called
+    // rate times per second, as many times per frame as needed, with
+    // frameTime set to 1/rate. Images are drawn between their positions at
+    // the last two ticks. Use 0 for one update per frame with a variable
+    // frameTime (default).
+    void setTickRate(float rate);
+
+    // Return ticks per second, 0 for variable time step.
+    float getTickRate() const   {return tickTime > 0 ? 1.0f/tickTime : 0;}
+
+    // Return number of simulation ticks.
+    UINT getTick() const        {return tick;}
+
+    // Return the texture loader, for TextureManager::initialize().
+    // Textures it loads are created between frames, on the render thread
+    // when one is running.
+    TextureLoader* getTextureLoader() {return &textureLoader;}
+
+    // Return the texture residency, for TextureManager::setResidency().
+    // Textures over its budget are evicted between frames and loaded again
+    // by the texture loader when drawn.
+    TextureResidency* getTextureResidency() {return &textureResidency;}
+
+    // Return the texture registry. Textures acquired from it are shared by
+    // file name, loaded by the texture loader, count against the texture
+    // residency budget and keep their pixels in the texture cache.
+    TextureRegistry* getTextureRegistry() {return &textureRegistry;}
+
+    // Return the texture cache, for TextureManager::setCache(). A lost
+    // device is reset from the cached pixels instead of the files.
+    TextureCache* getTextureCache() {return &textureCache;}
+
+    // Return the animator, for Image::setAnimator(). Its animations are
+    // advanced after each update(), so update() does not have to call
+    // Image::update() on the Images it animates.
+    Animator* getAnimator() {return &animator;}
+
+    // Return the entity store. Entities with VELOCITY are moved after each
+    // update(), render() draws them with getEntities()->draw().
+    EntityStore* getEntities() {return &entities;}
+
+    // Return the broadphase. Before each collisions() it holds the pairs
+    // of entities whose collider bounds overlap, see Broadphase::getPairs().
+    // It is rebuilt from the entities every tick, so it is read only: use
+    // a Broadphase of your own for other objects.
+    const Broadphase* getBroadphase() const {return &broadphase;}
+
+    // Return the narrowphase. Before each collisions() it holds a Contact
+    // for each broadphase pair that collides, see Narrowphase::getContacts().
+    Narrowphase* getNarrowphase() {return &narrowphase;}
+
+    // Return the job system, to split update(), ai() and collisions() into
+    // jobs that run on every core.
+    JobSystem* getJobs() {return &jobs;}
+
+    // Return the counter of the jobs of the current phase. Jobs added with
+    // it are done before the next of update(), ai() and collisions() starts.
+    JobCounter* getFrameJobs() {return &frameJobs;}
+
+    // Record the frameTime, input events and controller state of each frame
+    // from the next run().
+    void startRecording()   {inputRecorder.startRecording();}
+
+    // Stop recording and write the log to file. Returns false on error.
+    bool stopRecording(const char *file)
+    {
+        inputRecorder.stopRecording();
+        return inputRecorder.save(file);
+    }
+
+    // Replay the log in file. Each run() then takes its frameTime, input
+    // and controller state from the next frame of the log, without waiting
+    // for the frame rate and ignoring the input of the window and the
+    // controllers. The window may be NULL, see initialize().
+    // getReplaying() is false after the last frame.
+    // Returns false if the file is not a log.
+    bool startReplay(const char *file)  {return inputRecorder.load(file);}
+
+    // Return true while replaying.
+    bool getReplaying() const   {return inputRecorder.getReplaying();}
+
+    // Return the input recorder.
+    InputRecorder* getInputRecorder() {return &inputRecorder;}
+
+    // Return the frame pacer, for frame rate and timing statistics.
+    FramePacer& getFramePacer() {return framePacer;}
+
+#ifdef _WIN32
     // Exit the game
     void exitGame()         {PostMessage(hwnd, WM_DESTROY, 0, 0);}
+#else
+    // Exit the game, there is no window so this ends the replay
+    void exitGame()         {inputRecorder.stopReplay();}
+#endif
 
     // Pure virtual function declarations
     // These functions MUST be written in any class that inherits from Game
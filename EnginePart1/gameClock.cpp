@@ -0,0 +1,122 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// gameClock.cpp v1.0
+// Monotonic clock and sleep functions used for frame timing.
+
+#include "gameClock.h"
+
+#ifdef _WIN32
+#include <Mmsystem.h>           // timeBeginPeriod, requires winmm.lib
+#else
+#include <time.h>
+#include <sched.h>
+#endif
+
+#ifdef _WIN32
+//=============================================================================
+// Return the current time in ticks
+//=============================================================================
+LONGLONG GameClock::ticks()
+{
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    return t.QuadPart;
+}
+
+//=============================================================================
+// Return ticks per second
+// The frequency is fixed at boot so it is read once.
+//=============================================================================
+LONGLONG GameClock::frequency()
+{
+    static LONGLONG freq = 0;
+    if (freq == 0)
+    {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);  // always succeeds on Windows XP and later
+        freq = f.QuadPart;
+    }
+    return freq;
+}
+
+//=============================================================================
+// Sleep for about ms milliseconds
+//=============================================================================
+void GameClock::sleep(UINT ms)
+{
+    Sleep(ms);
+}
+
+//=============================================================================
+// Give the rest of the time slice to another thread
+//=============================================================================
+void GameClock::yield()
+{
+    SwitchToThread();
+}
+
+//=============================================================================
+// Request 1 ms timer resolution
+//=============================================================================
+void GameClock::beginHighResolution()
+{
+    timeBeginPeriod(1);
+}
+
+//=============================================================================
+// End 1 ms timer resolution
+//=============================================================================
+void GameClock::endHighResolution()
+{
+    timeEndPeriod(1);
+}
+
+#else
+//=============================================================================
+// Return the current time in ticks, nanoseconds
+//=============================================================================
+LONGLONG GameClock::ticks()
+{
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (LONGLONG)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+//=============================================================================
+// Return ticks per second
+//=============================================================================
+LONGLONG GameClock::frequency()
+{
+    return 1000000000;
+}
+
+//=============================================================================
+// Sleep for about ms milliseconds
+//=============================================================================
+void GameClock::sleep(UINT ms)
+{
+    timespec t;
+    t.tv_sec = ms / 1000;
+    t.tv_nsec = (long)(ms % 1000) * 1000000;
+    while (nanosleep(&t, &t) != 0)  // continue if interrupted by a signal
+        ;
+}
+
+//=============================================================================
+// Give the rest of the time slice to another thread
+//=============================================================================
+void GameClock::yield()
+{
+    sched_yield();
+}
+
+//=============================================================================
+// The timer is already high resolution
+//=============================================================================
+void GameClock::beginHighResolution()
+{}
+
+void GameClock::endHighResolution()
+{}
+#endif
@@ -0,0 +1,44 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// gameClock.h v1.0
+// Monotonic clock and sleep functions used for frame timing.
+// Uses QueryPerformanceCounter on Windows and CLOCK_MONOTONIC elsewhere.
+
+#ifndef _GAMECLOCK_H            // Prevent multiple definitions if this
+#define _GAMECLOCK_H            // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include "platform.h"
+
+class GameClock
+{
+  public:
+    // Return the current time in ticks. Never goes backwards.
+    static LONGLONG ticks();
+
+    // Return number of ticks per second.
+    static LONGLONG frequency();
+
+    // Convert ticks to seconds.
+    static double toSeconds(LONGLONG t)     {return (double)t / (double)frequency();}
+
+    // Convert seconds to ticks.
+    static LONGLONG fromSeconds(double s)   {return (LONGLONG)(s * (double)frequency());}
+
+    // Sleep for about ms milliseconds. May sleep longer, how much longer
+    // depends on the system timer. See FramePacer.
+    static void sleep(UINT ms);
+
+    // Give the rest of the time slice to another thread.
+    static void yield();
+
+    // Request 1 ms timer resolution from the system so sleep() is more
+    // accurate. Calls must be matched by endHighResolution().
+    static void beginHighResolution();
+
+    // End the request made by beginHighResolution().
+    static void endHighResolution();
+};
+
+#endif
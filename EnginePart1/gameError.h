@@ -40,6 +40,7 @@ public:
         std::exception::operator=(rhs);
         this->errorCode = rhs.errorCode;
         this->message = rhs.message;
+        return *this;
     }
     // destructor
     virtual ~GameError() throw() {};
@@ -4,6 +4,9 @@
 // Chapter 5 graphics.cpp v1.1
 
 #include "graphics.h"
+#include "imageFile.h"
+
+#ifndef SOFTWARE_GRAPHICS        // see softGraphics.cpp
 
 //=============================================================================
 // Constructor
@@ -13,10 +16,8 @@ Graphics::Graphics()
     direct3d = NULL;
     device3d = NULL;
     sprite = NULL;
-    fullscreen = false;
-    width = GAME_WIDTH;    // width & height are replaced in initialize()
-    height = GAME_HEIGHT;
-    backColor = graphicsNS::BACK_COLOR;
+    mipmapDevice = true;
+    mipmapNonPow2 = true;
 }
 
 //=============================================================================
@@ -75,6 +76,15 @@ void Graphics::initialize(HWND hw, int w, int h, bool full)
         behavior = D3DCREATE_SOFTWARE_VERTEXPROCESSING;  // use software only processing
     else
         behavior = D3DCREATE_HARDWARE_VERTEXPROCESSING;  // use hardware only processing
+    // The render thread draws, the texture loader uploads and the game thread
+    // creates and releases textures, so the device must be thread safe.
+    behavior |= D3DCREATE_MULTITHREADED;
+    // A device with D3DPTEXTURECAPS_POW2 can not mip a texture whose size is
+    // not a power of 2, with or without NONPOW2CONDITIONAL.
+    mipmapDevice = (caps.TextureCaps & D3DPTEXTURECAPS_MIPMAP) != 0;
+    mipmapNonPow2 = (caps.TextureCaps & D3DPTEXTURECAPS_POW2) == 0;
+    maxTextureSize = caps.MaxTextureWidth < caps.MaxTextureHeight ?
+                     caps.MaxTextureWidth : caps.MaxTextureHeight;
 
     //create Direct3D device
     result = direct3d->CreateDevice(
@@ -123,55 +133,180 @@ void Graphics::initD3Dpp()
 //=============================================================================
 // Load the texture into default D3D memory (normal texture use)
 // For internal engine use only. Use the TextureManager class to load game textures.
+// A cooked texture is created from the file data, with the mip levels
+// stored in it when it has them.
 // Pre: filename is name of texture file.
 //      transcolor is transparent color
 // Post: width and height = size of texture
 //       texture points to texture
+//       *sheet = frames of a cooked sprite sheet, if sheet is not NULL
 // Returns HRESULT
 //=============================================================================
 HRESULT Graphics::loadTexture(const char *filename, COLOR_ARGB transcolor,
-                                UINT &width, UINT &height, LP_TEXTURE &texture)
+                              UINT &width, UINT &height, LP_TEXTURE &texture,
+                              SpriteSheet *sheet)
 {
-    // The struct for reading file info
-    D3DXIMAGE_INFO info;
-    result = E_FAIL;
+    std::vector<BYTE> buffer;
+    const BYTE *data;
+    size_t size;
+    texture = NULL;
+    HRESULT hr = E_FAIL;
 
     try{
         if(filename == NULL)
-        {
-            texture = NULL;
             return D3DERR_INVALIDCALL;
+        if (!ImageFile::read(assetPack, filename, buffer, data, size))
+            return hr;
+
+        const CookedHeader *cooked = ImageFile::getCooked(data, size);
+        if (cooked)                     // already in texture format
+        {
+            hr = createTexture(ImageFile::getCookedPixels(cooked), cooked->width,
+                               cooked->height, texture, cooked->levels > 1 ? cooked->levels : 0,
+                               ImageFile::getCookedMips(cooked));
+            if (FAILED(hr))
+                return hr;
+            width = cooked->width;
+            height = cooked->height;
+            if (sheet)
+                ImageFile::getCookedSheet(cooked, *sheet);
+            return hr;
         }
-    
-        // Get width and height from file
-        result = D3DXGetImageInfoFromFile(filename, &info);
-        if (result != D3D_OK)
-            return result;
-        width = info.Width;
-        height = info.Height;
-    
-        // Create the new texture by loading from file
-        result = D3DXCreateTextureFromFileEx( 
-            device3d,           //3D device
-            filename,           //image filename
-            info.Width,         //texture width
-            info.Height,        //texture height
-            1,                  //mip-map levels (1 for no chain)
-            0,                  //usage
-            D3DFMT_UNKNOWN,     //surface format (default)
-            D3DPOOL_DEFAULT,    //memory class for the texture
-            D3DX_DEFAULT,       //image filter
-            D3DX_DEFAULT,       //mip filter
-            transcolor,         //color key for transparency
-            &info,              //bitmap file info (from loaded file)
-            NULL,               //color palette
-            &texture );         //destination texture
 
+        std::vector<COLOR_ARGB> pixels;
+        UINT w, h;
+        hr = decodeTexture(data, size, transcolor, w, h, pixels, sheet);
+        if (FAILED(hr))
+            return hr;
+        hr = createTexture(&pixels[0], w, h, texture);
+        if (SUCCEEDED(hr))
+        {
+            width = w;
+            height = h;
+        }
     } catch(...)
     {
         throw(GameError(gameErrorNS::FATAL_ERROR, "Error in Graphics::loadTexture"));
     }
-    return result;
+    return hr;
+}
+
+//=============================================================================
+// Decode an image file in memory into premultiplied ARGB pixels
+// A cooked texture is copied, other images are decoded by D3DX.
+// Returns HRESULT
+//=============================================================================
+HRESULT Graphics::decodeTexture(const BYTE *data, size_t size, COLOR_ARGB transcolor,
+                                UINT &width, UINT &height, std::vector<COLOR_ARGB> &pixels,
+                                SpriteSheet *sheet)
+{
+    D3DXIMAGE_INFO info;
+    LPDIRECT3DTEXTURE9 sysTexture = NULL;
+    D3DLOCKED_RECT locked;
+
+    if (ImageFile::getCooked(data, size))
+    {
+        if (!ImageFile::load(data, size, transcolor, width, height, pixels, sheet))
+            return E_FAIL;
+        return D3D_OK;
+    }
+    if (sheet)
+        sheet->frames.clear();
+
+    HRESULT hr = D3DXGetImageInfoFromFileInMemory(data, (UINT)size, &info);
+    if (hr != D3D_OK)
+        return hr;
+
+    // Load into a lockable system memory texture in a known format
+    hr = D3DXCreateTextureFromFileInMemoryEx(device3d, data, (UINT)size,
+                info.Width, info.Height, 1, 0, D3DFMT_A8R8G8B8, D3DPOOL_SYSTEMMEM,
+                D3DX_DEFAULT, D3DX_DEFAULT, transcolor, &info, NULL, &sysTexture);
+    if (FAILED(hr))
+        return hr;
+
+    hr = sysTexture->LockRect(0, &locked, NULL, D3DLOCK_READONLY);
+    if (SUCCEEDED(hr))
+    {
+        pixels.resize(info.Width*info.Height);
+        for (UINT y = 0; y < info.Height; y++)
+            memcpy(&pixels[y*info.Width], (const BYTE*)locked.pBits + y*locked.Pitch,
+                   info.Width*sizeof(COLOR_ARGB));
+        sysTexture->UnlockRect(0);
+        ImageFile::premultiply(pixels);
+        width = info.Width;
+        height = info.Height;
+    }
+    SAFE_RELEASE(sysTexture);
+    return hr;
+}
+
+//=============================================================================
+// Return number of mip levels createTexture() makes for a w x h texture
+//=============================================================================
+UINT Graphics::getMipLevels(UINT w, UINT h)
+{
+    if (!mipmaps || !mipmapDevice)
+        return 1;
+    bool pow2 = (w & (w-1)) == 0 && (h & (h-1)) == 0;
+    if (!pow2 && !mipmapNonPow2)
+        return 1;
+    return Mipmap::getLevelCount(w, h);
+}
+
+//=============================================================================
+// Create a texture in default D3D memory from ARGB pixels in memory
+// The pixels are written to a system memory texture and copied to the
+// default memory texture by UpdateTexture. With mipmaps the mip levels are
+// taken from chain, or made from the pixels when chain is NULL; the sprite
+// sampler state set by ID3DXSprite::Begin filters between levels, so the
+// hardware picks the level from the sprite scale.
+// Returns HRESULT
+//=============================================================================
+HRESULT Graphics::createTexture(const COLOR_ARGB *pixels, UINT w, UINT h, LP_TEXTURE &texture,
+                                UINT maxLevels, const COLOR_ARGB *chain)
+{
+    LPDIRECT3DTEXTURE9 sysTexture = NULL;
+    D3DLOCKED_RECT locked;
+    texture = NULL;
+    if (pixels == NULL || w == 0 || h == 0)
+        return D3DERR_INVALIDCALL;
+
+    UINT levels = getMipLevels(w, h);
+    if (maxLevels > 0 && levels > maxLevels)
+        levels = maxLevels;
+    std::vector<COLOR_ARGB> built;
+    if (levels > 1 && chain == NULL)
+    {
+        built.resize(Mipmap::getChainSize(w, h, levels));
+        Mipmap::build(pixels, w, h, levels, &built[0]);
+        chain = &built[0];
+    }
+    HRESULT hr = device3d->CreateTexture(w, h, levels, 0, D3DFMT_A8R8G8B8, D3DPOOL_SYSTEMMEM,
+                                         &sysTexture, NULL);
+    if (FAILED(hr))
+        return hr;
+    const COLOR_ARGB *level = pixels;
+    for (UINT n = 0; n < levels; n++)
+    {
+        UINT lw = Mipmap::getLevelSize(w, n);
+        UINT lh = Mipmap::getLevelSize(h, n);
+        hr = sysTexture->LockRect(n, &locked, NULL, 0);
+        if (FAILED(hr))
+            break;
+        for (UINT y = 0; y < lh; y++)
+            memcpy((BYTE*)locked.pBits + y*locked.Pitch, level + y*lw, lw*sizeof(COLOR_ARGB));
+        sysTexture->UnlockRect(n);
+        level = (n == 0) ? chain : level + (size_t)lw*lh;
+    }
+    if (SUCCEEDED(hr))
+        hr = device3d->CreateTexture(w, h, levels, 0, D3DFMT_A8R8G8B8, D3DPOOL_DEFAULT,
+                                     &texture, NULL);
+    if (SUCCEEDED(hr))
+        hr = device3d->UpdateTexture(sysTexture, texture);
+    if (FAILED(hr))
+        SAFE_RELEASE(texture);
+    SAFE_RELEASE(sysTexture);
+    return hr;
 }
 
 //=============================================================================
@@ -211,60 +346,29 @@ bool Graphics::isAdapterCompatible()
 }
 
 //=============================================================================
-// Draw the sprite described in SpriteData structure
-// Color is optional, it is applied like a filter, WHITE is default (no change)
+// Draw one sprite now
+// transform is computed by Transform2D, the same scale, rotation about the
+// center and flips D3DXMatrixTransformation2D used to build
 // Pre : sprite->Begin() is called
-// Post: sprite->End() is called
-// spriteData.rect defines the portion of spriteData.texture to draw
-//   spriteData.rect.right must be right edge + 1
-//   spriteData.rect.bottom must be bottom edge + 1
 //=============================================================================
-void Graphics::drawSprite(const SpriteData &spriteData, COLOR_ARGB color)
+void Graphics::submitSprite(const SpriteData &spriteData, COLOR_ARGB color,
+                            const Affine2D &transform)
 {
     if(spriteData.texture == NULL)      // if no texture
         return;
 
-    // Find center of sprite
-    D3DXVECTOR2 spriteCenter=D3DXVECTOR2((float)(spriteData.width/2*spriteData.scale),
-                                        (float)(spriteData.height/2*spriteData.scale));
-    // Screen position of the sprite
-    D3DXVECTOR2 translate=D3DXVECTOR2((float)spriteData.x,(float)spriteData.y);
-    // Scaling X,Y
-    D3DXVECTOR2 scaling(spriteData.scale,spriteData.scale);
-    if (spriteData.flipHorizontal)  // if flip horizontal
-    {
-        scaling.x *= -1;            // negative X scale to flip
-        // Get center of flipped image.
-        spriteCenter.x -= (float)(spriteData.width*spriteData.scale);
-        // Flip occurs around left edge, translate right to put
-        // Flipped image in same location as original.
-        translate.x += (float)(spriteData.width*spriteData.scale);
-    }
-    if (spriteData.flipVertical)    // if flip vertical
-    {
-        scaling.y *= -1;            // negative Y scale to flip
-        // Get center of flipped image
-        spriteCenter.y -= (float)(spriteData.height*spriteData.scale);
-        // Flip occurs around top edge, translate down to put
-        // Flipped image in same location as original.
-        translate.y += (float)(spriteData.height*spriteData.scale);
-    }
     // Create a matrix to rotate, scale and position our sprite
-    D3DXMATRIX matrix;
-    D3DXMatrixTransformation2D(
-        &matrix,                // the matrix
-        NULL,                   // keep origin at top left when scaling
-        0.0f,                   // no scaling rotation
-        &scaling,               // scale amount
-        &spriteCenter,          // rotation center
-        (float)(spriteData.angle),  // rotation angle
-        &translate);            // X,Y location
+    D3DXMATRIX matrix(
+        transform.m11, transform.m12, 0.0f, 0.0f,
+        transform.m21, transform.m22, 0.0f, 0.0f,
+        0.0f,          0.0f,          1.0f, 0.0f,
+        transform.dx,  transform.dy,  0.0f, 1.0f);
 
     // Tell the sprite about the matrix "Hello Neo"
     sprite->SetTransform(&matrix);
 
-    // Draw the sprite
-    sprite->Draw(spriteData.texture,&spriteData.rect,NULL,NULL,color);
+    // Draw the sprite, the color filter is premultiplied like the texture
+    sprite->Draw(spriteData.texture,&spriteData.rect,NULL,NULL,premultiplyColor(color));
 }
 
 //=============================================================================
@@ -354,3 +458,5 @@ void Graphics::changeDisplayMode(graphicsNS::DISPLAY_MODE mode)
                     TRUE);                                       // Repaint the window
     }
 }
+
+#endif  // SOFTWARE_GRAPHICS
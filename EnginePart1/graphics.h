@@ -18,73 +18,27 @@ Charles; Kelly (2012-07-09). Programming 2D Games (Page 47). A. K. Peters. Kindl
 #define _GRAPHICS_H             // file is included in more than one place
 #define WIN32_LEAN_AND_MEAN
 
+#include "platform.h"            // defines SOFTWARE_GRAPHICS when there is no Direct3D
+#ifndef SOFTWARE_GRAPHICS
 #ifdef _DEBUG
 #define D3D_DEBUG_INFO
 #endif
 #include <d3d9.h>
 #include <d3dx9.h>
-#include "constants.h"
-#include "gameError.h"
 
 // DirectX pointer types
-#define LP_TEXTURE  LPDIRECT3DTEXTURE9
 #define LP_SPRITE   LPD3DXSPRITE
 #define LP_3DDEVICE LPDIRECT3DDEVICE9
 #define LP_3D       LPDIRECT3D9
+#endif
 
-// Color defines
-#define COLOR_ARGB DWORD
-#define SETCOLOR_ARGB(a,r,g,b) \
-    ((COLOR_ARGB)((((a)&0xff)<<24)|(((r)&0xff)<<16)|(((g)&0xff)<<8)|((b)&0xff)))
+#include "graphicsBase.h"       // colors and the device independent part of Graphics
 
-namespace graphicsNS
-{
-    // Some common colors
-    // ARGB numbers range from 0 through 255
-    // A = Alpha channel (transparency where 255 is opaque)
-    // R = Red, G = Green, B = Blue
-    const COLOR_ARGB ORANGE  = D3DCOLOR_ARGB(255,255,165,  0);
-    const COLOR_ARGB BROWN   = D3DCOLOR_ARGB(255,139, 69, 19);
-    const COLOR_ARGB LTGRAY  = D3DCOLOR_ARGB(255,192,192,192);
-    const COLOR_ARGB GRAY    = D3DCOLOR_ARGB(255,128,128,128);
-    const COLOR_ARGB OLIVE   = D3DCOLOR_ARGB(255,128,128,  0);
-    const COLOR_ARGB PURPLE  = D3DCOLOR_ARGB(255,128,  0,128);
-    const COLOR_ARGB MAROON  = D3DCOLOR_ARGB(255,128,  0,  0);
-    const COLOR_ARGB TEAL    = D3DCOLOR_ARGB(255,  0,128,128);
-    const COLOR_ARGB GREEN   = D3DCOLOR_ARGB(255,  0,128,  0);
-    const COLOR_ARGB NAVY    = D3DCOLOR_ARGB(255,  0,  0,128);
-    const COLOR_ARGB WHITE   = D3DCOLOR_ARGB(255,255,255,255);
-    const COLOR_ARGB YELLOW  = D3DCOLOR_ARGB(255,255,255,  0);
-    const COLOR_ARGB MAGENTA = D3DCOLOR_ARGB(255,255,  0,255);
-    const COLOR_ARGB RED     = D3DCOLOR_ARGB(255,255,  0,  0);
-    const COLOR_ARGB CYAN    = D3DCOLOR_ARGB(255,  0,255,255);
-    const COLOR_ARGB LIME    = D3DCOLOR_ARGB(255,  0,255,  0);
-    const COLOR_ARGB BLUE    = D3DCOLOR_ARGB(255,  0,  0,255);
-    const COLOR_ARGB BLACK   = D3DCOLOR_ARGB(255,  0,  0,  0);
-    const COLOR_ARGB FILTER  = D3DCOLOR_ARGB(  0,  0,  0,  0);  // use to specify drawing with colorFilter
-    const COLOR_ARGB ALPHA25 = D3DCOLOR_ARGB( 64,255,255,255);  // AND with color to get 25% alpha
-    const COLOR_ARGB ALPHA50 = D3DCOLOR_ARGB(128,255,255,255);  // AND with color to get 50% alpha
-    const COLOR_ARGB BACK_COLOR = NAVY;                         // background color of game
-
-    enum DISPLAY_MODE{TOGGLE, FULLSCREEN, WINDOW};
-}
-
-// SpriteData: The properties required by Graphics::drawSprite to draw a sprite
-struct SpriteData
-{
-    int         width;      // width of sprite in pixels
-    int         height;     // height of sprite in pixels
-    float       x;          // screen location (top left corner of sprite)
-    float       y;
-    float       scale;      // <1 smaller, >1 bigger
-    float       angle;      // rotation angle in radians
-    RECT        rect;       // used to select an image from a larger texture
-    LP_TEXTURE  texture;    // pointer to texture
-    bool        flipHorizontal; // true to flip sprite horizontally (mirror)
-    bool        flipVertical;   // true to flip sprite vertically
-};
+#ifdef SOFTWARE_GRAPHICS
+#include "softGraphics.h"       // Graphics class drawing to a CPU framebuffer
+#else
 
-class Graphics
+class Graphics : public GraphicsBase
 {
 private:
     // DirectX pointers and stuff
@@ -95,17 +49,34 @@ private:
     D3DDISPLAYMODE pMode;
 
     // other variables
-    HRESULT     result;         // standard Windows return codes
-    HWND        hwnd;
-    bool        fullscreen;
-    int         width;
-    int         height;
-    COLOR_ARGB  backColor;      // background color
+    bool        mipmapDevice;   // false if the device can not mip textures
+    bool        mipmapNonPow2;  // false if the device can not mip non power of 2 textures
 
     // (For internal engine use only. No user serviceable parts inside.)
     // Initialize D3D presentation parameters
     void    initD3Dpp();
 
+    // Decode an image file in memory into premultiplied ARGB pixels.
+    virtual HRESULT decodeTexture(const BYTE *data, size_t size, COLOR_ARGB transcolor,
+                                  UINT &width, UINT &height, std::vector<COLOR_ARGB> &pixels,
+                                  SpriteSheet *sheet);
+
+    // Begin drawing sprites with premultiplied alpha blending.
+    virtual void beginSprites()
+    {
+        sprite->Begin(D3DXSPRITE_ALPHABLEND);
+        device3d->SetRenderState(D3DRS_SRCBLEND, D3DBLEND_ONE);     // premultiplied alpha
+        inSprite = true;
+    }
+
+    // Draw the batched sprites, if any, and end drawing sprites.
+    virtual void endSprites()
+    {
+        spriteBatch.flush(*this);
+        inSprite = false;
+        sprite->End();
+    }
+
 public:
     // Constructor
     Graphics();
@@ -126,11 +97,23 @@ public:
 
     // Load the texture into default D3D memory (normal texture use)
     // For internal engine use only. Use the TextureManager class to load game textures.
+    // Colors are premultiplied by alpha, see imageFile.h.
     // Pre: filename = name of texture file.
     //      transcolor = transparent color
     // Post: width and height = size of texture
     //       texture points to texture
-    HRESULT loadTexture(const char * filename, COLOR_ARGB transcolor, UINT &width, UINT &height, LP_TEXTURE &texture);
+    //       *sheet = frames of a cooked sprite sheet, if sheet is not NULL
+    HRESULT loadTexture(const char * filename, COLOR_ARGB transcolor, UINT &width, UINT &height,
+                        LP_TEXTURE &texture, SpriteSheet *sheet = NULL);
+
+    // Create a texture in default D3D memory from ARGB pixels in memory.
+    // Pre: pixels points to w*h premultiplied ARGB values, row by row from the top.
+    //      maxLevels = most mip levels, 0 for getMipLevels(w,h)
+    //      chain = mip levels 1 to maxLevels-1 made by Mipmap::build(), or
+    //      NULL to make them here
+    // Post: texture points to texture
+    HRESULT createTexture(const COLOR_ARGB *pixels, UINT w, UINT h, LP_TEXTURE &texture,
+                          UINT maxLevels = 0, const COLOR_ARGB *chain = NULL);
 
     // Display the offscreen backbuffer to the screen.
     HRESULT showBackbuffer();
@@ -143,14 +126,10 @@ public:
     //       Returns false if no compatible mode found.
     bool    isAdapterCompatible();
 
-    // Draw the sprite described in SpriteData structure.
-    // color is optional, it is applied as a filter, WHITE is default (no change).
-    // Creates a sprite Begin/End pair.
-    // Pre: spriteData.rect defines the portion of spriteData.texture to draw
-    //      spriteData.rect.right must be right edge + 1
-    //      spriteData.rect.bottom must be bottom edge + 1
-    void    drawSprite(const SpriteData &spriteData,           // sprite to draw
-                       COLOR_ARGB color = graphicsNS::WHITE);      // default to white color filter (no change)
+    // SpriteBatchBackend function, called by SpriteBatch::flush().
+    // Draw one sprite now using transform.
+    virtual void submitSprite(const SpriteData &spriteData, COLOR_ARGB color,
+                              const Affine2D &transform);
 
     // Reset the graphics device.
     HRESULT reset();
@@ -176,20 +155,21 @@ public:
     // Test for lost device
     HRESULT getDeviceState();
 
-    // Return fullscreen
-    bool    getFullscreen()     { return fullscreen; }
- 
-    // Set color used to clear screen
-    void setBackColor(COLOR_ARGB c) {backColor = c;}
+    // Return number of mip levels createTexture() makes for a w x h texture.
+    // 1 without mipmaps, or when the device can not mip a texture that size.
+    UINT getMipLevels(UINT w, UINT h);
 
     //=============================================================================
     // Clear backbuffer and BeginScene()
     //=============================================================================
-    HRESULT beginScene() 
+    virtual HRESULT beginScene() 
     {
         result = E_FAIL;
         if(device3d == NULL)
             return result;
+        spriteBatch.resetStats();   // new frame
+        spritesSubmitted = 0;
+        spritesCulled = 0;
         // clear backbuffer to backColor
         device3d->Clear(0, NULL, D3DCLEAR_TARGET, backColor, 1.0F, 0);
         result = device3d->BeginScene();          // begin scene for drawing
@@ -199,30 +179,15 @@ public:
     //=============================================================================
     // EndScene()
     //=============================================================================
-    HRESULT endScene() 
+    virtual HRESULT endScene() 
     {
         result = E_FAIL;
         if(device3d)
             result = device3d->EndScene();
         return result;
     }
-
-    //=============================================================================
-    // Sprite Begin
-    //=============================================================================
-    void spriteBegin() 
-    {
-        sprite->Begin(D3DXSPRITE_ALPHABLEND);
-    }
-
-    //=============================================================================
-    // Sprite End
-    //=============================================================================
-    void spriteEnd() 
-    {
-        sprite->End();
-    }
 };
 
-#endif
+#endif  // SOFTWARE_GRAPHICS
 
+#endif
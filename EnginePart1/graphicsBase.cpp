@@ -0,0 +1,178 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// graphicsBase.cpp v1.0
+// The device independent part of the Graphics class, see graphicsBase.h
+
+#include "graphics.h"
+
+//=============================================================================
+// Constructor
+//=============================================================================
+GraphicsBase::GraphicsBase()
+{
+    result = E_FAIL;
+    hwnd = NULL;
+    fullscreen = false;
+    width = GAME_WIDTH;    // width & height are replaced in initialize()
+    height = GAME_HEIGHT;
+    backColor = graphicsNS::BACK_COLOR;
+    batching = false;
+    inSprite = false;
+    culling = true;
+    mipmaps = true;
+    maxTextureSize = graphicsNS::MAX_TEXTURE_SIZE;
+    spritesSubmitted = 0;
+    spritesCulled = 0;
+    recordList = NULL;
+    assetPack = NULL;
+    tick = 0;
+    interpolation = 0;
+    interpolating = false;
+    imageTicks = NULL;
+}
+
+//=============================================================================
+// Load the texture file into premultiplied pixels
+// Pre: filename is name of texture file.
+//      transcolor is transparent color
+// Post: width and height = size of image
+//       pixels contains width*height ARGB values
+//       *sheet = frames of a cooked sprite sheet, if sheet is not NULL
+// Returns HRESULT
+//=============================================================================
+HRESULT GraphicsBase::loadTextureData(const char *filename, COLOR_ARGB transcolor,
+                                      UINT &width, UINT &height, std::vector<COLOR_ARGB> &pixels,
+                                      SpriteSheet *sheet)
+{
+    std::vector<BYTE> buffer;
+    const BYTE *data;
+    size_t size;
+    HRESULT hr = E_FAIL;
+
+    try{
+        if(filename == NULL)
+            return graphicsNS::E_INVALIDCALL;
+        if (!ImageFile::read(assetPack, filename, buffer, data, size))
+            return hr;
+        hr = decodeTexture(data, size, transcolor, width, height, pixels, sheet);
+    } catch(...)
+    {
+        throw(GameError(gameErrorNS::FATAL_ERROR, "Error in Graphics::loadTextureData"));
+    }
+    return hr;
+}
+
+//=============================================================================
+// Draw the sprite described in SpriteData structure
+// Color is optional, it is applied like a filter, WHITE is default (no change)
+// When batching the sprite is drawn by spriteEnd()
+// spriteData.rect defines the portion of spriteData.texture to draw
+//   spriteData.rect.right must be right edge + 1
+//   spriteData.rect.bottom must be bottom edge + 1
+//=============================================================================
+void GraphicsBase::drawSprite(const SpriteData &spriteData, COLOR_ARGB color)
+{
+    if(spriteData.texture == NULL)      // if no texture
+        return;
+    if(recordList)                      // if recording for the render thread
+    {
+        recordList->addSprite(spriteData, color);
+        return;
+    }
+    drawSpriteNow(spriteData, color);
+}
+
+//=============================================================================
+// Draw or batch the sprite
+//=============================================================================
+void GraphicsBase::drawSpriteNow(const SpriteData &spriteData, COLOR_ARGB color)
+{
+    spritesSubmitted++;
+    if(batching && inSprite)            // if batching sprites
+        spriteBatch.add(spriteData, color);
+    else
+    {
+        Affine2D transform;
+        Transform2D::spriteAffine(spriteData, transform);
+        submitSprite(spriteData, color, transform);
+    }
+}
+
+//=============================================================================
+// Sprite Begin
+//=============================================================================
+void GraphicsBase::spriteBegin()
+{
+    if (recordList)
+    {
+        recordList->add(renderCommandNS::SPRITE_BEGIN);
+        return;
+    }
+    beginSprites();
+}
+
+//=============================================================================
+// Sprite End
+//=============================================================================
+void GraphicsBase::spriteEnd()
+{
+    if (recordList)
+    {
+        recordList->add(renderCommandNS::SPRITE_END);
+        return;
+    }
+    endSprites();
+}
+
+//=============================================================================
+// Return true if the sprite may be visible in the backbuffer
+// Uses a bounding rectangle that contains the sprite at any rotation, so a
+// sprite is never culled when part of it is visible.
+//=============================================================================
+bool GraphicsBase::inViewport(const SpriteData &spriteData)
+{
+    if (!culling)
+        return true;
+    float left, top, right, bottom;
+    Transform2D::spriteBounds(spriteData, left, top, right, bottom);
+    if (right <= 0 || bottom <= 0 || left >= width || top >= height)
+    {
+        if (recordList)
+            recordList->addCulled();
+        else
+            spritesCulled++;
+        return false;
+    }
+    return true;
+}
+
+//=============================================================================
+// Draw a recorded frame
+// Called by the render thread, see renderQueue.h
+//=============================================================================
+void GraphicsBase::replay(const RenderCommandList &list)
+{
+    if (list.getBackColorSet())
+        backColor = list.getBackColor();
+    if (FAILED(beginScene()))
+        return;
+    for (UINT i = 0; i < list.getSize(); i++)
+    {
+        const RenderCommand &command = list.get(i);
+        switch (command.type)
+        {
+        case renderCommandNS::SPRITE_BEGIN:
+            beginSprites();
+            break;
+        case renderCommandNS::SPRITE:
+            drawSpriteNow(command.spriteData, command.color);
+            break;
+        case renderCommandNS::SPRITE_END:
+            endSprites();
+            break;
+        }
+    }
+    endScene();
+    spritesCulled += list.getSpritesCulled();   // beginScene() cleared the count
+}
@@ -0,0 +1,248 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// graphicsBase.h v1.0
+// The part of the Graphics class that does not depend on the device: the
+// common colors, the backbuffer size, sprite batching, culling, recording
+// for the render thread, interpolation between ticks and frame statistics.
+// The Direct3D Graphics class in graphics.h and the software one in
+// softGraphics.h inherit it and add the device: scenes, textures and
+// drawing one sprite.
+// Include graphics.h, not this file.
+
+#ifndef _GRAPHICSBASE_H         // Prevent multiple definitions if this
+#define _GRAPHICSBASE_H         // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <atomic>
+#include "constants.h"
+#include "gameError.h"
+#include "spriteData.h"
+#include "spriteBatch.h"
+#include "renderCommand.h"
+#include "assetPack.h"
+#include "imageFile.h"
+#include "mipmap.h"
+
+namespace graphicsNS
+{
+    // Some common colors
+    // ARGB numbers range from 0 through 255
+    // A = Alpha channel (transparency where 255 is opaque)
+    // R = Red, G = Green, B = Blue
+    const COLOR_ARGB ORANGE  = SETCOLOR_ARGB(255,255,165,  0);
+    const COLOR_ARGB BROWN   = SETCOLOR_ARGB(255,139, 69, 19);
+    const COLOR_ARGB LTGRAY  = SETCOLOR_ARGB(255,192,192,192);
+    const COLOR_ARGB GRAY    = SETCOLOR_ARGB(255,128,128,128);
+    const COLOR_ARGB OLIVE   = SETCOLOR_ARGB(255,128,128,  0);
+    const COLOR_ARGB PURPLE  = SETCOLOR_ARGB(255,128,  0,128);
+    const COLOR_ARGB MAROON  = SETCOLOR_ARGB(255,128,  0,  0);
+    const COLOR_ARGB TEAL    = SETCOLOR_ARGB(255,  0,128,128);
+    const COLOR_ARGB GREEN   = SETCOLOR_ARGB(255,  0,128,  0);
+    const COLOR_ARGB NAVY    = SETCOLOR_ARGB(255,  0,  0,128);
+    const COLOR_ARGB WHITE   = SETCOLOR_ARGB(255,255,255,255);
+    const COLOR_ARGB YELLOW  = SETCOLOR_ARGB(255,255,255,  0);
+    const COLOR_ARGB MAGENTA = SETCOLOR_ARGB(255,255,  0,255);
+    const COLOR_ARGB RED     = SETCOLOR_ARGB(255,255,  0,  0);
+    const COLOR_ARGB CYAN    = SETCOLOR_ARGB(255,  0,255,255);
+    const COLOR_ARGB LIME    = SETCOLOR_ARGB(255,  0,255,  0);
+    const COLOR_ARGB BLUE    = SETCOLOR_ARGB(255,  0,  0,255);
+    const COLOR_ARGB BLACK   = SETCOLOR_ARGB(255,  0,  0,  0);
+    const COLOR_ARGB FILTER  = SETCOLOR_ARGB(  0,  0,  0,  0);  // use to specify drawing with colorFilter
+    const COLOR_ARGB ALPHA25 = SETCOLOR_ARGB( 64,255,255,255);  // AND with color to get 25% alpha
+    const COLOR_ARGB ALPHA50 = SETCOLOR_ARGB(128,255,255,255);  // AND with color to get 50% alpha
+    const COLOR_ARGB BACK_COLOR = NAVY;                         // background color of game
+
+    const HRESULT E_INVALIDCALL = (HRESULT)0x8876086CL;         // same as D3DERR_INVALIDCALL
+    const UINT MAX_TEXTURE_SIZE = 8192;     // largest texture width and height until the device says
+
+    enum DISPLAY_MODE{TOGGLE, FULLSCREEN, WINDOW};
+}
+
+class ImageTicks;               // see image.h
+
+class GraphicsBase : public SpriteBatchBackend
+{
+protected:
+    HRESULT     result;         // standard return codes, of the drawing thread only;
+                                // texture functions, called by the game thread, use their own
+    HWND        hwnd;
+    bool        fullscreen;
+    int         width;
+    int         height;
+    COLOR_ARGB  backColor;      // background color
+    SpriteBatch spriteBatch;    // sprites waiting for spriteEnd() when batching
+    bool        batching;       // true to batch sprites between spriteBegin() and spriteEnd()
+    bool        inSprite;       // true between spriteBegin() and spriteEnd()
+    bool        culling;        // true to skip sprites outside the backbuffer
+    bool        mipmaps;        // true to create textures with mip levels
+    UINT        maxTextureSize; // largest texture width and height of the device
+    // Counted by the render thread when one runs and read by the game thread.
+    std::atomic<UINT> spritesSubmitted; // drawSprite() calls this frame
+    std::atomic<UINT> spritesCulled;    // sprites rejected by inViewport() this frame
+    RenderCommandList *recordList;  // when not NULL drawing is recorded here
+    AssetPack   *assetPack;     // textures are looked up here before the file system
+    UINT        tick;           // simulation tick being drawn, see setInterpolation()
+    float       interpolation;  // 0 to 1, time since tick as a fraction of a tick
+    bool        interpolating;  // true when Image::draw interpolates between ticks
+    ImageTicks *imageTicks;     // Images saving their position each tick, may be NULL
+
+    // Draw or batch the sprite, drawSprite() without recording.
+    void    drawSpriteNow(const SpriteData &spriteData, COLOR_ARGB color);
+
+    // Decode an image file in memory into premultiplied ARGB pixels.
+    virtual HRESULT decodeTexture(const BYTE *data, size_t size, COLOR_ARGB transcolor,
+                                  UINT &width, UINT &height, std::vector<COLOR_ARGB> &pixels,
+                                  SpriteSheet *sheet) = 0;
+
+    // Start and end drawing sprites on the device, spriteBegin() and
+    // spriteEnd() without recording.
+    virtual void beginSprites() = 0;
+    virtual void endSprites() = 0;
+
+public:
+    // Constructor
+    GraphicsBase();
+
+    // Destructor
+    virtual ~GraphicsBase() {}
+
+    // Clear backbuffer and begin scene.
+    virtual HRESULT beginScene() = 0;
+
+    // End scene.
+    virtual HRESULT endScene() = 0;
+
+    // Load the texture file into premultiplied ARGB pixels in system memory,
+    // with the color key applied.
+    // Pre: filename = name of texture file.
+    //      transcolor = transparent color, pixels with this RGB get 0 alpha
+    // Post: width and height = size of image
+    //       pixels contains width*height ARGB values, row by row from the top
+    //       *sheet = frames of a cooked sprite sheet, if sheet is not NULL
+    HRESULT loadTextureData(const char * filename, COLOR_ARGB transcolor, UINT &width, UINT &height,
+                            std::vector<COLOR_ARGB> &pixels, SpriteSheet *sheet = NULL);
+
+    // Load textures from pack. loadTexture() and loadTextureData() look up
+    // the file name in the pack first and read the file only if it is not
+    // there. NULL to use files only (default).
+    void setAssetPack(AssetPack *p) {assetPack = p;}
+
+    // Return the asset pack, NULL if none.
+    AssetPack* getAssetPack() const {return assetPack;}
+
+    // Draw the sprite described in SpriteData structure.
+    // color is optional, it is applied as a filter, WHITE is default (no change).
+    // When batching the sprite is added to the batch and drawn by spriteEnd().
+    // Pre: spriteData.rect defines the portion of spriteData.texture to draw
+    //      spriteData.rect.right must be right edge + 1
+    //      spriteData.rect.bottom must be bottom edge + 1
+    void    drawSprite(const SpriteData &spriteData,           // sprite to draw
+                       COLOR_ARGB color = graphicsNS::WHITE);      // default to white color filter (no change)
+
+    // Sprite Begin
+    void    spriteBegin();
+
+    // Sprite End, draws the batched sprites
+    void    spriteEnd();
+
+    // Return fullscreen
+    bool    getFullscreen()         {return fullscreen;}
+
+    // Return backbuffer width.
+    int     getWidth() const        {return width;}
+
+    // Return backbuffer height.
+    int     getHeight() const       {return height;}
+
+    // Set color used to clear screen
+    void setBackColor(COLOR_ARGB c)
+    {
+        if (recordList)
+            recordList->setBackColor(c);
+        else
+            backColor = c;
+    }
+
+    // Set batching. When true the sprites drawn between spriteBegin() and
+    // spriteEnd() are sorted by SpriteData.layer and texture before drawing.
+    void setBatching(bool b)        {batching = b;}
+
+    // Return batching
+    bool getBatching()              {return batching;}
+
+    // Set culling. When true inViewport() rejects sprites outside the backbuffer.
+    void setCulling(bool c)         {culling = c;}
+
+    // Return culling
+    bool getCulling()               {return culling;}
+
+    // Set mipmaps. When true (default) textures are created with mip levels,
+    // so sprites drawn scaled down sample a smaller texture. Applies to
+    // textures created after the call.
+    void setMipmaps(bool m)         {mipmaps = m;}
+
+    // Return mipmaps
+    bool getMipmaps()               {return mipmaps;}
+
+    // Return the largest texture width and height the device can create.
+    UINT getMaxTextureSize() const  {return maxTextureSize;}
+
+    // Return true if the sprite may be visible in the backbuffer, false if it
+    // is certainly outside. Image::draw calls this before drawSprite().
+    // Rejected sprites are counted in getSpritesCulled().
+    bool inViewport(const SpriteData &spriteData);
+
+    // Set the list to record into. While set, spriteBegin(), drawSprite(),
+    // spriteEnd() and setBackColor() are added to list instead of drawing,
+    // and inViewport() counts culled sprites in list. NULL to draw again.
+    // Used by Game when the render thread is running, see renderQueue.h.
+    void setRecording(RenderCommandList *list) {recordList = list;}
+
+    // Return the list being recorded, NULL if not recording.
+    RenderCommandList* getRecording() const {return recordList;}
+
+    // Draw a recorded frame: beginScene(), the recorded commands, endScene().
+    // The caller shows the backbuffer.
+    void replay(const RenderCommandList &list);
+
+    // Set the last simulation tick and the time since it as a fraction of
+    // a tick. Image::draw then draws sprites between their positions at
+    // the last two ticks. Called by Game in fixed time step mode.
+    void setInterpolation(UINT t, float alpha)
+    {
+        tick = t;
+        interpolation = alpha;
+        interpolating = true;
+    }
+
+    // Stop interpolating, sprites are drawn where they are.
+    void clearInterpolation()       {interpolating = false;}
+
+    // Return the tick set by setInterpolation().
+    UINT getTick() const            {return tick;}
+
+    // Return the fraction of a tick set by setInterpolation().
+    float getInterpolation() const  {return interpolation;}
+
+    // Return true if sprites are interpolated.
+    bool getInterpolating() const   {return interpolating;}
+
+    // Set the list Images add themselves to when they are first drawn
+    // interpolated. Game calls its beginTick() each tick. NULL for none.
+    void setImageTicks(ImageTicks *t)   {imageTicks = t;}
+
+    // Return the list set by setImageTicks().
+    ImageTicks* getImageTicks() const   {return imageTicks;}
+
+    // Return number of drawSprite() calls this frame.
+    UINT getSpritesSubmitted() const    {return spritesSubmitted;}
+
+    // Return number of sprites culled this frame.
+    UINT getSpritesCulled() const       {return spritesCulled;}
+
+    // Return the sprite batch, for statistics of the current frame.
+    const SpriteBatch& getSpriteBatch() const {return spriteBatch;}
+};
+
+#endif
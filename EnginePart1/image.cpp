@@ -4,6 +4,7 @@
 // Image.cpp v1.0
 
 #include "image.h"
+#include <math.h>
 
 //=============================================================================
 // default constructor
@@ -24,8 +25,16 @@ Image::Image()
     spriteData.texture = NULL;      // the sprite texture (picture)
     spriteData.flipHorizontal = false;
     spriteData.flipVertical = false;
+    spriteData.layer = 0;           // draw order when batching
     cols = 1;
     textureManager = NULL;
+    placeholder = NULL;
+    initWidth = 0;
+    initHeight = 0;
+    sizePending = false;
+    useSheet = false;
+    animator = NULL;
+    animation = 0;
     startFrame = 0;
     endFrame = 0;
     currentFrame = 0;
@@ -36,13 +45,24 @@ Image::Image()
     animComplete = false;
     graphics = NULL;                // link to graphics system
     colorFilter = graphicsNS::WHITE; // WHITE for no change
+    prevX = 0;
+    prevY = 0;
+    prevAngle = 0;
+    tickValid = false;
+    ticks = NULL;
+    tickIndex = 0;
 }
 
 //=============================================================================
 // destructor
 //=============================================================================
 Image::~Image()
-{}
+{
+    if (animator)
+        animator->remove(animation);
+    if (ticks)
+        ticks->remove(this);
+}
 
 //=============================================================================
 // Initialize the Image.
@@ -61,29 +81,84 @@ bool Image::initialize(Graphics *g, int width, int height, int ncols,
         textureManager = textureM;                  // pointer to texture object
 
         spriteData.texture = textureManager->getTexture();
-        if(width == 0)
-            width = textureManager->getWidth();     // use full width of texture
-        spriteData.width = width;
-        if(height == 0)
-            height = textureManager->getHeight();   // use full height of texture
-        spriteData.height = height;
         cols = ncols;
         if (cols == 0)
             cols = 1;                               // if 0 cols use 1
-
-        // configure spriteData.rect to draw currentFrame
-        spriteData.rect.left = (currentFrame % cols) * spriteData.width;
-        // right edge + 1
-        spriteData.rect.right = spriteData.rect.left + spriteData.width;
-        spriteData.rect.top = (currentFrame / cols) * spriteData.height;
-        // bottom edge + 1
-        spriteData.rect.bottom = spriteData.rect.top + spriteData.height;
+        initWidth = width;
+        initHeight = height;
+        useSheet = (width == 0 && height == 0 && ncols == 0);
+        // the size of a loading texture is not known yet, set again by draw()
+        sizePending = textureManager->isLoading();
+        setSize(width, height);
     }
     catch(...) {return false;}
     initialized = true;                                // successfully initialized
     return true;
 }
 
+//=============================================================================
+// Set the size and rect
+// width or height 0 uses the full texture width or height
+// or the frame size of a cooked sprite sheet
+//=============================================================================
+void Image::setSize(int width, int height)
+{
+    const SpriteSheet *sheet = useSheet ? textureManager->getSpriteSheet() : NULL;
+    if (sheet)
+    {
+        width = sheet->frameWidth;
+        height = sheet->frameHeight;
+        cols = sheet->cols;
+    }
+    if(width == 0)
+        width = textureManager->getWidth();     // use full width of texture
+    spriteData.width = width;
+    if(height == 0)
+        height = textureManager->getHeight();   // use full height of texture
+    spriteData.height = height;
+    if (animator)
+        animator->setFrameSize(animation, spriteData.width, spriteData.height, cols);
+    setRect();
+}
+
+//=============================================================================
+// Draw the placeholder in the place of the Image
+// The placeholder is scaled to fit inside the Image and centered. If the
+// size of the Image is not known yet it is drawn at its own size.
+//=============================================================================
+void Image::drawPlaceholder(const SpriteData &sd, COLOR_ARGB color)
+{
+    if (placeholder == NULL)
+        return;
+    placeholder->touch();
+    if (placeholder->getTexture() == NULL)
+        return;
+    UINT pw = placeholder->getWidth();
+    UINT ph = placeholder->getHeight();
+    if (pw == 0 || ph == 0)
+        return;
+    SpriteData p = sd;
+    p.texture = placeholder->getTexture();
+    p.width = pw;
+    p.height = ph;
+    p.rect.left = placeholder->getOffsetX();
+    p.rect.top = placeholder->getOffsetY();
+    p.rect.right = p.rect.left + pw;
+    p.rect.bottom = p.rect.top + ph;
+    if (!sizePending)
+    {
+        float fit = (float)sd.width / pw;
+        if ((float)sd.height / ph < fit)
+            fit = (float)sd.height / ph;
+        p.scale = sd.scale * fit;
+        p.x = sd.x + (sd.width*sd.scale - pw*p.scale) / 2;
+        p.y = sd.y + (sd.height*sd.scale - ph*p.scale) / 2;
+    }
+    if (!graphics->inViewport(p))               // if off screen
+        return;
+    graphics->drawSprite(p, color == graphicsNS::FILTER ? colorFilter : color);
+}
+
 
 //=============================================================================
 // Draw the image using color as filter
@@ -95,14 +170,84 @@ void Image::draw(COLOR_ARGB color)
 {
     if (!visible || graphics == NULL)
         return;
+    textureManager->touch();                    // load again if evicted
+    if (sizePending && !textureManager->isLoading())
+    {
+        sizePending = false;                    // the texture has loaded
+        setSize(initWidth, initHeight);
+    }
     // get fresh texture incase onReset() was called
     spriteData.texture = textureManager->getTexture();
+    if (animator)
+        setRect();                              // frame set by the Animator
+    float dx, dy, dAngle;
+    getTickOffset(dx, dy, dAngle);
+    if (dx != 0 || dy != 0 || dAngle != 0)      // if between two ticks
+    {
+        SpriteData sd = spriteData;
+        sd.x += dx;
+        sd.y += dy;
+        sd.angle += dAngle;
+        if (spriteData.texture == NULL)         // if still loading
+        {
+            drawPlaceholder(sd, color);
+            return;
+        }
+        if (!graphics->inViewport(sd))          // if off screen
+            return;
+        graphics->drawSprite(sd, color == graphicsNS::FILTER ? colorFilter : color);
+        return;
+    }
+    if (spriteData.texture == NULL)             // if still loading
+    {
+        drawPlaceholder(spriteData, color);
+        return;
+    }
+    if (!graphics->inViewport(spriteData))      // if off screen
+        return;
     if(color == graphicsNS::FILTER)                     // if draw with filter
         graphics->drawSprite(spriteData, colorFilter);  // use colorFilter
     else
         graphics->drawSprite(spriteData, color);        // use color as filter
 }
 
+//=============================================================================
+// Save the position at the start of a tick
+// Called by ImageTicks::beginTick() before the tick moves the Image.
+//=============================================================================
+void Image::saveTickState()
+{
+    prevX = spriteData.x;
+    prevY = spriteData.y;
+    prevAngle = spriteData.angle;
+    tickValid = true;
+}
+
+//=============================================================================
+// Set the offset from the current position to the position to draw at
+// In fixed time step mode the Image is drawn between its position at the
+// start of the last tick and its current position, by the fraction of a
+// tick passed since. The first time it is drawn so the Image adds itself to
+// the Graphics ImageTicks, and is drawn where it is until the next tick.
+//=============================================================================
+void Image::getTickOffset(float &dx, float &dy, float &dAngle)
+{
+    dx = dy = dAngle = 0;
+    if (!graphics->getInterpolating())          // if not fixed time step
+        return;
+    if (ticks == NULL && graphics->getImageTicks())
+        graphics->getImageTicks()->add(this);
+    if (!tickValid)
+        return;
+    float back = 1 - graphics->getInterpolation();
+    float turn = spriteData.angle - prevAngle;
+    if (turn > PI || turn < -PI)                // the angle wrapped around
+        turn -= (float)(2*PI) * floor(turn / (float)(2*PI) + 0.5f);
+    dx = (prevX - spriteData.x) * back;
+    dy = (prevY - spriteData.y) * back;
+    dAngle = -turn * back;
+}
+
 //=============================================================================
 // Draw this image using the specified SpriteData.
 //   The current SpriteData.rect is used to select the texture.
@@ -113,8 +258,23 @@ void Image::draw(SpriteData sd, COLOR_ARGB color)
 {
     if (!visible || graphics == NULL)
         return;
+    textureManager->touch();                    // load again if evicted
+    if (animator)
+        setRect();                              // frame set by the Animator
     sd.rect = spriteData.rect;                  // use this Images rect to select texture
+    float dx, dy, dAngle;
+    getTickOffset(dx, dy, dAngle);              // between ticks like draw()
+    sd.x += dx;
+    sd.y += dy;
+    sd.angle += dAngle;
+    if (!graphics->inViewport(sd))              // if off screen, bounded by the rect
+        return;
     sd.texture = textureManager->getTexture();  // get fresh texture incase onReset() was called
+    if (sd.texture == NULL)                     // if still loading
+    {
+        drawPlaceholder(sd, color);
+        return;
+    }
 
     if(color == graphicsNS::FILTER)             // if draw with filter
         graphics->drawSprite(sd, colorFilter);  // use colorFilter
@@ -129,6 +289,8 @@ void Image::draw(SpriteData sd, COLOR_ARGB color)
 //=============================================================================
 void Image::update(float frameTime)
 {
+    if (animator)                           // animated by Animator::update()
+        return;
     if (endFrame - startFrame > 0)          // if animated sprite
     {
         animTimer += frameTime;             // total elapsed time
@@ -160,21 +322,125 @@ void Image::setCurrentFrame(int c)
     {
         currentFrame = c;
         animComplete = false;
+        if (animator)
+            animator->setCurrentFrame(animation, c);
         setRect();                          // set spriteData.rect
     }
 }
 
+//=============================================================================
+// Animate the image with an Animator
+// The animation state is copied to the Animator, or back from it when a is
+// NULL, so the animation continues where it was.
+//=============================================================================
+void Image::setAnimator(Animator *a)
+{
+    if (a == animator)
+        return;
+    if (animator)
+    {
+        startFrame = animator->getStartFrame(animation);
+        endFrame = animator->getEndFrame(animation);
+        currentFrame = animator->getCurrentFrame(animation);
+        frameDelay = animator->getFrameDelay(animation);
+        animTimer = animator->getTimer(animation);
+        loop = animator->getLoop(animation);
+        animComplete = animator->getAnimationComplete(animation);
+        animator->remove(animation);
+    }
+    animator = a;
+    if (animator)
+    {
+        animation = animator->add(spriteData.width, spriteData.height, cols);
+        animator->setFrames(animation, startFrame, endFrame);
+        animator->setCurrentFrame(animation, currentFrame);
+        animator->setFrameDelay(animation, frameDelay);
+        animator->setTimer(animation, animTimer);
+        animator->setLoop(animation, loop);
+        animator->setAnimationComplete(animation, animComplete);
+    }
+    setRect();
+}
+
 //=============================================================================
 //  Set spriteData.rect to draw currentFrame
 //=============================================================================
 inline void Image::setRect() 
 {
     // configure spriteData.rect to draw currentFrame
-    spriteData.rect.left = (currentFrame % cols) * spriteData.width;
-    // right edge + 1
-    spriteData.rect.right = spriteData.rect.left + spriteData.width;
-    spriteData.rect.top = (currentFrame / cols) * spriteData.height;
-    // bottom edge + 1
-    spriteData.rect.bottom = spriteData.rect.top + spriteData.height;       
+    // offset by the image position when the texture is in an atlas
+    int offsetX = textureManager ? textureManager->getOffsetX() : 0;
+    int offsetY = textureManager ? textureManager->getOffsetY() : 0;
+    if (animator)
+        currentFrame = animator->getCurrentFrame(animation);
+    const SpriteSheet *sheet = (useSheet && textureManager) ? textureManager->getSpriteSheet() : NULL;
+    if (sheet && currentFrame >= 0 && currentFrame < (int)sheet->frames.size())
+    {
+        spriteData.rect = sheet->frames[currentFrame];  // precomputed by AssetTool
+    }
+    else if (animator && currentFrame >= 0)
+    {
+        spriteData.rect = animator->getFrameRect(animation);    // shared frame table
+    }
+    else
+    {
+        spriteData.rect.left = (currentFrame % cols) * spriteData.width;
+        // right edge + 1
+        spriteData.rect.right = spriteData.rect.left + spriteData.width;
+        spriteData.rect.top = (currentFrame / cols) * spriteData.height;
+        // bottom edge + 1
+        spriteData.rect.bottom = spriteData.rect.top + spriteData.height;
+    }
+    spriteData.rect.left += offsetX;
+    spriteData.rect.right += offsetX;
+    spriteData.rect.top += offsetY;
+    spriteData.rect.bottom += offsetY;
+}
+
+//=============================================================================
+// Destructor
+//=============================================================================
+ImageTicks::~ImageTicks()
+{
+    for (size_t i = 0; i < images.size(); i++)
+        images[i]->ticks = NULL;
+}
+
+//=============================================================================
+// Add image
+// Its position is saved from the next beginTick(), until then it is drawn
+// where it is.
+//=============================================================================
+void ImageTicks::add(Image *image)
+{
+    if (image->ticks)
+        image->ticks->remove(image);
+    image->ticks = this;
+    image->tickIndex = (UINT)images.size();
+    image->tickValid = false;
+    images.push_back(image);
+}
+
+//=============================================================================
+// Remove image
+// The last Image takes its place, so removing does not search.
+//=============================================================================
+void ImageTicks::remove(Image *image)
+{
+    if (image->ticks != this)
+        return;
+    Image *last = images.back();
+    images[image->tickIndex] = last;
+    last->tickIndex = image->tickIndex;
+    images.pop_back();
+    image->ticks = NULL;
 }
 
+//=============================================================================
+// Save the position of every Image as the start of a new tick
+//=============================================================================
+void ImageTicks::beginTick()
+{
+    for (size_t i = 0; i < images.size(); i++)
+        images[i]->saveTickState();
+}
@@ -9,15 +9,22 @@
 #define _IMAGE_H                // file is included in more than one place
 #define WIN32_LEAN_AND_MEAN
 
+#include <vector>
 #include "textureManager.h"
 #include "constants.h"
+#include "animator.h"
+
+class ImageTicks;
 
 class Image
 {
+    friend class ImageTicks;
+
     // Image properties
   protected:
     Graphics *graphics;     // pointer to graphics
     TextureManager *textureManager; // pointer to texture manager
+    TextureManager *placeholder;    // drawn while textureManager is loading, may be NULL
     // spriteData contains the data required to draw the image by Graphics::drawSprite()
     SpriteData spriteData;  // SpriteData is defined in "graphics.h"
     COLOR_ARGB colorFilter; // applied as a color filter (use WHITE for no change)
@@ -32,6 +39,39 @@ class Image
     bool    visible;        // true when visible
     bool    initialized;    // true when successfully initialized
     bool    animComplete;   // true when loop is false and endFrame has finished displaying
+    // interpolation between simulation ticks, see Graphics::setInterpolation()
+    float   prevX, prevY, prevAngle;    // position at the start of the last tick
+    bool    tickValid;      // false until a tick starts after the Image is drawn
+    ImageTicks *ticks;      // list saving the position each tick, NULL until drawn interpolated
+    UINT    tickIndex;      // place in ticks
+
+    // size requested by initialize(), used when the texture finishes loading
+    int     initWidth, initHeight;
+    bool    sizePending;    // true until the size of a loading texture is known
+    bool    useSheet;       // initialized with 0 width, height and cols, frames
+                            // come from a cooked sprite sheet if there is one
+    Animator *animator;     // animates the Image when not NULL, see setAnimator()
+    UINT    animation;      // animation number in animator
+
+    // Save the position at the start of a tick, called by ImageTicks.
+    void    saveTickState();
+
+    // Set the offset from the current position to the position to draw at.
+    // Not 0 when Game runs a fixed time step, see ImageTicks.
+    void    getTickOffset(float &dx, float &dy, float &dAngle);
+
+    // Set the size and rect from the initialize() parameters and the texture.
+    void    setSize(int width, int height);
+
+    // Draw the placeholder in the place of the Image.
+    void    drawPlaceholder(const SpriteData &sd, COLOR_ARGB color);
+
+  private:
+    // An Image is not copied: the copy would share the animation number of
+    // its Animator and the place in its ImageTicks, and remove them when
+    // destroyed.
+    Image(const Image &);
+    Image& operator=(const Image &);
 
   public:
     // Constructor
@@ -77,26 +117,59 @@ class Image
     virtual float getRadians()      {return spriteData.angle;}
 
     // Return delay between frames of animation.
-    virtual float getFrameDelay()   {return frameDelay;}
+    virtual float getFrameDelay()
+    {return animator ? animator->getFrameDelay(animation) : frameDelay;}
 
     // Return number of starting frame.
-    virtual int   getStartFrame()   {return startFrame;}
+    virtual int   getStartFrame()
+    {return animator ? animator->getStartFrame(animation) : startFrame;}
 
     // Return number of ending frame.
-    virtual int   getEndFrame()     {return endFrame;}
+    virtual int   getEndFrame()
+    {return animator ? animator->getEndFrame(animation) : endFrame;}
 
     // Return number of current frame.
-    virtual int   getCurrentFrame() {return currentFrame;}
+    virtual int   getCurrentFrame()
+    {return animator ? animator->getCurrentFrame(animation) : currentFrame;}
 
     // Return RECT structure of Image.
-    virtual RECT  getSpriteDataRect() {return spriteData.rect;}
+    // The RECT is relative to the image, also when the texture is in an atlas.
+    virtual RECT  getSpriteDataRect()
+    {
+        RECT r = spriteData.rect;
+        if (textureManager)
+        {
+            r.left -= textureManager->getOffsetX();
+            r.right -= textureManager->getOffsetX();
+            r.top -= textureManager->getOffsetY();
+            r.bottom -= textureManager->getOffsetY();
+        }
+        return r;
+    }
 
     // Return state of animation complete.
-    virtual bool  getAnimationComplete() {return animComplete;}
+    virtual bool  getAnimationComplete()
+    {return animator ? animator->getAnimationComplete(animation) : animComplete;}
+
+    // Return the Animator animating the Image, NULL if none.
+    Animator* getAnimator() const   {return animator;}
+
+    // Return true if the animation loops.
+    virtual bool  getLoop()
+    {return animator ? animator->getLoop(animation) : loop;}
+
+    // Return number of frames in a row of the texture.
+    virtual int   getColumns()      {return cols;}
+
+    // Return the TextureManager of the Image.
+    TextureManager* getTextureManager() const {return textureManager;}
 
     // Return colorFilter.
     virtual COLOR_ARGB getColorFilter() {return colorFilter;}
 
+    // Return draw layer.
+    virtual int   getLayer()        {return spriteData.layer;}
+
     ////////////////////////////////////////
     //           Set functions            //
     ////////////////////////////////////////
@@ -122,10 +195,21 @@ class Image
     virtual void setVisible(bool v) {visible = v;}
 
     // Set delay between frames of animation.
-    virtual void setFrameDelay(float d) {frameDelay = d;}
+    virtual void setFrameDelay(float d)
+    {
+        frameDelay = d;
+        if (animator)
+            animator->setFrameDelay(animation, d);
+    }
 
     // Set starting and ending frames of animation.
-    virtual void setFrames(int s, int e){startFrame = s; endFrame = e;}
+    virtual void setFrames(int s, int e)
+    {
+        startFrame = s;
+        endFrame = e;
+        if (animator)
+            animator->setFrames(animation, s, e);
+    }
 
     // Set current frame of animation.
     virtual void setCurrentFrame(int c);
@@ -134,21 +218,54 @@ class Image
     virtual void setRect(); 
 
     // Set spriteData.rect to r.
-    virtual void setSpriteDataRect(RECT r)  {spriteData.rect = r;}
+    // r is relative to the image, it is offset into the atlas page if the
+    // texture is in an atlas.
+    virtual void setSpriteDataRect(RECT r)
+    {
+        if (textureManager)
+        {
+            r.left += textureManager->getOffsetX();
+            r.right += textureManager->getOffsetX();
+            r.top += textureManager->getOffsetY();
+            r.bottom += textureManager->getOffsetY();
+        }
+        spriteData.rect = r;
+    }
 
     // Set animation loop. lp = true to loop.
-    virtual void setLoop(bool lp) {loop = lp;}
+    virtual void setLoop(bool lp)
+    {
+        loop = lp;
+        if (animator)
+            animator->setLoop(animation, lp);
+    }
 
     // Set animation complete Boolean.
-    virtual void setAnimationComplete(bool a) {animComplete = a;};
+    virtual void setAnimationComplete(bool a)
+    {
+        animComplete = a;
+        if (animator)
+            animator->setAnimationComplete(animation, a);
+    }
+
+    // Animate the Image with a, instead of in update(). The animation state
+    // moves to a, and back to the Image if a is NULL. a must outlive the Image.
+    virtual void setAnimator(Animator *a);
 
     // Set color filter. (use WHITE for no change)
     virtual void setColorFilter(COLOR_ARGB color) {colorFilter = color;}
 
+    // Set draw layer. When Graphics is batching, lower layers are drawn first.
+    virtual void setLayer(int l)    {spriteData.layer = l;}
+
     // Set TextureManager
     virtual void setTextureManager(TextureManager *textureM)
     { textureManager = textureM; }
 
+    // Set the texture drawn while the TextureManager is loading, scaled to
+    // fit the Image. NULL to draw nothing (default).
+    virtual void setPlaceholder(TextureManager *p) {placeholder = p;}
+
     ////////////////////////////////////////
     //         Other functions            //
     ////////////////////////////////////////
@@ -159,7 +276,9 @@ class Image
     //      height = height of Image in pixels (0 = use full texture height)
     //      ncols = number of columns in texture (1 to n) (0 same as 1)
     //      *textureM = pointer to TextureManager object
-    virtual bool Image::initialize(Graphics *g, int width, int height, 
+    // A cooked sprite sheet with width, height and ncols all 0 uses the frame
+    // size and frames stored in the texture file, see AssetTool cook.
+    virtual bool initialize(Graphics *g, int width, int height, 
                                     int ncols, TextureManager *textureM);
 
     // Flip image horizontally (mirror)
@@ -176,7 +295,39 @@ class Image
     virtual void draw(SpriteData sd, COLOR_ARGB color = graphicsNS::WHITE); // draw with SpriteData using color as filter
 
     // Update the animation. frameTime is used to regulate the speed.
+    // Does nothing when an Animator animates the Image.
     virtual void update(float frameTime);
+
+    // Draw at the current position instead of interpolating from the last tick.
+    // Call after moving the Image to a new place, e.g. respawn.
+    virtual void resetInterpolation() {tickValid = false;}
+};
+
+// The Images drawn between simulation ticks. An Image adds itself when it is
+// first drawn while Graphics is interpolating, and removes itself when it is
+// deleted. Game calls beginTick() before each tick, like
+// EntityStore::beginTick(), so every Image is drawn between its positions at
+// the last two ticks however many ticks run between frames.
+class ImageTicks
+{
+  private:
+    std::vector<Image*> images;
+
+  public:
+    // Destructor, Images still in the list are left without one.
+    ~ImageTicks();
+
+    // Add image, its position is saved from the next tick.
+    void    add(Image *image);
+
+    // Remove image.
+    void    remove(Image *image);
+
+    // Save the position of every Image as the start of a new tick.
+    void    beginTick();
+
+    // Return number of Images.
+    UINT    getSize() const     {return (UINT)images.size();}
 };
 
 #endif
@@ -0,0 +1,361 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// imageFile.cpp v1.0
+// Decodes image files into ARGB pixels without the graphics device.
+
+#include "imageFile.h"
+#include <stdio.h>
+#include <string.h>
+#include "assetPack.h"
+#include "mipmap.h"
+
+#ifdef _WIN32
+#include <wincodec.h>           // Windows Imaging Component, requires windowscodecs.lib
+#endif
+
+//=============================================================================
+// Read little endian values from a byte buffer
+//=============================================================================
+static inline UINT readWord(const BYTE *p)  {return p[0] | (p[1] << 8);}
+static inline UINT readDword(const BYTE *p) {return p[0] | (p[1] << 8) | (p[2] << 16) | ((UINT)p[3] << 24);}
+
+//=============================================================================
+// Read the whole file into data
+// Returns false on error
+//=============================================================================
+bool ImageFile::readFile(const char *filename, std::vector<BYTE> &data)
+{
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL)
+        return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    bool ok = false;
+    if (size > 0)
+    {
+        data.resize(size);
+        ok = fread(&data[0], 1, size, file) == (size_t)size;
+    }
+    fclose(file);
+    return ok;
+}
+
+//=============================================================================
+// Decode an uncompressed 24 or 32 bit .bmp file
+// Returns false if the file is not a supported .bmp
+//=============================================================================
+static bool decodeBmp(const BYTE *d, size_t size, UINT &width, UINT &height,
+                      std::vector<COLOR_ARGB> &pixels)
+{
+    if (size < 54 || d[0] != 'B' || d[1] != 'M')
+        return false;
+    UINT offset = readDword(d+10);
+    int w = (int)readDword(d+18);
+    int h = (int)readDword(d+22);
+    UINT bpp = readWord(d+28);
+    UINT compression = readDword(d+30);
+    bool topDown = h < 0;
+    if (topDown)
+        h = -h;
+    if (w <= 0 || h <= 0 || (bpp != 24 && bpp != 32) || (compression != 0 && compression != 3))
+        return false;
+    UINT bytes = bpp/8;
+    UINT pitch = (w*bytes + 3) & ~3u;       // rows are padded to 4 bytes
+    if (offset + (size_t)pitch*h > size)
+        return false;
+
+    width = w;
+    height = h;
+    pixels.resize(width*height);
+    for (UINT y = 0; y < height; y++)
+    {
+        const BYTE *row = d + offset + pitch*(topDown ? y : height-1-y);
+        COLOR_ARGB *out = &pixels[y*width];
+        for (UINT x = 0; x < width; x++, row += bytes)
+            out[x] = SETCOLOR_ARGB(255, row[2], row[1], row[0]);  // alpha not used by BI_RGB
+    }
+    return true;
+}
+
+//=============================================================================
+// Decode an uncompressed 24 or 32 bit .tga file
+// Returns false if the file is not a supported .tga
+//=============================================================================
+static bool decodeTga(const BYTE *d, size_t size, UINT &width, UINT &height,
+                      std::vector<COLOR_ARGB> &pixels)
+{
+    if (size < 18)
+        return false;
+    UINT idLength = d[0];
+    UINT w = readWord(d+12);
+    UINT h = readWord(d+14);
+    UINT bpp = d[16];
+    bool topDown = (d[17] & 0x20) != 0;
+    if (d[1] != 0 || d[2] != 2 || w == 0 || h == 0 || (bpp != 24 && bpp != 32))
+        return false;
+    UINT bytes = bpp/8;
+    size_t offset = 18 + idLength;
+    if (offset + (size_t)w*h*bytes > size)
+        return false;
+
+    width = w;
+    height = h;
+    pixels.resize(width*height);
+    for (UINT y = 0; y < height; y++)
+    {
+        const BYTE *row = d + offset + (size_t)w*bytes*(topDown ? y : height-1-y);
+        COLOR_ARGB *out = &pixels[y*width];
+        for (UINT x = 0; x < width; x++, row += bytes)
+            out[x] = SETCOLOR_ARGB(bytes == 4 ? row[3] : 255, row[2], row[1], row[0]);
+    }
+    return true;
+}
+
+#ifdef _WIN32
+//=============================================================================
+// Decode any image format Windows has a codec for (.jpg, .png, .bmp, ...)
+// with the Windows Imaging Component. WIC objects are free threaded so this
+// may run on a worker thread.
+// Returns false on error
+//=============================================================================
+static bool decodeWic(const BYTE *data, size_t size, UINT &width, UINT &height,
+                      std::vector<COLOR_ARGB> &pixels)
+{
+    HRESULT hr = CoInitializeEx(NULL, COINIT_MULTITHREADED);
+    bool uninitialize = SUCCEEDED(hr);      // S_FALSE if already initialized, still counted
+    IWICImagingFactory    *factory = NULL;
+    IWICStream            *stream = NULL;
+    IWICBitmapDecoder     *decoder = NULL;
+    IWICBitmapFrameDecode *frame = NULL;
+    IWICBitmapSource      *bgra = NULL;
+    UINT w = 0, h = 0;
+
+    hr = CoCreateInstance(CLSID_WICImagingFactory, NULL, CLSCTX_INPROC_SERVER,
+                          IID_IWICImagingFactory, (void**)&factory);
+    if (SUCCEEDED(hr))
+        hr = factory->CreateStream(&stream);
+    if (SUCCEEDED(hr))
+        hr = stream->InitializeFromMemory((BYTE*)data, (DWORD)size);
+    if (SUCCEEDED(hr))
+        hr = factory->CreateDecoderFromStream(stream, NULL, WICDecodeMetadataCacheOnDemand, &decoder);
+    if (SUCCEEDED(hr))
+        hr = decoder->GetFrame(0, &frame);
+    if (SUCCEEDED(hr))      // 32 bit BGRA in memory is ARGB in a DWORD
+        hr = WICConvertBitmapSource(GUID_WICPixelFormat32bppBGRA, frame, &bgra);
+    if (SUCCEEDED(hr))
+        hr = bgra->GetSize(&w, &h);
+    if (SUCCEEDED(hr) && (w == 0 || h == 0))
+        hr = E_FAIL;
+    if (SUCCEEDED(hr))
+    {
+        pixels.resize(w*h);
+        hr = bgra->CopyPixels(NULL, w*4, w*h*4, (BYTE*)&pixels[0]);
+    }
+    SAFE_RELEASE(bgra);
+    SAFE_RELEASE(frame);
+    SAFE_RELEASE(decoder);
+    SAFE_RELEASE(stream);
+    SAFE_RELEASE(factory);
+    if (uninitialize)
+        CoUninitialize();
+    if (FAILED(hr))
+        return false;
+    width = w;
+    height = h;
+    return true;
+}
+#endif
+
+//=============================================================================
+// Decode an image in memory
+// Returns false if the format is not supported
+//=============================================================================
+bool ImageFile::decode(const BYTE *data, size_t size, UINT &width, UINT &height,
+                       std::vector<COLOR_ARGB> &pixels)
+{
+    if (data == NULL || size == 0)
+        return false;
+    if (decodeBmp(data, size, width, height, pixels) || decodeTga(data, size, width, height, pixels))
+        return true;
+#ifdef _WIN32
+    return decodeWic(data, size, width, height, pixels);
+#else
+    return false;
+#endif
+}
+
+//=============================================================================
+// Make pixels with the RGB of transcolor transparent black
+//=============================================================================
+void ImageFile::applyColorKey(std::vector<COLOR_ARGB> &pixels, COLOR_ARGB transcolor)
+{
+    if (transcolor == 0)
+        return;
+    for (size_t i = 0; i < pixels.size(); i++)
+        if ((pixels[i] & 0x00FFFFFF) == (transcolor & 0x00FFFFFF))
+            pixels[i] = 0;
+}
+
+//=============================================================================
+// Multiply red, green and blue by alpha
+//=============================================================================
+void ImageFile::premultiply(std::vector<COLOR_ARGB> &pixels)
+{
+    for (size_t i = 0; i < pixels.size(); i++)
+        pixels[i] = premultiplyColor(pixels[i]);
+}
+
+//=============================================================================
+// Read the image file and load it
+// Returns false on error
+//=============================================================================
+bool ImageFile::load(const char *filename, COLOR_ARGB transcolor, UINT &width, UINT &height,
+                     std::vector<COLOR_ARGB> &pixels, SpriteSheet *sheet)
+{
+    std::vector<BYTE> data;
+    if (filename == NULL || !readFile(filename, data))
+        return false;
+    return load(&data[0], data.size(), transcolor, width, height, pixels, sheet);
+}
+
+//=============================================================================
+// Load the image file in memory
+// A cooked texture is already color keyed and premultiplied, it is copied.
+// Other images are decoded, color keyed and premultiplied.
+// Returns false on error
+//=============================================================================
+bool ImageFile::load(const BYTE *data, size_t size, COLOR_ARGB transcolor, UINT &width,
+                     UINT &height, std::vector<COLOR_ARGB> &pixels, SpriteSheet *sheet)
+{
+    const CookedHeader *cooked = getCooked(data, size);
+    if (cooked)
+    {
+        const COLOR_ARGB *p = getCookedPixels(cooked);
+        pixels.assign(p, p + cooked->width*cooked->height);
+        width = cooked->width;
+        height = cooked->height;
+        if (sheet)
+            getCookedSheet(cooked, *sheet);
+        return true;
+    }
+    if (!decode(data, size, width, height, pixels))
+        return false;
+    applyColorKey(pixels, transcolor);
+    premultiply(pixels);
+    if (sheet)
+        sheet->frames.clear();
+    return true;
+}
+
+//=============================================================================
+// Get the bytes of an image file, from the pack or the file
+// Returns false if the file can not be read
+//=============================================================================
+bool ImageFile::read(const AssetPack *pack, const char *filename, std::vector<BYTE> &buffer,
+                     const BYTE *&data, size_t &size)
+{
+    if (filename == NULL)
+        return false;
+    if (pack && pack->find(filename, data, size))
+        return true;
+    if (!readFile(filename, buffer))
+        return false;
+    data = &buffer[0];
+    size = buffer.size();
+    return true;
+}
+
+//=============================================================================
+// Return the header of a cooked texture, NULL if data is not one
+// Every size is checked against the data so a damaged file is rejected.
+//=============================================================================
+const CookedHeader* ImageFile::getCooked(const BYTE *data, size_t size)
+{
+    if (data == NULL || size < sizeof(CookedHeader) || ((size_t)data & 3) != 0)
+        return NULL;
+    const CookedHeader *h = (const CookedHeader*)data;
+    if (h->magic != imageFileNS::COOKED_MAGIC || h->version != imageFileNS::COOKED_VERSION)
+        return NULL;
+    if (h->width == 0 || h->height == 0 || h->width > 0x8000 || h->height > 0x8000)
+        return NULL;
+    UINT64 frameEnd = sizeof(CookedHeader) + (UINT64)h->frameCount*sizeof(RECT);
+    if (h->levels > Mipmap::getLevelCount(h->width, h->height))
+        return NULL;
+    UINT64 pixelCount = (UINT64)h->width*h->height;
+    if (h->levels > 1)
+        pixelCount += Mipmap::getChainSize(h->width, h->height, h->levels);
+    UINT64 pixelEnd = (UINT64)h->pixelOffset + pixelCount*sizeof(COLOR_ARGB);
+    if (frameEnd > h->pixelOffset || pixelEnd > size || (h->pixelOffset & 3) != 0)
+        return NULL;
+    return h;
+}
+
+//=============================================================================
+// Get the frames of a cooked sprite sheet
+//=============================================================================
+void ImageFile::getCookedSheet(const CookedHeader *cooked, SpriteSheet &sheet)
+{
+    const RECT *frames = (const RECT*)(cooked + 1);
+    sheet.frameWidth = cooked->frameWidth;
+    sheet.frameHeight = cooked->frameHeight;
+    sheet.cols = cooked->cols;
+    sheet.frames.assign(frames, frames + cooked->frameCount);
+}
+
+//=============================================================================
+// Write a cooked texture
+// With mips the mip chain is made here and written after the pixels.
+// Returns false on error
+//=============================================================================
+bool ImageFile::writeCooked(const char *filename, UINT width, UINT height,
+                            const std::vector<COLOR_ARGB> &pixels, const SpriteSheet *sheet,
+                            bool mips)
+{
+    if (width == 0 || height == 0 || pixels.size() != (size_t)width*height)
+        return false;
+    std::vector<COLOR_ARGB> chain;
+    UINT levels = mips ? Mipmap::getLevelCount(width, height) : 1;
+    if (levels > 1)
+    {
+        chain.resize(Mipmap::getChainSize(width, height, levels));
+        Mipmap::build(&pixels[0], width, height, levels, &chain[0]);
+    }
+    CookedHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = imageFileNS::COOKED_MAGIC;
+    header.version = imageFileNS::COOKED_VERSION;
+    header.width = width;
+    header.height = height;
+    header.levels = levels;
+    if (sheet)
+    {
+        header.frameWidth = sheet->frameWidth;
+        header.frameHeight = sheet->frameHeight;
+        header.cols = sheet->cols;
+        header.frameCount = (UINT)sheet->frames.size();
+    }
+    UINT frameEnd = sizeof(CookedHeader) + header.frameCount*sizeof(RECT);
+    UINT align = imageFileNS::COOKED_ALIGNMENT;
+    header.pixelOffset = (frameEnd + align-1) / align * align;
+
+    FILE *file = fopen(filename, "wb");
+    if (file == NULL)
+        return false;
+    static const BYTE zeros[imageFileNS::COOKED_ALIGNMENT] = {0};
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (ok && header.frameCount > 0)
+        ok = fwrite(&sheet->frames[0], sizeof(RECT), header.frameCount, file) == header.frameCount;
+    if (ok && header.pixelOffset > frameEnd)
+        ok = fwrite(zeros, 1, header.pixelOffset - frameEnd, file) == header.pixelOffset - frameEnd;
+    if (ok)
+        ok = fwrite(&pixels[0], sizeof(COLOR_ARGB), pixels.size(), file) == pixels.size();
+    if (ok && !chain.empty())
+        ok = fwrite(&chain[0], sizeof(COLOR_ARGB), chain.size(), file) == chain.size();
+    if (fclose(file) != 0)
+        ok = false;
+    if (!ok)
+        remove(filename);
+    return ok;
+}
@@ -0,0 +1,129 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// imageFile.h v1.0
+// Decodes image files into ARGB pixels without the graphics device, so it
+// is safe to call from any thread. Uncompressed 24 and 32 bit .bmp and .tga
+// files are decoded everywhere. On Windows other formats (.jpg, .png) are
+// decoded with the Windows Imaging Component.
+// Textures hold premultiplied alpha: red, green and blue are multiplied by
+// alpha when an image is loaded. Cooked textures, made by AssetTool cook,
+// are stored that way, with their mip levels, so loading one is a copy.
+
+#ifndef _IMAGEFILE_H            // Prevent multiple definitions if this
+#define _IMAGEFILE_H            // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+#include "constants.h"
+#include "spriteData.h"
+
+class AssetPack;
+
+namespace imageFileNS
+{
+    const UINT COOKED_MAGIC = 0x58455443;   // "CTEX"
+    const UINT COOKED_VERSION = 1;
+    const UINT COOKED_ALIGNMENT = 64;       // of the pixels in the file
+}
+
+// Header of a cooked texture file.
+// File layout: CookedHeader, RECT[frameCount], premultiplied ARGB pixels
+// at pixelOffset, row by row from the top, then mip levels 1 to levels-1
+// the same way, largest first, see mipmap.h.
+struct CookedHeader
+{
+    UINT    magic;          // imageFileNS::COOKED_MAGIC
+    UINT    version;        // imageFileNS::COOKED_VERSION
+    UINT    width;          // size of the texture
+    UINT    height;
+    UINT    frameWidth;     // size of one frame, 0 if not a sprite sheet
+    UINT    frameHeight;
+    UINT    cols;           // frames in a row
+    UINT    frameCount;     // source RECTs following the header
+    UINT    pixelOffset;    // file offset of the pixels
+    UINT    levels;         // mip levels stored including the pixels, 0 or 1 for none
+    UINT    reserved[6];    // 0, header is 64 bytes
+};
+
+// Frames of a sprite sheet, frames[n] is the source RECT of frame n.
+struct SpriteSheet
+{
+    UINT    frameWidth;
+    UINT    frameHeight;
+    UINT    cols;
+    std::vector<RECT> frames;
+};
+
+class ImageFile
+{
+  public:
+    // Read the image file, decode it, apply the color key and premultiply
+    // alpha. A cooked texture is copied.
+    // Post: width and height = size of image
+    //       pixels contains width*height premultiplied ARGB values, row by
+    //       row from the top
+    //       *sheet = frames of a cooked sprite sheet, if sheet is not NULL
+    // Returns false on error.
+    static bool load(const char *filename, COLOR_ARGB transcolor, UINT &width, UINT &height,
+                     std::vector<COLOR_ARGB> &pixels, SpriteSheet *sheet = NULL);
+
+    // Load an image file in memory, e.g. in an AssetPack. Same as load() above.
+    // Returns false on error.
+    static bool load(const BYTE *data, size_t size, COLOR_ARGB transcolor, UINT &width,
+                     UINT &height, std::vector<COLOR_ARGB> &pixels, SpriteSheet *sheet = NULL);
+
+    // Get the bytes of an image file, from pack if the file is in it, else
+    // by reading the file into buffer. pack may be NULL.
+    // Post: data points to size bytes of the file
+    // Returns false if the file can not be read.
+    static bool read(const AssetPack *pack, const char *filename, std::vector<BYTE> &buffer,
+                     const BYTE *&data, size_t &size);
+
+    // Read the whole file into data.
+    // Returns false on error.
+    static bool readFile(const char *filename, std::vector<BYTE> &data);
+
+    // Return the header if data is a valid cooked texture, else NULL.
+    static const CookedHeader* getCooked(const BYTE *data, size_t size);
+
+    // Return the pixels of a cooked texture.
+    static const COLOR_ARGB* getCookedPixels(const CookedHeader *cooked)
+    {
+        return (const COLOR_ARGB*)((const BYTE*)cooked + cooked->pixelOffset);
+    }
+
+    // Return mip levels 1 to cooked->levels-1 of a cooked texture, NULL if
+    // it has none.
+    static const COLOR_ARGB* getCookedMips(const CookedHeader *cooked)
+    {
+        if (cooked->levels <= 1)
+            return NULL;
+        return getCookedPixels(cooked) + cooked->width*cooked->height;
+    }
+
+    // Get the sprite sheet frames of a cooked texture.
+    static void getCookedSheet(const CookedHeader *cooked, SpriteSheet &sheet);
+
+    // Write a cooked texture file. With mips every mip level down to 1x1 is
+    // stored after the pixels, so they are not made at load.
+    // Pre: pixels are premultiplied, sheet may be NULL.
+    // Returns false on error.
+    static bool writeCooked(const char *filename, UINT width, UINT height,
+                            const std::vector<COLOR_ARGB> &pixels, const SpriteSheet *sheet,
+                            bool mips = true);
+
+    // Decode an image file already in memory. The color key is not applied.
+    // Returns false if the format is not supported.
+    static bool decode(const BYTE *data, size_t size, UINT &width, UINT &height,
+                       std::vector<COLOR_ARGB> &pixels);
+
+    // Make pixels with the RGB of transcolor transparent black, the same as
+    // the color key of D3DXCreateTextureFromFileEx. 0 for no color key.
+    static void applyColorKey(std::vector<COLOR_ARGB> &pixels, COLOR_ARGB transcolor);
+
+    // Multiply red, green and blue by alpha.
+    static void premultiply(std::vector<COLOR_ARGB> &pixels);
+};
+
+#endif
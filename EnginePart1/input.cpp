@@ -4,38 +4,18 @@
 // input.cpp v1.0
 
 #include "input.h"
+#include "gameClock.h"
+#include <string.h>
 
 //=============================================================================
 // default constructor
 //=============================================================================
 Input::Input()
 {
-    // clear key down array
-    for (size_t i = 0; i < inputNS::KEYS_ARRAY_LEN; i++)
-        keysDown[i] = false;
-    // clear key pressed array
-    for (size_t i = 0; i < inputNS::KEYS_ARRAY_LEN; i++)
-        keysPressed[i] = false;
-    newLine = true;                     // start new line
-    textIn = "";                        // clear textIn
-    charIn = 0;                         // clear charIn
-
-    // mouse data
-    mouseX = 0;                         // screen X
-    mouseY = 0;                         // screen Y
-    mouseRawX = 0;                      // high-definition X
-    mouseRawY = 0;                      // high-definition Y
-    mouseLButton = false;               // true if left mouse button is down
-    mouseMButton = false;               // true if middle mouse button is down
-    mouseRButton = false;               // true if right mouse button is down
-    mouseX1Button = false;              // true if X1 mouse button is down
-    mouseX2Button = false;              // true if X2 mouse button is down
-
-    for(int i=0; i<MAX_CONTROLLERS; i++)
-    {
-        controllers[i].vibrateTimeLeft = 0;
-        controllers[i].vibrateTimeRight = 0;
-    }
+    mouseCaptured = false;
+    // not connected until initialize(), which may not be called when
+    // replaying recorded input without a window
+    memset( controllers, 0, sizeof(ControllerState) * MAX_CONTROLLERS );
 }
 
 //=============================================================================
@@ -43,8 +23,10 @@ Input::Input()
 //=============================================================================
 Input::~Input()
 {
+#ifdef _WIN32
     if(mouseCaptured)
         ReleaseCapture();               // release mouse
+#endif
 }
 
 //=============================================================================
@@ -52,6 +34,7 @@ Input::~Input()
 // Set capture=true to capture mouse
 // Throws GameError
 //=============================================================================
+#ifdef _WIN32
 void Input::initialize(HWND hwnd, bool capture)
 {
     try{
@@ -77,143 +60,48 @@ void Input::initialize(HWND hwnd, bool capture)
         throw(GameError(gameErrorNS::FATAL_ERROR, "Error initializing input system"));
     }
 }
-
-//=============================================================================
-// Set true in the keysDown and keysPessed array for this key
-// Pre: wParam contains the virtual key code (0--255)
-//=============================================================================
-void Input::keyDown(WPARAM wParam)
-{
-    // make sure key code is within buffer range
-    if (wParam < inputNS::KEYS_ARRAY_LEN)
-    {
-        keysDown[wParam] = true;    // update keysDown array
-        // key has been "pressed, erased by clear()
-        keysPressed[wParam] = true; // update keysPressed array
-    }
-}
-
-//=============================================================================
-// Set false in the keysDown array for this key
-// Pre: wParam contains the virtual key code (0--255)
-//=============================================================================
-void Input::keyUp(WPARAM wParam)
-{
-    // make sure key code is within buffer range
-    if (wParam < inputNS::KEYS_ARRAY_LEN)
-        // update state table
-        keysDown[wParam] = false;
-}
-
-//=============================================================================
-// Save the char just entered in textIn string
-// Pre: wParam contains the char
-//=============================================================================
-void Input::keyIn(WPARAM wParam)
-{
-    if (newLine)                            // if start of new line
-    {
-        textIn.clear();
-        newLine = false;
-    }
-
-    if (wParam == '\b')                     // if backspace
-    {
-        if(textIn.length() > 0)             // if characters exist
-            textIn.erase(textIn.size()-1);  // erase last character entered
-    }
-    else
-    {
-        textIn += wParam;                   // add character to textIn
-        charIn = wParam;                    // save last char entered
-    }
-
-    if ((char)wParam == '\r')               // if return    
-        newLine = true;                     // start new line
-}
-
-//=============================================================================
-// Returns true if the specified VIRTUAL KEY is down, otherwise false.
-//=============================================================================
-bool Input::isKeyDown(UCHAR vkey) const
-{
-    if (vkey < inputNS::KEYS_ARRAY_LEN)
-        return keysDown[vkey];
-    else
-        return false;
-}
-
-//=============================================================================
-// Return true if the specified VIRTUAL KEY has been pressed in the most recent
-// frame. Key presses are erased at the end of each frame.
-//=============================================================================
-bool Input::wasKeyPressed(UCHAR vkey) const
-{
-    if (vkey < inputNS::KEYS_ARRAY_LEN)
-        return keysPressed[vkey];
-    else
-        return false;
-}
-
-//=============================================================================
-// Return true if any key was pressed in the most recent frame.
-// Key presses are erased at the end of each frame.
-//=============================================================================
-bool Input::anyKeyPressed() const
+#else
+void Input::initialize(HWND, bool)
 {
-    for (size_t i = 0; i < inputNS::KEYS_ARRAY_LEN; i++)
-        if(keysPressed[i] == true)
-            return true;
-    return false;
+    mouseCaptured = false;              // no window to capture the mouse in
+    memset( controllers, 0, sizeof(ControllerState) * MAX_CONTROLLERS );
 }
+#endif
 
 //=============================================================================
-// Clear the specified key press
+// Post an event
+// Returns false if the queue is full
 //=============================================================================
-void Input::clearKeyPress(UCHAR vkey)
+bool Input::postEvent(inputNS::EVENT_TYPE type, UINT code, int x, int y)
 {
-    if (vkey < inputNS::KEYS_ARRAY_LEN)
-        keysPressed[vkey] = false;
+    InputEvent e;
+    e.time = GameClock::ticks();
+    e.type = type;
+    e.code = code;
+    e.x = x;
+    e.y = y;
+    return queue.push(e);
 }
 
 //=============================================================================
-// Clear specified input buffers
-// See input.h for what values
+// Apply the posted events to the input state
+// Returns the number of events processed
 //=============================================================================
-void Input::clear(UCHAR what)
+UINT Input::processEvents()
 {
-    if(what & inputNS::KEYS_DOWN)       // if clear keys down
-    {
-        for (size_t i = 0; i < inputNS::KEYS_ARRAY_LEN; i++)
-            keysDown[i] = false;
-    }
-    if(what & inputNS::KEYS_PRESSED)    // if clear keys pressed
-    {
-        for (size_t i = 0; i < inputNS::KEYS_ARRAY_LEN; i++)
-            keysPressed[i] = false;
-    }
-    if(what & inputNS::MOUSE)           // if clear mouse
+    UINT n = 0;
+    InputEvent e;
+    while (queue.pop(e))
     {
-        mouseX = 0;
-        mouseY = 0;
-        mouseRawX = 0;
-        mouseRawY = 0;
+        state.apply(e);
+        n++;
     }
-    if(what & inputNS::TEXT_IN)
-        clearTextIn();
+    return n;
 }
 
+#ifdef _WIN32
 //=============================================================================
-// Reads mouse screen position into mouseX, mouseY
-//=============================================================================
-void Input::mouseIn(LPARAM lParam)
-{
-    mouseX = GET_X_LPARAM(lParam); 
-    mouseY = GET_Y_LPARAM(lParam);
-}
-
-//=============================================================================
-// Reads raw mouse data into mouseRawX, mouseRawY
+// Reads raw mouse data and posts it
 // This routine is compatible with a high-definition mouse
 //=============================================================================
 void Input::mouseRawIn(LPARAM lParam)
@@ -227,10 +115,7 @@ void Input::mouseRawIn(LPARAM lParam)
     RAWINPUT* raw = (RAWINPUT*)lpb;
     
     if (raw->header.dwType == RIM_TYPEMOUSE) 
-    {
-        mouseRawX = raw->data.mouse.lLastX;
-        mouseRawY = raw->data.mouse.lLastY;
-    } 
+        postEvent(inputNS::MOUSE_RAW, 0, raw->data.mouse.lLastX, raw->data.mouse.lLastY);
 }
 
 //=============================================================================
@@ -266,12 +151,65 @@ void Input::readControllers()
     }
 }
 
+#else
+//=============================================================================
+// No controllers without XInput
+//=============================================================================
+void Input::checkControllers()
+{
+}
+
+void Input::readControllers()
+{
+}
+#endif
+
+//=============================================================================
+// Copy the state of the controllers, for recording
+//=============================================================================
+void Input::getControllerInput(ControllerInput *c) const
+{
+    for (DWORD i = 0; i < MAX_CONTROLLERS; i++)
+    {
+        const XINPUT_GAMEPAD &pad = controllers[i].state.Gamepad;
+        c[i].connected = controllers[i].connected;
+        c[i].packet = controllers[i].state.dwPacketNumber;
+        c[i].buttons = pad.wButtons;
+        c[i].leftTrigger = pad.bLeftTrigger;
+        c[i].rightTrigger = pad.bRightTrigger;
+        c[i].thumbLX = pad.sThumbLX;
+        c[i].thumbLY = pad.sThumbLY;
+        c[i].thumbRX = pad.sThumbRX;
+        c[i].thumbRY = pad.sThumbRY;
+    }
+}
+
+//=============================================================================
+// Set the state of the controllers, for replaying
+//=============================================================================
+void Input::setControllerInput(const ControllerInput *c)
+{
+    for (DWORD i = 0; i < MAX_CONTROLLERS; i++)
+    {
+        XINPUT_GAMEPAD &pad = controllers[i].state.Gamepad;
+        controllers[i].connected = c[i].connected;
+        controllers[i].state.dwPacketNumber = c[i].packet;
+        pad.wButtons = c[i].buttons;
+        pad.bLeftTrigger = c[i].leftTrigger;
+        pad.bRightTrigger = c[i].rightTrigger;
+        pad.sThumbLX = c[i].thumbLX;
+        pad.sThumbLY = c[i].thumbLY;
+        pad.sThumbRX = c[i].thumbRX;
+        pad.sThumbRY = c[i].thumbRY;
+    }
+}
+
 //=============================================================================
 // Vibrate connected controllers
 //=============================================================================
 void Input::vibrateControllers(float frameTime)
 {
-    for(int i=0; i < MAX_CONTROLLERS; i++)
+    for(DWORD i=0; i < MAX_CONTROLLERS; i++)
     {
         if(controllers[i].connected)
         {
@@ -287,7 +225,9 @@ void Input::vibrateControllers(float frameTime)
                 controllers[i].vibrateTimeRight = 0;
                 controllers[i].vibration.wRightMotorSpeed = 0;
             }
+#ifdef _WIN32
             XInputSetState(i, &controllers[i].vibration);
+#endif
         }
     }
 }
@@ -9,6 +9,12 @@
 //The game controller data is stored in the controllers array.
 //
 //Charles; Kelly (2012-07-09). Programming 2D Games (Page 86). A. K. Peters. Kindle Edition. 
+//
+// Key and mouse messages are posted as timestamped events and applied to the
+// key, mouse and text state once a frame by processEvents(), see inputQueue.h.
+// Game controllers are read with XInput on Windows. Elsewhere there is no
+// window or controller to read, input comes from postEvent() and
+// setControllerInput(), for replaying recorded input, see inputRecorder.h.
 
 #ifndef _INPUT_H                // Prevent multiple definitions if this 
 #define _INPUT_H                // file is included in more than one place
@@ -16,14 +22,18 @@
 
 class Input;
 
-#include <windows.h>
+#include "platform.h"
+#ifdef _WIN32
 #include <WindowsX.h>
-#include <string>
 #include <XInput.h>
+#endif
+#include <string>
 #include "constants.h"
 #include "gameError.h"
+#include "inputQueue.h"
+#include "inputRecorder.h"
 
-
+#ifdef _WIN32
 // for high-definition mouse
 #ifndef HID_USAGE_PAGE_GENERIC
 #define HID_USAGE_PAGE_GENERIC      ((USHORT) 0x01)
@@ -31,19 +41,32 @@ class Input;
 #ifndef HID_USAGE_GENERIC_MOUSE
 #define HID_USAGE_GENERIC_MOUSE     ((USHORT) 0x02)
 #endif
-//--------------------------
+#else
+// XInput types, no controller is read without XInput
+struct XINPUT_GAMEPAD
+{
+    WORD    wButtons;
+    BYTE    bLeftTrigger;
+    BYTE    bRightTrigger;
+    SHORT   sThumbLX;
+    SHORT   sThumbLY;
+    SHORT   sThumbRX;
+    SHORT   sThumbRY;
+};
 
-namespace inputNS
+struct XINPUT_STATE
 {
-    const int KEYS_ARRAY_LEN = 256;     // size of key arrays
-    
-    // what values for clear(), bit flag
-    const UCHAR KEYS_DOWN = 1;
-    const UCHAR KEYS_PRESSED = 2;
-    const UCHAR MOUSE = 4;
-    const UCHAR TEXT_IN = 8;
-    const UCHAR KEYS_MOUSE_TEXT = KEYS_DOWN + KEYS_PRESSED + MOUSE + TEXT_IN;
-}
+    DWORD   dwPacketNumber;
+    XINPUT_GAMEPAD Gamepad;
+};
+
+struct XINPUT_VIBRATION
+{
+    WORD    wLeftMotorSpeed;
+    WORD    wRightMotorSpeed;
+};
+#endif
+//--------------------------
 
 const DWORD GAMEPAD_THUMBSTICK_DEADZONE = (DWORD)(0.20f * 0X7FFF);    // default to 20% of range as deadzone
 const DWORD GAMEPAD_TRIGGER_DEADZONE = 30;                      // trigger range 0-255
@@ -77,20 +100,12 @@ struct ControllerState
 class Input
 {
 private:
-    bool keysDown[inputNS::KEYS_ARRAY_LEN];     // true if specified key is down
-    bool keysPressed[inputNS::KEYS_ARRAY_LEN];  // true if specified key was pressed
-    std::string textIn;                         // user entered text
-    char charIn;                                // last character entered
-    bool newLine;                               // true on start of new line
-    int  mouseX, mouseY;                        // mouse screen coordinates
-    int  mouseRawX, mouseRawY;                  // high-definition mouse data
+    InputQueue queue;                           // events posted, not yet processed
+    InputState state;                           // keys, mouse and text from processed events
+#ifdef _WIN32
     RAWINPUTDEVICE Rid[1];                      // for high-definition mouse
+#endif
     bool mouseCaptured;                         // true if mouse captured
-    bool mouseLButton;                          // true if left mouse button down
-    bool mouseMButton;                          // true if middle mouse button down
-    bool mouseRButton;                          // true if right mouse button down
-    bool mouseX1Button;                         // true if X1 mouse button down
-    bool mouseX2Button;                         // true if X2 mouse button down
     ControllerState controllers[MAX_CONTROLLERS];    // state of controllers
 
 public:
@@ -106,93 +121,133 @@ public:
     //      capture = true to capture mouse.
     void initialize(HWND hwnd, bool capture);
 
-    // Save key down state
-    void keyDown(WPARAM);
+    // Post an event, stamped with the current GameClock time. The state
+    // returned by the functions below changes when processEvents() is called.
+    // Called by the message handler, may be called by any one thread.
+    // Returns false if the queue is full and the event was dropped.
+    bool postEvent(inputNS::EVENT_TYPE type, UINT code, int x = 0, int y = 0);
+
+    // Post an event with its own time, to replay recorded input.
+    bool postEvent(const InputEvent &e)    {return queue.push(e);}
 
-    // Save key up state
-    void keyUp(WPARAM);
+    // Remove the posted events without processing them.
+    void discardEvents()    {InputEvent e; while (queue.pop(e)) {}}
 
-    // Save the char just entered in textIn string
-    void keyIn(WPARAM);
+    // Apply the posted events to the key, mouse and text state and add them
+    // to getEvents(). Called by Game::run() at the start of each frame.
+    // Returns the number of events processed.
+    UINT processEvents();
+
+    // Return the events processed since the last clear(EVENTS), oldest
+    // first. Game::run() clears them with the key presses, after a frame
+    // that ran update().
+    const std::vector<InputEvent>& getEvents() const {return state.getEvents();}
+
+    // Return the queue of posted events, for statistics.
+    const InputQueue& getQueue() const {return queue;}
+
+    // Post key down event
+    void keyDown(WPARAM wParam)     {postEvent(inputNS::KEY_DOWN, (UINT)wParam);}
+
+    // Post key up event
+    void keyUp(WPARAM wParam)       {postEvent(inputNS::KEY_UP, (UINT)wParam);}
+
+    // Post the char just entered, added to the textIn string
+    void keyIn(WPARAM wParam)       {postEvent(inputNS::CHAR_IN, (UINT)wParam);}
 
     // Returns true if the specified VIRTUAL KEY is down, otherwise false.
-    bool isKeyDown(UCHAR vkey) const;
+    bool isKeyDown(UCHAR vkey) const        {return state.isKeyDown(vkey);}
 
     // Return true if the specified VIRTUAL KEY has been pressed in the most recent frame.
     // Key presses are erased at the end of each frame.
-    bool wasKeyPressed(UCHAR vkey) const;
+    bool wasKeyPressed(UCHAR vkey) const    {return state.wasKeyPressed(vkey);}
 
     // Return true if any key was pressed in the most recent frame.
     // Key presses are erased at the end of each frame.
-    bool anyKeyPressed() const;
+    bool anyKeyPressed() const              {return state.anyKeyPressed();}
 
     // Clear the specified key press
-    void clearKeyPress(UCHAR vkey);
+    void clearKeyPress(UCHAR vkey)          {state.clearKeyPress(vkey);}
 
     // Clear specified input buffers where what is any combination of
-    // KEYS_DOWN, KEYS_PRESSED, MOUSE, TEXT_IN or KEYS_MOUSE_TEXT.
+    // KEYS_DOWN, KEYS_PRESSED, MOUSE, TEXT_IN, EVENTS or KEYS_MOUSE_TEXT.
     // Use OR '|' operator to combine parmeters.
-    void clear(UCHAR what);
+    void clear(UCHAR what)                  {state.clear(what);}
 
     // Clears key, mouse and text input data
     void clearAll() {clear(inputNS::KEYS_MOUSE_TEXT);}
 
     // Clear text input buffer
-    void clearTextIn() {textIn.clear();}
+    void clearTextIn() {state.clearTextIn();}
 
     // Return text input as a string
-    std::string getTextIn() {return textIn;}
+    std::string getTextIn() {return state.getTextIn();}
 
     // Return last character entered
-    char getCharIn()        {return charIn;}
+    char getCharIn()        {return state.getCharIn();}
 
-    // Reads mouse screen position into mouseX, mouseY
-    void mouseIn(LPARAM);
+#ifdef _WIN32
+    // Post mouse screen position
+    void mouseIn(LPARAM lParam)
+    {
+        postEvent(inputNS::MOUSE_MOVE, 0, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
+    }
 
-    // Reads raw mouse data into mouseRawX, mouseRawY
+    // Reads raw mouse data and posts it
     // This routine is compatible with a high-definition mouse
     void mouseRawIn(LPARAM);
 
-    // Save state of mouse button
-    void setMouseLButton(bool b) { mouseLButton = b; }
+#endif
+
+    // Post state of mouse button
+    void setMouseLButton(bool b) {setMouseButton(inputNS::LEFT_BUTTON, b);}
+
+    // Post state of mouse button
+    void setMouseMButton(bool b) {setMouseButton(inputNS::MIDDLE_BUTTON, b);}
 
-    // Save state of mouse button
-    void setMouseMButton(bool b) { mouseMButton = b; }
+    // Post state of mouse button
+    void setMouseRButton(bool b) {setMouseButton(inputNS::RIGHT_BUTTON, b);}
+
+#ifdef _WIN32
+    // Post state of mouse button
+    void setMouseXButton(WPARAM wParam) {setMouseButton(inputNS::X1_BUTTON, (wParam & MK_XBUTTON1) != 0);
+                                         setMouseButton(inputNS::X2_BUTTON, (wParam & MK_XBUTTON2) != 0);}
+#endif
 
-    // Save state of mouse button
-    void setMouseRButton(bool b) { mouseRButton = b; }
+    // Post state of mouse button b
+    void setMouseButton(inputNS::MOUSE_BUTTON b, bool down)
+    {
+        postEvent(down ? inputNS::MOUSE_BUTTON_DOWN : inputNS::MOUSE_BUTTON_UP, b);
+    }
 
-    // Save state of mouse button
-    void setMouseXButton(WPARAM wParam) {mouseX1Button = (wParam & MK_XBUTTON1) ? true:false;
-                                         mouseX2Button = (wParam & MK_XBUTTON2) ? true:false;}
     // Return mouse X position
-    int  getMouseX()        const { return mouseX; }
+    int  getMouseX()        const { return state.getMouseX(); }
 
     // Return mouse Y position
-    int  getMouseY()        const { return mouseY; }
+    int  getMouseY()        const { return state.getMouseY(); }
 
     // Return raw mouse X movement. Left is <0, Right is >0
     // Compatible with high-definition mouse.
-    int  getMouseRawX()     const { return mouseRawX; }
+    int  getMouseRawX()     const { return state.getMouseRawX(); }
 
     // Return raw mouse Y movement. Up is <0, Down is >0
     // Compatible with high-definition mouse.
-    int  getMouseRawY()     const { return mouseRawY; }
+    int  getMouseRawY()     const { return state.getMouseRawY(); }
 
     // Return state of left mouse button.
-    bool getMouseLButton()  const { return mouseLButton; }
+    bool getMouseLButton()  const { return state.getMouseButton(inputNS::LEFT_BUTTON); }
 
     // Return state of middle mouse button.
-    bool getMouseMButton()  const { return mouseMButton; }
+    bool getMouseMButton()  const { return state.getMouseButton(inputNS::MIDDLE_BUTTON); }
 
     // Return state of right mouse button.
-    bool getMouseRButton()  const { return mouseRButton; }
+    bool getMouseRButton()  const { return state.getMouseButton(inputNS::RIGHT_BUTTON); }
 
     // Return state of X1 mouse button.
-    bool getMouseX1Button() const { return mouseX1Button; }
+    bool getMouseX1Button() const { return state.getMouseButton(inputNS::X1_BUTTON); }
 
     // Return state of X2 mouse button.
-    bool getMouseX2Button() const { return mouseX2Button; }
+    bool getMouseX2Button() const { return state.getMouseButton(inputNS::X2_BUTTON); }
 
     // Update connection status of game controllers.
     void checkControllers();
@@ -200,6 +255,15 @@ public:
     // Save input from connected game controllers.
     void readControllers();
 
+    // Copy the state of the controllers to c, for recording.
+    // Pre: c has room for MAX_CONTROLLERS controller states
+    void getControllerInput(ControllerInput *c) const;
+
+    // Set the state of the controllers from c, for replaying a recording.
+    // The state returned below is then c until the next readControllers().
+    // Pre: c holds MAX_CONTROLLERS controller states
+    void setControllerInput(const ControllerInput *c);
+
     // Return state of specified game controller.
     const ControllerState* getControllerState(UINT n)
     {
@@ -209,7 +273,7 @@ public:
     }
 
     // Return state of controller n buttons.
-    const WORD getGamepadButtons(UINT n)
+    WORD getGamepadButtons(UINT n)
     {
         if(n > MAX_CONTROLLERS-1)
             n=MAX_CONTROLLERS-1;
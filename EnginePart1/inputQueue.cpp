@@ -0,0 +1,160 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// inputQueue.cpp v1.0
+// Input event ring buffer and input state, see inputQueue.h
+
+#include "inputQueue.h"
+
+//=============================================================================
+// Constructor
+//=============================================================================
+InputQueue::InputQueue(UINT size) : head(0), tail(0), dropped(0)
+{
+    UINT n = 2;
+    while (n < size)
+        n *= 2;
+    events.resize(n);
+    mask = n - 1;
+}
+
+//=============================================================================
+// Add an event
+// The event is written before head is moved past it, so the reader never
+// sees a slot that is still being written.
+// Returns false if the queue is full
+//=============================================================================
+bool InputQueue::push(const InputEvent &e)
+{
+    UINT h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) > mask)    // full
+    {
+        dropped++;
+        return false;
+    }
+    events[h & mask] = e;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+//=============================================================================
+// Remove the oldest event
+// Returns false if the queue is empty
+//=============================================================================
+bool InputQueue::pop(InputEvent &e)
+{
+    UINT t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire))          // empty
+        return false;
+    e = events[t & mask];
+    tail.store(t + 1, std::memory_order_release);           // the slot may be written again
+    return true;
+}
+
+//=============================================================================
+// Constructor
+//=============================================================================
+InputState::InputState()
+{
+    newLine = true;                     // start new line
+    charIn = 0;
+    clear(inputNS::KEYS_MOUSE_TEXT);
+    for (int i = 0; i < 5; i++)
+        mouseButtons[i] = false;
+}
+
+//=============================================================================
+// Change the state by event e
+// Keys and text change the same way Input::keyDown(), keyUp() and keyIn()
+// changed them when they were called from the message handler.
+//=============================================================================
+void InputState::apply(const InputEvent &e)
+{
+    events.push_back(e);
+    switch (e.type)
+    {
+    case inputNS::KEY_DOWN:
+        if (e.code < inputNS::KEYS_ARRAY_LEN)
+        {
+            keysDown[e.code] = true;
+            keysPressed[e.code] = true;     // erased by clear()
+        }
+        break;
+    case inputNS::KEY_UP:
+        if (e.code < inputNS::KEYS_ARRAY_LEN)
+            keysDown[e.code] = false;
+        break;
+    case inputNS::CHAR_IN:
+        if (newLine)                        // if start of new line
+        {
+            textIn.clear();
+            newLine = false;
+        }
+        if (e.code == '\b')                 // if backspace
+        {
+            if (textIn.length() > 0)        // if characters exist
+                textIn.erase(textIn.size()-1);
+        }
+        else
+        {
+            textIn += (char)e.code;         // add character to textIn
+            charIn = (char)e.code;          // save last char entered
+        }
+        if ((char)e.code == '\r')           // if return
+            newLine = true;                 // start new line
+        break;
+    case inputNS::MOUSE_MOVE:
+        mouseX = e.x;
+        mouseY = e.y;
+        break;
+    case inputNS::MOUSE_RAW:
+        mouseRawX = e.x;
+        mouseRawY = e.y;
+        break;
+    case inputNS::MOUSE_BUTTON_DOWN:
+    case inputNS::MOUSE_BUTTON_UP:
+        if (e.code <= inputNS::X2_BUTTON)
+            mouseButtons[e.code] = (e.type == inputNS::MOUSE_BUTTON_DOWN);
+        break;
+    }
+}
+
+//=============================================================================
+// Clear specified state
+// See inputQueue.h for what values
+//=============================================================================
+void InputState::clear(UCHAR what)
+{
+    if (what & inputNS::KEYS_DOWN)      // if clear keys down
+    {
+        for (size_t i = 0; i < inputNS::KEYS_ARRAY_LEN; i++)
+            keysDown[i] = false;
+    }
+    if (what & inputNS::KEYS_PRESSED)   // if clear keys pressed
+    {
+        for (size_t i = 0; i < inputNS::KEYS_ARRAY_LEN; i++)
+            keysPressed[i] = false;
+    }
+    if (what & inputNS::MOUSE)          // if clear mouse
+    {
+        mouseX = 0;
+        mouseY = 0;
+        mouseRawX = 0;
+        mouseRawY = 0;
+    }
+    if (what & inputNS::TEXT_IN)
+        clearTextIn();
+    if (what & inputNS::EVENTS)
+        events.clear();                 // keeps its memory
+}
+
+//=============================================================================
+// Return true if any key was pressed
+//=============================================================================
+bool InputState::anyKeyPressed() const
+{
+    for (size_t i = 0; i < inputNS::KEYS_ARRAY_LEN; i++)
+        if (keysPressed[i])
+            return true;
+    return false;
+}
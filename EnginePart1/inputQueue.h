@@ -0,0 +1,161 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// inputQueue.h v1.0
+// Timestamped input events and the state derived from them.
+// Input posts an InputEvent for every key, character and mouse message
+// into an InputQueue, a fixed size ring buffer one thread writes and one
+// thread reads without a lock. Once a frame Game::run() moves the events
+// to an InputState, which keeps the key, mouse and text state Input
+// returns, and the list of the events of the frame. Every key change and
+// raw mouse packet is in that list even when several arrive in one frame,
+// with the GameClock time it was posted at.
+// Nothing here depends on Windows, so the queue and state can be driven by
+// hand or by a recording, see Input::postEvent().
+
+#ifndef _INPUTQUEUE_H           // Prevent multiple definitions if this
+#define _INPUTQUEUE_H           // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "platform.h"
+
+namespace inputNS
+{
+    const int KEYS_ARRAY_LEN = 256;     // size of key arrays
+
+    // what values for clear(), bit flag
+    const UCHAR KEYS_DOWN = 1;
+    const UCHAR KEYS_PRESSED = 2;
+    const UCHAR MOUSE = 4;
+    const UCHAR TEXT_IN = 8;
+    const UCHAR EVENTS = 16;
+    const UCHAR KEYS_MOUSE_TEXT = KEYS_DOWN + KEYS_PRESSED + MOUSE + TEXT_IN;
+
+    const UINT QUEUE_SIZE = 4096;       // events posted and not yet processed, power of 2
+
+    // InputEvent types
+    enum EVENT_TYPE
+    {
+        KEY_DOWN,           // code = virtual key
+        KEY_UP,             // code = virtual key
+        CHAR_IN,            // code = character
+        MOUSE_MOVE,         // x,y = screen position
+        MOUSE_RAW,          // x,y = movement of a high-definition mouse
+        MOUSE_BUTTON_DOWN,  // code = MOUSE_BUTTON
+        MOUSE_BUTTON_UP     // code = MOUSE_BUTTON
+    };
+
+    enum MOUSE_BUTTON {LEFT_BUTTON, MIDDLE_BUTTON, RIGHT_BUTTON, X1_BUTTON, X2_BUTTON};
+}
+
+// A key, character or mouse message.
+struct InputEvent
+{
+    LONGLONG time;          // GameClock::ticks() when posted
+    UINT    type;           // inputNS::EVENT_TYPE
+    UINT    code;           // virtual key, character or mouse button
+    int     x;              // mouse position or movement
+    int     y;
+};
+
+// Ring buffer of events, written by one thread and read by one thread.
+class InputQueue
+{
+  private:
+    std::vector<InputEvent> events;
+    UINT    mask;                   // events.size()-1
+    std::atomic<UINT> head;         // events written, changed by the writer only
+    char    pad[64];                // keep head and tail in different cache lines
+    std::atomic<UINT> tail;         // events read, changed by the reader only
+    std::atomic<UINT> dropped;      // events not written because the queue was full
+
+  public:
+    // Constructor
+    // size = most events waiting, rounded up to a power of 2
+    InputQueue(UINT size = inputNS::QUEUE_SIZE);
+
+    // Add an event. Called by the writing thread only.
+    // Returns false, and counts the event dropped, if the queue is full.
+    bool    push(const InputEvent &e);
+
+    // Remove the oldest event. Called by the reading thread only.
+    // Returns false if the queue is empty.
+    bool    pop(InputEvent &e);
+
+    // Return number of events waiting. Exact only on the writing or
+    // reading thread while the other is idle.
+    UINT    getCount() const        {return head.load() - tail.load();}
+
+    // Return most events that can wait.
+    UINT    getSize() const         {return mask + 1;}
+
+    // Return number of events dropped because the queue was full.
+    UINT    getDropped() const      {return dropped.load();}
+};
+
+// Key, mouse and text state made from events.
+class InputState
+{
+  private:
+    bool keysDown[inputNS::KEYS_ARRAY_LEN];     // true if specified key is down
+    bool keysPressed[inputNS::KEYS_ARRAY_LEN];  // true if specified key was pressed
+    std::string textIn;                         // user entered text
+    char charIn;                                // last character entered
+    bool newLine;                               // true on start of new line
+    int  mouseX, mouseY;                        // mouse screen coordinates
+    int  mouseRawX, mouseRawY;                  // last high-definition mouse movement
+    bool mouseButtons[5];                       // true if button down, by MOUSE_BUTTON
+    std::vector<InputEvent> events;             // events applied since clear(EVENTS)
+
+  public:
+    // Constructor
+    InputState();
+
+    // Change the state by event e and add it to getEvents().
+    void apply(const InputEvent &e);
+
+    // Clear specified state where what is any combination of KEYS_DOWN,
+    // KEYS_PRESSED, MOUSE, TEXT_IN, EVENTS or KEYS_MOUSE_TEXT.
+    void clear(UCHAR what);
+
+    // Return events applied since the last clear(EVENTS), oldest first.
+    const std::vector<InputEvent>& getEvents() const {return events;}
+
+    // Returns true if the specified virtual key is down.
+    bool isKeyDown(UCHAR vkey) const            {return keysDown[vkey];}
+
+    // Return true if the specified virtual key was pressed since the last
+    // clear(KEYS_PRESSED).
+    bool wasKeyPressed(UCHAR vkey) const        {return keysPressed[vkey];}
+
+    // Return true if any key was pressed since the last clear(KEYS_PRESSED).
+    bool anyKeyPressed() const;
+
+    // Clear the specified key press
+    void clearKeyPress(UCHAR vkey)              {keysPressed[vkey] = false;}
+
+    // Clear text input buffer
+    void clearTextIn()                          {textIn.clear();}
+
+    // Return text input as a string
+    const std::string& getTextIn() const        {return textIn;}
+
+    // Return last character entered
+    char getCharIn() const                      {return charIn;}
+
+    // Return mouse screen position.
+    int  getMouseX() const                      {return mouseX;}
+    int  getMouseY() const                      {return mouseY;}
+
+    // Return last raw mouse movement.
+    int  getMouseRawX() const                   {return mouseRawX;}
+    int  getMouseRawY() const                   {return mouseRawY;}
+
+    // Return true if mouse button b is down.
+    bool getMouseButton(inputNS::MOUSE_BUTTON b) const {return mouseButtons[b];}
+};
+
+#endif
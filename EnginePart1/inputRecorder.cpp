@@ -0,0 +1,316 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// inputRecorder.cpp v1.0
+// Input and frameTime log, see inputRecorder.h
+
+#include "inputRecorder.h"
+#include "gameClock.h"
+#include <stdio.h>
+#include <string.h>
+
+namespace inputRecorderNS
+{
+    const BYTE MAGIC[4] = {'P', '2', 'D', 'I'};
+}
+
+//=============================================================================
+// Return v with the sign in the low bit, so small negative numbers are
+// small varints, and back
+//=============================================================================
+static inline UINT zigzag(int v)
+{
+    return ((UINT)v << 1) ^ (UINT)(v >> 31);
+}
+
+static inline int unzigzag(UINT v)
+{
+    return (int)(v >> 1) ^ -(int)(v & 1);
+}
+
+//=============================================================================
+// Return true if two controller states are the same
+//=============================================================================
+static bool sameController(const ControllerInput &a, const ControllerInput &b)
+{
+    return a.connected == b.connected && a.packet == b.packet && a.buttons == b.buttons &&
+           a.leftTrigger == b.leftTrigger && a.rightTrigger == b.rightTrigger &&
+           a.thumbLX == b.thumbLX && a.thumbLY == b.thumbLY &&
+           a.thumbRX == b.thumbRX && a.thumbRY == b.thumbRY;
+}
+
+//=============================================================================
+// Constructor
+//=============================================================================
+InputRecorder::InputRecorder()
+{
+    readPos = 0;
+    frames = 0;
+    frame = 0;
+    version = inputRecorderNS::VERSION;
+    recording = false;
+    replaying = false;
+    clearControllers();
+}
+
+//=============================================================================
+// Start the controllers of a log not connected
+//=============================================================================
+void InputRecorder::clearControllers()
+{
+    memset(controllers, 0, sizeof(controllers));
+}
+
+//=============================================================================
+// Append v as a varint
+//=============================================================================
+void InputRecorder::putVarint(UINT v)
+{
+    while (v >= 0x80)
+    {
+        log.push_back((BYTE)(v | 0x80));
+        v >>= 7;
+    }
+    log.push_back((BYTE)v);
+}
+
+//=============================================================================
+// Read a varint
+// Returns false at the end of the log
+//=============================================================================
+bool InputRecorder::getVarint(UINT &v)
+{
+    v = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (readPos >= log.size())
+            return false;
+        BYTE b = log[readPos++];
+        v |= (UINT)(b & 0x7f) << shift;
+        if ((b & 0x80) == 0)
+            return true;
+    }
+    return false;                       // more than 5 bytes, not a log
+}
+
+//=============================================================================
+// Clear the log and start recording
+//=============================================================================
+void InputRecorder::startRecording()
+{
+    replaying = false;
+    log.assign(inputRecorderNS::MAGIC, inputRecorderNS::MAGIC + 4);
+    log.push_back(inputRecorderNS::VERSION);
+    version = inputRecorderNS::VERSION;
+    frames = 0;
+    frame = 0;
+    clearControllers();
+    recording = true;
+}
+
+//=============================================================================
+// Add a frame to the log
+//=============================================================================
+void InputRecorder::recordFrame(float frameTime, const InputEvent *events, UINT count,
+                                const ControllerInput *controllerInput, LONGLONG now)
+{
+    if (!recording)
+        return;
+    UINT bits;
+    memcpy(&bits, &frameTime, 4);       // exact, so a replay has the same frameTime
+    for (int i = 0; i < 4; i++)
+        log.push_back((BYTE)(bits >> (8*i)));
+    putVarint(count);
+    LONGLONG frequency = GameClock::frequency();
+    for (UINT n = 0; n < count; n++)
+    {
+        const InputEvent &e = events[n];
+        log.push_back((BYTE)e.type);
+        putVarint(e.code);
+        putVarint(zigzag(e.x));
+        putVarint(zigzag(e.y));
+        LONGLONG age = now > e.time ? (now - e.time) * 1000000 / frequency : 0;
+        putVarint(age < 0xffffffff ? (UINT)age : 0xffffffff);
+    }
+
+    // the controllers that changed since the last frame
+    ControllerInput none[inputRecorderNS::CONTROLLERS];
+    if (controllerInput == NULL)
+    {
+        memset(none, 0, sizeof(none));
+        controllerInput = none;
+    }
+    size_t changedPos = log.size();
+    log.push_back(0);
+    for (UINT n = 0; n < inputRecorderNS::CONTROLLERS; n++)
+    {
+        const ControllerInput &c = controllerInput[n];
+        if (sameController(c, controllers[n]))
+            continue;
+        log[changedPos] |= (BYTE)(1 << n);
+        log.push_back(c.connected ? 1 : 0);
+        putVarint(c.packet);
+        putVarint(c.buttons);
+        log.push_back(c.leftTrigger);
+        log.push_back(c.rightTrigger);
+        putVarint(zigzag(c.thumbLX));
+        putVarint(zigzag(c.thumbLY));
+        putVarint(zigzag(c.thumbRX));
+        putVarint(zigzag(c.thumbRY));
+        controllers[n] = c;
+    }
+    frames++;
+}
+
+//=============================================================================
+// Write the log to file
+// Returns false on error
+//=============================================================================
+bool InputRecorder::save(const char *file) const
+{
+    if (file == NULL || log.empty())
+        return false;
+    FILE *f = fopen(file, "wb");
+    if (f == NULL)
+        return false;
+    bool ok = fwrite(&log[0], 1, log.size(), f) == log.size();
+    if (fclose(f) != 0)
+        ok = false;
+    return ok;
+}
+
+//=============================================================================
+// Read the frame at readPos
+// Returns false if the log ends inside the frame
+//=============================================================================
+bool InputRecorder::readFrame(float &frameTime, std::vector<InputEvent> &events, LONGLONG now)
+{
+    if (readPos + 4 > log.size())
+        return false;
+    UINT bits = 0;
+    for (int i = 0; i < 4; i++)
+        bits |= (UINT)log[readPos++] << (8*i);
+    memcpy(&frameTime, &bits, 4);
+    UINT count;
+    if (!getVarint(count))
+        return false;
+    events.clear();
+    LONGLONG frequency = GameClock::frequency();
+    for (UINT n = 0; n < count; n++)
+    {
+        InputEvent e;
+        UINT x, y, age;
+        if (readPos >= log.size())
+            return false;
+        e.type = log[readPos++];
+        if (!getVarint(e.code) || !getVarint(x) || !getVarint(y) || !getVarint(age))
+            return false;
+        e.x = unzigzag(x);
+        e.y = unzigzag(y);
+        e.time = now - (LONGLONG)age * frequency / 1000000;
+        events.push_back(e);
+    }
+    if (version < 2)                    // no controllers
+        return true;
+    if (readPos >= log.size())
+        return false;
+    BYTE changed = log[readPos++];
+    for (UINT n = 0; n < inputRecorderNS::CONTROLLERS; n++)
+    {
+        if ((changed & (1 << n)) == 0)
+            continue;
+        ControllerInput &c = controllers[n];
+        UINT packet, buttons, thumbs[4];
+        if (readPos >= log.size())
+            return false;
+        c.connected = log[readPos++] != 0;
+        if (!getVarint(packet) || !getVarint(buttons) || readPos + 2 > log.size())
+            return false;
+        c.leftTrigger = log[readPos++];
+        c.rightTrigger = log[readPos++];
+        for (int i = 0; i < 4; i++)
+            if (!getVarint(thumbs[i]))
+                return false;
+        c.packet = packet;
+        c.buttons = (WORD)buttons;
+        c.thumbLX = (SHORT)unzigzag(thumbs[0]);
+        c.thumbLY = (SHORT)unzigzag(thumbs[1]);
+        c.thumbRX = (SHORT)unzigzag(thumbs[2]);
+        c.thumbRY = (SHORT)unzigzag(thumbs[3]);
+    }
+    return true;
+}
+
+//=============================================================================
+// Read a log from file and start replaying it
+// Every frame is read once to count them and to reject a damaged file.
+// Returns false if the file can not be read or is not a log
+//=============================================================================
+bool InputRecorder::load(const char *file)
+{
+    recording = false;
+    replaying = false;
+    frames = 0;
+    log.clear();
+    if (file == NULL)
+        return false;
+    FILE *f = fopen(file, "rb");
+    if (f == NULL)
+        return false;
+    BYTE buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+        log.insert(log.end(), buffer, buffer + n);
+    fclose(f);
+    if (log.size() < inputRecorderNS::HEADER_SIZE ||
+        memcmp(&log[0], inputRecorderNS::MAGIC, 4) != 0 ||
+        log[4] == 0 || log[4] > inputRecorderNS::VERSION)
+    {
+        log.clear();
+        return false;
+    }
+    version = log[4];
+    float frameTime;
+    std::vector<InputEvent> events;
+    clearControllers();
+    for (readPos = inputRecorderNS::HEADER_SIZE; readPos < log.size(); frames++)
+    {
+        if (!readFrame(frameTime, events, 0))
+        {
+            log.clear();
+            frames = 0;
+            return false;
+        }
+    }
+    startReplay();
+    return true;
+}
+
+//=============================================================================
+// Replay the log from the first frame
+//=============================================================================
+void InputRecorder::startReplay()
+{
+    recording = false;
+    readPos = inputRecorderNS::HEADER_SIZE;
+    frame = 0;
+    clearControllers();
+    replaying = log.size() >= inputRecorderNS::HEADER_SIZE;
+}
+
+//=============================================================================
+// Return the next frame of the log
+// Returns false, and stops replaying, at the end of the log
+//=============================================================================
+bool InputRecorder::replayFrame(float &frameTime, std::vector<InputEvent> &events,
+                                ControllerInput *controllerInput, LONGLONG now)
+{
+    if (!replaying || frame >= frames || !readFrame(frameTime, events, now))
+    {
+        replaying = false;
+        return false;
+    }
+    memcpy(controllerInput, controllers, sizeof(controllers));
+    frame++;
+    return true;
+}
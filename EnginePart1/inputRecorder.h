@@ -0,0 +1,137 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// inputRecorder.h v1.0
+// An InputRecorder saves the frameTime, input events and game controller
+// state of each frame to a compact binary log, and plays the log back.
+// Replayed through Game::run() the game sees the same frameTime and the
+// same key, mouse, text and controller state every frame, with no window
+// and without waiting for the frame rate, for repeatable benchmark runs and
+// for comparing the timing of two builds of the engine on the same input.
+// Log format, little endian:
+//   "P2DI", version byte, then for each frame:
+//   frameTime        4 byte float, the bits as recorded
+//   event count      varint
+//   for each event:  type byte, code varint, x and y zigzag varint,
+//                    microseconds from posting to processing varint
+//   changed          byte, bit n set if controller n changed since the
+//                    last frame (version 2 and later)
+//   for each changed controller: connected byte, packet and buttons
+//                    varint, left and right trigger bytes, the 4 thumb
+//                    stick values zigzag varint
+// A varint is 7 bits per byte, low bits first, high bit set if more follow.
+// Version 1 logs, without controllers, are replayed with none connected.
+// Usage:
+//   game->startRecording();  ...  game->stopRecording("run.inp");
+//   game->startReplay("run.inp");
+//   while (game->getReplaying()) game->run(NULL);
+
+#ifndef _INPUTRECORDER_H        // Prevent multiple definitions if this
+#define _INPUTRECORDER_H        // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+#include "inputQueue.h"
+
+namespace inputRecorderNS
+{
+    const BYTE VERSION = 2;         // log format version
+    const UINT HEADER_SIZE = 5;     // magic and version
+    const UINT CONTROLLERS = 4;     // game controllers recorded, MAX_CONTROLLERS of input.h
+}
+
+// State of a game controller in a frame, the XInput gamepad state without
+// any Windows types.
+struct ControllerInput
+{
+    bool    connected;
+    DWORD   packet;                 // XINPUT_STATE dwPacketNumber
+    WORD    buttons;                // GAMEPAD_ bits of input.h
+    BYTE    leftTrigger;
+    BYTE    rightTrigger;
+    SHORT   thumbLX;
+    SHORT   thumbLY;
+    SHORT   thumbRX;
+    SHORT   thumbRY;
+};
+
+class InputRecorder
+{
+  private:
+    std::vector<BYTE> log;          // the whole log, header first
+    size_t  readPos;                // next byte to replay
+    UINT    frames;                 // frames in the log
+    UINT    frame;                  // next frame to replay
+    BYTE    version;                // of the log being replayed
+    ControllerInput controllers[inputRecorderNS::CONTROLLERS]; // of the last frame written or read
+    bool    recording;
+    bool    replaying;
+
+    // Append v as a varint.
+    void    putVarint(UINT v);
+
+    // Read a varint. Returns false at the end of the log.
+    bool    getVarint(UINT &v);
+
+    // Read the frame at readPos into frameTime, events and controllers.
+    // Returns false if the log ends inside the frame.
+    bool    readFrame(float &frameTime, std::vector<InputEvent> &events, LONGLONG now);
+
+    // Start the controllers of a log not connected.
+    void    clearControllers();
+
+  public:
+    // Constructor
+    InputRecorder();
+
+    // Clear the log and start recording.
+    void    startRecording();
+
+    // Stop recording, the log is kept until the next start.
+    void    stopRecording()         {recording = false;}
+
+    // Add a frame to the log.
+    // events = count events processed in the frame, now = GameClock::ticks()
+    // when they were processed
+    // controllerInput = CONTROLLERS controller states seen by the frame, NULL
+    // for none connected
+    void    recordFrame(float frameTime, const InputEvent *events, UINT count,
+                        const ControllerInput *controllerInput, LONGLONG now);
+
+    // Write the log to file. Returns false on error.
+    bool    save(const char *file) const;
+
+    // Read a log from file and start replaying it.
+    // Returns false if the file can not be read or is not a log.
+    bool    load(const char *file);
+
+    // Replay the log from the first frame.
+    void    startReplay();
+
+    // Stop replaying.
+    void    stopReplay()            {replaying = false;}
+
+    // Return the next frame of the log. Event times are set to now minus
+    // the recorded time from posting to processing.
+    // Pre: controllerInput has room for CONTROLLERS controller states
+    // Returns false, and stops replaying, at the end of the log.
+    bool    replayFrame(float &frameTime, std::vector<InputEvent> &events,
+                        ControllerInput *controllerInput, LONGLONG now);
+
+    // Return true while recording.
+    bool    getRecording() const    {return recording;}
+
+    // Return true while replaying.
+    bool    getReplaying() const    {return replaying;}
+
+    // Return number of frames in the log.
+    UINT    getFrameCount() const   {return frames;}
+
+    // Return number of the next frame to replay.
+    UINT    getFrame() const        {return frame;}
+
+    // Return the log bytes.
+    const std::vector<BYTE>& getLog() const {return log;}
+};
+
+#endif
@@ -0,0 +1,288 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// jobSystem.cpp v1.0
+// Work stealing job scheduler, see jobSystem.h
+
+#include "jobSystem.h"
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+// The JobSystem and queue of the calling thread, set in each worker
+static THREAD_LOCAL const JobSystem *threadSystem = NULL;
+static THREAD_LOCAL UINT threadQueue = 0;
+
+//=============================================================================
+// Constructor
+//=============================================================================
+JobSystem::JobSystem() : queued(0), sleeping(0), executed(0), steals(0)
+{
+    stopping = false;
+}
+
+//=============================================================================
+// Destructor
+//=============================================================================
+JobSystem::~JobSystem()
+{
+    stop();
+}
+
+//=============================================================================
+// Start the worker threads
+// Returns false if already started
+//=============================================================================
+bool JobSystem::initialize(UINT count)
+{
+    if (!queues.empty())
+        return false;
+    if (count == 0)
+    {
+        UINT cores = std::thread::hardware_concurrency();
+        count = cores > 1 ? cores - 1 : 0;
+    }
+    stopping = false;
+    for (UINT q = 0; q <= count; q++)
+    {
+        Queue *queue = new Queue;
+        queue->jobs.resize(jobSystemNS::QUEUE_SIZE);
+        queue->front = 0;
+        queue->count = 0;
+        queues.push_back(queue);
+    }
+    for (UINT q = 1; q <= count; q++)
+    {
+        try{
+            workers.push_back(std::thread(&JobSystem::workerMain, this, q));
+        }
+        catch(...) {break;}     // run with the workers created so far
+    }
+    return true;
+}
+
+//=============================================================================
+// Stop the worker threads
+// The workers finish the jobs in the queues first.
+//=============================================================================
+void JobSystem::stop()
+{
+    if (queues.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+    workers.clear();
+    Job job;
+    while (take(0, job))        // jobs of queues without a worker
+        execute(job);
+    for (size_t q = 0; q < queues.size(); q++)
+        delete queues[q];
+    queues.clear();
+}
+
+//=============================================================================
+// Return the queue of the calling thread
+//=============================================================================
+UINT JobSystem::getQueue() const
+{
+    return threadSystem == this ? threadQueue : 0;
+}
+
+//=============================================================================
+// Add a job to queue q
+//=============================================================================
+void JobSystem::push(UINT q, const Job &job)
+{
+    Queue *queue = queues[q];
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        UINT size = (UINT)queue->jobs.size();
+        if (queue->count == size)           // full, double the size
+        {
+            std::vector<Job> jobs(size * 2);
+            for (UINT i = 0; i < size; i++)
+                jobs[i] = queue->jobs[(queue->front + i) % size];
+            queue->jobs.swap(jobs);
+            queue->front = 0;
+            size *= 2;
+        }
+        queue->jobs[(queue->front + queue->count) % size] = job;
+        queue->count++;
+    }
+    queued++;
+    if (sleeping.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        workReady.notify_one();
+    }
+}
+
+//=============================================================================
+// Take a job
+// The newest job of queue q is taken first, its data is most likely still
+// in the cache. Otherwise the oldest job of another queue is stolen.
+// Returns false if every queue is empty
+//=============================================================================
+bool JobSystem::take(UINT q, Job &job)
+{
+    if (queued.load() == 0)
+        return false;
+    UINT n = (UINT)queues.size();
+    for (UINT k = 0; k < n; k++)
+    {
+        Queue *queue = queues[(q + k) % n];
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (queue->count == 0)
+            continue;
+        UINT size = (UINT)queue->jobs.size();
+        if (k == 0)                         // own queue, newest job
+            job = queue->jobs[(queue->front + queue->count - 1) % size];
+        else                                // steal the oldest job
+        {
+            job = queue->jobs[queue->front];
+            queue->front = (queue->front + 1) % size;
+            steals++;
+        }
+        queue->count--;
+        queued--;
+        return true;
+    }
+    return false;
+}
+
+//=============================================================================
+// Run a job and count it done
+// When the counter reaches 0 the jobs waiting for it are started. They are
+// taken from the counter under its mutex and started after it is released,
+// because before initialize() they run here and may add jobs to the same
+// counter. finishing stays above 0 until the counter is no longer used, so
+// wait() does not return while another thread may still touch the counter.
+//=============================================================================
+void JobSystem::execute(const Job &job)
+{
+    job.function(job.data, job.begin, job.end);
+    executed++;
+    JobCounter *counter = job.counter;
+    if (counter == NULL)
+        return;
+    counter->finishing++;
+    std::vector<Job> ready;
+    if (--counter->pending == 0)
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex);
+        ready.swap(counter->waiting);
+    }
+    counter->finishing--;
+    for (size_t i = 0; i < ready.size(); i++)
+        schedule(ready[i]);
+}
+
+//=============================================================================
+// Add a job whose dependency is done
+//=============================================================================
+void JobSystem::schedule(const Job &job)
+{
+    if (queues.empty())                     // not started, run it now
+        execute(job);
+    else
+        push(getQueue(), job);
+}
+
+//=============================================================================
+// Add a job
+//=============================================================================
+void JobSystem::add(JobFunction f, void *data, UINT begin, UINT end, JobCounter *counter,
+                    JobCounter *after)
+{
+    Job job = {f, data, begin, end, counter};
+    if (counter)
+        counter->pending++;
+    if (after && !after->done())
+    {
+        std::lock_guard<std::mutex> lock(after->mutex);
+        if (!after->done())                 // started when after is done
+        {
+            after->waiting.push_back(job);
+            return;
+        }
+    }
+    schedule(job);
+}
+
+//=============================================================================
+// Split elements 0 to count-1 into jobs of grain elements
+//=============================================================================
+void JobSystem::parallelFor(UINT count, UINT grain, JobFunction f, void *data,
+                            JobCounter *counter, JobCounter *after)
+{
+    if (grain == 0)
+        grain = 1;
+    for (UINT begin = 0; begin < count; begin += grain)
+    {
+        UINT end = count - begin > grain ? begin + grain : count;
+        add(f, data, begin, end, counter, after);
+    }
+}
+
+//=============================================================================
+// Run jobs until every job of counter is done
+// The jobs run may be of any counter, the calling thread helps the workers
+// instead of blocking.
+//=============================================================================
+void JobSystem::wait(JobCounter *counter)
+{
+    if (counter == NULL)
+        return;
+    UINT q = getQueue();
+    Job job;
+    while (!counter->done())
+    {
+        if (!queues.empty() && take(q, job))
+            execute(job);
+        else
+            std::this_thread::yield();      // the last jobs are running on workers
+    }
+    while (counter->finishing.load() > 0)
+        std::this_thread::yield();
+}
+
+//=============================================================================
+// Worker thread loop
+// A worker looks for a job SPIN times before it sleeps until a job is added.
+//=============================================================================
+void JobSystem::workerMain(UINT q)
+{
+    threadSystem = this;
+    threadQueue = q;
+    Job job;
+    for (;;)
+    {
+        bool found = false;
+        for (UINT i = 0; i < jobSystemNS::SPIN && !found; i++)
+        {
+            found = take(q, job);
+            if (!found)
+                std::this_thread::yield();
+        }
+        if (found)
+        {
+            execute(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (stopping && queued.load() == 0)
+            return;
+        sleeping++;
+        while (queued.load() == 0 && !stopping)
+            workReady.wait(lock);
+        sleeping--;
+    }
+}
@@ -0,0 +1,174 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// jobSystem.h v1.0
+// A JobSystem runs small jobs on a pool of worker threads so the work of a
+// frame is spread over every core. Each thread has its own queue of jobs:
+// a thread takes the job it added last from its own queue, and when that is
+// empty it steals the oldest job from another queue, so busy threads hand
+// work to idle ones without a shared queue every job goes through.
+// Each queue is a ring buffer guarded by its own mutex, not a lock-free
+// deque: threads only wait for each other when they use the same queue.
+// A JobCounter counts the jobs of a group that have not finished. wait()
+// runs jobs on the calling thread until the counter is 0, and a job may be
+// held back until the jobs of another counter are done.
+// Game owns a JobSystem, see Game::getJobs(). Jobs added to
+// Game::getFrameJobs() during update(), ai() or collisions() finish before
+// the next of those is called, and before renderGame().
+// Usage:
+//   struct Move {void operator()(UINT begin, UINT end) {...}} move;
+//   jobs->parallelFor(count, 256, move, getFrameJobs());
+//   // more jobs, move must stay valid until they are done
+//   jobs->wait(getFrameJobs());            // optional, Game::run() waits
+
+#ifndef _JOBSYSTEM_H            // Prevent multiple definitions if this
+#define _JOBSYSTEM_H            // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "platform.h"
+
+namespace jobSystemNS
+{
+    const UINT QUEUE_SIZE = 1024;       // starting size of each queue, grows when full
+    const UINT SPIN = 64;               // tries to find a job before a worker sleeps
+}
+
+// Work of a job: elements begin to end-1 of data.
+typedef void (*JobFunction)(void *data, UINT begin, UINT end);
+
+class JobCounter;
+
+// A job, run as function(data, begin, end).
+struct Job
+{
+    JobFunction function;
+    void    *data;
+    UINT    begin;
+    UINT    end;
+    JobCounter *counter;        // decremented when the job is done, may be NULL
+};
+
+// Number of jobs of a group that have not finished.
+class JobCounter
+{
+  private:
+    friend class JobSystem;
+    std::atomic<int> pending;
+    std::atomic<int> finishing;     // threads still using the counter after a job
+    std::mutex mutex;               // guards waiting
+    std::vector<Job> waiting;       // jobs to start when pending is 0
+
+  public:
+    // Constructor
+    JobCounter() : pending(0), finishing(0) {}
+
+    // Return true if every job of the counter has finished.
+    bool done() const       {return pending.load() == 0;}
+
+    // Return number of jobs not finished.
+    int getPending() const  {return pending.load();}
+};
+
+class JobSystem
+{
+  private:
+    // Jobs of one thread, a ring buffer. The owner adds and takes at the
+    // back, other threads steal from the front.
+    struct Queue
+    {
+        std::mutex mutex;
+        std::vector<Job> jobs;
+        UINT    front;              // first job
+        UINT    count;              // jobs in the queue
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<Queue*> queues;     // queues[0] is for threads that are not workers
+    std::atomic<UINT> queued;       // jobs in all queues
+    std::atomic<UINT> sleeping;     // workers waiting for work
+    std::atomic<UINT> executed;     // jobs run since the start
+    std::atomic<UINT> steals;       // jobs taken from another queue
+    std::mutex sleepMutex;
+    std::condition_variable workReady;
+    bool    stopping;               // guarded by sleepMutex
+
+    // Return the queue of the calling thread.
+    UINT    getQueue() const;
+
+    // Add a job to queue q.
+    void    push(UINT q, const Job &job);
+
+    // Take a job, from queue q first. Returns false if every queue is empty.
+    bool    take(UINT q, Job &job);
+
+    // Run a job and count it done.
+    void    execute(const Job &job);
+
+    // Add a job whose dependency is done.
+    void    schedule(const Job &job);
+
+    // Worker thread loop.
+    void    workerMain(UINT q);
+
+    // Call f(begin, end) for the parallelFor() template.
+    template <class F>
+    static void callFunctor(void *data, UINT begin, UINT end)
+    {
+        (*(F*)data)(begin, end);
+    }
+
+  public:
+    // Constructor
+    JobSystem();
+
+    // Destructor, stops the workers
+    virtual ~JobSystem();
+
+    // Start count worker threads. 0 starts one less than the number of
+    // cores, the thread calling wait() is the last one.
+    // Returns false if already started.
+    bool    initialize(UINT count = 0);
+
+    // Stop the worker threads after the jobs already added are done.
+    void    stop();
+
+    // Return number of threads that run jobs, the workers and the caller
+    // of wait().
+    UINT    getThreadCount() const  {return (UINT)workers.size() + 1;}
+
+    // Add a job, run as f(data, begin, end).
+    // counter = incremented now and decremented when the job is done
+    // after = the job is not started until after is done, may be NULL
+    void    add(JobFunction f, void *data, UINT begin, UINT end, JobCounter *counter,
+                JobCounter *after = NULL);
+
+    // Split elements 0 to count-1 into jobs of grain elements, or fewer for
+    // the last, and add them.
+    void    parallelFor(UINT count, UINT grain, JobFunction f, void *data,
+                        JobCounter *counter, JobCounter *after = NULL);
+
+    // parallelFor() calling f(begin, end). f must be valid until the jobs
+    // are done.
+    template <class F>
+    void    parallelFor(UINT count, UINT grain, F &f, JobCounter *counter,
+                        JobCounter *after = NULL)
+    {
+        parallelFor(count, grain, &callFunctor<F>, &f, counter, after);
+    }
+
+    // Run jobs on the calling thread until every job of counter is done.
+    void    wait(JobCounter *counter);
+
+    // Return number of jobs run since the start.
+    UINT    getExecuted() const     {return executed.load();}
+
+    // Return number of jobs a thread took from the queue of another.
+    UINT    getSteals() const       {return steals.load();}
+};
+
+#endif
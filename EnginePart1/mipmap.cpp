@@ -0,0 +1,146 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// mipmap.cpp v1.0
+// Builds texture mip levels, see mipmap.h
+
+#include "mipmap.h"
+#include "cpuFeatures.h"
+
+//=============================================================================
+// Average of the 2x2 block of pixels a,b over c,d
+// Rounded to nearest, the same as the SSE2 version.
+//=============================================================================
+static inline COLOR_ARGB average4(COLOR_ARGB a, COLOR_ARGB b, COLOR_ARGB c, COLOR_ARGB d)
+{
+    COLOR_ARGB result = 0;
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        UINT sum = ((a >> shift) & 0xff) + ((b >> shift) & 0xff) +
+                   ((c >> shift) & 0xff) + ((d >> shift) & 0xff);
+        result |= ((sum + 2) >> 2) << shift;
+    }
+    return result;
+}
+
+#ifdef CPU_X86
+
+//=============================================================================
+// Average count pairs of 2x2 blocks, 2 destination pixels per loop
+// Returns number of destination pixels done.
+//=============================================================================
+TARGET_SSE2 static UINT downsampleSSE2(const COLOR_ARGB *row0, const COLOR_ARGB *row1,
+                                       COLOR_ARGB *dest, UINT count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+    UINT x = 0;
+    for (; x+2 <= count; x += 2)
+    {
+        // 4 source pixels from each row, channels widened to 16 bits
+        __m128i a = _mm_loadu_si128((const __m128i*)(row0 + 2*x));
+        __m128i b = _mm_loadu_si128((const __m128i*)(row1 + 2*x));
+        __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+        __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+        // add the left and right columns of each block
+        lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+        hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+        __m128i sum = _mm_unpacklo_epi64(lo, hi);
+        sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+        _mm_storel_epi64((__m128i*)(dest + x), _mm_packus_epi16(sum, sum));
+    }
+    return x;
+}
+
+#endif  // CPU_X86
+
+namespace
+{
+    const bool hasSSE2 = CpuFeatures::hasSSE2();
+    bool useSSE2 = hasSSE2;
+}
+
+//=============================================================================
+// Use SSE2 if the CPU has it
+//=============================================================================
+void Mipmap::setSimd(bool simd)
+{
+    useSSE2 = simd && hasSSE2;
+}
+
+//=============================================================================
+// Return true if SSE2 is used
+//=============================================================================
+bool Mipmap::getSimd()
+{
+    return useSSE2;
+}
+
+//=============================================================================
+// Return number of levels, down to 1x1
+//=============================================================================
+UINT Mipmap::getLevelCount(UINT width, UINT height)
+{
+    UINT levels = 1;
+    while ((width > 1 || height > 1) && levels < mipmapNS::MAX_LEVELS)
+    {
+        width = getLevelSize(width, 1);
+        height = getLevelSize(height, 1);
+        levels++;
+    }
+    return levels;
+}
+
+//=============================================================================
+// Return number of pixels in levels 1 to levels-1
+//=============================================================================
+size_t Mipmap::getChainSize(UINT width, UINT height, UINT levels)
+{
+    size_t size = 0;
+    for (UINT level = 1; level < levels; level++)
+        size += (size_t)getLevelSize(width, level) * getLevelSize(height, level);
+    return size;
+}
+
+//=============================================================================
+// Make the next level
+// Each pixel is the average of a 2x2 block. An odd last row or column is
+// dropped, a size of 1 is averaged with itself.
+//=============================================================================
+void Mipmap::downsample(const COLOR_ARGB *src, UINT width, UINT height, COLOR_ARGB *dest)
+{
+    UINT destWidth = getLevelSize(width, 1);
+    UINT destHeight = getLevelSize(height, 1);
+    UINT right = (width > 1) ? 1 : 0;       // offset of the right column of a block
+    for (UINT y = 0; y < destHeight; y++)
+    {
+        const COLOR_ARGB *row0 = src + (2*y)*width;
+        const COLOR_ARGB *row1 = (height > 1) ? row0 + width : row0;
+        COLOR_ARGB *out = dest + y*destWidth;
+        UINT x = 0;
+#ifdef CPU_X86
+        if (useSSE2 && right)
+            x = downsampleSSE2(row0, row1, out, destWidth);
+#endif
+        for (; x < destWidth; x++)
+            out[x] = average4(row0[2*x], row0[2*x+right], row1[2*x], row1[2*x+right]);
+    }
+}
+
+//=============================================================================
+// Make levels 1 to levels-1
+// Each level is made from the one before.
+//=============================================================================
+void Mipmap::build(const COLOR_ARGB *pixels, UINT width, UINT height, UINT levels,
+                   COLOR_ARGB *chain)
+{
+    const COLOR_ARGB *src = pixels;
+    for (UINT level = 1; level < levels; level++)
+    {
+        downsample(src, width, height, chain);
+        src = chain;
+        width = getLevelSize(width, 1);
+        height = getLevelSize(height, 1);
+        chain += (size_t)width*height;
+    }
+}
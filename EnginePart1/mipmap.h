@@ -0,0 +1,61 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// mipmap.h v1.0
+// Mipmap builds the smaller copies of a texture used when a sprite is drawn
+// scaled down. Each level is half the size of the one before, down to 1x1,
+// so a sprite drawn at scale 0.25 samples a texture 1/16 the size instead of
+// skipping over the full size one. Levels are made with a 2x2 box filter,
+// which is correct for premultiplied alpha, 2 pixels per SSE2 instruction
+// when the CPU has it.
+// Graphics::createTexture() makes the levels of every texture, or takes
+// them from a cooked file, see Graphics::setMipmaps() and getMipLevels().
+// Direct3D picks the level from the screen size of the sprite, the software
+// Graphics from the sprite transform.
+
+#ifndef _MIPMAP_H               // Prevent multiple definitions if this
+#define _MIPMAP_H               // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include "spriteData.h"
+
+namespace mipmapNS
+{
+    const UINT MAX_LEVELS = 16;     // 32768x32768 texture
+}
+
+class Mipmap
+{
+  public:
+    // Return number of levels of a width x height texture, down to 1x1.
+    static UINT getLevelCount(UINT width, UINT height);
+
+    // Return the width or height of level, size is the width or height of level 0.
+    static UINT getLevelSize(UINT size, UINT level)
+    {
+        size >>= level;
+        return size ? size : 1;
+    }
+
+    // Return number of pixels in levels 1 to levels-1.
+    static size_t getChainSize(UINT width, UINT height, UINT levels);
+
+    // Make the next level of a width x height image.
+    // Pre: dest has room for getLevelSize(width,1) x getLevelSize(height,1) pixels
+    static void downsample(const COLOR_ARGB *src, UINT width, UINT height, COLOR_ARGB *dest);
+
+    // Make levels 1 to levels-1 of a width x height image.
+    // Pre: chain has room for getChainSize(width, height, levels) pixels
+    // Post: chain holds the levels one after the other, largest first
+    static void build(const COLOR_ARGB *pixels, UINT width, UINT height, UINT levels,
+                      COLOR_ARGB *chain);
+
+    // Use SSE2 if the CPU has it (default), false for the scalar version.
+    // The results are the same.
+    static void setSimd(bool simd);
+
+    // Return true if SSE2 is used.
+    static bool getSimd();
+};
+
+#endif
@@ -0,0 +1,499 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// narrowphase.cpp v1.0
+// Exact collision tests of broadphase pairs, see narrowphase.h
+// The SSE2 tests do the same operations in the same order as the scalar
+// tests, so both find the same contacts with the same values.
+
+#include "narrowphase.h"
+#include "cpuFeatures.h"
+#include <cmath>
+
+using namespace entityStoreNS;
+
+#ifdef CPU_X86
+
+//=============================================================================
+// Return v of the first or second objects of 4 pairs
+//=============================================================================
+TARGET_SSE2 static inline __m128 gatherA(const float *v, const BroadphasePair *p)
+{
+    return _mm_set_ps(v[p[3].a], v[p[2].a], v[p[1].a], v[p[0].a]);
+}
+
+TARGET_SSE2 static inline __m128 gatherB(const float *v, const BroadphasePair *p)
+{
+    return _mm_set_ps(v[p[3].b], v[p[2].b], v[p[1].b], v[p[0].b]);
+}
+
+//=============================================================================
+// Return a where mask is set, else b
+//=============================================================================
+TARGET_SSE2 static inline __m128 select4(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+//=============================================================================
+// Return |v|
+//=============================================================================
+TARGET_SSE2 static inline __m128 abs4(__m128 v)
+{
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+//=============================================================================
+// Add the contacts of the lanes set in mask
+//=============================================================================
+TARGET_SSE2 static inline void addContacts(std::vector<Contact> &contacts, const BroadphasePair *p,
+                                           int mask, __m128 nx, __m128 ny, __m128 depth)
+{
+    float x[4], y[4], d[4];
+    _mm_storeu_ps(x, nx);
+    _mm_storeu_ps(y, ny);
+    _mm_storeu_ps(d, depth);
+    for (int k = 0; k < 4; k++)
+        if (mask & (1 << k))
+        {
+            Contact c = {p[k].a, p[k].b, x[k], y[k], d[k]};
+            contacts.push_back(c);
+        }
+}
+
+//=============================================================================
+// Circle-circle test of 4 pairs per loop
+// Returns number of pairs done.
+//=============================================================================
+TARGET_SSE2 static UINT circlesSSE2(const BroadphasePair *p, UINT count, const float *cx,
+                                    const float *cy, const float *ex, std::vector<Contact> &contacts)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    UINT i = 0;
+    for (; i+4 <= count; i += 4, p += 4)
+    {
+        __m128 dx = _mm_sub_ps(gatherB(cx, p), gatherA(cx, p));
+        __m128 dy = _mm_sub_ps(gatherB(cy, p), gatherA(cy, p));
+        __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        __m128 r = _mm_add_ps(gatherA(ex, p), gatherB(ex, p));
+        int mask = _mm_movemask_ps(_mm_cmplt_ps(d2, _mm_mul_ps(r, r)));
+        if (mask == 0)
+            continue;                           // none collide
+        __m128 dist = _mm_sqrt_ps(d2);
+        __m128 apart = _mm_cmpgt_ps(dist, zero);
+        __m128 nx = select4(apart, _mm_div_ps(dx, dist), one);
+        __m128 ny = _mm_and_ps(apart, _mm_div_ps(dy, dist));
+        addContacts(contacts, p, mask, nx, ny, _mm_sub_ps(r, dist));
+    }
+    return i;
+}
+
+//=============================================================================
+// Axis aligned box test of 4 pairs per loop
+// Returns number of pairs done.
+//=============================================================================
+TARGET_SSE2 static UINT boxesSSE2(const BroadphasePair *p, UINT count, const float *cx,
+                                  const float *cy, const float *ex, const float *ey,
+                                  std::vector<Contact> &contacts)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minusOne = _mm_set1_ps(-1.0f);
+    UINT i = 0;
+    for (; i+4 <= count; i += 4, p += 4)
+    {
+        __m128 dx = _mm_sub_ps(gatherB(cx, p), gatherA(cx, p));
+        __m128 dy = _mm_sub_ps(gatherB(cy, p), gatherA(cy, p));
+        __m128 ox = _mm_sub_ps(_mm_add_ps(gatherA(ex, p), gatherB(ex, p)), abs4(dx));
+        __m128 oy = _mm_sub_ps(_mm_add_ps(gatherA(ey, p), gatherB(ey, p)), abs4(dy));
+        int mask = _mm_movemask_ps(_mm_and_ps(_mm_cmpgt_ps(ox, zero), _mm_cmpgt_ps(oy, zero)));
+        if (mask == 0)
+            continue;                           // none collide
+        __m128 useX = _mm_cmplt_ps(ox, oy);
+        __m128 sx = select4(_mm_cmplt_ps(dx, zero), minusOne, one);
+        __m128 sy = select4(_mm_cmplt_ps(dy, zero), minusOne, one);
+        __m128 nx = _mm_and_ps(useX, sx);
+        __m128 ny = _mm_andnot_ps(useX, sy);
+        addContacts(contacts, p, mask, nx, ny, select4(useX, ox, oy));
+    }
+    return i;
+}
+
+//=============================================================================
+// Rotated box test of 4 pairs per loop
+// Returns number of pairs done.
+//=============================================================================
+TARGET_SSE2 static UINT rotatedSSE2(const BroadphasePair *p, UINT count, const float *cx,
+                                    const float *cy, const float *ex, const float *ey,
+                                    const float *cosA, const float *sinA,
+                                    std::vector<Contact> &contacts)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    UINT i = 0;
+    for (; i+4 <= count; i += 4, p += 4)
+    {
+        __m128 dx = _mm_sub_ps(gatherB(cx, p), gatherA(cx, p));
+        __m128 dy = _mm_sub_ps(gatherB(cy, p), gatherA(cy, p));
+        __m128 ca = gatherA(cosA, p);
+        __m128 sa = gatherA(sinA, p);
+        __m128 cb = gatherB(cosA, p);
+        __m128 sb = gatherB(sinA, p);
+        __m128 exa = gatherA(ex, p);
+        __m128 eya = gatherA(ey, p);
+        __m128 exb = gatherB(ex, p);
+        __m128 eyb = gatherB(ey, p);
+        __m128 c = abs4(_mm_add_ps(_mm_mul_ps(ca, cb), _mm_mul_ps(sa, sb)));
+        __m128 s = abs4(_mm_sub_ps(_mm_mul_ps(sa, cb), _mm_mul_ps(ca, sb)));
+        __m128 dau = _mm_add_ps(_mm_mul_ps(dx, ca), _mm_mul_ps(dy, sa));
+        __m128 dav = _mm_sub_ps(_mm_mul_ps(dy, ca), _mm_mul_ps(dx, sa));
+        __m128 dbu = _mm_add_ps(_mm_mul_ps(dx, cb), _mm_mul_ps(dy, sb));
+        __m128 dbv = _mm_sub_ps(_mm_mul_ps(dy, cb), _mm_mul_ps(dx, sb));
+        __m128 o1 = _mm_sub_ps(_mm_add_ps(_mm_add_ps(exa, _mm_mul_ps(exb, c)), _mm_mul_ps(eyb, s)), abs4(dau));
+        __m128 o2 = _mm_sub_ps(_mm_add_ps(_mm_add_ps(eya, _mm_mul_ps(exb, s)), _mm_mul_ps(eyb, c)), abs4(dav));
+        __m128 o3 = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(exa, c), _mm_mul_ps(eya, s)), exb), abs4(dbu));
+        __m128 o4 = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(exa, s), _mm_mul_ps(eya, c)), eyb), abs4(dbv));
+        __m128 hit = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(o1, zero), _mm_cmpgt_ps(o2, zero)),
+                                _mm_and_ps(_mm_cmpgt_ps(o3, zero), _mm_cmpgt_ps(o4, zero)));
+        int mask = _mm_movemask_ps(hit);
+        if (mask == 0)
+            continue;                           // all separated
+        // axis of least overlap, in the order of the scalar test
+        __m128 depth = o1;
+        __m128 nx = ca;
+        __m128 ny = sa;
+        __m128 proj = dau;
+        __m128 less = _mm_cmplt_ps(o2, depth);
+        depth = select4(less, o2, depth);
+        nx = select4(less, _mm_xor_ps(sa, sign), nx);
+        ny = select4(less, ca, ny);
+        proj = select4(less, dav, proj);
+        less = _mm_cmplt_ps(o3, depth);
+        depth = select4(less, o3, depth);
+        nx = select4(less, cb, nx);
+        ny = select4(less, sb, ny);
+        proj = select4(less, dbu, proj);
+        less = _mm_cmplt_ps(o4, depth);
+        depth = select4(less, o4, depth);
+        nx = select4(less, _mm_xor_ps(sb, sign), nx);
+        ny = select4(less, cb, ny);
+        proj = select4(less, dbv, proj);
+        __m128 flip = _mm_and_ps(_mm_cmplt_ps(proj, zero), sign);  // point from a to b
+        addContacts(contacts, p, mask, _mm_xor_ps(nx, flip), _mm_xor_ps(ny, flip), depth);
+    }
+    return i;
+}
+
+#endif  // CPU_X86
+
+//=============================================================================
+// Constructor
+//=============================================================================
+Narrowphase::Narrowphase()
+{
+    simd = CpuFeatures::hasSSE2();
+}
+
+//=============================================================================
+// Use SSE2 if the CPU has it
+//=============================================================================
+void Narrowphase::setSimd(bool s)
+{
+    simd = s && CpuFeatures::hasSSE2();
+}
+
+//=============================================================================
+// Remove all objects
+//=============================================================================
+void Narrowphase::clear()
+{
+    type.clear();
+    cx.clear();
+    cy.clear();
+    ex.clear();
+    ey.clear();
+    cosA.clear();
+    sinA.clear();
+}
+
+//=============================================================================
+// Add an object
+// Returns the object number
+//=============================================================================
+UINT Narrowphase::add(COLLISION_TYPE t, float x, float y, float w, float h, float angle)
+{
+    type.push_back(t);
+    cx.push_back(x);
+    cy.push_back(y);
+    ex.push_back(w);
+    ey.push_back(t == CIRCLE ? w : h);
+    if (t == ROTATED_BOX)
+    {
+        cosA.push_back(cos(angle));
+        sinA.push_back(sin(angle));
+    }
+    else
+    {
+        cosA.push_back(1.0f);
+        sinA.push_back(0.0f);
+    }
+    return (UINT)type.size() - 1;
+}
+
+//=============================================================================
+// Add every entity with TRANSFORM and COLLIDER
+//=============================================================================
+void Narrowphase::addEntities(EntityStore *store)
+{
+    if (store == NULL)
+        return;
+    for (UINT n = 0; n < store->getArchetypeCount(); n++)
+    {
+        Archetype &a = store->getArchetype(n);
+        if (a.count == 0 || !a.has(entityStoreNS::TRANSFORM | entityStoreNS::COLLIDER))
+            continue;
+        bool sprite = a.has(entityStoreNS::SPRITE);
+        for (UINT i = 0; i < a.count; i++)
+        {
+            float scale = a.scale[i];
+            float x = a.x[i];                       // collider center
+            float y = a.y[i];
+            if (sprite)
+            {
+                x += a.width[i] * scale * 0.5f;
+                y += a.height[i] * scale * 0.5f;
+            }
+            if (a.colliderType[i] == CIRCLE)
+                add(CIRCLE, x, y, a.radius[i] * scale, 0);
+            else
+                add(a.colliderType[i], x, y, a.halfWidth[i] * scale, a.halfHeight[i] * scale,
+                    a.angle[i]);
+        }
+    }
+}
+
+//=============================================================================
+// Circle-circle test
+//=============================================================================
+void Narrowphase::testCircles(UINT a, UINT b)
+{
+    float dx = cx[b] - cx[a];
+    float dy = cy[b] - cy[a];
+    float d2 = dx*dx + dy*dy;
+    float r = ex[a] + ex[b];
+    if (!(d2 < r*r))
+        return;
+    float dist = sqrt(d2);
+    Contact c = {a, b, 1.0f, 0.0f, r - dist};   // same centers, push along x
+    if (dist > 0)
+    {
+        c.normalX = dx / dist;
+        c.normalY = dy / dist;
+    }
+    contacts.push_back(c);
+}
+
+//=============================================================================
+// Axis aligned box test
+//=============================================================================
+void Narrowphase::testBoxes(UINT a, UINT b)
+{
+    float dx = cx[b] - cx[a];
+    float dy = cy[b] - cy[a];
+    float ox = (ex[a] + ex[b]) - fabs(dx);      // overlap on each axis
+    float oy = (ey[a] + ey[b]) - fabs(dy);
+    if (!(ox > 0 && oy > 0))
+        return;
+    Contact c = {a, b, 0.0f, 0.0f, 0.0f};
+    if (ox < oy)                                // separate on the smaller overlap
+    {
+        c.normalX = dx < 0 ? -1.0f : 1.0f;
+        c.depth = ox;
+    }
+    else
+    {
+        c.normalY = dy < 0 ? -1.0f : 1.0f;
+        c.depth = oy;
+    }
+    contacts.push_back(c);
+}
+
+//=============================================================================
+// Rotated box test
+// Separating axis test on the edge directions of both boxes. The contact
+// normal is the axis of least overlap.
+//=============================================================================
+void Narrowphase::testRotated(UINT a, UINT b)
+{
+    float dx = cx[b] - cx[a];
+    float dy = cy[b] - cy[a];
+    float ca = cosA[a], sa = sinA[a];
+    float cb = cosA[b], sb = sinA[b];
+    float c = fabs(ca*cb + sa*sb);              // |cos| and |sin| of the angle between the boxes
+    float s = fabs(sa*cb - ca*sb);
+    float dau = dx*ca + dy*sa;                  // center distance along each axis
+    float dav = dy*ca - dx*sa;
+    float dbu = dx*cb + dy*sb;
+    float dbv = dy*cb - dx*sb;
+    float o1 = ((ex[a] + ex[b]*c) + ey[b]*s) - fabs(dau);
+    float o2 = ((ey[a] + ex[b]*s) + ey[b]*c) - fabs(dav);
+    float o3 = ((ex[a]*c + ey[a]*s) + ex[b]) - fabs(dbu);
+    float o4 = ((ex[a]*s + ey[a]*c) + ey[b]) - fabs(dbv);
+    if (!(o1 > 0 && o2 > 0 && o3 > 0 && o4 > 0))
+        return;                                 // a separating axis
+    Contact ct = {a, b, ca, sa, o1};
+    float proj = dau;
+    if (o2 < ct.depth)
+    {
+        ct.depth = o2;
+        ct.normalX = -sa;
+        ct.normalY = ca;
+        proj = dav;
+    }
+    if (o3 < ct.depth)
+    {
+        ct.depth = o3;
+        ct.normalX = cb;
+        ct.normalY = sb;
+        proj = dbu;
+    }
+    if (o4 < ct.depth)
+    {
+        ct.depth = o4;
+        ct.normalX = -sb;
+        ct.normalY = cb;
+        proj = dbv;
+    }
+    if (proj < 0)                               // point from a to b
+    {
+        ct.normalX = -ct.normalX;
+        ct.normalY = -ct.normalY;
+    }
+    contacts.push_back(ct);
+}
+
+//=============================================================================
+// Circle-box test, either object may be the circle
+// The circle center is moved into the frame of the box and the closest
+// point of the box is found by clamping.
+//=============================================================================
+void Narrowphase::testCircleBox(UINT a, UINT b)
+{
+    UINT circle = type[a] == CIRCLE ? a : b;
+    UINT box = circle == a ? b : a;
+    float co = cosA[box], si = sinA[box];
+    float dx = cx[circle] - cx[box];
+    float dy = cy[circle] - cy[box];
+    float lx = dx*co + dy*si;                   // circle center in the box frame
+    float ly = dy*co - dx*si;
+    float r = ex[circle];
+    float hx = ex[box], hy = ey[box];
+    float qx = lx < -hx ? -hx : (lx > hx ? hx : lx);    // closest point of the box
+    float qy = ly < -hy ? -hy : (ly > hy ? hy : ly);
+    float nx, ny, depth;
+    if (qx == lx && qy == ly)                   // center inside the box
+    {
+        float ox = hx - fabs(lx);
+        float oy = hy - fabs(ly);
+        if (ox < oy)
+        {
+            nx = lx < 0 ? -1.0f : 1.0f;
+            ny = 0;
+            depth = r + ox;
+        }
+        else
+        {
+            nx = 0;
+            ny = ly < 0 ? -1.0f : 1.0f;
+            depth = r + oy;
+        }
+    }
+    else
+    {
+        float ddx = lx - qx;
+        float ddy = ly - qy;
+        float d2 = ddx*ddx + ddy*ddy;
+        if (!(d2 < r*r))
+            return;
+        float dist = sqrt(d2);
+        nx = ddx / dist;
+        ny = ddy / dist;
+        depth = r - dist;
+    }
+    // normal from the box to the circle, back to world
+    Contact c = {a, b, nx*co - ny*si, nx*si + ny*co, depth};
+    if (circle == a)
+    {
+        c.normalX = -c.normalX;
+        c.normalY = -c.normalY;
+    }
+    contacts.push_back(c);
+}
+
+//=============================================================================
+// Test the pairs and return the contacts of the ones that collide
+// The pairs are sorted by test first, so each batch runs one test.
+//=============================================================================
+const std::vector<Contact>& Narrowphase::findContacts(const std::vector<BroadphasePair> &pairs)
+{
+    contacts.clear();
+    circles.clear();
+    boxes.clear();
+    rotated.clear();
+    mixed.clear();
+    for (UINT n = 0; n < pairs.size(); n++)
+    {
+        const BroadphasePair &p = pairs[n];
+        COLLISION_TYPE ta = type[p.a];
+        COLLISION_TYPE tb = type[p.b];
+        if (ta == CIRCLE && tb == CIRCLE)
+            circles.push_back(p);
+        else if (ta == CIRCLE || tb == CIRCLE)
+            mixed.push_back(p);
+        else if (ta == BOX && tb == BOX)
+            boxes.push_back(p);
+        else
+            rotated.push_back(p);               // a BOX is a rotated box at angle 0
+    }
+
+    UINT i = 0;
+#ifdef CPU_X86
+    if (simd && !circles.empty())
+        i = circlesSSE2(&circles[0], (UINT)circles.size(), &cx[0], &cy[0], &ex[0], contacts);
+#endif
+    for (; i < circles.size(); i++)             // remaining pairs
+        testCircles(circles[i].a, circles[i].b);
+
+    i = 0;
+#ifdef CPU_X86
+    if (simd && !boxes.empty())
+        i = boxesSSE2(&boxes[0], (UINT)boxes.size(), &cx[0], &cy[0], &ex[0], &ey[0], contacts);
+#endif
+    for (; i < boxes.size(); i++)
+        testBoxes(boxes[i].a, boxes[i].b);
+
+    i = 0;
+#ifdef CPU_X86
+    if (simd && !rotated.empty())
+        i = rotatedSSE2(&rotated[0], (UINT)rotated.size(), &cx[0], &cy[0], &ex[0], &ey[0],
+                        &cosA[0], &sinA[0], contacts);
+#endif
+    for (; i < rotated.size(); i++)
+        testRotated(rotated[i].a, rotated[i].b);
+
+    for (i = 0; i < mixed.size(); i++)
+        testCircleBox(mixed[i].a, mixed[i].b);
+    return contacts;
+}
+
+//=============================================================================
+// Clear, add the entities of store and test the pairs
+//=============================================================================
+const std::vector<Contact>& Narrowphase::update(EntityStore *store,
+                                                const std::vector<BroadphasePair> &pairs)
+{
+    clear();
+    addEntities(store);
+    return findContacts(pairs);
+}
@@ -0,0 +1,100 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// narrowphase.h v1.0
+// A Narrowphase does the exact collision test of the pairs found by a
+// Broadphase and returns a Contact for each pair that collides, with the
+// direction and depth to push them apart.
+// Shapes are circles, axis aligned boxes and rotated boxes, at the scale
+// and angle of the object. Pairs are sorted by the kind of test, and
+// circle-circle, box-box and rotated box tests are done for 4 pairs per
+// SSE2 instruction. Rotated boxes use the separating axis test on the 4
+// edge directions. Circle-box pairs are tested one at a time, they are
+// rare compared to pairs of the same shape.
+// Object numbers are the numbers of the Broadphase: add the same objects
+// in the same order, or fill both from one EntityStore with addEntities().
+// Game owns a Narrowphase that tests the broadphase pairs before
+// collisions(), see Game::getNarrowphase().
+
+#ifndef _NARROWPHASE_H          // Prevent multiple definitions if this
+#define _NARROWPHASE_H          // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+#include "broadphase.h"
+
+// A collision between objects a and b.
+struct Contact
+{
+    UINT    a;
+    UINT    b;
+    float   normalX;        // unit vector from a to b
+    float   normalY;
+    float   depth;          // distance to move b along the normal, or a against it, to separate them
+};
+
+class Narrowphase
+{
+  private:
+    // shapes, element n is object n
+    std::vector<entityStoreNS::COLLISION_TYPE> type;
+    std::vector<float> cx;          // center
+    std::vector<float> cy;
+    std::vector<float> ex;          // half width, or radius of a circle
+    std::vector<float> ey;          // half height
+    std::vector<float> cosA;        // rotation, 1 and 0 unless ROTATED_BOX
+    std::vector<float> sinA;
+    // pairs by test
+    std::vector<BroadphasePair> circles;
+    std::vector<BroadphasePair> boxes;
+    std::vector<BroadphasePair> rotated;
+    std::vector<BroadphasePair> mixed;
+    std::vector<Contact> contacts;
+    bool    simd;                   // true to use SSE2
+
+    // Test one pair, adding a Contact if it collides.
+    void    testCircles(UINT a, UINT b);
+    void    testBoxes(UINT a, UINT b);
+    void    testRotated(UINT a, UINT b);
+    void    testCircleBox(UINT a, UINT b);
+
+  public:
+    // Constructor
+    Narrowphase();
+
+    // Remove all objects.
+    void    clear();
+
+    // Add an object.
+    // x,y = center, e = radius of a CIRCLE, w,h = half size of a box,
+    // angle = radians, ROTATED_BOX only
+    // Returns the object number.
+    UINT    add(entityStoreNS::COLLISION_TYPE t, float x, float y, float w, float h, float angle = 0);
+
+    // Add every entity with TRANSFORM and COLLIDER in store, in the order
+    // of Broadphase::addEntities().
+    void    addEntities(EntityStore *store);
+
+    // Return number of objects.
+    UINT    getCount() const        {return (UINT)type.size();}
+
+    // Test the pairs and return the contacts of the ones that collide, in
+    // no particular order.
+    const std::vector<Contact>& findContacts(const std::vector<BroadphasePair> &pairs);
+
+    // Return the contacts found by the last findContacts().
+    const std::vector<Contact>& getContacts() const {return contacts;}
+
+    // Clear, add the entities of store and test the pairs.
+    // Called by Game::run() before collisions().
+    const std::vector<Contact>& update(EntityStore *store, const std::vector<BroadphasePair> &pairs);
+
+    // Use SSE2 if the CPU has it (default), false for the scalar version.
+    // The contacts are the same.
+    void    setSimd(bool s);
+
+    // Return true if SSE2 is used.
+    bool    getSimd() const         {return simd;}
+};
+
+#endif
@@ -0,0 +1,346 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// particles.cpp v1.0
+// Structure of arrays particle emitter, see particles.h
+
+#include "particles.h"
+#include "cpuFeatures.h"
+#include <cmath>
+
+// Arrays used by the integration, in the order of ParticleEmitter::FIELD
+struct ParticleArrays
+{
+    float   *x, *y, *vx, *vy;
+    float   *c[4];                  // r, g, b, a
+    float   *dc[4];                 // change of color per second
+    float   *life;
+    COLOR_ARGB *argb;
+};
+
+//=============================================================================
+// Return c limited to 0 to 1
+//=============================================================================
+static inline float clamp01(float c)
+{
+    c = c < 0.0f ? 0.0f : c;        // the order of _mm_max_ps, _mm_min_ps
+    return c > 1.0f ? 1.0f : c;
+}
+
+//=============================================================================
+// Return the ARGB color of r, g, b, a from 0 to 1
+//=============================================================================
+static inline COLOR_ARGB packColor(float r, float g, float b, float a)
+{
+    UINT ia = (UINT)(int)(a * 255.0f + 0.5f);
+    UINT ir = (UINT)(int)(r * 255.0f + 0.5f);
+    UINT ig = (UINT)(int)(g * 255.0f + 0.5f);
+    UINT ib = (UINT)(int)(b * 255.0f + 0.5f);
+    return (ia << 24) | (ir << 16) | (ig << 8) | ib;
+}
+
+//=============================================================================
+// Move particle i by dt
+// gdx,gdy = change of velocity in dt
+//=============================================================================
+static inline void integrate1(const ParticleArrays &p, UINT i, float dt, float gdx, float gdy)
+{
+    p.vx[i] += gdx;
+    p.vy[i] += gdy;
+    p.x[i] += p.vx[i] * dt;
+    p.y[i] += p.vy[i] * dt;
+    for (int k = 0; k < 4; k++)
+        p.c[k][i] = clamp01(p.c[k][i] + p.dc[k][i] * dt);
+    p.life[i] -= dt;
+    p.argb[i] = packColor(p.c[0][i], p.c[1][i], p.c[2][i], p.c[3][i]);
+}
+
+#ifdef CPU_X86
+
+//=============================================================================
+// Move 4 particles per loop
+// The operations are the ones of integrate1() in the same order, so the
+// particles are the same.
+// Returns number of particles done.
+//=============================================================================
+TARGET_SSE2 static UINT integrateSSE2(const ParticleArrays &p, UINT count, float dt,
+                                      float gdx, float gdy)
+{
+    const __m128 t = _mm_set1_ps(dt);
+    const __m128 gx = _mm_set1_ps(gdx);
+    const __m128 gy = _mm_set1_ps(gdy);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 c255 = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    UINT i = 0;
+    for (; i+4 <= count; i += 4)
+    {
+        __m128 vx = _mm_add_ps(_mm_loadu_ps(p.vx + i), gx);
+        __m128 vy = _mm_add_ps(_mm_loadu_ps(p.vy + i), gy);
+        _mm_storeu_ps(p.vx + i, vx);
+        _mm_storeu_ps(p.vy + i, vy);
+        _mm_storeu_ps(p.x + i, _mm_add_ps(_mm_loadu_ps(p.x + i), _mm_mul_ps(vx, t)));
+        _mm_storeu_ps(p.y + i, _mm_add_ps(_mm_loadu_ps(p.y + i), _mm_mul_ps(vy, t)));
+        __m128i channel[4];
+        for (int k = 0; k < 4; k++)
+        {
+            __m128 c = _mm_add_ps(_mm_loadu_ps(p.c[k] + i), _mm_mul_ps(_mm_loadu_ps(p.dc[k] + i), t));
+            c = _mm_min_ps(_mm_max_ps(c, zero), one);
+            _mm_storeu_ps(p.c[k] + i, c);
+            channel[k] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(c, c255), half));
+        }
+        _mm_storeu_ps(p.life + i, _mm_sub_ps(_mm_loadu_ps(p.life + i), t));
+        __m128i argb = _mm_or_si128(
+            _mm_or_si128(_mm_slli_epi32(channel[3], 24), _mm_slli_epi32(channel[0], 16)),
+            _mm_or_si128(_mm_slli_epi32(channel[1], 8), channel[2]));
+        _mm_storeu_si128((__m128i*)(p.argb + i), argb);
+    }
+    return i;
+}
+
+#endif  // CPU_X86
+
+//=============================================================================
+// Constructor
+//=============================================================================
+ParticleEmitter::ParticleEmitter()
+{
+    stride = 0;
+    capacity = 0;
+    count = 0;
+    graphics = NULL;
+    textureManager = NULL;
+    width = 0;
+    height = 0;
+    cols = 1;
+    frame = 0;
+    scale = 1.0f;
+    layer = 0;
+    posX = posY = 0;
+    rate = 0;
+    emitTime = 0;
+    minLife = maxLife = 1.0f;
+    minSpeed = 50.0f;
+    maxSpeed = 100.0f;
+    direction = 0;
+    spread = (float)(2*PI);
+    gravityX = gravityY = 0;
+    setColors(graphicsNS::WHITE, graphicsNS::WHITE & 0x00ffffff);   // fade out
+    seed = 1;
+    lastFrameTime = 0;
+    simd = CpuFeatures::hasSSE2();
+}
+
+//=============================================================================
+// Use SSE2 if the CPU has it
+//=============================================================================
+void ParticleEmitter::setSimd(bool s)
+{
+    simd = s && CpuFeatures::hasSSE2();
+}
+
+//=============================================================================
+// Allocate the particles and set the texture
+// The arrays are the only memory used, the emitter does not grow.
+// Returns false if the memory could not be allocated.
+//=============================================================================
+bool ParticleEmitter::initialize(Graphics *g, int width, int height, int ncols,
+                                 TextureManager *textureM, UINT maxParticles)
+{
+    graphics = g;
+    textureManager = textureM;
+    this->width = width;
+    this->height = height;
+    cols = ncols > 0 ? ncols : 1;
+    count = 0;
+    emitTime = 0;
+    try{
+        stride = (maxParticles + 3) & ~3u;          // keep each array 16 byte aligned to the next
+        std::vector<float>(stride * FIELDS).swap(memory);
+        std::vector<COLOR_ARGB>(stride).swap(argb);
+    }
+    catch(...)
+    {
+        stride = 0;
+        capacity = 0;
+        memory.clear();
+        argb.clear();
+        return false;
+    }
+    capacity = maxParticles;
+    return true;
+}
+
+//=============================================================================
+// Set color at birth and at death
+//=============================================================================
+void ParticleEmitter::setColors(COLOR_ARGB start, COLOR_ARGB end)
+{
+    for (int k = 0; k < 4; k++)
+    {
+        int shift = k < 3 ? 16 - 8*k : 24;          // r, g, b, a
+        startColor[k] = ((start >> shift) & 0xff) / 255.0f;
+        endColor[k] = ((end >> shift) & 0xff) / 255.0f;
+    }
+}
+
+//=============================================================================
+// Return a random number from 0 to 1 (xorshift)
+//=============================================================================
+float ParticleEmitter::random()
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return (seed >> 8) * (1.0f / 16777216.0f);
+}
+
+//=============================================================================
+// Add a particle
+// Returns false if the emitter is full
+//=============================================================================
+bool ParticleEmitter::add(float x, float y, float vx, float vy, float life)
+{
+    if (count >= capacity)
+        return false;
+    UINT i = count++;
+    field(X)[i] = x;
+    field(Y)[i] = y;
+    field(VX)[i] = vx;
+    field(VY)[i] = vy;
+    field(LIFE)[i] = life;
+    float invLife = life > 0 ? 1.0f / life : 0;
+    for (int k = 0; k < 4; k++)
+    {
+        field((FIELD)(R + k))[i] = startColor[k];
+        field((FIELD)(DR + k))[i] = (endColor[k] - startColor[k]) * invLife;
+    }
+    argb[i] = packColor(startColor[0], startColor[1], startColor[2], startColor[3]);
+    return true;
+}
+
+//=============================================================================
+// Add n particles at the emitter position
+// Returns the number added
+//=============================================================================
+UINT ParticleEmitter::emit(UINT n)
+{
+    UINT added = 0;
+    for (; added < n && count < capacity; added++)
+    {
+        float angle = direction + (random() - 0.5f) * spread;
+        float speed = minSpeed + (maxSpeed - minSpeed) * random();
+        float life = minLife + (maxLife - minLife) * random();
+        add(posX, posY, cos(angle) * speed, sin(angle) * speed, life);
+    }
+    return added;
+}
+
+//=============================================================================
+// Remove particle i, the last particle takes its place
+//=============================================================================
+inline void ParticleEmitter::removeParticle(UINT i)
+{
+    UINT last = --count;
+    for (int f = 0; f < FIELDS; f++)
+        memory[f * stride + i] = memory[f * stride + last];
+    argb[i] = argb[last];
+}
+
+//=============================================================================
+// Move the particles, remove the dead ones and emit new ones
+//=============================================================================
+void ParticleEmitter::update(float frameTime)
+{
+    lastFrameTime = frameTime;
+    if (count > 0)
+    {
+        ParticleArrays p;
+        p.x = field(X);
+        p.y = field(Y);
+        p.vx = field(VX);
+        p.vy = field(VY);
+        for (int k = 0; k < 4; k++)
+        {
+            p.c[k] = field((FIELD)(R + k));
+            p.dc[k] = field((FIELD)(DR + k));
+        }
+        p.life = field(LIFE);
+        p.argb = &argb[0];
+        float gdx = gravityX * frameTime;
+        float gdy = gravityY * frameTime;
+        UINT i = 0;
+#ifdef CPU_X86
+        if (simd)
+            i = integrateSSE2(p, count, frameTime, gdx, gdy);
+#endif
+        for (; i < count; i++)
+            integrate1(p, i, frameTime, gdx, gdy);
+
+        // compact, the particle moved into a dead one's place is checked next
+        for (i = 0; i < count; )
+        {
+            if (p.life[i] <= 0)
+                removeParticle(i);
+            else
+                i++;
+        }
+    }
+
+    if (rate > 0)
+    {
+        emitTime += frameTime;
+        UINT n = (UINT)(emitTime * rate);
+        emitTime -= n / rate;
+        emit(n);                        // particles with no room are dropped
+    }
+    else
+        emitTime = 0;
+}
+
+//=============================================================================
+// Draw the particles
+// Particles are drawn centered on their position. When Graphics
+// interpolates they are moved back along their velocity by the part of the
+// last update() not yet shown.
+//=============================================================================
+void ParticleEmitter::draw()
+{
+    if (graphics == NULL || textureManager == NULL || count == 0)
+        return;
+    textureManager->touch();            // load again if evicted
+    LP_TEXTURE texture = textureManager->getTexture();
+    if (texture == NULL)                // if still loading
+        return;
+    SpriteData sd;
+    sd.width = width ? width : (int)textureManager->getWidth();
+    sd.height = height ? height : (int)textureManager->getHeight();
+    sd.scale = scale;
+    sd.angle = 0;
+    sd.rect.left = (frame % cols) * sd.width + textureManager->getOffsetX();
+    sd.rect.right = sd.rect.left + sd.width;
+    sd.rect.top = (frame / cols) * sd.height + textureManager->getOffsetY();
+    sd.rect.bottom = sd.rect.top + sd.height;
+    sd.texture = texture;
+    sd.flipHorizontal = false;
+    sd.flipVertical = false;
+    sd.layer = layer;
+    float halfWidth = sd.width * scale * 0.5f;
+    float halfHeight = sd.height * scale * 0.5f;
+    float back = 0;
+    if (graphics->getInterpolating())
+        back = (1.0f - graphics->getInterpolation()) * lastFrameTime;
+    const float *x = field(X);
+    const float *y = field(Y);
+    const float *vx = field(VX);
+    const float *vy = field(VY);
+    for (UINT i = 0; i < count; i++)
+    {
+        sd.x = x[i] - vx[i] * back - halfWidth;
+        sd.y = y[i] - vy[i] * back - halfHeight;
+        if (!graphics->inViewport(sd))  // if off screen
+            continue;
+        graphics->drawSprite(sd, argb[i]);
+    }
+}
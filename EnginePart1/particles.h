@@ -0,0 +1,171 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// particles.h v1.0
+// A ParticleEmitter creates, moves and draws many short lived sprites of
+// one texture, for smoke, sparks, explosions and the like.
+// Particles are kept in one array per property (structure of arrays) in a
+// single block allocated by initialize(), so an emitter never uses more
+// memory than its capacity. update() moves 4 particles per SSE2
+// instruction: velocity, position, color and remaining life. Dead
+// particles are replaced by the last particle, so the live ones stay
+// packed at the start of the arrays. The color of each particle is packed
+// to ARGB by update(), draw() only fills a SpriteData per particle and
+// passes it to Graphics::drawSprite(), batched with the other sprites.
+// Usage:
+//   emitter.initialize(graphics, 8, 8, 0, &sparkTexture, 2048);
+//   emitter.setPosition(x, y);
+//   emitter.setRate(500);                  // or emitter.emit(200) for a burst
+//   // in update(): emitter.update(frameTime);
+//   // in render(): emitter.draw();
+
+#ifndef _PARTICLES_H            // Prevent multiple definitions if this
+#define _PARTICLES_H            // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+#include "graphics.h"
+#include "textureManager.h"
+
+namespace particlesNS
+{
+    const UINT MAX_PARTICLES = 4096;    // default capacity of an emitter
+}
+
+class ParticleEmitter
+{
+  private:
+    // properties of a particle, one array each
+    enum FIELD {X, Y, VX, VY, R, G, B, A, DR, DG, DB, DA, LIFE, FIELDS};
+    std::vector<float> memory;      // all the float arrays, one after another
+    UINT    stride;                 // floats from the start of one array to the next
+    std::vector<COLOR_ARGB> argb;   // packed color of each particle
+    UINT    capacity;               // most particles alive at once
+    UINT    count;                  // particles alive, 0 to count-1
+    Graphics *graphics;
+    TextureManager *textureManager;
+    int     width;                  // frame size, 0 for the texture size
+    int     height;
+    int     cols;                   // frames in a row of the texture
+    int     frame;                  // frame drawn
+    float   scale;
+    int     layer;
+    // emission
+    float   posX, posY;             // center of new particles
+    float   rate;                   // particles per second
+    float   emitTime;               // time not yet turned into particles
+    float   minLife, maxLife;       // seconds
+    float   minSpeed, maxSpeed;     // pixels per second
+    float   direction;              // radians, 0 is to the right
+    float   spread;                 // angle of the cone particles leave in
+    float   gravityX, gravityY;     // pixels per second per second
+    float   startColor[4];          // r, g, b, a at birth, 0 to 1
+    float   endColor[4];            // at death
+    UINT    seed;                   // random number state
+    float   lastFrameTime;          // of the last update(), for interpolation
+    bool    simd;                   // true to use SSE2
+
+    // Return the array of property f.
+    float*  field(FIELD f)              {return &memory[f * stride];}
+    const float* field(FIELD f) const   {return &memory[f * stride];}
+
+    // Return a random number from 0 to 1.
+    float   random();
+
+    // Remove particle i, the last particle takes its place.
+    void    removeParticle(UINT i);
+
+  public:
+    // Constructor
+    ParticleEmitter();
+
+    // Allocate room for maxParticles particles and set the texture.
+    // width,height = frame size, 0 for the texture size
+    // ncols = frames in a row of the texture, 0 for 1
+    // Returns false if the memory could not be allocated.
+    bool    initialize(Graphics *g, int width, int height, int ncols,
+                       TextureManager *textureM, UINT maxParticles = particlesNS::MAX_PARTICLES);
+
+    // Add a particle with the emitter colors.
+    // x,y = center, vx,vy = velocity in pixels per second, life = seconds
+    // Returns false if the emitter is full.
+    bool    add(float x, float y, float vx, float vy, float life);
+
+    // Add n particles at the emitter position, as many as there is room for.
+    // Returns the number added.
+    UINT    emit(UINT n);
+
+    // Move the particles by frameTime, remove the dead ones and emit
+    // new ones at the emitter rate.
+    void    update(float frameTime);
+
+    // Draw the particles. In fixed time step mode they are drawn between
+    // their positions at the last two ticks.
+    void    draw();
+
+    // Remove every particle.
+    void    clear()                 {count = 0; emitTime = 0;}
+
+    // Set the center of new particles.
+    void    setPosition(float x, float y)   {posX = x; posY = y;}
+
+    // Set particles emitted per second by update(), 0 to stop.
+    void    setRate(float r)        {rate = r;}
+
+    // Set life of new particles, a random time from lo to hi seconds.
+    void    setLife(float lo, float hi)     {minLife = lo; maxLife = hi;}
+
+    // Set speed of new particles, random from lo to hi pixels per second.
+    void    setSpeed(float lo, float hi)    {minSpeed = lo; maxSpeed = hi;}
+
+    // Set direction of new particles. They leave at a random angle up to
+    // s/2 either side of angle, radians. Use s = 2*PI for all directions
+    // (default).
+    void    setDirection(float angle, float s)  {direction = angle; spread = s;}
+
+    // Set acceleration of every particle, pixels per second per second.
+    void    setGravity(float x, float y)    {gravityX = x; gravityY = y;}
+
+    // Set color at birth and at death. The color of a particle changes
+    // from start to end over its life, alpha too.
+    void    setColors(COLOR_ARGB start, COLOR_ARGB end);
+
+    // Set frame of the texture drawn.
+    void    setFrame(int f)         {frame = f;}
+
+    // Set scale of the particles.
+    void    setScale(float s)       {scale = s;}
+
+    // Set layer of the particles, see SpriteData.
+    void    setLayer(int l)         {layer = l;}
+
+    // Set the random number seed, the same seed emits the same particles.
+    void    setSeed(UINT s)         {seed = s ? s : 1;}
+
+    // Return number of particles alive.
+    UINT    getCount() const        {return count;}
+
+    // Return most particles alive at once.
+    UINT    getCapacity() const     {return capacity;}
+
+    // Return bytes allocated for the particles.
+    size_t  getMemory() const
+    {
+        return memory.size() * sizeof(float) + argb.size() * sizeof(COLOR_ARGB);
+    }
+
+    // Return position and color of particle i, 0 to getCount()-1.
+    float   getX(UINT i) const      {return field(X)[i];}
+    float   getY(UINT i) const      {return field(Y)[i];}
+    float   getLife(UINT i) const   {return field(LIFE)[i];}
+    COLOR_ARGB getColor(UINT i) const {return argb[i];}
+
+    // Use SSE2 if the CPU has it (default), false for the scalar version.
+    // The particles are the same.
+    void    setSimd(bool s);
+
+    // Return true if SSE2 is used.
+    bool    getSimd() const         {return simd;}
+};
+
+#endif
@@ -0,0 +1,62 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// platform.h v1.0
+// Windows types used by the engine.
+// On Windows this simply includes windows.h. On other systems the few Win32
+// types and macros used by the platform independent parts of the engine
+// (sprite batching, software graphics, tools) are defined here so those
+// parts may be built and tested on Linux.
+
+#ifndef _PLATFORM_H             // Prevent multiple definitions if this 
+#define _PLATFORM_H             // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t        DWORD;
+typedef unsigned int    UINT;
+typedef unsigned char   UCHAR;
+typedef unsigned char   BYTE;
+typedef uint16_t        WORD;
+typedef int16_t         SHORT;
+typedef int32_t         LONG;
+typedef int64_t         LONGLONG;
+typedef uint64_t        UINT64;
+typedef int             BOOL;
+typedef int32_t         HRESULT;
+typedef void*           HWND;
+typedef uintptr_t       WPARAM;
+typedef intptr_t        LPARAM;
+typedef intptr_t        LRESULT;
+
+struct RECT
+{
+    LONG    left;
+    LONG    top;
+    LONG    right;
+    LONG    bottom;
+};
+
+#define SUCCEEDED(hr)   (((HRESULT)(hr)) >= 0)
+#define FAILED(hr)      (((HRESULT)(hr)) < 0)
+#define S_OK            ((HRESULT)0)
+#define E_FAIL          ((HRESULT)0x80004005L)
+
+// virtual key codes used in constants.h
+#define VK_RETURN       0x0D
+#define VK_MENU         0x12
+#define VK_ESCAPE       0x1B
+
+// Direct3D is only available on Windows, use the software Graphics class.
+// SOFTWARE_GRAPHICS may also be defined in a Windows build.
+#ifndef SOFTWARE_GRAPHICS
+#define SOFTWARE_GRAPHICS
+#endif
+#endif
+
+#endif
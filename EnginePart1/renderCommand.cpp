@@ -0,0 +1,53 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// renderCommand.cpp v1.0
+// Recorded drawing of one frame, see renderCommand.h
+// The texture type is complete only after graphics.h, so the functions that
+// hold references are here and not in the header.
+
+#include "graphics.h"
+
+//=============================================================================
+// Destructor
+//=============================================================================
+RenderCommandList::~RenderCommandList()
+{
+    clear();
+}
+
+//=============================================================================
+// Remove all commands and release their textures
+// Called by the game thread after the render thread has drawn the list.
+//=============================================================================
+void RenderCommandList::clear()
+{
+    commands.clear();
+    backColorSet = false;
+    spritesCulled = 0;
+    for (size_t i = 0; i < textures.size(); i++)
+        textures[i]->Release();
+    textures.clear();
+    lastTexture = NULL;
+}
+
+//=============================================================================
+// Add a drawSprite() command
+// A reference to the texture is held until clear(), so the texture lives
+// until the render thread has drawn the frame even if its TextureManager
+// releases it first.
+//=============================================================================
+void RenderCommandList::addSprite(const SpriteData &spriteData, COLOR_ARGB color)
+{
+    if (spriteData.texture != lastTexture && spriteData.texture != NULL)
+    {
+        spriteData.texture->AddRef();
+        textures.push_back(spriteData.texture);
+        lastTexture = spriteData.texture;
+    }
+    commands.push_back(RenderCommand());
+    RenderCommand &command = commands.back();
+    command.spriteData = spriteData;
+    command.color = color;
+    command.type = renderCommandNS::SPRITE;
+}
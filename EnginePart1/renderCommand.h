@@ -0,0 +1,102 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// renderCommand.h v1.0
+// A RenderCommandList records the drawing of one frame so it can be drawn
+// later, by another thread. While Graphics::setRecording() is set the
+// Graphics functions called by render() add commands here instead of drawing.
+// The list holds a reference to each texture it draws until it is cleared,
+// so a TextureManager may release its texture while the render thread still
+// draws a frame that uses it. See renderQueue.h.
+
+#ifndef _RENDERCOMMAND_H        // Prevent multiple definitions if this
+#define _RENDERCOMMAND_H        // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+#include "spriteData.h"
+
+namespace renderCommandNS
+{
+    const UINT START_SIZE = 1024;   // commands reserved, the list grows when needed
+
+    enum TYPE {SPRITE_BEGIN, SPRITE, SPRITE_END};
+}
+
+// One recorded Graphics call.
+// The sprite holds the texture, rect and transform of the sprite to draw.
+// The texture is kept by a reference held by the list.
+struct RenderCommand
+{
+    SpriteData  spriteData;     // SPRITE only
+    COLOR_ARGB  color;          // SPRITE only, color filter
+    renderCommandNS::TYPE type;
+};
+
+class RenderCommandList
+{
+  private:
+    std::vector<RenderCommand> commands;
+    COLOR_ARGB  backColor;      // set by setBackColor() this frame
+    bool        backColorSet;   // true if setBackColor() was called
+    UINT        spritesCulled;  // sprites rejected by Graphics::inViewport()
+    std::vector<LP_TEXTURE> textures;   // textures with a reference held by the list
+    LP_TEXTURE  lastTexture;    // last texture added to textures
+
+    // A list holds texture references, it is not copied.
+    RenderCommandList(const RenderCommandList &);
+    RenderCommandList& operator=(const RenderCommandList &);
+
+  public:
+    // Constructor
+    RenderCommandList() : backColor(0), backColorSet(false), spritesCulled(0), lastTexture(NULL)
+    {
+        commands.reserve(renderCommandNS::START_SIZE);
+    }
+
+    // Destructor, releases the textures
+    ~RenderCommandList();
+
+    // Remove all commands and release their textures. Memory is kept for the
+    // next frame.
+    void clear();
+
+    // Add a spriteBegin() or spriteEnd() command.
+    void add(renderCommandNS::TYPE type)
+    {
+        RenderCommand command;
+        command.type = type;
+        command.color = 0;
+        commands.push_back(command);
+    }
+
+    // Add a drawSprite() command and hold a reference to its texture.
+    // Sprites in a row with the same texture share one reference.
+    void addSprite(const SpriteData &spriteData, COLOR_ARGB color);
+
+    // Record the color used to clear the screen.
+    void setBackColor(COLOR_ARGB c) {backColor = c; backColorSet = true;}
+
+    // Count a culled sprite.
+    void addCulled()                {spritesCulled++;}
+
+    // Return number of commands.
+    UINT getSize() const            {return (UINT)commands.size();}
+
+    // Return command i.
+    const RenderCommand& get(UINT i) const {return commands[i];}
+
+    // Return true if setBackColor() was called.
+    bool getBackColorSet() const    {return backColorSet;}
+
+    // Return the recorded back color.
+    COLOR_ARGB getBackColor() const {return backColor;}
+
+    // Return number of culled sprites.
+    UINT getSpritesCulled() const   {return spritesCulled;}
+
+    // Return number of texture references held.
+    UINT getTextureRefs() const     {return (UINT)textures.size();}
+};
+
+#endif
@@ -0,0 +1,161 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// renderQueue.cpp v1.0
+// Render thread that draws frames recorded by the game thread.
+
+#include "renderQueue.h"
+#include <chrono>
+
+//=============================================================================
+// Constructor
+//=============================================================================
+RenderQueue::RenderQueue()
+{
+    graphics = NULL;
+    textureLoader = NULL;
+    textureResidency = NULL;
+    recorded.store(0);
+    drawn.store(0);
+    stopping.store(false);
+    deviceLost.store(false);
+    running = false;
+    inFrame = false;
+    waits = 0;
+}
+
+//=============================================================================
+// Destructor
+//=============================================================================
+RenderQueue::~RenderQueue()
+{
+    stop();
+}
+
+//=============================================================================
+// One step of waiting
+// Spin first since the other thread is usually almost done, then yield the
+// rest of the time slice, then sleep so a long wait does not use a CPU.
+//=============================================================================
+void RenderQueue::backoff(UINT &count)
+{
+    count++;
+    if (count < renderQueueNS::SPIN_COUNT)
+        return;
+    if (count < renderQueueNS::YIELD_COUNT)
+        std::this_thread::yield();
+    else
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+//=============================================================================
+// Start the render thread
+// Returns false if already running or the thread could not be created
+//=============================================================================
+bool RenderQueue::start(Graphics *g)
+{
+    if (running || g == NULL)
+        return false;
+    graphics = g;
+    recorded.store(0);
+    drawn.store(0);
+    stopping.store(false);
+    deviceLost.store(false);
+    inFrame = false;
+    waits = 0;
+    try{
+        thread = std::thread(&RenderQueue::threadMain, this);
+    }
+    catch(...) {return false;}
+    running = true;
+    return true;
+}
+
+//=============================================================================
+// Draw the recorded frames and stop the render thread
+//=============================================================================
+void RenderQueue::stop()
+{
+    if (!running)
+        return;
+    inFrame = false;            // a frame still being recorded is not drawn
+    finish();
+    stopping.store(true);
+    thread.join();
+    running = false;
+}
+
+//=============================================================================
+// Render thread
+// Draws each recorded frame in order, then uploads loaded textures. recorded is read with acquire so the
+// commands written by the game thread are visible, drawn is written with
+// release so the game thread may reuse the list.
+//=============================================================================
+void RenderQueue::threadMain()
+{
+    UINT count = 0;
+    for (;;)
+    {
+        UINT frame = drawn.load(std::memory_order_relaxed);
+        if (recorded.load(std::memory_order_acquire) == frame)
+        {
+            if (stopping.load())
+                return;
+            backoff(count);
+            continue;
+        }
+        count = 0;
+        graphics->replay(lists[frame & 1]);
+        graphics->showBackbuffer();
+        if (textureLoader)          // the render thread owns the device
+            textureLoader->update();
+        if (textureResidency)
+            textureResidency->update();
+        if (FAILED(graphics->getDeviceState()))
+            deviceLost.store(true);
+        drawn.store(frame + 1, std::memory_order_release);
+    }
+}
+
+//=============================================================================
+// Start recording a frame
+// Frame n is recorded into lists[n & 1], which held frame n-2. The render
+// thread must be done with frame n-2 before it is cleared.
+//=============================================================================
+RenderCommandList& RenderQueue::beginFrame()
+{
+    UINT frame = recorded.load(std::memory_order_relaxed);
+    if (frame >= 2 && drawn.load(std::memory_order_acquire) < frame - 1)
+    {
+        waits++;
+        UINT count = 0;
+        while (drawn.load(std::memory_order_acquire) < frame - 1)
+            backoff(count);
+    }
+    inFrame = true;
+    lists[frame & 1].clear();
+    return lists[frame & 1];
+}
+
+//=============================================================================
+// Pass the recorded frame to the render thread
+//=============================================================================
+void RenderQueue::endFrame()
+{
+    if (!inFrame)
+        return;
+    inFrame = false;
+    recorded.store(recorded.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+//=============================================================================
+// Wait until every recorded frame is drawn
+//=============================================================================
+void RenderQueue::finish()
+{
+    if (!running)
+        return;
+    UINT count = 0;
+    while (drawn.load(std::memory_order_acquire) != recorded.load(std::memory_order_relaxed))
+        backoff(count);
+}
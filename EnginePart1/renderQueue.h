@@ -0,0 +1,106 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// renderQueue.h v1.0
+// A RenderQueue runs a render thread that draws frames recorded by the game
+// thread. There are two RenderCommandLists. The game thread records frame n
+// into one list while the render thread draws frame n-1 from the other, so
+// the time of a frame is the longer of simulation and drawing instead of the
+// sum. The lists are handed over with two atomic frame counters, no locks.
+// Game::run uses this when Game::startRenderThread() was called.
+
+#ifndef _RENDERQUEUE_H          // Prevent multiple definitions if this
+#define _RENDERQUEUE_H          // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <atomic>
+#include <thread>
+#include "graphics.h"
+#include "renderCommand.h"
+#include "textureLoader.h"
+#include "textureResidency.h"
+
+namespace renderQueueNS
+{
+    const UINT SPIN_COUNT = 200;    // checks before a waiting thread starts to yield
+    const UINT YIELD_COUNT = 2000;  // yields before a waiting thread sleeps 1 ms
+}
+
+class RenderQueue
+{
+  private:
+    Graphics *graphics;
+    TextureLoader *textureLoader;   // uploads textures after each frame, may be NULL
+    TextureResidency *textureResidency; // evicts textures after each frame, may be NULL
+    RenderCommandList lists[2];     // frame n uses lists[n & 1]
+    std::atomic<UINT> recorded;     // frames finished by endFrame()
+    std::atomic<UINT> drawn;        // frames drawn by the render thread
+    std::atomic<bool> stopping;     // tells the render thread to exit
+    std::atomic<bool> deviceLost;   // set by the render thread if the device fails
+    std::thread thread;
+    bool    running;
+    bool    inFrame;                // true between beginFrame() and endFrame()
+    UINT    waits;                  // beginFrame() calls that waited for the render thread
+
+    // Render thread main loop.
+    void threadMain();
+
+    // Wait step for a thread that is waiting. Spins, then yields, then sleeps.
+    static void backoff(UINT &count);
+
+  public:
+    // Constructor
+    RenderQueue();
+
+    // Destructor, stops the render thread
+    virtual ~RenderQueue();
+
+    // Start the render thread drawing with g.
+    // Returns false if already running or the thread could not be created.
+    bool start(Graphics *g);
+
+    // Draw the frames already recorded and stop the render thread.
+    // A frame started by beginFrame() without endFrame() is dropped.
+    void stop();
+
+    // Upload the textures decoded by l on the render thread after each frame.
+    // Call before start(). NULL for none.
+    void setTextureLoader(TextureLoader *l) {textureLoader = l;}
+
+    // Evict textures over the budget of r on the render thread after each
+    // frame. Call before start(). NULL for none.
+    void setTextureResidency(TextureResidency *r) {textureResidency = r;}
+
+    // Return true if the render thread is running.
+    bool isRunning() const {return running;}
+
+    // Start recording a frame. Game thread only.
+    // Waits if the render thread is still drawing the list, which is the one
+    // recorded two frames ago. Returns the cleared list to record into.
+    RenderCommandList& beginFrame();
+
+    // Finish recording the frame and pass it to the render thread.
+    void endFrame();
+
+    // Wait until the render thread has drawn every recorded frame.
+    // Call before the game thread uses the graphics device itself, for
+    // example before releasing textures or resetting the device.
+    void finish();
+
+    // Return true if the graphics device state failed after a frame.
+    bool getDeviceLost() const {return deviceLost.load();}
+
+    // Clear the device lost flag after the device was handled.
+    void clearDeviceLost()     {deviceLost.store(false);}
+
+    // Return number of frames recorded.
+    UINT getFramesRecorded() const {return recorded.load();}
+
+    // Return number of frames drawn.
+    UINT getFramesDrawn() const    {return drawn.load();}
+
+    // Return number of times beginFrame() had to wait for the render thread.
+    UINT getWaits() const          {return waits;}
+};
+
+#endif
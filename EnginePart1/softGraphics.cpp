@@ -0,0 +1,354 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// softGraphics.cpp v1.0
+// Software implementation of the Graphics class, see softGraphics.h
+
+#include "graphics.h"
+#include "imageFile.h"
+
+#ifdef SOFTWARE_GRAPHICS         // see graphics.cpp for Direct3D
+
+#include <stdio.h>
+#include <math.h>
+
+//=============================================================================
+// Multiply two 0-255 color channels, result is 0-255
+//=============================================================================
+static inline UINT mulChannel(UINT a, UINT b)
+{
+    UINT t = a*b + 128;
+    return (t + (t >> 8)) >> 8;     // exact a*b/255 rounded
+}
+
+//=============================================================================
+// Constructor
+//=============================================================================
+Graphics::Graphics()
+{
+    inScene = false;
+    frameCount = 0;
+}
+
+//=============================================================================
+// Destructor
+//=============================================================================
+Graphics::~Graphics()
+{
+    releaseAll();
+}
+
+//=============================================================================
+// Release all
+//=============================================================================
+void Graphics::releaseAll()
+{
+    std::vector<COLOR_ARGB>().swap(backbuffer);     // free memory
+}
+
+//=============================================================================
+// Initialize software graphics
+// throws GameError on error
+//=============================================================================
+void Graphics::initialize(HWND hw, int w, int h, bool full)
+{
+    hwnd = hw;
+    width = w;
+    height = h;
+    fullscreen = full;
+
+    if (width <= 0 || height <= 0)
+        throw(GameError(gameErrorNS::FATAL_ERROR, "Invalid software graphics size"));
+    try{
+        backbuffer.assign(width*height, backColor);
+    } catch(...)
+    {
+        throw(GameError(gameErrorNS::FATAL_ERROR, "Error creating software backbuffer"));
+    }
+}
+
+//=============================================================================
+// Decode an image file in memory into premultiplied pixels
+// Returns HRESULT
+//=============================================================================
+HRESULT Graphics::decodeTexture(const BYTE *data, size_t size, COLOR_ARGB transcolor,
+                                UINT &width, UINT &height, std::vector<COLOR_ARGB> &pixels,
+                                SpriteSheet *sheet)
+{
+    UINT w, h;
+    if (!ImageFile::load(data, size, transcolor, w, h, pixels, sheet))
+        return E_FAIL;
+    width = w;
+    height = h;
+    return S_OK;
+}
+
+//=============================================================================
+// Load the texture into system memory
+// For internal engine use only. Use the TextureManager class to load game textures.
+// A cooked texture is created from the file data, with the mip levels
+// stored in it when it has them.
+// Pre: filename is name of texture file.
+//      transcolor is transparent color
+// Post: width and height = size of texture
+//       texture points to texture
+//       *sheet = frames of a cooked sprite sheet, if sheet is not NULL
+// Returns HRESULT
+//=============================================================================
+HRESULT Graphics::loadTexture(const char *filename, COLOR_ARGB transcolor,
+                              UINT &width, UINT &height, LP_TEXTURE &texture,
+                              SpriteSheet *sheet)
+{
+    std::vector<BYTE> buffer;
+    const BYTE *data;
+    size_t size;
+    texture = NULL;
+    HRESULT hr = E_FAIL;
+    if(filename == NULL)
+        return graphicsNS::E_INVALIDCALL;
+    if (!ImageFile::read(assetPack, filename, buffer, data, size))
+        return hr;
+
+    const CookedHeader *cooked = ImageFile::getCooked(data, size);
+    if (cooked)                         // already in texture format
+    {
+        hr = createTexture(ImageFile::getCookedPixels(cooked), cooked->width,
+                           cooked->height, texture, cooked->levels > 1 ? cooked->levels : 0,
+                           ImageFile::getCookedMips(cooked));
+        if (FAILED(hr))
+            return hr;
+        width = cooked->width;
+        height = cooked->height;
+        if (sheet)
+            ImageFile::getCookedSheet(cooked, *sheet);
+        return hr;
+    }
+
+    std::vector<COLOR_ARGB> pixels;
+    UINT w, h;
+    hr = decodeTexture(data, size, transcolor, w, h, pixels, sheet);
+    if (FAILED(hr))
+        return hr;
+    hr = createTexture(&pixels[0], w, h, texture);
+    if (SUCCEEDED(hr))
+    {
+        width = w;
+        height = h;
+    }
+    return hr;
+}
+
+//=============================================================================
+// Create a texture from ARGB pixels in memory
+// With mipmaps the mip levels are copied from chain, or made from the pixels
+// when chain is NULL.
+//=============================================================================
+HRESULT Graphics::createTexture(const COLOR_ARGB *pixels, UINT w, UINT h, LP_TEXTURE &texture,
+                                UINT maxLevels, const COLOR_ARGB *chain)
+{
+    texture = NULL;
+    if (pixels == NULL || w == 0 || h == 0 || w > maxTextureSize || h > maxTextureSize)
+        return graphicsNS::E_INVALIDCALL;
+    try{
+        texture = new SoftTexture(w, h);
+        texture->pixels.assign(pixels, pixels + w*h);
+        UINT levels = getMipLevels(w, h);
+        if (maxLevels > 0 && levels > maxLevels)
+            levels = maxLevels;
+        if (levels > 1)
+            texture->buildMips(levels, chain);
+    } catch(...)
+    {
+        SAFE_RELEASE(texture);
+        return E_FAIL;
+    }
+    return S_OK;
+}
+
+//=============================================================================
+// Finish the frame
+//=============================================================================
+HRESULT Graphics::showBackbuffer()
+{
+    result = E_FAIL;    // default to fail, replace on success
+    if (backbuffer.empty())
+        return result;
+    frameCount++;
+    result = S_OK;
+    return result;
+}
+
+//=============================================================================
+// Draw one sprite now
+// transform is the sprite transform from Transform2D, the same one the
+// Direct3D version uses. Each backbuffer pixel inside the sprite is mapped
+// back to the texture and the nearest texel is alpha blended with the color
+// filter applied. Texels and the filter are premultiplied by alpha, so the
+// blend is texel + backbuffer*(1-alpha).
+// The texture mip level is the one with about one texel per pixel: each
+// halving of the sprite size in both directions moves one level down.
+//=============================================================================
+void Graphics::submitSprite(const SpriteData &spriteData, COLOR_ARGB color,
+                            const Affine2D &transform)
+{
+    const SoftTexture *texture = spriteData.texture;
+    if(texture == NULL || backbuffer.empty())
+        return;
+    int srcWidth = spriteData.rect.right - spriteData.rect.left;
+    int srcHeight = spriteData.rect.bottom - spriteData.rect.top;
+    float det = transform.m11*transform.m22 - transform.m12*transform.m21;
+    if (srcWidth <= 0 || srcHeight <= 0 || det == 0)
+        return;
+
+    // Screen bounds of the transformed sprite
+    Quad2D quad;
+    Transform2D::affineCorners(transform, (float)srcWidth, (float)srcHeight, quad);
+    float minX = quad.x[0], minY = quad.y[0], maxX = quad.x[0], maxY = quad.y[0];
+    for (int i = 1; i < 4; i++)
+    {
+        if (quad.x[i] < minX) minX = quad.x[i];
+        if (quad.x[i] > maxX) maxX = quad.x[i];
+        if (quad.y[i] < minY) minY = quad.y[i];
+        if (quad.y[i] > maxY) maxY = quad.y[i];
+    }
+    int x0 = (int)floorf(minX);
+    int y0 = (int)floorf(minY);
+    int x1 = (int)ceilf(maxX);
+    int y1 = (int)ceilf(maxY);
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > width) x1 = width;
+    if (y1 > height) y1 = height;
+    if (x0 >= x1 || y0 >= y1)
+        return;                         // off screen
+
+    // Inverse transform, texture coordinates change linearly across the screen
+    float duDx =  transform.m22/det, duDy = -transform.m21/det;
+    float dvDx = -transform.m12/det, dvDy =  transform.m11/det;
+    float rx = x0 + 0.5f - transform.dx;
+    float ry = y0 + 0.5f - transform.dy;
+    float rowU = rx*duDx + ry*duDy;
+    float rowV = rx*dvDx + ry*dvDy;
+
+    // det is the screen area of one texel
+    UINT level = 0;
+    float area = fabsf(det);
+    while (area <= 0.25f && level+1 < texture->levels)
+    {
+        area *= 4;
+        level++;
+    }
+    const COLOR_ARGB *pixels = texture->levelPixels.empty() ? &texture->pixels[0]
+                                                            : texture->levelPixels[level];
+    int levelWidth = Mipmap::getLevelSize(texture->width, level);
+    int levelHeight = Mipmap::getLevelSize(texture->height, level);
+
+    color = premultiplyColor(color);
+    UINT filterA = (color >> 24) & 0xff;
+    UINT filterR = (color >> 16) & 0xff;
+    UINT filterG = (color >> 8) & 0xff;
+    UINT filterB = color & 0xff;
+    bool noFilter = (color == graphicsNS::WHITE);
+
+    for (int y = y0; y < y1; y++, rowU += duDy, rowV += dvDy)
+    {
+        COLOR_ARGB *dest = &backbuffer[y*width];
+        float u = rowU, v = rowV;
+        for (int x = x0; x < x1; x++, u += duDx, v += dvDx)
+        {
+            if (u < 0 || v < 0 || u >= srcWidth || v >= srcHeight)
+                continue;               // outside sprite
+            int tx = spriteData.rect.left + (int)u;
+            int ty = spriteData.rect.top + (int)v;
+            if (tx < 0 || ty < 0 || tx >= (int)texture->width || ty >= (int)texture->height)
+                continue;               // rect outside texture
+            tx >>= level;
+            ty >>= level;
+            if (tx >= levelWidth) tx = levelWidth-1;    // odd size, last column dropped
+            if (ty >= levelHeight) ty = levelHeight-1;
+            COLOR_ARGB texel = pixels[ty*levelWidth + tx];
+            UINT a = texel >> 24;
+            UINT r = (texel >> 16) & 0xff;
+            UINT g = (texel >> 8) & 0xff;
+            UINT b = texel & 0xff;
+            if (!noFilter)
+            {
+                a = mulChannel(a, filterA);
+                r = mulChannel(r, filterR);
+                g = mulChannel(g, filterG);
+                b = mulChannel(b, filterB);
+            }
+            if (a == 0)
+                continue;               // transparent
+            if (a < 255)                // alpha blend with backbuffer
+            {
+                COLOR_ARGB d = dest[x];
+                r += mulChannel((d >> 16) & 0xff, 255-a);
+                g += mulChannel((d >> 8) & 0xff, 255-a);
+                b += mulChannel(d & 0xff, 255-a);
+                if (r > 255) r = 255;   // only if a texel has color > alpha
+                if (g > 255) g = 255;
+                if (b > 255) b = 255;
+            }
+            dest[x] = SETCOLOR_ARGB(255, r, g, b);
+        }
+    }
+}
+
+//=============================================================================
+// Toggle window or fullscreen mode
+// Only the fullscreen setting changes, there is no window.
+//=============================================================================
+void Graphics::changeDisplayMode(graphicsNS::DISPLAY_MODE mode)
+{
+    switch(mode)
+    {
+    case graphicsNS::FULLSCREEN:
+        fullscreen = true; break;
+    case graphicsNS::WINDOW:
+        fullscreen = false; break;
+    default:        // default to toggle window/fullscreen
+        fullscreen = !fullscreen;
+    }
+}
+
+//=============================================================================
+// Save the backbuffer as an uncompressed 32 bit .tga file
+// Returns false on error
+//=============================================================================
+bool Graphics::saveBackbuffer(const char *filename) const
+{
+    if (backbuffer.empty() || filename == NULL)
+        return false;
+    FILE *file = fopen(filename, "wb");
+    if (file == NULL)
+        return false;
+
+    BYTE header[18] = {0};
+    header[2] = 2;                      // uncompressed true color
+    header[12] = width & 0xff;
+    header[13] = (width >> 8) & 0xff;
+    header[14] = height & 0xff;
+    header[15] = (height >> 8) & 0xff;
+    header[16] = 32;                    // bits per pixel
+    header[17] = 0x28;                  // top left origin, 8 alpha bits
+    bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+    std::vector<BYTE> row(width*4);
+    for (int y = 0; ok && y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            COLOR_ARGB c = backbuffer[y*width + x];
+            row[x*4]   = c & 0xff;          // B
+            row[x*4+1] = (c >> 8) & 0xff;   // G
+            row[x*4+2] = (c >> 16) & 0xff;  // R
+            row[x*4+3] = (c >> 24) & 0xff;  // A
+        }
+        ok = fwrite(&row[0], 1, row.size(), file) == row.size();
+    }
+    fclose(file);
+    return ok;
+}
+
+#endif  // SOFTWARE_GRAPHICS
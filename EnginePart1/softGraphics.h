@@ -0,0 +1,205 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// softGraphics.h v1.0
+// Graphics class that draws into a CPU ARGB framebuffer instead of Direct3D.
+// Used when SOFTWARE_GRAPHICS is defined (always on Linux). It has the same
+// functions as the Direct3D Graphics class so the rest of the engine does not
+// change. The functions that do not use the device are in graphicsBase.h.
+// Nothing is displayed, the backbuffer may be read or saved to a file for
+// dedicated servers, image tests and timing runs without a display.
+// Include graphics.h, not this file.
+
+#ifndef _SOFTGRAPHICS_H         // Prevent multiple definitions if this
+#define _SOFTGRAPHICS_H         // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <atomic>
+#include <vector>
+
+// A texture in system memory. Pixels are ARGB, row by row from the top.
+// Reference counted like a Direct3D texture so SAFE_RELEASE works.
+class SoftTexture
+{
+  private:
+    std::atomic<UINT> refCount;
+    ~SoftTexture() {}           // use Release()
+
+  public:
+    UINT    width;              // width in pixels
+    UINT    height;             // height in pixels
+    std::vector<COLOR_ARGB> pixels;
+    UINT    levels;             // mip levels including pixels, see mipmap.h
+    std::vector<COLOR_ARGB> mips;   // levels 1 to levels-1, largest first
+    std::vector<const COLOR_ARGB*> levelPixels;    // start of each level
+
+    // Create a width x height texture filled with 0 (transparent black)
+    SoftTexture(UINT w, UINT h) : refCount(1), width(w), height(h), pixels(w*h, 0), levels(1) {}
+
+    // Make mip levels from pixels, or copy them from chain if it is not NULL.
+    // Pre: chain holds levels 1 to count-1 made by Mipmap::build()
+    void buildMips(UINT count, const COLOR_ARGB *chain = NULL)
+    {
+        levels = count;
+        mips.resize(Mipmap::getChainSize(width, height, levels));
+        if (!mips.empty() && chain)
+            mips.assign(chain, chain + mips.size());
+        else if (!mips.empty())
+            Mipmap::build(&pixels[0], width, height, levels, &mips[0]);
+        levelPixels.resize(levels);
+        levelPixels[0] = &pixels[0];
+        const COLOR_ARGB *level = mips.empty() ? NULL : &mips[0];
+        for (UINT n = 1; n < levels; n++)
+        {
+            levelPixels[n] = level;
+            level += (size_t)Mipmap::getLevelSize(width, n)*Mipmap::getLevelSize(height, n);
+        }
+    }
+
+    // Add a reference. Returns new reference count.
+    // The count is atomic, render command lists hold references on the game
+    // thread while the render thread draws.
+    UINT AddRef()   {return ++refCount;}
+
+    // Remove a reference, deletes the texture when there are none left.
+    // Returns new reference count.
+    UINT Release()
+    {
+        UINT count = --refCount;
+        if (count == 0)
+            delete this;
+        return count;
+    }
+};
+
+class Graphics : public GraphicsBase
+{
+private:
+    std::vector<COLOR_ARGB> backbuffer;     // width*height ARGB pixels
+    bool        inScene;        // true between beginScene() and endScene()
+    UINT        frameCount;     // number of showBackbuffer() calls
+
+    // Decode an image file in memory into premultiplied ARGB pixels.
+    virtual HRESULT decodeTexture(const BYTE *data, size_t size, COLOR_ARGB transcolor,
+                                  UINT &width, UINT &height, std::vector<COLOR_ARGB> &pixels,
+                                  SpriteSheet *sheet);
+
+    // Start drawing sprites.
+    virtual void beginSprites()     {inSprite = true;}
+
+    // Draw the batched sprites, if any.
+    virtual void endSprites()
+    {
+        spriteBatch.flush(*this);
+        inSprite = false;
+    }
+
+public:
+    // Constructor
+    Graphics();
+
+    // Destructor
+    virtual ~Graphics();
+
+    // Releases the backbuffer.
+    void    releaseAll();
+
+    // Initialize software graphics
+    // Throws GameError on error
+    // Pre: hw = handle to window, may be NULL, saved for compatibility
+    //      width = width in pixels
+    //      height = height in pixels
+    //      fullscreen = saved, has no effect
+    void    initialize(HWND hw, int width, int height, bool fullscreen);
+
+    // Load the texture into system memory.
+    // For internal engine use only. Use the TextureManager class to load game textures.
+    // Uncompressed 24 and 32 bit .bmp and .tga files and cooked textures are
+    // supported. Colors are premultiplied by alpha, see imageFile.h.
+    // Pre: filename = name of texture file.
+    //      transcolor = transparent color, pixels with this RGB get 0 alpha
+    // Post: width and height = size of texture
+    //       texture points to texture
+    //       *sheet = frames of a cooked sprite sheet, if sheet is not NULL
+    HRESULT loadTexture(const char * filename, COLOR_ARGB transcolor, UINT &width, UINT &height,
+                        LP_TEXTURE &texture, SpriteSheet *sheet = NULL);
+
+    // Create a texture from ARGB pixels in memory.
+    // Pre: pixels points to w*h premultiplied ARGB values, row by row from the top.
+    //      maxLevels = most mip levels, 0 for getMipLevels(w,h)
+    //      chain = mip levels 1 to maxLevels-1 made by Mipmap::build(), or
+    //      NULL to make them here
+    // Post: texture points to texture
+    // Fails if w or h is over getMaxTextureSize().
+    HRESULT createTexture(const COLOR_ARGB *pixels, UINT w, UINT h, LP_TEXTURE &texture,
+                          UINT maxLevels = 0, const COLOR_ARGB *chain = NULL);
+
+    // Finish the frame. Nothing is displayed.
+    HRESULT showBackbuffer();
+
+    // Any size is compatible with a software framebuffer.
+    bool    isAdapterCompatible()   {return true;}
+
+    // SpriteBatchBackend function, called by SpriteBatch::flush().
+    // Draw one sprite now using transform.
+    virtual void submitSprite(const SpriteData &spriteData, COLOR_ARGB color,
+                              const Affine2D &transform);
+
+    // Reset the graphics device. Always succeeds.
+    HRESULT reset()                 {return S_OK;}
+
+    // Toggle, fullscreen or window display mode. Only the setting changes.
+    void    changeDisplayMode(graphicsNS::DISPLAY_MODE mode = graphicsNS::TOGGLE);
+
+    // get functions
+    // Return pointer to the backbuffer, width*height ARGB pixels.
+    const COLOR_ARGB* getBackbuffer() const {return backbuffer.empty() ? NULL : &backbuffer[0];}
+
+    // Return number of frames shown.
+    UINT    getFrameCount() const   {return frameCount;}
+
+    // The software device is never lost.
+    HRESULT getDeviceState()        {return backbuffer.empty() ? E_FAIL : S_OK;}
+
+    // Return number of mip levels createTexture() makes for a w x h texture,
+    // 1 without mipmaps. Any size can be mipped in software.
+    UINT getMipLevels(UINT w, UINT h) {return mipmaps ? Mipmap::getLevelCount(w, h) : 1;}
+
+    // Set the largest texture width and height createTexture() accepts, to
+    // run as on a device with a smaller limit than graphicsNS::MAX_TEXTURE_SIZE.
+    void setMaxTextureSize(UINT size) {maxTextureSize = size;}
+
+    // Save the backbuffer as an uncompressed 32 bit .tga file.
+    // Returns false on error.
+    bool    saveBackbuffer(const char *filename) const;
+
+    //=============================================================================
+    // Clear backbuffer and begin scene
+    //=============================================================================
+    virtual HRESULT beginScene()
+    {
+        result = E_FAIL;
+        if(backbuffer.empty())
+            return result;
+        spriteBatch.resetStats();   // new frame
+        spritesSubmitted = 0;
+        spritesCulled = 0;
+        // clear backbuffer to backColor
+        backbuffer.assign(backbuffer.size(), backColor);
+        inScene = true;
+        result = S_OK;
+        return result;
+    }
+
+    //=============================================================================
+    // End scene
+    //=============================================================================
+    virtual HRESULT endScene()
+    {
+        result = inScene ? S_OK : E_FAIL;
+        inScene = false;
+        return result;
+    }
+};
+
+#endif
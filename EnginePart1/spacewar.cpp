@@ -28,15 +28,25 @@ Spacewar::~Spacewar()
 void Spacewar::initialize(HWND hwnd)
 {
     Game::initialize(hwnd); // throws GameError
+    graphics->setBatching(true);    // sort sprites by layer and texture
+    setTickRate(TICK_RATE);         // fixed time step, drawing is interpolated
+
+    // texture atlas, both images share one texture
+    if (!atlas.initialize(graphics))
+        throw(GameError(gameErrorNS::FATAL_ERROR, "Error initializing texture atlas"));
 
     // nebula texture
-    if (!nebulaTexture.initialize(graphics,NEBULA_IMAGE))
+    if (!nebulaTexture.initialize(graphics,NEBULA_IMAGE,&atlas))
         throw(GameError(gameErrorNS::FATAL_ERROR, "Error initializing nebula texture"));
 
     // planet texture
-    if (!planetTexture.initialize(graphics,PLANET_IMAGE))
+    if (!planetTexture.initialize(graphics,PLANET_IMAGE,&atlas))
         throw(GameError(gameErrorNS::FATAL_ERROR, "Error initializing planet texture"));
 
+    // pack the textures into the atlas page
+    if (!atlas.build())
+        throw(GameError(gameErrorNS::FATAL_ERROR, "Error building texture atlas"));
+
     // nebula
     if (!nebula.initialize(graphics,0,0,0,&nebulaTexture))
         throw(GameError(gameErrorNS::FATAL_ERROR, "Error initializing nebula"));
@@ -44,10 +54,15 @@ void Spacewar::initialize(HWND hwnd)
     // planet
     if (!planet.initialize(graphics,0,0,0,&planetTexture))
         throw(GameError(gameErrorNS::FATAL_ERROR, "Error initializing planet"));
+    planet.setLayer(1);             // draw planet on top of nebula
     // place planet in center of screen
     planet.setX(GAME_WIDTH*0.5f  - planet.getWidth()*0.5f);
     planet.setY(GAME_HEIGHT*0.5f - planet.getHeight()*0.5f);
 
+    // draw on a render thread while the next frame is updated
+    if (!startRenderThread())
+        throw(GameError(gameErrorNS::FATAL_ERROR, "Error starting render thread"));
+
     return;
 }
 
@@ -102,6 +117,7 @@ void Spacewar::releaseAll()
 {
     planetTexture.onLostDevice();
     nebulaTexture.onLostDevice();
+    atlas.onLostDevice();
 
     Game::releaseAll();
     return;
@@ -113,6 +129,7 @@ void Spacewar::releaseAll()
 //=============================================================================
 void Spacewar::resetAll()
 {
+    atlas.onResetDevice();
     nebulaTexture.onResetDevice();
     planetTexture.onResetDevice();
 
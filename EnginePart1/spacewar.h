@@ -18,6 +18,7 @@ class Spacewar : public Game
 {
 private:
     // game items
+    TextureAtlas   atlas;           // page holding the nebula and planet textures
     TextureManager nebulaTexture;   // nebula texture
     TextureManager planetTexture;   // planet texture
     Image   planet;                 // planet image
@@ -0,0 +1,107 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// spriteBatch.cpp v1.0
+
+#include <algorithm>
+#include "spriteBatch.h"
+
+//=============================================================================
+// default constructor
+//=============================================================================
+SpriteBatch::SpriteBatch()
+{
+    items.reserve(spriteBatchNS::START_SIZE);
+    keys.reserve(spriteBatchNS::START_SIZE);
+    resetStats();
+}
+
+//=============================================================================
+// Add a sprite to the batch
+//=============================================================================
+void SpriteBatch::add(const SpriteData &spriteData, COLOR_ARGB color)
+{
+    if (spriteData.texture == NULL)     // if no texture, nothing to draw
+        return;
+    Item item;
+    item.spriteData = spriteData;
+    item.color = color;
+    items.push_back(item);
+}
+
+//=============================================================================
+// Sort the batch by layer and texture and submit it to backend.
+// Sprites with the same layer and texture keep the order they were added.
+// Returns the number of sprites submitted.
+//=============================================================================
+UINT SpriteBatch::flush(SpriteBatchBackend &backend)
+{
+    UINT count = (UINT)items.size();
+    if (count == 0)
+        return 0;
+
+    // build sort keys, counting the texture switches of the unsorted batch
+    keys.resize(count);
+    size_t lastTexture = 0;
+    for (UINT i = 0; i < count; i++)
+    {
+        keys[i].layer = items[i].spriteData.layer;
+        keys[i].texture = (size_t)items[i].spriteData.texture;
+        keys[i].index = i;
+        if (i == 0 || keys[i].texture != lastTexture)
+            unsortedSwitches++;
+        lastTexture = keys[i].texture;
+    }
+
+    // the index tie breaker makes std::sort stable
+    std::sort(keys.begin(), keys.end());
+
+    // transform all sprites in sorted order
+    x.resize(count);
+    y.resize(count);
+    scale.resize(count);
+    angle.resize(count);
+    width.resize(count);
+    height.resize(count);
+    flip.resize(count);
+    transforms.resize(count);
+    for (UINT i = 0; i < count; i++)
+    {
+        const SpriteData &sd = items[keys[i].index].spriteData;
+        x[i] = sd.x;
+        y[i] = sd.y;
+        scale[i] = sd.scale;
+        angle[i] = sd.angle;
+        width[i] = sd.width;
+        height[i] = sd.height;
+        flip[i] = (sd.flipHorizontal ? transform2DNS::FLIP_HORIZONTAL : 0) |
+                  (sd.flipVertical ? transform2DNS::FLIP_VERTICAL : 0);
+    }
+    TransformArrays in = {&x[0], &y[0], &scale[0], &angle[0], &width[0], &height[0], &flip[0]};
+    transform.affine(in, &transforms[0], count);
+
+    // submit runs of sprites that share a texture
+    for (UINT i = 0; i < count; i++)
+    {
+        const Item &item = items[keys[i].index];
+        if (i == 0 || keys[i].texture != keys[i-1].texture)
+        {
+            backend.setBatchTexture(item.spriteData.texture);
+            textureSwitches++;
+        }
+        backend.submitSprite(item.spriteData, item.color, transforms[i]);
+    }
+    spritesDrawn += count;
+    clear();
+    return count;
+}
+
+//=============================================================================
+// Clear the statistics
+//=============================================================================
+void SpriteBatch::resetStats()
+{
+    spritesDrawn = 0;
+    textureSwitches = 0;
+    unsortedSwitches = 0;
+}
@@ -0,0 +1,114 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// spriteBatch.h v1.0
+// SpriteBatch records the sprites drawn between spriteBegin() and spriteEnd()
+// and submits them sorted by layer and texture, so sprites that share a
+// texture are drawn together. The transforms of the whole batch are computed
+// at once by Transform2D. The batch does not know how sprites are drawn,
+// a SpriteBatchBackend does that. Graphics is the normal backend.
+
+#ifndef _SPRITEBATCH_H          // Prevent multiple definitions if this 
+#define _SPRITEBATCH_H          // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+#include "spriteData.h"
+#include "transform2D.h"
+
+namespace spriteBatchNS
+{
+    const UINT START_SIZE = 1024;   // number of sprites reserved in a new batch
+}
+
+// Interface used by SpriteBatch::flush() to draw the sorted sprites.
+class SpriteBatchBackend
+{
+public:
+    virtual ~SpriteBatchBackend() {}
+
+    // Called before the first sprite of each run of sprites sharing a texture.
+    // Does nothing by default, for a backend that takes the texture from
+    // spriteData in submitSprite().
+    virtual void setBatchTexture(LP_TEXTURE) {}
+
+    // Draw one sprite of spriteData.texture.
+    // transform is the sprite transform computed from spriteData.
+    virtual void submitSprite(const SpriteData &spriteData, COLOR_ARGB color,
+                              const Affine2D &transform) = 0;
+};
+
+class SpriteBatch
+{
+    // SpriteBatch properties
+  private:
+    // A recorded sprite
+    struct Item
+    {
+        SpriteData  spriteData;
+        COLOR_ARGB  color;
+    };
+    // Sort key of a recorded sprite
+    struct Key
+    {
+        int         layer;
+        size_t      texture;        // texture pointer as a number
+        UINT        index;          // order of arrival, keeps the sort stable
+        bool operator<(const Key &rhs) const
+        {
+            if (layer != rhs.layer)
+                return layer < rhs.layer;
+            if (texture != rhs.texture)
+                return texture < rhs.texture;
+            return index < rhs.index;
+        }
+    };
+    std::vector<Item> items;        // sprites in the order they were added
+    std::vector<Key>  keys;         // sorted by flush()
+    // sprite properties in sorted order for transform
+    std::vector<float> x, y, scale, angle;
+    std::vector<int>   width, height;
+    std::vector<BYTE>  flip;
+    std::vector<Affine2D> transforms;
+    Transform2D transform;          // computes transforms
+    UINT    spritesDrawn;           // sprites submitted since resetStats()
+    UINT    textureSwitches;        // texture changes made since resetStats()
+    UINT    unsortedSwitches;       // texture changes the order of arrival would have made
+
+  public:
+    // Constructor
+    SpriteBatch();
+
+    // Add a sprite to the batch.
+    // color is applied as a filter when the sprite is drawn.
+    void    add(const SpriteData &spriteData, COLOR_ARGB color);
+
+    // Sort the batch by layer and texture, stable within a texture,
+    // and submit it to backend. The batch is empty afterwards.
+    // Returns the number of sprites submitted.
+    UINT    flush(SpriteBatchBackend &backend);
+
+    // Remove all sprites without drawing them.
+    void    clear()     {items.clear(); keys.clear();}
+
+    // Clear the statistics. Graphics calls this at the start of each frame.
+    void    resetStats();
+
+    // Return the transform kernel, to select SSE2, AVX or scalar code.
+    Transform2D& getTransform2D()       {return transform;}
+
+    // Return the number of sprites waiting to be drawn.
+    UINT    getSize() const             {return (UINT)items.size();}
+
+    // Return the number of sprites submitted since resetStats().
+    UINT    getSpritesDrawn() const     {return spritesDrawn;}
+
+    // Return the number of texture switches made since resetStats().
+    UINT    getTextureSwitches() const  {return textureSwitches;}
+
+    // Return the number of texture switches saved by sorting since resetStats().
+    // May be negative when layers force a texture to be set more than once.
+    int     getSwitchesSaved() const    {return (int)unsortedSwitches - (int)textureSwitches;}
+};
+
+#endif
@@ -0,0 +1,57 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// spriteData.h v1.0
+// SpriteData and the color and texture types it uses.
+// Kept apart from graphics.h so code that only records or sorts sprites
+// (see SpriteBatch) does not depend on Direct3D.
+
+#ifndef _SPRITEDATA_H           // Prevent multiple definitions if this 
+#define _SPRITEDATA_H           // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include "platform.h"
+
+#ifdef SOFTWARE_GRAPHICS
+class SoftTexture;              // see softGraphics.h
+#define LP_TEXTURE  SoftTexture*
+#else
+#include <d3d9.h>
+#define LP_TEXTURE  LPDIRECT3DTEXTURE9
+#endif
+
+// Color defines
+#define COLOR_ARGB DWORD
+#define SETCOLOR_ARGB(a,r,g,b) \
+    ((COLOR_ARGB)((((a)&0xff)<<24)|(((r)&0xff)<<16)|(((g)&0xff)<<8)|((b)&0xff)))
+
+// Return color c with red, green and blue multiplied by alpha.
+// Textures hold premultiplied colors, see imageFile.h.
+inline COLOR_ARGB premultiplyColor(COLOR_ARGB c)
+{
+    UINT a = c >> 24;
+    if (a == 255)
+        return c;
+    UINT r = ((c >> 16) & 0xff)*a + 128;
+    UINT g = ((c >> 8) & 0xff)*a + 128;
+    UINT b = (c & 0xff)*a + 128;
+    return SETCOLOR_ARGB(a, (r + (r >> 8)) >> 8, (g + (g >> 8)) >> 8, (b + (b >> 8)) >> 8);
+}
+
+// SpriteData: The properties required by Graphics::drawSprite to draw a sprite
+struct SpriteData
+{
+    int         width;      // width of sprite in pixels
+    int         height;     // height of sprite in pixels
+    float       x;          // screen location (top left corner of sprite)
+    float       y;
+    float       scale;      // <1 smaller, >1 bigger
+    float       angle;      // rotation angle in radians
+    RECT        rect;       // used to select an image from a larger texture
+    LP_TEXTURE  texture;    // pointer to texture
+    bool        flipHorizontal; // true to flip sprite horizontally (mirror)
+    bool        flipVertical;   // true to flip sprite vertically
+    int         layer;      // draw order when batching, lower layers are drawn first
+};
+
+#endif
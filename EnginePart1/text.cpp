@@ -0,0 +1,218 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// text.cpp v1.0
+// Bitmap font text with cached layouts, see text.h
+
+#include "text.h"
+
+//=============================================================================
+// Constructor
+//=============================================================================
+Text::Text()
+{
+    graphics = NULL;
+    textureManager = NULL;
+    cellWidth = 1;
+    cellHeight = 1;
+    cols = 1;
+    proportional = true;
+    spacing = textNS::PROPORTIONAL_SPACING;
+    scale = 1.0f;
+    layer = 0;
+    fontColor = graphicsNS::WHITE;
+    generation = 0;
+    layoutsBuilt = 0;
+}
+
+//=============================================================================
+// Initialize the font
+// Returns false on error
+//=============================================================================
+bool Text::initialize(Graphics *g, int width, int height, int ncols, TextureManager *textureM)
+{
+    if (g == NULL || textureM == NULL || width <= 0 || height <= 0)
+        return false;
+    graphics = g;
+    textureManager = textureM;
+    cellWidth = width;
+    cellHeight = height;
+    cols = ncols > 0 ? ncols : 1;
+    layoutsBuilt = 0;
+    clearLayouts();
+    try{
+        Glyph full = {0, (short)(width - 1)};
+        glyphs.assign(textNS::MAX_CHAR - textNS::MIN_CHAR + 1, full);
+        UINT w, h;
+        std::vector<COLOR_ARGB> pixels;
+        if (textureM->getFile() &&
+            SUCCEEDED(graphics->loadTextureData(textureM->getFile(), TRANSCOLOR, w, h, pixels)))
+            measure(pixels, w, h);
+        else
+            proportional = false;
+    }
+    catch(...) {return false;}
+    return true;
+}
+
+//=============================================================================
+// Find the edges of each character
+// A column is part of the character if any pixel in it is not transparent.
+// An empty cell, a space, is given half the cell width.
+//=============================================================================
+void Text::measure(const std::vector<COLOR_ARGB> &pixels, UINT width, UINT height)
+{
+    for (UINT n = 0; n < glyphs.size(); n++)
+    {
+        int cellX = (n % cols) * cellWidth;
+        int cellY = (n / cols) * cellHeight;
+        if ((UINT)(cellX + cellWidth) > width || (UINT)(cellY + cellHeight) > height)
+            break;                              // the image ends before MAX_CHAR
+        int left = cellWidth;
+        int right = -1;
+        for (int row = 0; row < cellHeight; row++)
+        {
+            const COLOR_ARGB *p = &pixels[(cellY + row) * width + cellX];
+            for (int col = 0; col < cellWidth; col++)
+                if (p[col] >> 24)               // alpha not 0
+                {
+                    if (col < left)
+                        left = col;
+                    if (col > right)
+                        right = col;
+                }
+        }
+        if (right < 0)                          // empty
+        {
+            left = 0;
+            right = cellWidth / 2 - 1;
+        }
+        glyphs[n].left = (short)left;
+        glyphs[n].right = (short)right;
+    }
+}
+
+//=============================================================================
+// Return the layout of str, making it if new
+// When MAX_LAYOUTS are kept the ones not used since the last removal are
+// removed, strings printed every frame stay.
+//=============================================================================
+const Text::Layout& Text::getLayout(const std::string &str)
+{
+    std::map<std::string, Layout>::iterator it = layouts.find(str);
+    if (it != layouts.end())
+    {
+        it->second.generation = generation;
+        return it->second;
+    }
+    if (layouts.size() >= textNS::MAX_LAYOUTS)
+    {
+        for (it = layouts.begin(); it != layouts.end(); )
+        {
+            if (it->second.generation != generation)
+                layouts.erase(it++);
+            else
+                ++it;
+        }
+        generation++;
+    }
+
+    Layout &layout = layouts[str];
+    layout.generation = generation;
+    layout.width = 0;
+    layout.height = str.empty() ? 0 : (float)cellHeight;
+    layoutsBuilt++;
+    bool prop = proportional && !glyphs.empty();    // fixed width before initialize()
+    int spaceWidth = prop ? glyphs[0].right - glyphs[0].left + 1 + spacing : cellWidth;
+    float penX = 0;
+    float penY = 0;
+    for (size_t i = 0; i < str.size(); i++)
+    {
+        UINT ch = (BYTE)str[i];
+        if (ch == '\n')
+        {
+            penX = 0;
+            penY += cellHeight;
+            layout.height += cellHeight;
+            continue;
+        }
+        if (ch == '\t')
+        {
+            int tab = spaceWidth * textNS::TAB_SIZE;
+            if (tab < 1)                        // a negative spacing can leave no space
+                tab = 1;
+            penX = (float)(((int)penX / tab + 1) * tab);
+            continue;
+        }
+        if (ch < textNS::MIN_CHAR || ch > textNS::MAX_CHAR)
+            ch = textNS::MIN_CHAR;
+        UINT n = ch - textNS::MIN_CHAR;
+        Quad q;
+        q.x = penX;
+        q.y = penY;
+        q.rect.left = (n % cols) * cellWidth;
+        q.rect.top = (n / cols) * cellHeight;
+        q.rect.bottom = q.rect.top + cellHeight;
+        if (prop)
+        {
+            q.rect.left += glyphs[n].left;
+            q.width = glyphs[n].right - glyphs[n].left + 1;
+            penX += q.width + spacing;
+        }
+        else
+        {
+            q.width = cellWidth;
+            penX += cellWidth;
+        }
+        q.rect.right = q.rect.left + q.width;
+        if (n != 0)                             // spaces are not drawn
+            layout.quads.push_back(q);
+        if (q.x + q.width > layout.width)
+            layout.width = q.x + q.width;
+    }
+    return layout;
+}
+
+//=============================================================================
+// Draw str at x,y in the font color
+//=============================================================================
+void Text::print(const std::string &str, float x, float y)
+{
+    print(str, x, y, fontColor);
+}
+
+//=============================================================================
+// Draw str at x,y in color
+//=============================================================================
+void Text::print(const std::string &str, float x, float y, COLOR_ARGB color)
+{
+    if (graphics == NULL || textureManager == NULL)
+        return;
+    textureManager->touch();            // load again if evicted
+    LP_TEXTURE texture = textureManager->getTexture();
+    if (texture == NULL)                // if still loading
+        return;
+    const Layout &layout = getLayout(str);
+    int offsetX = textureManager->getOffsetX();
+    int offsetY = textureManager->getOffsetY();
+    SpriteData sd;
+    sd.height = cellHeight;
+    sd.scale = scale;
+    sd.angle = 0;
+    sd.texture = texture;
+    sd.flipHorizontal = false;
+    sd.flipVertical = false;
+    sd.layer = layer;
+    for (size_t i = 0; i < layout.quads.size(); i++)
+    {
+        const Quad &q = layout.quads[i];
+        sd.width = q.width;
+        sd.x = x + q.x * scale;
+        sd.y = y + q.y * scale;
+        sd.rect.left = q.rect.left + offsetX;
+        sd.rect.right = q.rect.right + offsetX;
+        sd.rect.top = q.rect.top + offsetY;
+        sd.rect.bottom = q.rect.bottom + offsetY;
+        graphics->drawSprite(sd, color);
+    }
+}
@@ -0,0 +1,148 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// text.h v1.0
+// Text draws strings with a bitmap font, a texture holding a grid of
+// character images, for scores, FPS and other HUD text.
+// The font texture has cols characters in a row, each in a cell of
+// cellWidth x cellHeight, starting with MIN_CHAR. initialize() reads the
+// pixels once and finds the left and right edge of each character for
+// proportional spacing. The texture may be in a TextureAtlas.
+// print() turns a string into a list of character rects and positions,
+// a layout, and keeps it. Printing the same string again, in the same or a
+// later frame, only looks the layout up. Each character is one sprite
+// passed to Graphics::drawSprite(), so when batching all the text of a
+// font is drawn together as one run of its texture.
+// Usage:
+//   fontTexture.initialize(graphics, FONT_IMAGE);
+//   font.initialize(graphics, 32, 32, 16, &fontTexture);
+//   // in render(), between spriteBegin() and spriteEnd():
+//   font.print("Score " + std::to_string(score), 10, 10);
+
+#ifndef _TEXT_H                 // Prevent multiple definitions if this
+#define _TEXT_H                 // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <map>
+#include <string>
+#include <vector>
+#include "graphics.h"
+#include "textureManager.h"
+
+namespace textNS
+{
+    const UINT MIN_CHAR = 0x0020;       // first character in the font texture
+    const UINT MAX_CHAR = 0x00FF;       // last character in the font texture
+    const int PROPORTIONAL_SPACING = 2; // pixels between proportional characters
+    const int TAB_SIZE = 4;             // tab stops every TAB_SIZE spaces
+    const UINT MAX_LAYOUTS = 1024;      // layouts kept before unused ones are removed
+}
+
+class Text
+{
+  private:
+    // Columns of a character cell that hold the character
+    struct Glyph
+    {
+        short   left;               // first column with a pixel
+        short   right;              // last column with a pixel
+    };
+
+    // A character of a layout
+    struct Quad
+    {
+        float   x;                  // position relative to the string at scale 1
+        float   y;
+        int     width;              // pixels of the cell drawn
+        RECT    rect;               // in the font image, without the atlas offset
+    };
+
+    // A laid out string
+    struct Layout
+    {
+        std::vector<Quad> quads;
+        float   width;              // size at scale 1
+        float   height;
+        UINT    generation;         // value of generation when last used
+    };
+
+    Graphics *graphics;
+    TextureManager *textureManager;
+    int     cellWidth;              // size of a character cell
+    int     cellHeight;
+    int     cols;                   // cells in a row of the font texture
+    std::vector<Glyph> glyphs;      // MIN_CHAR to MAX_CHAR
+    bool    proportional;           // true for proportional spacing
+    int     spacing;                // pixels between proportional characters
+    float   scale;
+    int     layer;
+    COLOR_ARGB fontColor;
+    std::map<std::string, Layout> layouts;
+    UINT    generation;             // incremented when unused layouts are removed
+    UINT    layoutsBuilt;           // layouts made since initialize()
+
+    // Find the edges of each character in the pixels of the font image.
+    void    measure(const std::vector<COLOR_ARGB> &pixels, UINT width, UINT height);
+
+    // Return the layout of str, making it if new.
+    const Layout& getLayout(const std::string &str);
+
+  public:
+    // Constructor
+    Text();
+
+    // Initialize the font.
+    // width,height = size of a character cell
+    // ncols = cells in a row of the font texture
+    // textureM = font texture, initialized
+    // Proportional spacing is turned off if the pixels can not be read.
+    // Returns false on error.
+    bool    initialize(Graphics *g, int width, int height, int ncols, TextureManager *textureM);
+
+    // Draw str with its top left corner at x,y. '\n' starts a new line.
+    // Characters outside MIN_CHAR to MAX_CHAR are drawn as spaces.
+    void    print(const std::string &str, float x, float y);
+
+    // Draw str in color at x,y.
+    void    print(const std::string &str, float x, float y, COLOR_ARGB color);
+
+    // Return the size of str in pixels at the current scale.
+    float   getWidth(const std::string &str)    {return getLayout(str).width * scale;}
+    float   getHeight(const std::string &str)   {return getLayout(str).height * scale;}
+
+    // Set proportional spacing, false for fixed width cells.
+    void    setProportional(bool p)     {proportional = p; clearLayouts();}
+
+    // Set pixels between proportional characters, may be negative.
+    void    setSpacing(int s)           {spacing = s; clearLayouts();}
+
+    // Set scale of the characters.
+    void    setScale(float s)           {scale = s;}
+
+    // Set color of the text.
+    void    setFontColor(COLOR_ARGB c)  {fontColor = c;}
+
+    // Set layer of the text, see SpriteData.
+    void    setLayer(int l)             {layer = l;}
+
+    // Remove every layout.
+    void    clearLayouts()              {layouts.clear();}
+
+    // Return true if spacing is proportional.
+    bool    getProportional() const     {return proportional;}
+
+    // Return scale of the characters.
+    float   getScale() const            {return scale;}
+
+    // Return color of the text.
+    COLOR_ARGB getFontColor() const     {return fontColor;}
+
+    // Return number of layouts kept.
+    UINT    getLayoutCount() const      {return (UINT)layouts.size();}
+
+    // Return number of layouts made since initialize(). Printing the same
+    // strings every frame does not increase it.
+    UINT    getLayoutsBuilt() const     {return layoutsBuilt;}
+};
+
+#endif
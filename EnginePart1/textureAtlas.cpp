@@ -0,0 +1,360 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// textureAtlas.cpp v1.0
+// Packs the images of many TextureManagers into shared page textures.
+
+#include "textureAtlas.h"
+#include "textureManager.h"
+#include <algorithm>
+
+//=============================================================================
+// Order images for packing: tallest first, then widest, then order added
+//=============================================================================
+struct AtlasOrder
+{
+    const std::vector<UINT> *w;
+    const std::vector<UINT> *h;
+    bool operator()(UINT a, UINT b) const
+    {
+        if ((*h)[a] != (*h)[b])
+            return (*h)[a] > (*h)[b];
+        if ((*w)[a] != (*w)[b])
+            return (*w)[a] > (*w)[b];
+        return a < b;
+    }
+};
+
+//=============================================================================
+// AtlasPacker constructor
+//=============================================================================
+AtlasPacker::AtlasPacker()
+{
+    pageWidth = textureAtlasNS::PAGE_WIDTH;
+    pageHeight = textureAtlasNS::PAGE_HEIGHT;
+}
+
+//=============================================================================
+// Remove all pages and set the page size
+//=============================================================================
+void AtlasPacker::reset(UINT pageW, UINT pageH)
+{
+    pageWidth = pageW;
+    pageHeight = pageH;
+    pages.clear();
+}
+
+//=============================================================================
+// Add an empty page of size w x h
+// Returns page number
+//=============================================================================
+UINT AtlasPacker::addPage(UINT w, UINT h)
+{
+    Page p;
+    p.width = w;
+    p.height = h;
+    p.usedArea = 0;
+    SkylineNode node = {0, 0, w};   // flat skyline along the top edge
+    p.skyline.push_back(node);
+    pages.push_back(p);
+    return (UINT)pages.size() - 1;
+}
+
+//=============================================================================
+// Return y where a w x h rectangle fits with its left edge at skyline node i,
+// or -1 if it does not fit. The rectangle rests on the lowest point below it,
+// which is the largest y of the nodes it spans.
+//=============================================================================
+int AtlasPacker::fit(const Page &p, UINT i, UINT w, UINT h) const
+{
+    UINT x = p.skyline[i].x;
+    if (x + w > p.width)
+        return -1;
+    UINT y = 0;
+    UINT remaining = w;
+    for (UINT j = i; remaining > 0; j++)    // the skyline covers the width so j stays in range
+    {
+        if (p.skyline[j].y > y)
+            y = p.skyline[j].y;
+        if (y + h > p.height)
+            return -1;
+        remaining -= (std::min)(remaining, p.skyline[j].width);
+    }
+    return (int)y;
+}
+
+//=============================================================================
+// Place a w x h rectangle at skyline node i with its top at y
+//=============================================================================
+void AtlasPacker::place(Page &p, UINT i, UINT w, UINT h, UINT y)
+{
+    SkylineNode node = {p.skyline[i].x, y + h, w};
+    p.skyline.insert(p.skyline.begin() + i, node);
+
+    // remove or shorten the nodes now under the rectangle
+    UINT right = node.x + w;
+    UINT j = i + 1;
+    while (j < p.skyline.size() && p.skyline[j].x < right)
+    {
+        UINT shrink = right - p.skyline[j].x;
+        if (p.skyline[j].width <= shrink)
+            p.skyline.erase(p.skyline.begin() + j);
+        else
+        {
+            p.skyline[j].x += shrink;
+            p.skyline[j].width -= shrink;
+            break;
+        }
+    }
+
+    // join neighbours of the same height
+    for (j = 0; j + 1 < p.skyline.size(); )
+    {
+        if (p.skyline[j].y == p.skyline[j+1].y)
+        {
+            p.skyline[j].width += p.skyline[j+1].width;
+            p.skyline.erase(p.skyline.begin() + j + 1);
+        }
+        else
+            j++;
+    }
+    p.usedArea += w*h;
+}
+
+//=============================================================================
+// Pack a w x h rectangle
+// Post: out = location of rectangle
+// Returns false if w or h is 0
+//=============================================================================
+bool AtlasPacker::insert(UINT w, UINT h, AtlasRect &out)
+{
+    if (w == 0 || h == 0)
+        return false;
+    out.width = w;
+    out.height = h;
+
+    for (UINT pg = 0; pg < pages.size(); pg++)
+    {
+        Page &p = pages[pg];
+        int bestNode = -1;
+        UINT bestTop = 0;
+        UINT bestY = 0;
+        for (UINT i = 0; i < p.skyline.size(); i++)
+        {
+            int y = fit(p, i, w, h);
+            if (y < 0)
+                continue;
+            if (bestNode < 0 || (UINT)y + h < bestTop)  // leftmost wins a tie
+            {
+                bestNode = i;
+                bestTop = y + h;
+                bestY = y;
+            }
+        }
+        if (bestNode >= 0)
+        {
+            out.page = pg;
+            out.x = p.skyline[bestNode].x;
+            out.y = bestY;
+            place(p, bestNode, w, h, bestY);
+            return true;
+        }
+    }
+
+    // start a new page, larger than normal if the rectangle needs it
+    UINT pg = addPage((std::max)(w, pageWidth), (std::max)(h, pageHeight));
+    out.page = pg;
+    out.x = 0;
+    out.y = 0;
+    place(pages[pg], 0, w, h, 0);
+    return true;
+}
+
+//=============================================================================
+// Return the fraction of page covered by rectangles
+//=============================================================================
+float AtlasPacker::getOccupancy(UINT page) const
+{
+    if (page >= pages.size())
+        return 0;
+    const Page &p = pages[page];
+    return (float)p.usedArea / ((float)p.width * p.height);
+}
+
+//=============================================================================
+// TextureAtlas constructor
+//=============================================================================
+TextureAtlas::TextureAtlas()
+{
+    graphics = NULL;
+    pageWidth = textureAtlasNS::PAGE_WIDTH;
+    pageHeight = textureAtlasNS::PAGE_HEIGHT;
+    padding = textureAtlasNS::PADDING;
+    built = false;
+}
+
+//=============================================================================
+// Destructor
+//=============================================================================
+TextureAtlas::~TextureAtlas()
+{
+    onLostDevice();
+}
+
+//=============================================================================
+// Initialize the atlas
+// Returns false on error
+//=============================================================================
+bool TextureAtlas::initialize(Graphics *g, UINT pageW, UINT pageH, UINT pad)
+{
+    if (g == NULL || pageW == 0 || pageH == 0)
+        return false;
+    onLostDevice();
+    graphics = g;
+    UINT maxSize = graphics->getMaxTextureSize();
+    pageWidth = (std::min)(pageW, maxSize);     // a page must be a texture
+    pageHeight = (std::min)(pageH, maxSize);
+    padding = pad;
+    entries.clear();
+    pagePixels.clear();
+    packer.reset(pageWidth, pageHeight);
+    built = false;
+    return true;
+}
+
+//=============================================================================
+// Load the image file and register it for packing
+// Returns false on error or if build() was already called
+//=============================================================================
+bool TextureAtlas::add(TextureManager *tm, const char *file, COLOR_ARGB transcolor)
+{
+    if (graphics == NULL || built || tm == NULL)
+        return false;
+    try{
+        entries.push_back(Entry());
+        Entry &e = entries.back();
+        e.textureManager = tm;
+        if (FAILED(graphics->loadTextureData(file, transcolor, e.width, e.height, e.pixels)))
+        {
+            entries.pop_back();
+            return false;
+        }
+        UINT maxSize = graphics->getMaxTextureSize();
+        if (e.width + 2*padding > maxSize || e.height + 2*padding > maxSize)
+        {
+            entries.pop_back();             // no page could hold it
+            return false;
+        }
+        AtlasRect r = {0, 0, 0, e.width, e.height};
+        e.rect = r;
+        tm->setAtlasRect(e.rect);           // size is known before build()
+    }
+    catch(...) {return false;}
+    return true;
+}
+
+//=============================================================================
+// Pack the registered images and create the page textures
+// Returns false on error
+//=============================================================================
+bool TextureAtlas::build()
+{
+    if (graphics == NULL || built)
+        return false;
+    try{
+        // tallest first packs tighter, ties keep the order added
+        std::vector<UINT> order(entries.size());
+        std::vector<UINT> w(entries.size()), h(entries.size());
+        for (UINT i = 0; i < entries.size(); i++)
+        {
+            order[i] = i;
+            w[i] = entries[i].width + 2*padding;     // padding on all four sides
+            h[i] = entries[i].height + 2*padding;
+        }
+        AtlasOrder compare = {&w, &h};
+        std::sort(order.begin(), order.end(), compare);
+
+        packer.reset(pageWidth, pageHeight);
+        for (UINT i = 0; i < order.size(); i++)
+        {
+            Entry &e = entries[order[i]];
+            packer.insert(w[order[i]], h[order[i]], e.rect);
+            e.rect.x += padding;            // image inside its padding
+            e.rect.y += padding;
+            e.rect.width = e.width;
+            e.rect.height = e.height;
+        }
+
+        // copy the images into the pages
+        pagePixels.assign(packer.getPageCount(), std::vector<COLOR_ARGB>());
+        for (UINT pg = 0; pg < pagePixels.size(); pg++)
+            pagePixels[pg].assign(packer.getPageWidth(pg) * packer.getPageHeight(pg), 0);
+        for (UINT i = 0; i < entries.size(); i++)
+        {
+            Entry &e = entries[i];
+            UINT pitch = packer.getPageWidth(e.rect.page);
+            COLOR_ARGB *dest = &pagePixels[e.rect.page][e.rect.y*pitch + e.rect.x];
+            for (UINT y = 0; y < e.height; y++)
+                std::copy(&e.pixels[y*e.width], &e.pixels[y*e.width] + e.width, dest + y*pitch);
+            std::vector<COLOR_ARGB>().swap(e.pixels);      // free memory
+            e.textureManager->setAtlasRect(e.rect);
+        }
+    }
+    catch(...) {return false;}
+    built = true;
+    return createPages();
+}
+
+//=============================================================================
+// Return most mip levels of a page
+// Images are 2*padding apart, also across the page edge. Each level halves
+// the gap, so a level with less than one transparent texel between images
+// would blend neighbouring images together.
+//=============================================================================
+UINT TextureAtlas::getMaxLevels() const
+{
+    UINT levels = 1;
+    for (UINT gap = 2*padding; gap >= 2; gap /= 2)
+        levels++;
+    return levels;
+}
+
+//=============================================================================
+// Create the page textures from pagePixels
+// Returns false on error
+//=============================================================================
+bool TextureAtlas::createPages()
+{
+    pages.assign(pagePixels.size(), (LP_TEXTURE)NULL);
+    for (UINT pg = 0; pg < pagePixels.size(); pg++)
+    {
+        if (FAILED(graphics->createTexture(&pagePixels[pg][0], packer.getPageWidth(pg),
+                                           packer.getPageHeight(pg), pages[pg],
+                                           getMaxLevels())))
+        {
+            onLostDevice();
+            return false;
+        }
+    }
+    return true;
+}
+
+//=============================================================================
+// called when graphics device is lost
+//=============================================================================
+void TextureAtlas::onLostDevice()
+{
+    for (UINT pg = 0; pg < pages.size(); pg++)
+        SAFE_RELEASE(pages[pg]);
+    pages.clear();
+}
+
+//=============================================================================
+// called when graphics device is reset
+//=============================================================================
+void TextureAtlas::onResetDevice()
+{
+    if (!built)
+        return;
+    createPages();
+}
@@ -0,0 +1,189 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// textureAtlas.h v1.0
+// A TextureAtlas packs the images of many TextureManagers into a few large
+// page textures, so sprites from different images share a texture and the
+// sprite batch draws them without texture switches.
+// Usage:
+//   atlas.initialize(graphics);
+//   textureA.initialize(graphics, FILE_A, &atlas);   // register images
+//   textureB.initialize(graphics, FILE_B, &atlas);
+//   atlas.build();                                   // pack and create pages
+//   image.initialize(graphics, w, h, ncols, &textureA);
+// Image rects are offset into the page automatically.
+// Each image has padding transparent pixels on all four sides, so filtering
+// at any edge of an image, also across the edge of the page, reads
+// transparent texels and never a neighbouring image.
+// Each mip level halves the 2*padding gap between images, so pages only get
+// the levels that keep at least one transparent texel between them:
+// floor(log2(2*padding))+1, 2 with the default padding of 1. Use more
+// padding for images drawn well below full size.
+// Pages are no larger than Graphics::getMaxTextureSize().
+
+#ifndef _TEXTUREATLAS_H         // Prevent multiple definitions if this
+#define _TEXTUREATLAS_H         // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+#include "graphics.h"
+
+class TextureManager;
+
+namespace textureAtlasNS
+{
+    const UINT PAGE_WIDTH  = 1024;  // default page size in pixels
+    const UINT PAGE_HEIGHT = 1024;
+    const UINT PADDING = 1;         // transparent pixels around each image, stops filtering bleed
+}
+
+// Location of a packed image.
+struct AtlasRect
+{
+    UINT page;              // page number
+    UINT x, y;              // top left pixel in page
+    UINT width, height;     // size of image
+};
+
+// Skyline bottom-left rectangle packer.
+// Each page keeps its skyline, the top edge of the packed images seen from
+// above. A new rectangle goes at the position with the lowest top edge,
+// leftmost on a tie, in the first page where it fits. A new page is started
+// when it does not fit in any page. A rectangle larger than the page size
+// starts a page large enough for it. The result depends only on the order and sizes of the
+// inserted rectangles.
+class AtlasPacker
+{
+  private:
+    struct SkylineNode
+    {
+        UINT x, y, width;
+    };
+    struct Page
+    {
+        UINT width, height;
+        UINT usedArea;                      // pixels covered by rectangles
+        std::vector<SkylineNode> skyline;   // left to right, covers the page width
+    };
+    UINT pageWidth;
+    UINT pageHeight;
+    std::vector<Page> pages;
+
+    // Add a page of size w x h, returns page number.
+    UINT addPage(UINT w, UINT h);
+
+    // Return y where a w x h rectangle fits at skyline node i of page p,
+    // or -1 if it does not fit.
+    int fit(const Page &p, UINT i, UINT w, UINT h) const;
+
+    // Place a w x h rectangle at node i of page p with its top at y.
+    void place(Page &p, UINT i, UINT w, UINT h, UINT y);
+
+  public:
+    // Constructor
+    AtlasPacker();
+
+    // Remove all pages and set the page size.
+    void reset(UINT pageW, UINT pageH);
+
+    // Pack a w x h rectangle.
+    // Post: out = location of rectangle
+    // Returns false if w or h is 0.
+    bool insert(UINT w, UINT h, AtlasRect &out);
+
+    // Return number of pages.
+    UINT getPageCount() const {return (UINT)pages.size();}
+
+    // Return width of page.
+    UINT getPageWidth(UINT page) const  {return pages[page].width;}
+
+    // Return height of page.
+    UINT getPageHeight(UINT page) const {return pages[page].height;}
+
+    // Return the fraction of page covered by rectangles, 0 to 1.
+    // Padding added by TextureAtlas counts as covered.
+    float getOccupancy(UINT page) const;
+};
+
+class TextureAtlas
+{
+  private:
+    // A registered image
+    struct Entry
+    {
+        TextureManager *textureManager;
+        UINT width, height;
+        std::vector<COLOR_ARGB> pixels;     // freed by build()
+        AtlasRect rect;
+    };
+    Graphics *graphics;
+    UINT     pageWidth;
+    UINT     pageHeight;
+    UINT     padding;
+    AtlasPacker packer;
+    std::vector<Entry> entries;
+    std::vector<LP_TEXTURE> pages;
+    std::vector< std::vector<COLOR_ARGB> > pagePixels;  // for onResetDevice()
+    bool     built;
+
+    // Create the page textures from pagePixels.
+    bool createPages();
+
+  public:
+    // Constructor
+    TextureAtlas();
+
+    // Destructor
+    virtual ~TextureAtlas();
+
+    // Initialize the atlas.
+    // Pre: *g points to Graphics object
+    //      pageW, pageH = page size in pixels, reduced to the largest
+    //      texture of the device
+    //      pad = transparent pixels around each image
+    bool initialize(Graphics *g, UINT pageW = textureAtlasNS::PAGE_WIDTH,
+                    UINT pageH = textureAtlasNS::PAGE_HEIGHT,
+                    UINT pad = textureAtlasNS::PADDING);
+
+    // Load the image file and register it for packing.
+    // Called by TextureManager::initialize(), use that instead.
+    // Returns false on error, if build() was already called, or if the
+    // image with its padding is larger than the largest texture of the device.
+    bool add(TextureManager *tm, const char *file, COLOR_ARGB transcolor);
+
+    // Pack the registered images and create the page textures.
+    // Each TextureManager is then set to its page and position.
+    // Images are packed tallest first, in the order added when the same
+    // height, so the same images always give the same pages.
+    // Returns false on error.
+    bool build();
+
+    // Return page width, reduced to the largest texture of the device.
+    UINT getPageWidth() const {return pageWidth;}
+
+    // Return page height, reduced to the largest texture of the device.
+    UINT getPageHeight() const {return pageHeight;}
+
+    // Return page texture, NULL before build().
+    LP_TEXTURE getPage(UINT page) const {return page < pages.size() ? pages[page] : NULL;}
+
+    // Return number of pages.
+    UINT getPageCount() const {return (UINT)pagePixels.size();}
+
+    // Return the fraction of page covered by images and padding, 0 to 1.
+    float getPageOccupancy(UINT page) const {return packer.getOccupancy(page);}
+
+    // Return number of registered images.
+    UINT getImageCount() const {return (UINT)entries.size();}
+
+    // Return most mip levels of a page, floor(log2(2*padding))+1.
+    UINT getMaxLevels() const;
+
+    // Release page textures
+    void onLostDevice();
+
+    // Recreate page textures
+    void onResetDevice();
+};
+
+#endif
@@ -0,0 +1,115 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// textureCache.cpp v1.0
+// System memory copy of texture pixels for fast device reset.
+
+#include "textureCache.h"
+
+//=============================================================================
+// Constructor
+//=============================================================================
+TextureCache::TextureCache(size_t budgetBytes)
+{
+    budget = budgetBytes;
+    bytes = 0;
+    useCount = 0;
+    hits = 0;
+    misses = 0;
+    evictions = 0;
+}
+
+//=============================================================================
+// Find the pixels of file
+// Returns false if not in the cache
+//=============================================================================
+bool TextureCache::find(const char *file, COLOR_ARGB transcolor, UINT &width, UINT &height,
+                        const COLOR_ARGB *&pixels)
+{
+    if (file == NULL)
+        return false;
+    std::map<std::string, Entry>::iterator it = entries.find(file);
+    if (it == entries.end() || it->second.transcolor != transcolor)
+    {
+        misses++;
+        return false;
+    }
+    Entry &e = it->second;
+    e.lastUse = ++useCount;
+    width = e.width;
+    height = e.height;
+    pixels = &e.pixels[0];
+    hits++;
+    return true;
+}
+
+//=============================================================================
+// Add the pixels of file
+// The pixels are swapped into the cache so they are not copied.
+//=============================================================================
+void TextureCache::add(const char *file, COLOR_ARGB transcolor, UINT width, UINT height,
+                       std::vector<COLOR_ARGB> &pixels)
+{
+    size_t size = pixels.size() * sizeof(COLOR_ARGB);
+    if (file == NULL || pixels.empty() || size > budget)
+        return;
+    remove(file);               // replace an older copy
+    evict(size);
+    Entry &e = entries[file];
+    e.transcolor = transcolor;
+    e.width = width;
+    e.height = height;
+    e.pixels.swap(pixels);
+    e.lastUse = ++useCount;
+    bytes += size;
+    pixels.clear();
+}
+
+//=============================================================================
+// Remove least recently used images until needed bytes fit in the budget
+//=============================================================================
+void TextureCache::evict(size_t needed)
+{
+    while (!entries.empty() && bytes + needed > budget)
+    {
+        std::map<std::string, Entry>::iterator oldest = entries.begin();
+        for (std::map<std::string, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+            if (it->second.lastUse < oldest->second.lastUse)
+                oldest = it;
+        bytes -= oldest->second.pixels.size() * sizeof(COLOR_ARGB);
+        entries.erase(oldest);
+        evictions++;
+    }
+}
+
+//=============================================================================
+// Remove the pixels of file
+//=============================================================================
+void TextureCache::remove(const char *file)
+{
+    if (file == NULL)
+        return;
+    std::map<std::string, Entry>::iterator it = entries.find(file);
+    if (it == entries.end())
+        return;
+    bytes -= it->second.pixels.size() * sizeof(COLOR_ARGB);
+    entries.erase(it);
+}
+
+//=============================================================================
+// Remove all images
+//=============================================================================
+void TextureCache::clear()
+{
+    entries.clear();
+    bytes = 0;
+}
+
+//=============================================================================
+// Set the memory budget
+//=============================================================================
+void TextureCache::setBudget(size_t budgetBytes)
+{
+    budget = budgetBytes;
+    evict(0);
+}
@@ -0,0 +1,96 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// textureCache.h v1.0
+// A TextureCache keeps the decoded, color keyed pixels of texture files in
+// system memory. A TextureManager using a cache recreates its texture from
+// the cached pixels when the graphics device is reset, instead of reading
+// and decoding the file again. When the cache is over its memory budget the
+// least recently used images are removed, those are loaded from the file.
+// One cache may be shared by many TextureManagers, see TextureManager::setCache().
+// It is not locked: it is used on the thread that owns the graphics device,
+// by TextureLoader::update() and TextureManager::onResetDevice().
+// Game owns a TextureCache for the textures of its TextureRegistry.
+
+#ifndef _TEXTURECACHE_H         // Prevent multiple definitions if this
+#define _TEXTURECACHE_H         // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <map>
+#include <string>
+#include <vector>
+#include "spriteData.h"
+
+namespace textureCacheNS
+{
+    const size_t BUDGET = 64*1024*1024;     // default memory budget in bytes
+}
+
+class TextureCache
+{
+  private:
+    struct Entry
+    {
+        COLOR_ARGB transcolor;      // color key the pixels were loaded with
+        UINT    width;
+        UINT    height;
+        std::vector<COLOR_ARGB> pixels;
+        UINT    lastUse;            // useCount when last used
+    };
+    std::map<std::string, Entry> entries;   // by file name
+    size_t  budget;             // bytes
+    size_t  bytes;              // bytes of pixels in the cache
+    UINT    useCount;           // counts find() and add() calls, for LRU
+    UINT    hits;               // find() calls that found the image
+    UINT    misses;             // find() calls that did not
+    UINT    evictions;          // images removed to stay in budget
+
+    // Remove least recently used images until bytes + needed <= budget.
+    void    evict(size_t needed);
+
+  public:
+    // Constructor
+    TextureCache(size_t budgetBytes = textureCacheNS::BUDGET);
+
+    // Find the pixels of file loaded with color key transcolor.
+    // Post: width, height and pixels are set if found. pixels is valid
+    //       until the next add(), remove(), clear() or setBudget().
+    // Returns false if not in the cache.
+    bool    find(const char *file, COLOR_ARGB transcolor, UINT &width, UINT &height,
+                 const COLOR_ARGB *&pixels);
+
+    // Add the pixels of file. The pixels are moved into the cache, the
+    // vector is empty after the call. Images larger than the budget are
+    // not kept.
+    void    add(const char *file, COLOR_ARGB transcolor, UINT width, UINT height,
+                std::vector<COLOR_ARGB> &pixels);
+
+    // Remove the pixels of file.
+    void    remove(const char *file);
+
+    // Remove all images.
+    void    clear();
+
+    // Set the memory budget in bytes, removing images if over it.
+    void    setBudget(size_t budgetBytes);
+
+    // Return the memory budget in bytes.
+    size_t  getBudget() const       {return budget;}
+
+    // Return bytes of pixels in the cache.
+    size_t  getBytes() const        {return bytes;}
+
+    // Return number of images in the cache.
+    UINT    getCount() const        {return (UINT)entries.size();}
+
+    // Return number of find() calls that found the image.
+    UINT    getHits() const         {return hits;}
+
+    // Return number of find() calls that did not find the image.
+    UINT    getMisses() const       {return misses;}
+
+    // Return number of images removed to stay in budget.
+    UINT    getEvictions() const    {return evictions;}
+};
+
+#endif
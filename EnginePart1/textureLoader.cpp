@@ -0,0 +1,271 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// textureLoader.cpp v1.0
+// Loads texture files on worker threads, see textureLoader.h
+
+#include "textureLoader.h"
+#include <algorithm>
+#include "textureManager.h"
+#include "imageFile.h"
+#include "gameClock.h"
+
+//=============================================================================
+// Constructor
+//=============================================================================
+TextureLoader::TextureLoader()
+{
+    graphics = NULL;
+    active = 0;
+    sequence = 0;
+    loaded.store(0);
+    failed.store(0);
+    uploadTime.store(0);
+    stopping = false;
+}
+
+//=============================================================================
+// Destructor
+//=============================================================================
+TextureLoader::~TextureLoader()
+{
+    stop();
+}
+
+//=============================================================================
+// Start the worker threads
+// Returns false if already started or no thread could be created
+//=============================================================================
+bool TextureLoader::initialize(Graphics *g, UINT count)
+{
+    if (!workers.empty() || g == NULL)
+        return false;
+    graphics = g;
+    stopping = false;
+    if (count == 0)
+        count = 1;
+    for (UINT i = 0; i < count; i++)
+    {
+        try{
+            workers.push_back(std::thread(&TextureLoader::workerMain, this));
+        }
+        catch(...) {break;}     // run with the workers created so far
+    }
+    return !workers.empty();
+}
+
+//=============================================================================
+// Stop the worker threads
+// Jobs not uploaded are dropped, their TextureManagers are set as failed.
+//=============================================================================
+void TextureLoader::stop()
+{
+    if (workers.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+    jobDecoded.notify_all();
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+    workers.clear();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        if (jobs[i]->textureManager)
+            jobs[i]->textureManager->setLoadFailed();
+        delete jobs[i];
+    }
+    jobs.clear();
+    waiting.clear();
+    decoded.clear();
+}
+
+//=============================================================================
+// Queue a texture file
+// Returns false if the loader is not started
+//=============================================================================
+bool TextureLoader::load(TextureManager *tm, const char *file, COLOR_ARGB transcolor,
+                         int priority)
+{
+    if (tm == NULL || file == NULL || graphics == NULL)   // if not started
+        return false;
+    Job *job = new Job;
+    job->textureManager = tm;
+    job->file = file;
+    job->pack = graphics->getAssetPack();
+    job->transcolor = transcolor;
+    job->priority = priority;
+    job->width = 0;
+    job->height = 0;
+    job->decoded = false;
+    job->levels = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (workers.empty() || stopping)
+        {
+            delete job;
+            return false;
+        }
+        job->sequence = sequence++;
+        jobs.push_back(job);
+        waiting.push_back(job);
+        std::push_heap(waiting.begin(), waiting.end(), JobOrder());
+    }
+    workReady.notify_one();
+    return true;
+}
+
+//=============================================================================
+// Forget the jobs of tm
+// The upload of a job is done with mutex locked, so after this returns the
+// loader no longer uses tm.
+//=============================================================================
+void TextureLoader::cancel(TextureManager *tm)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < jobs.size(); i++)
+        if (jobs[i]->textureManager == tm)
+            jobs[i]->textureManager = NULL;     // deleted when next seen by a worker or update()
+}
+
+//=============================================================================
+// Remove job from jobs and delete it
+// mutex must be locked
+//=============================================================================
+void TextureLoader::deleteJob(Job *job)
+{
+    std::vector<Job*>::iterator it = std::find(jobs.begin(), jobs.end(), job);
+    if (it != jobs.end())
+    {
+        *it = jobs.back();
+        jobs.pop_back();
+    }
+    delete job;
+}
+
+//=============================================================================
+// Worker thread
+// Takes the waiting job with the highest priority, reads and decodes its file
+// without holding the lock, then passes it to update().
+//=============================================================================
+void TextureLoader::workerMain()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        while (!stopping && waiting.empty())
+            workReady.wait(lock);
+        if (stopping)
+            return;
+        std::pop_heap(waiting.begin(), waiting.end(), JobOrder());
+        Job *job = waiting.back();
+        waiting.pop_back();
+        if (job->textureManager == NULL)    // cancelled
+        {
+            deleteJob(job);
+            continue;
+        }
+        active++;
+        lock.unlock();
+        // file, transcolor and the results are only used by this thread until
+        // the job is put in decoded
+        std::vector<BYTE> buffer;
+        const BYTE *data;
+        size_t size;
+        job->decoded = ImageFile::read(job->pack, job->file.c_str(), buffer, data, size) &&
+                       ImageFile::load(data, size, job->transcolor, job->width, job->height,
+                                       job->pixels, &job->sheet);
+        const CookedHeader *cooked = job->decoded ? ImageFile::getCooked(data, size) : NULL;
+        if (cooked && cooked->levels > 1)   // keep the mip levels of a cooked file
+        {
+            const COLOR_ARGB *mips = ImageFile::getCookedMips(cooked);
+            job->levels = cooked->levels;
+            job->mips.assign(mips, mips + Mipmap::getChainSize(job->width, job->height,
+                                                                job->levels));
+        }
+        lock.lock();
+        active--;
+        decoded.push_back(job);
+        jobDecoded.notify_all();
+    }
+}
+
+//=============================================================================
+// Upload decoded textures
+// A texture that can not be created because the device is lost is kept and
+// uploaded by a later update(). budget < 0 for no time limit.
+// The pixels of a texture with a cache are moved into the cache.
+//=============================================================================
+void TextureLoader::update(float budget)
+{
+    LONGLONG start = GameClock::ticks();
+    LONGLONG limit = GameClock::fromSeconds(budget);
+    UINT uploaded = 0;
+    std::lock_guard<std::mutex> lock(mutex);
+    while (!decoded.empty())
+    {
+        Job *job = decoded.front();
+        TextureManager *tm = job->textureManager;
+        if (tm)
+        {
+            if (uploaded > 0 && budget >= 0 && GameClock::ticks() - start >= limit)
+                break;
+            LP_TEXTURE texture = NULL;
+            HRESULT result = E_FAIL;
+            if (job->decoded)
+            {
+                result = graphics->createTexture(&job->pixels[0], job->width, job->height, texture,
+                                                 job->levels, job->mips.empty() ? NULL : &job->mips[0]);
+                if (FAILED(result) && FAILED(graphics->getDeviceState()))
+                    break;          // try again after the device is reset
+            }
+            if (SUCCEEDED(result))
+            {
+                tm->setLoaded(texture, job->width, job->height, job->sheet);
+                if (tm->getCache())     // keep the pixels for a device reset
+                    tm->getCache()->add(job->file.c_str(), job->transcolor, job->width,
+                                        job->height, job->pixels);
+                loaded++;
+            }
+            else
+            {
+                tm->setLoadFailed();
+                failed++;
+            }
+            uploaded++;
+        }
+        decoded.pop_front();
+        deleteJob(job);
+    }
+    uploadTime.store((float)GameClock::toSeconds(GameClock::ticks() - start));
+}
+
+//=============================================================================
+// Wait for every queued file to be decoded, then upload them all
+//=============================================================================
+void TextureLoader::finish()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping && (!waiting.empty() || active > 0))
+            jobDecoded.wait(lock);
+    }
+    update(-1);
+}
+
+//=============================================================================
+// Return number of textures queued and not yet uploaded
+//=============================================================================
+UINT TextureLoader::getPending()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    UINT pending = 0;
+    for (size_t i = 0; i < jobs.size(); i++)
+        if (jobs[i]->textureManager)
+            pending++;
+    return pending;
+}
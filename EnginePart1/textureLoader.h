@@ -0,0 +1,141 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// textureLoader.h v1.0
+// A TextureLoader reads and decodes texture files on worker threads so the
+// game keeps running while textures load. Only the upload of the decoded
+// pixels to the graphics device is done on the thread that owns the device,
+// a few textures per frame, by update(). Game owns a TextureLoader and calls
+// update() every frame, on the render thread when one is running.
+// Usage:
+//   texture.initialize(graphics, FILE, getTextureLoader());    // returns at once
+//   image.initialize(graphics, 0, 0, 0, &texture);
+//   image.setPlaceholder(&placeholderTexture);                  // optional
+// The Image draws the placeholder, or nothing, until texture.isLoading()
+// is false.
+
+#ifndef _TEXTURELOADER_H        // Prevent multiple definitions if this
+#define _TEXTURELOADER_H        // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "graphics.h"
+#include "assetPack.h"
+
+class TextureManager;
+
+namespace textureLoaderNS
+{
+    const UINT WORKERS = 2;             // default number of worker threads
+    const float UPLOAD_TIME = 0.002f;   // default seconds of uploading per update()
+}
+
+class TextureLoader
+{
+  private:
+    // A texture file to load
+    struct Job
+    {
+        TextureManager *textureManager; // NULL when cancelled
+        std::string file;
+        const AssetPack *pack;          // looked up before the file, may be NULL
+        COLOR_ARGB  transcolor;
+        int     priority;               // higher loads first
+        UINT    sequence;               // order of load() calls, first loads first
+        UINT    width, height;
+        std::vector<COLOR_ARGB> pixels; // decoded by a worker
+        UINT    levels;                 // mip levels of a cooked file, 0 if not stored
+        std::vector<COLOR_ARGB> mips;   // levels 1 to levels-1 of a cooked file
+        SpriteSheet sheet;              // frames of a cooked file
+        bool    decoded;                // false if the file could not be decoded
+    };
+
+    // Heap order of waiting jobs, the top is the one to decode next.
+    struct JobOrder
+    {
+        bool operator()(const Job *a, const Job *b) const
+        {
+            if (a->priority != b->priority)
+                return a->priority < b->priority;
+            return a->sequence > b->sequence;
+        }
+    };
+
+    Graphics *graphics;
+    std::vector<std::thread> workers;
+    std::vector<Job*> waiting;          // heap ordered by JobOrder
+    std::deque<Job*>  decoded;          // ready for upload, in the order decoded
+    std::vector<Job*> jobs;             // every job not yet finished, for cancel()
+    std::mutex mutex;                   // guards everything above and the upload of a job
+    std::condition_variable workReady;  // signals the workers
+    std::condition_variable jobDecoded; // signals finish()
+    UINT    active;                     // jobs being decoded
+    UINT    sequence;
+    std::atomic<UINT>  loaded;          // textures uploaded
+    std::atomic<UINT>  failed;          // textures that could not be loaded
+    std::atomic<float> uploadTime;      // seconds spent in the last update()
+    bool    stopping;
+
+    // Worker thread main loop.
+    void workerMain();
+
+    // Remove job from jobs and delete it. mutex must be locked.
+    void deleteJob(Job *job);
+
+  public:
+    // Constructor
+    TextureLoader();
+
+    // Destructor, stops the workers
+    virtual ~TextureLoader();
+
+    // Start the worker threads.
+    // Pre: *g points to Graphics object
+    //      count = number of worker threads
+    // Returns false if already started or no thread could be created.
+    bool initialize(Graphics *g, UINT count = textureLoaderNS::WORKERS);
+
+    // Stop the worker threads. Jobs not yet uploaded are dropped and their
+    // TextureManagers are set as failed.
+    void stop();
+
+    // Queue the file to be loaded into tm. Called by TextureManager::initialize(),
+    // use that instead. Files with a higher priority load first, files of the
+    // same priority in the order queued.
+    // Returns false if the loader is not started.
+    bool load(TextureManager *tm, const char *file, COLOR_ARGB transcolor, int priority);
+
+    // Forget the jobs of tm. Called by the TextureManager destructor.
+    // Waits if the texture of tm is being uploaded.
+    void cancel(TextureManager *tm);
+
+    // Upload decoded textures to the graphics device.
+    // Call on the thread that owns the graphics device, once per frame.
+    // Stops after budget seconds, at least one texture is uploaded per call.
+    void update(float budget = textureLoaderNS::UPLOAD_TIME);
+
+    // Wait for every queued file to be decoded and upload them all.
+    // Call on the thread that owns the graphics device, e.g. at the end of
+    // a loading screen.
+    void finish();
+
+    // Return number of textures queued and not yet uploaded.
+    UINT getPending();
+
+    // Return number of textures uploaded.
+    UINT getLoaded() const      {return loaded.load();}
+
+    // Return number of textures that could not be loaded.
+    UINT getFailed() const      {return failed.load();}
+
+    // Return seconds spent uploading in the last update().
+    float getUploadTime() const {return uploadTime.load();}
+};
+
+#endif
@@ -13,10 +13,16 @@
 #define _TEXTUREMANAGER_H       // file is included in more than one place
 #define WIN32_LEAN_AND_MEAN
 
+#include <atomic>
 #include "graphics.h"
 #include "constants.h"
+#include "textureAtlas.h"
+#include "textureCache.h"
+#include "textureResidency.h"
 
-class TextureManager
+class TextureLoader;
+
+class TextureManager : public Resident
 {
     // TextureManager properties
   private:
@@ -25,9 +31,30 @@ class TextureManager
     LP_TEXTURE texture;     // pointer to texture
     const char *file;       // name of file
     Graphics *graphics;     // save pointer to graphics
+    TextureAtlas *atlas;    // atlas holding the image, NULL for own texture
+    AtlasRect atlasRect;    // position of the image in the atlas
+    SpriteSheet sheet;      // frames of a cooked sprite sheet, none if not cooked
+    TextureCache *cache;    // system memory copy of the pixels, may be NULL
+    TextureLoader *loader;  // loading the texture on a worker thread, may be NULL
+    TextureResidency *residency;    // memory budget the texture counts against, may be NULL
+    std::atomic<bool> evicted;  // released by residency, loaded again when drawn, set on the render thread
+    int     priority;       // TextureLoader priority
+    std::atomic<bool> loading;  // true until the loader has created the texture
+    bool    loadFailed;     // true if the loader could not load the file
+    float   resetTime;      // seconds taken by the last onResetDevice()
+    bool    resetFromCache; // true if the last onResetDevice() used the cache
     bool    initialized;    // true when successfully initialized
     HRESULT hr;             // standard return type
 
+    // Load the texture, from the cache if possible.
+    HRESULT load();
+
+    // Return bytes of the texture and its mip levels.
+    UINT64  getBytes() const;
+
+    // Load an evicted texture again.
+    void    reload();
+
   public:
     // Constructor
     TextureManager();
@@ -35,8 +62,21 @@ class TextureManager
     // Destructor
     virtual ~TextureManager();
 
-    // Returns a pointer to the texture
-    LP_TEXTURE getTexture() const {return texture;}
+    // Returns a pointer to the texture, the atlas page when in an atlas.
+    // NULL while the texture is loading.
+    LP_TEXTURE getTexture() const
+    {
+        if (loading.load(std::memory_order_acquire))
+            return NULL;
+        return atlas ? atlas->getPage(atlasRect.page) : texture;
+    }
+
+    // Return true while a TextureLoader is loading the texture.
+    // The width and height are 0 until it is loaded.
+    bool isLoading() const  {return loading.load(std::memory_order_acquire);}
+
+    // Return true if the TextureLoader could not load the file.
+    bool getLoadFailed() const {return !isLoading() && loadFailed;}
 
     // Returns the texture width
     UINT getWidth() const {return width;}
@@ -44,12 +84,104 @@ class TextureManager
     // Return the texture height
     UINT getHeight() const {return height;}
 
+    // Return name of the texture file
+    const char* getFile() const {return file;}
+
+    // Return left edge of the image in getTexture(), 0 unless in an atlas
+    UINT getOffsetX() const {return atlas ? atlasRect.x : 0;}
+
+    // Return top edge of the image in getTexture(), 0 unless in an atlas
+    UINT getOffsetY() const {return atlas ? atlasRect.y : 0;}
+
+    // Use cache for the pixels of the texture. Call before initialize().
+    // The pixels are added when the texture is first loaded, by the
+    // TextureLoader when there is one, and used by onResetDevice().
+    // NULL to read the file every time (default).
+    void setCache(TextureCache *c) {cache = c;}
+
+    // Return the cache, NULL if none.
+    TextureCache* getCache() const {return cache;}
+
+    // Return seconds taken by the last onResetDevice().
+    float getResetTime() const  {return resetTime;}
+
+    // Return true if the last onResetDevice() used the cache instead of the file.
+    bool getResetFromCache() const {return resetFromCache;}
+
+    // Count the texture against the memory budget of r. Call before initialize().
+    // NULL to keep the texture until onLostDevice() (default). Not used for
+    // textures in an atlas.
+    void setResidency(TextureResidency *r) {residency = r;}
+
+    // Return true if the texture was evicted by the residency and not yet
+    // loaded again. Safe to call from any thread.
+    bool getEvicted() const {return evicted.load();}
+
+    // Mark the texture used this frame, loading it again if it was evicted.
+    // Called by Image::draw() before getTexture(), also for Images culled
+    // off screen, so the texture can not be evicted between the two.
+    // An evicted texture is loaded by the TextureLoader of the residency if
+    // it has one, then getTexture() is NULL until it is loaded, like any
+    // loading texture.
+    void touch()
+    {
+        if (residency && !residency->touch(this))
+            reload();
+    }
+
+    // Release the texture to stay in the memory budget. Called by TextureResidency.
+    virtual void evict();
+
+    // Return the atlas, NULL if the image has its own texture
+    TextureAtlas* getAtlas() const {return atlas;}
+
+    // Return the frames of a cooked sprite sheet, NULL if the file has none.
+    // The rects do not include the atlas offset.
+    const SpriteSheet* getSpriteSheet() const
+    {
+        if (isLoading() || sheet.frames.empty())
+            return NULL;
+        return &sheet;
+    }
+
     // Initialize the textureManager
     // Pre: *g points to Graphics object
     //      *file points to name of texture file to load
     // Post: The texture file is loaded
     virtual bool initialize(Graphics *g, const char *file);
 
+    // Initialize the textureManager with the image in an atlas
+    // Pre: *g points to Graphics object
+    //      *file points to name of texture file to load
+    //      *a points to initialized TextureAtlas
+    // Post: The image is registered with the atlas. getTexture() returns
+    //       NULL until atlas->build() is called.
+    virtual bool initialize(Graphics *g, const char *file, TextureAtlas *a);
+
+    // Initialize the textureManager and load the texture in the background
+    // Pre: *g points to Graphics object
+    //      *file points to name of texture file to load
+    //      *l points to initialized TextureLoader
+    //      priority = load order, higher first
+    // Post: The file is queued. isLoading() is true and getTexture() returns
+    //       NULL until the loader has created the texture.
+    virtual bool initialize(Graphics *g, const char *file, TextureLoader *l, int priority = 0);
+
+    // Set the texture loaded by the TextureLoader. Called by TextureLoader.
+    // Post: s is swapped with the sprite sheet of the texture
+    void setLoaded(LP_TEXTURE t, UINT w, UINT h, SpriteSheet &s);
+
+    // The TextureLoader could not load the file. Called by TextureLoader.
+    void setLoadFailed();
+
+    // Set position of the image in the atlas. Called by TextureAtlas.
+    void setAtlasRect(const AtlasRect &r)
+    {
+        atlasRect = r;
+        width = r.width;
+        height = r.height;
+    }
+
     // Release resources
     virtual void onLostDevice();
 
@@ -0,0 +1,148 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// textureRegistry.cpp v1.0
+// Shared, reference counted TextureManagers, see textureRegistry.h
+
+#include "textureRegistry.h"
+#include "assetPack.h"
+
+//=============================================================================
+// Constructor
+//=============================================================================
+TextureRegistry::TextureRegistry()
+{
+    graphics = NULL;
+    loader = NULL;
+    residency = NULL;
+    cache = NULL;
+    hits = 0;
+    misses = 0;
+}
+
+//=============================================================================
+// Destructor
+//=============================================================================
+TextureRegistry::~TextureRegistry()
+{
+    for (EntryMap::iterator it = entries.begin(); it != entries.end(); ++it)
+    {
+        SAFE_DELETE(it->second->texture);
+        delete it->second;
+    }
+    entries.clear();
+    byTexture.clear();
+}
+
+//=============================================================================
+// Initialize the registry
+//=============================================================================
+void TextureRegistry::initialize(Graphics *g, TextureLoader *l, TextureResidency *r,
+                                 TextureCache *c)
+{
+    graphics = g;
+    loader = l;
+    residency = r;
+    cache = c;
+}
+
+//=============================================================================
+// Return the entry of name, entries.end() if none
+// Names are compared as well as IDs, two names with the same ID are
+// different textures.
+//=============================================================================
+TextureRegistry::EntryMap::iterator TextureRegistry::find(UINT id, const std::string &name)
+{
+    std::pair<EntryMap::iterator, EntryMap::iterator> range = entries.equal_range(id);
+    for (EntryMap::iterator it = range.first; it != range.second; ++it)
+        if (it->second->name == name)
+            return it;
+    return entries.end();
+}
+
+//=============================================================================
+// Return the texture of file, loading it if this is the first user
+// Returns NULL on error
+//=============================================================================
+TextureManager* TextureRegistry::acquire(const char *file, int priority)
+{
+    if (file == NULL || graphics == NULL)
+        return NULL;
+    UINT id = AssetPack::getId(file);
+    std::string name = AssetPack::normalizeName(file);
+    EntryMap::iterator it = find(id, name);
+    if (it != entries.end())
+    {
+        it->second->refCount++;
+        hits++;
+        return it->second->texture;
+    }
+
+    Entry *e = new Entry;
+    e->name = name;
+    e->file = file;
+    e->refCount = 1;
+    e->texture = new TextureManager;
+    e->texture->setCache(cache);
+    e->texture->setResidency(residency);
+    if (!e->texture->initialize(graphics, e->file.c_str(), loader, priority))
+    {
+        delete e->texture;
+        delete e;
+        return NULL;
+    }
+    byTexture[e->texture] = entries.insert(EntryMap::value_type(id, e));
+    misses++;
+    return e->texture;
+}
+
+//=============================================================================
+// Release a texture returned by acquire()
+// The TextureManager is deleted with its last user. Frames recorded for the
+// render thread hold their own texture references, so that is safe while
+// the render thread still draws them.
+//=============================================================================
+void TextureRegistry::release(TextureManager *texture)
+{
+    std::map<TextureManager*, EntryMap::iterator>::iterator found = byTexture.find(texture);
+    if (found == byTexture.end())
+        return;
+    EntryMap::iterator it = found->second;
+    Entry *e = it->second;
+    if (--e->refCount == 0)
+    {
+        delete e->texture;
+        delete e;
+        entries.erase(it);
+        byTexture.erase(found);
+    }
+}
+
+//=============================================================================
+// Return number of users of the texture of file
+//=============================================================================
+UINT TextureRegistry::getRefCount(const char *file)
+{
+    if (file == NULL)
+        return 0;
+    EntryMap::iterator it = find(AssetPack::getId(file), AssetPack::normalizeName(file));
+    return it == entries.end() ? 0 : it->second->refCount;
+}
+
+//=============================================================================
+// Call onLostDevice() for every texture
+//=============================================================================
+void TextureRegistry::onLostDevice()
+{
+    for (EntryMap::iterator it = entries.begin(); it != entries.end(); ++it)
+        it->second->texture->onLostDevice();
+}
+
+//=============================================================================
+// Call onResetDevice() for every texture
+//=============================================================================
+void TextureRegistry::onResetDevice()
+{
+    for (EntryMap::iterator it = entries.begin(); it != entries.end(); ++it)
+        it->second->texture->onResetDevice();
+}
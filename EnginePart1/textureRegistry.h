@@ -0,0 +1,97 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// textureRegistry.h v1.0
+// A TextureRegistry shares one TextureManager between every user of the
+// same texture file, so a sprite sheet used by hundreds of enemies is read,
+// decoded and held in memory once. Textures are found by ID, the
+// AssetPack::getId() hash of the file name, and are reference counted: the
+// TextureManager is deleted when the last user releases it.
+// Game owns a TextureRegistry, see Game::getTextureRegistry().
+// Usage:
+//   TextureManager *t = registry->acquire(ENEMY_IMAGE);   // NULL on error
+//   image.initialize(graphics, w, h, ncols, t);
+//   ...
+//   registry->release(t);                                 // when done with it
+// Registry textures are released and restored by Game::releaseAll() and
+// Game::resetAll(), do not call onLostDevice() or onResetDevice() on them.
+// release() may delete a texture on the game thread while the render thread
+// draws an earlier frame with it: the recorded RenderCommandList holds its
+// own reference to the texture, see renderCommand.h.
+
+#ifndef _TEXTUREREGISTRY_H      // Prevent multiple definitions if this
+#define _TEXTUREREGISTRY_H      // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <map>
+#include <string>
+#include "textureManager.h"
+
+class TextureRegistry
+{
+  private:
+    struct Entry
+    {
+        std::string name;           // normalized file name, for comparing
+        std::string file;           // file name of the first acquire(), TextureManager points to it
+        TextureManager *texture;
+        UINT    refCount;
+    };
+    typedef std::multimap<UINT, Entry*> EntryMap;   // by ID, names with the same ID share a key
+    EntryMap entries;
+    std::map<TextureManager*, EntryMap::iterator> byTexture;    // for release()
+    Graphics *graphics;
+    TextureLoader *loader;      // loads new textures, may be NULL
+    TextureResidency *residency;    // budget of new textures, may be NULL
+    TextureCache *cache;        // pixels of new textures, may be NULL
+    UINT    hits;               // acquire() calls that shared a texture
+    UINT    misses;             // acquire() calls that loaded a texture
+
+    // Return the entry of name with ID id, entries.end() if none.
+    EntryMap::iterator find(UINT id, const std::string &name);
+
+  public:
+    // Constructor
+    TextureRegistry();
+
+    // Destructor, deletes the textures still acquired
+    virtual ~TextureRegistry();
+
+    // Initialize the registry.
+    // Pre: *g points to Graphics object
+    //      l = loader for new textures, NULL to load them in acquire()
+    //      r = residency for new textures, may be NULL
+    //      c = cache for new textures, may be NULL
+    void initialize(Graphics *g, TextureLoader *l = NULL, TextureResidency *r = NULL,
+                    TextureCache *c = NULL);
+
+    // Return the texture of file, loading it if this is the first user.
+    // Each acquire() must be matched by a release().
+    // priority = TextureLoader priority of a new texture, higher loads first
+    // Returns NULL if the texture could not be loaded.
+    TextureManager* acquire(const char *file, int priority = 0);
+
+    // Release a texture returned by acquire(). The texture is deleted
+    // when it has no users. NULL is ignored.
+    void release(TextureManager *texture);
+
+    // Return number of different textures held.
+    UINT getCount() const   {return (UINT)entries.size();}
+
+    // Return number of users of the texture of file, 0 if not held.
+    UINT getRefCount(const char *file);
+
+    // Return number of acquire() calls that shared a texture already held.
+    UINT getHits() const    {return hits;}
+
+    // Return number of acquire() calls that loaded a texture.
+    UINT getMisses() const  {return misses;}
+
+    // Call onLostDevice() for every texture.
+    void onLostDevice();
+
+    // Call onResetDevice() for every texture.
+    void onResetDevice();
+};
+
+#endif
@@ -0,0 +1,161 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// textureResidency.cpp v1.0
+// Texture memory budget with least recently drawn eviction, see textureResidency.h
+
+#include "textureResidency.h"
+
+//=============================================================================
+// Constructor
+//=============================================================================
+TextureResidency::TextureResidency(UINT64 budgetBytes)
+{
+    loader = NULL;
+    budget = budgetBytes;
+    bytes = 0;
+    frame = 0;
+    evictedCount = 0;
+    evictions = 0;
+    reloads = 0;
+    totalEvictions = 0;
+}
+
+//=============================================================================
+// Register a resident texture
+// An evicted texture that is added again counts as a reload.
+//=============================================================================
+void TextureResidency::add(Resident *r, UINT64 size)
+{
+    if (r == NULL)
+        return;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<Resident*, Entry>::iterator it = entries.find(r);
+    if (it != entries.end())
+    {
+        if (it->second.resident)
+            bytes -= it->second.bytes;  // replaced, e.g. after a device reset
+        else
+        {
+            evictedCount--;
+            reloads++;
+        }
+    }
+    Entry &e = entries[r];
+    e.bytes = size;
+    e.lastUse = frame;
+    e.resident = true;
+    bytes += size;
+}
+
+//=============================================================================
+// Forget r
+//=============================================================================
+void TextureResidency::remove(Resident *r)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<Resident*, Entry>::iterator it = entries.find(r);
+    if (it == entries.end())
+        return;
+    if (it->second.resident)
+        bytes -= it->second.bytes;
+    else
+        evictedCount--;
+    entries.erase(it);
+}
+
+//=============================================================================
+// Mark r used this frame
+// Returns false if r is evicted
+//=============================================================================
+bool TextureResidency::touch(Resident *r)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<Resident*, Entry>::iterator it = entries.find(r);
+    if (it == entries.end())
+        return true;
+    it->second.lastUse = frame;
+    return it->second.resident;
+}
+
+//=============================================================================
+// Start a new frame
+//=============================================================================
+void TextureResidency::beginFrame()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    frame++;
+    evictions = 0;
+    reloads = 0;
+}
+
+//=============================================================================
+// Evict until the resident bytes fit the budget
+// The oldest entry is found by a scan, as in TextureCache. Eviction stops
+// when the oldest one was drawn in the last MIN_AGE frames, so a frame that
+// draws more than the budget stays over budget instead of thrashing.
+//=============================================================================
+void TextureResidency::update()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    while (bytes > budget)
+    {
+        std::map<Resident*, Entry>::iterator oldest = entries.end();
+        for (std::map<Resident*, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+            if (it->second.resident &&
+                (oldest == entries.end() || it->second.lastUse < oldest->second.lastUse))
+                oldest = it;
+        if (oldest == entries.end() || frame - oldest->second.lastUse < textureResidencyNS::MIN_AGE)
+            break;
+        oldest->first->evict();
+        oldest->second.resident = false;
+        bytes -= oldest->second.bytes;
+        evictedCount++;
+        evictions++;
+        totalEvictions++;
+    }
+}
+
+//=============================================================================
+// Set the memory budget in bytes
+//=============================================================================
+void TextureResidency::setBudget(UINT64 budgetBytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    budget = budgetBytes;
+}
+
+//=============================================================================
+// Return the memory budget in bytes
+//=============================================================================
+UINT64 TextureResidency::getBudget()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return budget;
+}
+
+//=============================================================================
+// Return the residency of this frame so far
+//=============================================================================
+ResidencyStats TextureResidency::getStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ResidencyStats stats;
+    stats.frame = frame;
+    stats.budget = budget;
+    stats.bytes = bytes;
+    stats.resident = (UINT)entries.size() - evictedCount;
+    stats.evicted = evictedCount;
+    stats.evictions = evictions;
+    stats.reloads = reloads;
+    return stats;
+}
+
+//=============================================================================
+// Return number of textures evicted since the start
+//=============================================================================
+UINT TextureResidency::getTotalEvictions()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return totalEvictions;
+}
@@ -0,0 +1,119 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// textureResidency.h v1.0
+// TextureResidency keeps the memory used by textures under a budget. Each
+// texture registers its size and is marked used every time it is drawn.
+// When the total is over the budget, the textures drawn longest ago are
+// released, and a released texture is loaded again the next time an Image
+// draws it. One TextureResidency is shared by the TextureManagers of a
+// game, see Game::getTextureResidency() and TextureManager::setResidency().
+// The policy only knows Residents, so it can be tried without a graphics
+// device by registering Residents that count their evict() calls.
+
+#ifndef _TEXTURERESIDENCY_H     // Prevent multiple definitions if this
+#define _TEXTURERESIDENCY_H     // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <map>
+#include <mutex>
+#include "constants.h"
+
+class TextureLoader;
+
+namespace textureResidencyNS
+{
+    const UINT64 BUDGET = 256*1024*1024;    // default memory budget in bytes
+    // A texture drawn in the last MIN_AGE frames is never evicted. The
+    // render thread may still be drawing the frame before the current one.
+    const UINT MIN_AGE = 2;
+}
+
+// Something TextureResidency can release, a TextureManager.
+class Resident
+{
+  public:
+    virtual ~Resident() {}
+
+    // Release the texture. Called by TextureResidency::update() with the
+    // residency locked, so a Resident must not call TextureResidency from here.
+    virtual void evict() = 0;
+};
+
+// Residency of textures at one point in a frame.
+struct ResidencyStats
+{
+    UINT    frame;          // frames started by beginFrame()
+    UINT64  budget;         // bytes
+    UINT64  bytes;          // bytes of resident textures
+    UINT    resident;       // textures in memory
+    UINT    evicted;        // textures released and not yet loaded again
+    UINT    evictions;      // textures released this frame
+    UINT    reloads;        // evicted textures loaded again this frame
+};
+
+class TextureResidency
+{
+  private:
+    struct Entry
+    {
+        UINT64  bytes;
+        UINT    lastUse;        // frame last drawn
+        bool    resident;       // false after evict() until add() again
+    };
+    std::map<Resident*, Entry> entries;
+    std::mutex mutex;           // guards everything, touch() is called by the
+                                // game thread and update() by the render thread
+    TextureLoader *loader;      // loads evicted textures again, may be NULL
+    UINT64  budget;
+    UINT64  bytes;              // bytes of resident entries
+    UINT    frame;
+    UINT    evictedCount;       // entries not resident
+    UINT    evictions;          // this frame
+    UINT    reloads;            // this frame
+    UINT    totalEvictions;
+
+  public:
+    // Constructor
+    TextureResidency(UINT64 budgetBytes = textureResidencyNS::BUDGET);
+
+    // Set the loader used to load evicted textures again. NULL to load them
+    // in Image::draw(), only safe without a render thread.
+    void    setTextureLoader(TextureLoader *l) {loader = l;}
+
+    // Return the loader for evicted textures, may be NULL.
+    TextureLoader* getTextureLoader() const {return loader;}
+
+    // Register a resident texture of size bytes, or mark an evicted one
+    // resident again. Called when the texture is created.
+    void    add(Resident *r, UINT64 size);
+
+    // Forget r. Called when the texture is released for good.
+    void    remove(Resident *r);
+
+    // Mark r used this frame. Called by Image::draw().
+    // Returns false if r was evicted and must be loaded again, true if it is
+    // resident or not registered.
+    bool    touch(Resident *r);
+
+    // Start a new frame. Called by Game::run() before anything is drawn.
+    void    beginFrame();
+
+    // Evict least recently drawn textures until the resident bytes fit the
+    // budget. Call on the thread that owns the graphics device, after a frame.
+    void    update();
+
+    // Set the memory budget in bytes. Textures are evicted by the next update().
+    void    setBudget(UINT64 budgetBytes);
+
+    // Return the memory budget in bytes.
+    UINT64  getBudget();
+
+    // Return the residency of this frame so far.
+    ResidencyStats getStats();
+
+    // Return number of textures evicted since the start.
+    UINT    getTotalEvictions();
+};
+
+#endif
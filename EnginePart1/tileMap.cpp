@@ -0,0 +1,362 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// tileMap.cpp v1.0
+// Chunked tile map, see tileMap.h
+
+#include "tileMap.h"
+#include <cmath>
+
+namespace tileMapNS
+{
+    const float EDGE = 0.001f;      // part of a tile a box edge may be off by and not cover it
+}
+
+//=============================================================================
+// Constructor
+//=============================================================================
+TileMap::TileMap()
+{
+    graphics = NULL;
+    textureManager = NULL;
+    tileWidth = 1;
+    tileHeight = 1;
+    cols = 1;
+    mapCols = 0;
+    mapRows = 0;
+    chunkCols = 0;
+    chunkRows = 0;
+    x = 0;
+    y = 0;
+    layer = 0;
+    colorFilter = graphicsNS::WHITE;
+    chunksDrawn = 0;
+    chunksBuilt = 0;
+}
+
+//=============================================================================
+// Create an empty map of mapC x mapR tiles
+// Returns false on error
+//=============================================================================
+bool TileMap::initialize(Graphics *g, int width, int height, int ncols,
+                         TextureManager *textureM, int mapC, int mapR)
+{
+    if (width <= 0 || height <= 0 || mapC < 0 || mapR < 0)
+        return false;
+    graphics = g;
+    textureManager = textureM;
+    tileWidth = width;
+    tileHeight = height;
+    cols = ncols > 0 ? ncols : 1;
+    mapCols = mapC;
+    mapRows = mapR;
+    chunkCols = (mapC + tileMapNS::CHUNK_SIZE - 1) / tileMapNS::CHUNK_SIZE;
+    chunkRows = (mapR + tileMapNS::CHUNK_SIZE - 1) / tileMapNS::CHUNK_SIZE;
+    chunksBuilt = 0;
+    try{
+        std::vector<Chunk>(chunkCols * chunkRows).swap(chunks);
+        for (size_t n = 0; n < chunks.size(); n++)
+        {
+            chunks[n].tiles.assign(tileMapNS::CHUNK_SIZE * tileMapNS::CHUNK_SIZE,
+                                   tileMapNS::EMPTY);
+            chunks[n].dirty = true;
+        }
+    }
+    catch(...)
+    {
+        chunks.clear();
+        mapCols = mapRows = chunkCols = chunkRows = 0;
+        return false;
+    }
+    return true;
+}
+
+//=============================================================================
+// Set the tile at col,row
+// The chunk of the tile is built again when next drawn.
+//=============================================================================
+void TileMap::setTile(int col, int row, int tile)
+{
+    if (col < 0 || row < 0 || col >= mapCols || row >= mapRows)
+        return;
+    if (tile < 0)
+        tile = tileMapNS::EMPTY;
+    Chunk &c = chunks[(row / tileMapNS::CHUNK_SIZE) * chunkCols + col / tileMapNS::CHUNK_SIZE];
+    int &t = c.tiles[(row % tileMapNS::CHUNK_SIZE) * tileMapNS::CHUNK_SIZE + col % tileMapNS::CHUNK_SIZE];
+    if (t != tile)
+    {
+        t = tile;
+        c.dirty = true;
+    }
+}
+
+//=============================================================================
+// Set every tile, row by row
+//=============================================================================
+void TileMap::setTiles(const int *tiles)
+{
+    if (tiles == NULL)
+        return;
+    for (int row = 0; row < mapRows; row++)
+        for (int col = 0; col < mapCols; col++)
+            setTile(col, row, tiles[row * mapCols + col]);
+}
+
+//=============================================================================
+// Return the tile at col,row, EMPTY outside the map
+//=============================================================================
+int TileMap::getTile(int col, int row) const
+{
+    if (col < 0 || row < 0 || col >= mapCols || row >= mapRows)
+        return tileMapNS::EMPTY;
+    const Chunk &c = chunks[(row / tileMapNS::CHUNK_SIZE) * chunkCols + col / tileMapNS::CHUNK_SIZE];
+    return c.tiles[(row % tileMapNS::CHUNK_SIZE) * tileMapNS::CHUNK_SIZE + col % tileMapNS::CHUNK_SIZE];
+}
+
+//=============================================================================
+// Set whether tiles of frame tile are solid
+//=============================================================================
+void TileMap::setSolid(int tile, bool s)
+{
+    if (tile < 0)
+        return;
+    if (tile >= (int)solid.size())
+        solid.resize(tile + 1, 0);
+    solid[tile] = s ? 1 : 0;
+}
+
+//=============================================================================
+// Return the column and row at a screen position
+//=============================================================================
+int TileMap::getCol(float px) const
+{
+    return (int)floor((px - x) / tileWidth);
+}
+
+int TileMap::getRow(float py) const
+{
+    return (int)floor((py - y) / tileHeight);
+}
+
+//=============================================================================
+// Return the tiles covered from left to right, right not included
+// An edge within EDGE of a tile boundary does not cover the tile past it,
+// so a box moveBox() stopped against a tile does not overlap it.
+//=============================================================================
+void TileMap::colRange(float left, float right, int &c0, int &c1) const
+{
+    c0 = (int)floor((left - x) / tileWidth + tileMapNS::EDGE);
+    c1 = (int)ceil((right - x) / tileWidth - tileMapNS::EDGE) - 1;
+}
+
+void TileMap::rowRange(float top, float bottom, int &r0, int &r1) const
+{
+    r0 = (int)floor((top - y) / tileHeight + tileMapNS::EDGE);
+    r1 = (int)ceil((bottom - y) / tileHeight - tileMapNS::EDGE) - 1;
+}
+
+//=============================================================================
+// Return true if the box overlaps a solid tile
+//=============================================================================
+bool TileMap::overlapsSolid(float left, float top, float right, float bottom) const
+{
+    int c0, c1, r0, r1;
+    colRange(left, right, c0, c1);
+    rowRange(top, bottom, r0, r1);
+    if (c0 < 0) c0 = 0;
+    if (r0 < 0) r0 = 0;
+    if (c1 >= mapCols) c1 = mapCols - 1;
+    if (r1 >= mapRows) r1 = mapRows - 1;
+    for (int row = r0; row <= r1; row++)
+        for (int col = c0; col <= c1; col++)
+            if (isSolid(col, row))
+                return true;
+    return false;
+}
+
+//=============================================================================
+// Move a box by dx, then by dy, stopping at solid tiles
+// Each axis checks the columns or rows the moving edge enters, nearest
+// first, so a fast box does not pass through a thin wall. Only those in
+// the map are checked, outside is not solid.
+// Returns true if the box was stopped
+//=============================================================================
+bool TileMap::moveBox(float &bx, float &by, float w, float h, float dx, float dy) const
+{
+    bool stopped = false;
+    int c0, c1, r0, r1, n0, n1;
+    if (dx != 0)
+    {
+        rowRange(by, by + h, r0, r1);
+        colRange(bx, bx + w, c0, c1);
+        colRange(bx + dx, bx + w + dx, n0, n1);
+        bx += dx;
+        if (r0 < 0) r0 = 0;
+        if (r1 >= mapRows) r1 = mapRows - 1;
+        if (dx > 0)
+        {
+            if (n1 >= mapCols) n1 = mapCols - 1;
+            if (c1 < -1) c1 = -1;
+            for (int col = c1 + 1; col <= n1 && !stopped; col++)
+                for (int row = r0; row <= r1; row++)
+                    if (isSolid(col, row))
+                    {
+                        bx = x + col * tileWidth - w;   // right edge against the tile
+                        stopped = true;
+                        break;
+                    }
+        }
+        else
+        {
+            if (n0 < 0) n0 = 0;
+            if (c0 > mapCols) c0 = mapCols;
+            for (int col = c0 - 1; col >= n0 && !stopped; col--)
+                for (int row = r0; row <= r1; row++)
+                    if (isSolid(col, row))
+                    {
+                        bx = x + (col + 1) * tileWidth; // left edge against the tile
+                        stopped = true;
+                        break;
+                    }
+        }
+    }
+    if (dy != 0)
+    {
+        bool stoppedY = false;
+        colRange(bx, bx + w, c0, c1);
+        rowRange(by, by + h, r0, r1);
+        rowRange(by + dy, by + h + dy, n0, n1);
+        by += dy;
+        if (c0 < 0) c0 = 0;
+        if (c1 >= mapCols) c1 = mapCols - 1;
+        if (dy > 0)
+        {
+            if (n1 >= mapRows) n1 = mapRows - 1;
+            if (r1 < -1) r1 = -1;
+            for (int row = r1 + 1; row <= n1 && !stoppedY; row++)
+                for (int col = c0; col <= c1; col++)
+                    if (isSolid(col, row))
+                    {
+                        by = y + row * tileHeight - h;  // bottom edge against the tile
+                        stoppedY = true;
+                        break;
+                    }
+        }
+        else
+        {
+            if (n0 < 0) n0 = 0;
+            if (r0 > mapRows) r0 = mapRows;
+            for (int row = r0 - 1; row >= n0 && !stoppedY; row--)
+                for (int col = c0; col <= c1; col++)
+                    if (isSolid(col, row))
+                    {
+                        by = y + (row + 1) * tileHeight; // top edge against the tile
+                        stoppedY = true;
+                        break;
+                    }
+        }
+        stopped = stopped || stoppedY;
+    }
+    return stopped;
+}
+
+//=============================================================================
+// Build the sprites of chunk cx,cy
+// Positions are relative to the map and rects to the texture, draw() adds
+// the map position and the atlas offset.
+//=============================================================================
+void TileMap::buildChunk(int cx, int cy)
+{
+    Chunk &c = chunks[cy * chunkCols + cx];
+    c.sprites.clear();
+    SpriteData sd;
+    sd.width = tileWidth;
+    sd.height = tileHeight;
+    sd.scale = 1.0f;
+    sd.angle = 0;
+    sd.texture = NULL;
+    sd.flipHorizontal = false;
+    sd.flipVertical = false;
+    sd.layer = 0;
+    int col0 = cx * tileMapNS::CHUNK_SIZE;
+    int row0 = cy * tileMapNS::CHUNK_SIZE;
+    for (int r = 0; r < tileMapNS::CHUNK_SIZE && row0 + r < mapRows; r++)
+        for (int k = 0; k < tileMapNS::CHUNK_SIZE && col0 + k < mapCols; k++)
+        {
+            int tile = c.tiles[r * tileMapNS::CHUNK_SIZE + k];
+            if (tile < 0)
+                continue;
+            sd.x = (float)((col0 + k) * tileWidth);
+            sd.y = (float)((row0 + r) * tileHeight);
+            sd.rect.left = (tile % cols) * tileWidth;
+            sd.rect.right = sd.rect.left + tileWidth;
+            sd.rect.top = (tile / cols) * tileHeight;
+            sd.rect.bottom = sd.rect.top + tileHeight;
+            c.sprites.push_back(sd);
+        }
+    c.dirty = false;
+    chunksBuilt++;
+}
+
+//=============================================================================
+// Build every chunk again when next drawn
+//=============================================================================
+void TileMap::invalidate()
+{
+    for (size_t n = 0; n < chunks.size(); n++)
+        chunks[n].dirty = true;
+}
+
+//=============================================================================
+// Draw the chunks that are on screen
+// The chunks are found from the map position, chunks off screen are not
+// looked at.
+//=============================================================================
+void TileMap::draw()
+{
+    chunksDrawn = 0;
+    if (graphics == NULL || textureManager == NULL || chunks.empty())
+        return;
+    textureManager->touch();            // load again if evicted
+    LP_TEXTURE texture = textureManager->getTexture();
+    if (texture == NULL)                // if still loading
+        return;
+    float chunkWidth = (float)(tileWidth * tileMapNS::CHUNK_SIZE);
+    float chunkHeight = (float)(tileHeight * tileMapNS::CHUNK_SIZE);
+    int cx0 = (int)floor(-x / chunkWidth);
+    int cx1 = (int)floor((graphics->getWidth() - x) / chunkWidth);
+    int cy0 = (int)floor(-y / chunkHeight);
+    int cy1 = (int)floor((graphics->getHeight() - y) / chunkHeight);
+    if (cx0 < 0) cx0 = 0;
+    if (cy0 < 0) cy0 = 0;
+    if (cx1 >= chunkCols) cx1 = chunkCols - 1;
+    if (cy1 >= chunkRows) cy1 = chunkRows - 1;
+    int offsetX = textureManager->getOffsetX();
+    int offsetY = textureManager->getOffsetY();
+    SpriteData sd;
+    for (int cy = cy0; cy <= cy1; cy++)
+        for (int cx = cx0; cx <= cx1; cx++)
+        {
+            Chunk &c = chunks[cy * chunkCols + cx];
+            if (c.dirty)
+                buildChunk(cx, cy);
+            if (c.sprites.empty())
+                continue;
+            chunksDrawn++;
+            for (size_t i = 0; i < c.sprites.size(); i++)
+            {
+                sd = c.sprites[i];
+                sd.x += x;
+                sd.y += y;
+                sd.rect.left += offsetX;
+                sd.rect.right += offsetX;
+                sd.rect.top += offsetY;
+                sd.rect.bottom += offsetY;
+                sd.texture = texture;
+                sd.layer = layer;
+                if (!graphics->inViewport(sd))  // tiles of an edge chunk may be off screen
+                    continue;
+                graphics->drawSprite(sd, colorFilter);
+            }
+        }
+}
@@ -0,0 +1,161 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// tileMap.h v1.0
+// A TileMap draws a grid of tiles from the frames of one texture, for
+// level backgrounds larger than the screen.
+// Tiles are stored in chunks of CHUNK_SIZE x CHUNK_SIZE. Each chunk keeps
+// the SpriteData of its tiles, built the first time it is drawn and again
+// only after one of its tiles changes. draw() finds the chunks that cover
+// the backbuffer from the map position and draws just those, so the time
+// to draw and the number of sprites drawn depend on the screen size, not
+// the map size.
+// Tiles can be marked solid, and the collision functions test points and
+// boxes against the solid tiles or move a box until it touches one.
+// Coordinates are the ones Images are drawn at, the top left corner of the
+// map is at getX(), getY().
+// Usage:
+//   map.initialize(graphics, 32, 32, 8, &tileTexture, 200, 100);
+//   map.setTiles(levelTiles);              // 200*100 frame numbers, -1 for none
+//   map.setSolid(3, true);                 // frame 3 is a wall
+//   map.setX(-scrollX);                    // scroll
+//   // in render(): map.draw();
+//   // in collisions(): map.moveBox(x, y, w, h, dx, dy);
+
+#ifndef _TILEMAP_H              // Prevent multiple definitions if this
+#define _TILEMAP_H              // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+#include "graphics.h"
+#include "textureManager.h"
+
+namespace tileMapNS
+{
+    const int CHUNK_SIZE = 16;      // tiles in a row and in a column of a chunk
+    const int EMPTY = -1;           // tile number of no tile
+}
+
+class TileMap
+{
+  private:
+    // CHUNK_SIZE x CHUNK_SIZE tiles
+    struct Chunk
+    {
+        std::vector<int> tiles;         // frame numbers, row by row
+        std::vector<SpriteData> sprites;// tiles that are not EMPTY, relative to the map
+        bool    dirty;                  // sprites must be built again
+    };
+
+    Graphics *graphics;
+    TextureManager *textureManager;
+    int     tileWidth;              // tile size in pixels
+    int     tileHeight;
+    int     cols;                   // frames in a row of the texture
+    int     mapCols;                // size of the map in tiles
+    int     mapRows;
+    int     chunkCols;              // size of the map in chunks
+    int     chunkRows;
+    std::vector<Chunk> chunks;      // row by row
+    std::vector<BYTE> solid;        // 1 if tile number n is solid
+    float   x, y;                   // screen position of the top left corner
+    int     layer;
+    COLOR_ARGB colorFilter;
+    UINT    chunksDrawn;            // chunks drawn by the last draw()
+    UINT    chunksBuilt;            // chunk sprites built since initialize()
+
+    // Build the sprites of chunk cx,cy.
+    void    buildChunk(int cx, int cy);
+
+    // Return the tiles covered by left to right, right not included.
+    void    colRange(float left, float right, int &c0, int &c1) const;
+    void    rowRange(float top, float bottom, int &r0, int &r1) const;
+
+  public:
+    // Constructor
+    TileMap();
+
+    // Create an empty map of mapC x mapR tiles.
+    // width,height = tile size, the frame size in the texture
+    // ncols = frames in a row of the texture, 0 for 1
+    // Returns false on error.
+    bool    initialize(Graphics *g, int width, int height, int ncols,
+                       TextureManager *textureM, int mapC, int mapR);
+
+    // Set the tile at col,row to frame tile, EMPTY for none.
+    // Positions outside the map are ignored.
+    void    setTile(int col, int row, int tile);
+
+    // Set every tile from getMapCols()*getMapRows() frame numbers, row by row.
+    void    setTiles(const int *tiles);
+
+    // Return the tile at col,row, EMPTY outside the map.
+    int     getTile(int col, int row) const;
+
+    // Set whether tiles of frame tile are solid.
+    void    setSolid(int tile, bool s);
+
+    // Return true if tiles of frame tile are solid.
+    bool    getSolid(int tile) const
+    {
+        return tile >= 0 && tile < (int)solid.size() && solid[tile] != 0;
+    }
+
+    // Return true if the tile at col,row is solid. Outside the map is not solid.
+    bool    isSolid(int col, int row) const {return getSolid(getTile(col, row));}
+
+    // Return the column and row at screen position px,py.
+    int     getCol(float px) const;
+    int     getRow(float py) const;
+
+    // Return true if the point px,py is in a solid tile.
+    bool    isSolidAt(float px, float py) const {return isSolid(getCol(px), getRow(py));}
+
+    // Return true if the box left,top to right,bottom overlaps a solid tile.
+    // right and bottom are not part of the box.
+    bool    overlapsSolid(float left, float top, float right, float bottom) const;
+
+    // Move the box at bx,by of size w,h by dx, then by dy. The box stops
+    // against the first solid tile in its way on each axis.
+    // Pre: the box does not overlap a solid tile.
+    // Post: bx,by = new position
+    // Returns true if the box was stopped.
+    bool    moveBox(float &bx, float &by, float w, float h, float dx, float dy) const;
+
+    // Draw the chunks that are on screen.
+    void    draw();
+
+    // Build the sprites of every chunk again when next drawn, after the
+    // tile size or texture frames change.
+    void    invalidate();
+
+    // Set screen position of the top left corner of the map.
+    void    setX(float newX)        {x = newX;}
+    void    setY(float newY)        {y = newY;}
+
+    // Set layer of the tiles, see SpriteData.
+    void    setLayer(int l)         {layer = l;}
+
+    // Set color filter of the tiles.
+    void    setColorFilter(COLOR_ARGB color) {colorFilter = color;}
+
+    // Return screen position of the top left corner of the map.
+    float   getX() const            {return x;}
+    float   getY() const            {return y;}
+
+    // Return size of the map in tiles.
+    int     getMapCols() const      {return mapCols;}
+    int     getMapRows() const      {return mapRows;}
+
+    // Return size of a tile in pixels.
+    int     getTileWidth() const    {return tileWidth;}
+    int     getTileHeight() const   {return tileHeight;}
+
+    // Return number of chunks drawn by the last draw().
+    UINT    getChunksDrawn() const  {return chunksDrawn;}
+
+    // Return number of times chunk sprites were built since initialize().
+    UINT    getChunksBuilt() const  {return chunksBuilt;}
+};
+
+#endif
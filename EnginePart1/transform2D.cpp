@@ -0,0 +1,553 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// transform2D.cpp v1.0
+// The transform is the one built by D3DXMatrixTransformation2D in
+// Graphics::drawSprite: scale about the top left corner, rotate about the
+// center of the sprite, then translate to x,y. Flips use a negative scale
+// and move the image back into place.
+
+#include <math.h>
+#include <string.h>
+#include "transform2D.h"
+#include "cpuFeatures.h"
+
+namespace
+{
+    // sincos constants
+    // pi/2 split in three parts for accurate range reduction
+    const float TWO_OVER_PI = 0.636619772367581343f;
+    const float PIO2_1 = 1.5703125f;
+    const float PIO2_2 = 4.837512969970703125e-4f;
+    const float PIO2_3 = 7.54978995489188216e-8f;
+    // polynomials for sin and cos on -pi/4 to pi/4
+    const float SIN_C1 = -1.6666654611e-1f;
+    const float SIN_C2 =  8.3321608736e-3f;
+    const float SIN_C3 = -1.9515295891e-4f;
+    const float COS_C1 =  4.166664568298827e-2f;
+    const float COS_C2 = -1.388731625493765e-3f;
+    const float COS_C3 =  2.443315711809948e-5f;
+}
+
+//=============================================================================
+// Sine and cosine of one angle
+//=============================================================================
+static inline void sinCos1(float a, float &s, float &c)
+{
+    float j = floorf(a*TWO_OVER_PI + 0.5f);         // nearest multiple of pi/2
+    float r = ((a - j*PIO2_1) - j*PIO2_2) - j*PIO2_3;
+    float r2 = r*r;
+    float sr = r + r*r2*(SIN_C1 + r2*(SIN_C2 + r2*SIN_C3));
+    float cr = 1.0f - 0.5f*r2 + r2*r2*(COS_C1 + r2*(COS_C2 + r2*COS_C3));
+    switch ((int)j & 3)                             // quadrant
+    {
+    case 0:  s =  sr; c =  cr; break;
+    case 1:  s =  cr; c = -sr; break;
+    case 2:  s = -sr; c = -cr; break;
+    default: s = -cr; c =  sr; break;
+    }
+}
+
+//=============================================================================
+// Affine transform of one sprite
+//=============================================================================
+static inline void affine1(float x, float y, float scale, float angle,
+                           int width, int height, BYTE flip, Affine2D &out)
+{
+    // Same values as Graphics::drawSprite
+    float centerX = (float)(width/2*scale);
+    float centerY = (float)(height/2*scale);
+    float scaleX = scale, scaleY = scale;
+    if (flip & transform2DNS::FLIP_HORIZONTAL)
+    {
+        scaleX = -scaleX;
+        centerX -= (float)(width*scale);
+        x += (float)(width*scale);
+    }
+    if (flip & transform2DNS::FLIP_VERTICAL)
+    {
+        scaleY = -scaleY;
+        centerY -= (float)(height*scale);
+        y += (float)(height*scale);
+    }
+    float s, c;
+    sinCos1(angle, s, c);
+    out.m11 =  scaleX*c;
+    out.m12 =  scaleX*s;
+    out.m21 = -scaleY*s;
+    out.m22 =  scaleY*c;
+    out.dx = centerX - centerX*c + centerY*s + x;
+    out.dy = centerY - centerX*s - centerY*c + y;
+}
+
+#ifdef CPU_X86
+
+//=============================================================================
+// SSE2 kernel, 4 sprites at a time
+//=============================================================================
+TARGET_SSE2 static inline __m128 select4(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+TARGET_SSE2 static inline void sinCos4(__m128 a, __m128 &s, __m128 &c)
+{
+    __m128i ji = _mm_cvtps_epi32(_mm_mul_ps(a, _mm_set1_ps(TWO_OVER_PI)));
+    __m128 j = _mm_cvtepi32_ps(ji);
+    __m128 r = _mm_sub_ps(a, _mm_mul_ps(j, _mm_set1_ps(PIO2_1)));
+    r = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(PIO2_2)));
+    r = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(PIO2_3)));
+    __m128 r2 = _mm_mul_ps(r, r);
+    __m128 sp = _mm_add_ps(_mm_set1_ps(SIN_C2), _mm_mul_ps(r2, _mm_set1_ps(SIN_C3)));
+    sp = _mm_add_ps(_mm_set1_ps(SIN_C1), _mm_mul_ps(r2, sp));
+    __m128 sr = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), sp));
+    __m128 cp = _mm_add_ps(_mm_set1_ps(COS_C2), _mm_mul_ps(r2, _mm_set1_ps(COS_C3)));
+    cp = _mm_add_ps(_mm_set1_ps(COS_C1), _mm_mul_ps(r2, cp));
+    __m128 cr = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), r2));
+    cr = _mm_add_ps(cr, _mm_mul_ps(_mm_mul_ps(r2, r2), cp));
+
+    // quadrant: odd swaps sin and cos, bit 1 negates sin, bit 1 of q+1 negates cos
+    __m128i one = _mm_set1_epi32(1);
+    __m128i two = _mm_set1_epi32(2);
+    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(ji, one), one));
+    __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(ji, two), 30));
+    __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(ji, one), two), 30));
+    s = _mm_xor_ps(select4(swap, cr, sr), sinSign);
+    c = _mm_xor_ps(select4(swap, sr, cr), cosSign);
+}
+
+// Expand 4 flip bytes to horizontal and vertical lane masks
+TARGET_SSE2 static inline void flipMasks4(const BYTE *flip, __m128 &h, __m128 &v)
+{
+    int bytes;
+    memcpy(&bytes, flip, 4);
+    __m128i zero = _mm_setzero_si128();
+    __m128i f = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+    __m128i fh = _mm_set1_epi32(transform2DNS::FLIP_HORIZONTAL);
+    __m128i fv = _mm_set1_epi32(transform2DNS::FLIP_VERTICAL);
+    h = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(f, fh), fh));
+    v = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(f, fv), fv));
+}
+
+// Affine transforms of sprites i to i+3, m holds m11,m12,m21,m22,dx,dy
+TARGET_SSE2 static inline void affine4(const TransformArrays &in, UINT i, __m128 m[6])
+{
+    __m128 scale = _mm_loadu_ps(in.scale + i);
+    __m128 x = _mm_loadu_ps(in.x + i);
+    __m128 y = _mm_loadu_ps(in.y + i);
+    __m128 w = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(in.width + i)));
+    __m128 h = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(in.height + i)));
+    __m128 half = _mm_set1_ps(0.5f);
+    // width/2 and height/2 are integer divisions in drawSprite
+    __m128 centerX = _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(w, half))), scale);
+    __m128 centerY = _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(h, half))), scale);
+    __m128 ws = _mm_mul_ps(w, scale);
+    __m128 hs = _mm_mul_ps(h, scale);
+    __m128 negScale = _mm_sub_ps(_mm_setzero_ps(), scale);
+
+    __m128 flipH, flipV;
+    flipMasks4(in.flip + i, flipH, flipV);
+    __m128 scaleX = select4(flipH, negScale, scale);
+    centerX = select4(flipH, _mm_sub_ps(centerX, ws), centerX);
+    x = select4(flipH, _mm_add_ps(x, ws), x);
+    __m128 scaleY = select4(flipV, negScale, scale);
+    centerY = select4(flipV, _mm_sub_ps(centerY, hs), centerY);
+    y = select4(flipV, _mm_add_ps(y, hs), y);
+
+    __m128 s, c;
+    sinCos4(_mm_loadu_ps(in.angle + i), s, c);
+    m[0] = _mm_mul_ps(scaleX, c);
+    m[1] = _mm_mul_ps(scaleX, s);
+    m[2] = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(scaleY, s));
+    m[3] = _mm_mul_ps(scaleY, c);
+    m[4] = _mm_add_ps(_mm_add_ps(_mm_sub_ps(centerX, _mm_mul_ps(centerX, c)), _mm_mul_ps(centerY, s)), x);
+    m[5] = _mm_add_ps(_mm_sub_ps(_mm_sub_ps(centerY, _mm_mul_ps(centerX, s)), _mm_mul_ps(centerY, c)), y);
+}
+
+TARGET_SSE2 static UINT sinCosSSE2(const float *angle, float *sinOut, float *cosOut, UINT count)
+{
+    UINT i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 s, c;
+        sinCos4(_mm_loadu_ps(angle + i), s, c);
+        _mm_storeu_ps(sinOut + i, s);
+        _mm_storeu_ps(cosOut + i, c);
+    }
+    return i;
+}
+
+TARGET_SSE2 static UINT affineSSE2(const TransformArrays &in, Affine2D *out, UINT count)
+{
+    UINT i = 0;
+    float t[6][4];
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 m[6];
+        affine4(in, i, m);
+        for (int k = 0; k < 6; k++)
+            _mm_storeu_ps(t[k], m[k]);
+        for (int n = 0; n < 4; n++)
+        {
+            Affine2D &a = out[i+n];
+            a.m11 = t[0][n]; a.m12 = t[1][n];
+            a.m21 = t[2][n]; a.m22 = t[3][n];
+            a.dx  = t[4][n]; a.dy  = t[5][n];
+        }
+    }
+    return i;
+}
+
+TARGET_SSE2 static UINT cornersSSE2(const TransformArrays &in, Quad2D *out, UINT count)
+{
+    UINT i = 0;
+    float t[8][4];
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 m[6];
+        affine4(in, i, m);
+        __m128 w = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(in.width + i)));
+        __m128 h = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(in.height + i)));
+        __m128 rightX = _mm_mul_ps(w, m[0]), rightY = _mm_mul_ps(w, m[1]);
+        __m128 downX = _mm_mul_ps(h, m[2]), downY = _mm_mul_ps(h, m[3]);
+        _mm_storeu_ps(t[0], m[4]);
+        _mm_storeu_ps(t[1], _mm_add_ps(m[4], rightX));
+        _mm_storeu_ps(t[2], _mm_add_ps(m[4], downX));
+        _mm_storeu_ps(t[3], _mm_add_ps(_mm_add_ps(m[4], rightX), downX));
+        _mm_storeu_ps(t[4], m[5]);
+        _mm_storeu_ps(t[5], _mm_add_ps(m[5], rightY));
+        _mm_storeu_ps(t[6], _mm_add_ps(m[5], downY));
+        _mm_storeu_ps(t[7], _mm_add_ps(_mm_add_ps(m[5], rightY), downY));
+        for (int n = 0; n < 4; n++)
+            for (int k = 0; k < 4; k++)
+            {
+                out[i+n].x[k] = t[k][n];
+                out[i+n].y[k] = t[k+4][n];
+            }
+    }
+    return i;
+}
+
+//=============================================================================
+// AVX kernel, 8 sprites at a time
+// Only AVX floating point instructions are used, so AVX2 is not required.
+//=============================================================================
+// and/andnot/or, GCC turns blendv into integer code that AVX does not have
+TARGET_AVX static inline __m256 select8(__m256 mask, __m256 a, __m256 b)
+{
+    return _mm256_or_ps(_mm256_and_ps(mask, a), _mm256_andnot_ps(mask, b));
+}
+
+TARGET_AVX static inline __m256 signIf8(__m256 mask)
+{
+    return _mm256_and_ps(mask, _mm256_set1_ps(-0.0f));
+}
+
+TARGET_AVX static inline void sinCos8(__m256 a, __m256 &s, __m256 &c)
+{
+    __m256 j = _mm256_round_ps(_mm256_mul_ps(a, _mm256_set1_ps(TWO_OVER_PI)),
+                               _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_sub_ps(a, _mm256_mul_ps(j, _mm256_set1_ps(PIO2_1)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(j, _mm256_set1_ps(PIO2_2)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(j, _mm256_set1_ps(PIO2_3)));
+    __m256 r2 = _mm256_mul_ps(r, r);
+    __m256 sp = _mm256_add_ps(_mm256_set1_ps(SIN_C2), _mm256_mul_ps(r2, _mm256_set1_ps(SIN_C3)));
+    sp = _mm256_add_ps(_mm256_set1_ps(SIN_C1), _mm256_mul_ps(r2, sp));
+    __m256 sr = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, r2), sp));
+    __m256 cp = _mm256_add_ps(_mm256_set1_ps(COS_C2), _mm256_mul_ps(r2, _mm256_set1_ps(COS_C3)));
+    cp = _mm256_add_ps(_mm256_set1_ps(COS_C1), _mm256_mul_ps(r2, cp));
+    __m256 cr = _mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(_mm256_set1_ps(0.5f), r2));
+    cr = _mm256_add_ps(cr, _mm256_mul_ps(_mm256_mul_ps(r2, r2), cp));
+
+    // quadrant 0-3 computed in floating point
+    __m256 q = _mm256_sub_ps(j, _mm256_mul_ps(_mm256_set1_ps(4.0f),
+                    _mm256_floor_ps(_mm256_mul_ps(j, _mm256_set1_ps(0.25f)))));
+    __m256 odd = _mm256_sub_ps(q, _mm256_mul_ps(_mm256_set1_ps(2.0f),
+                    _mm256_floor_ps(_mm256_mul_ps(q, _mm256_set1_ps(0.5f)))));
+    __m256 swap = _mm256_cmp_ps(odd, _mm256_set1_ps(0.5f), _CMP_GT_OQ);
+    __m256 sinNeg = _mm256_cmp_ps(q, _mm256_set1_ps(1.5f), _CMP_GT_OQ);
+    __m256 cosNeg = _mm256_and_ps(_mm256_cmp_ps(q, _mm256_set1_ps(0.5f), _CMP_GT_OQ),
+                                  _mm256_cmp_ps(q, _mm256_set1_ps(2.5f), _CMP_LT_OQ));
+    s = _mm256_xor_ps(select8(swap, cr, sr), signIf8(sinNeg));
+    c = _mm256_xor_ps(select8(swap, sr, cr), signIf8(cosNeg));
+}
+
+// Expand 8 flip bytes to horizontal and vertical lane masks
+TARGET_AVX static inline void flipMasks8(const BYTE *flip, __m256 &h, __m256 &v)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i f16 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)flip), zero);
+    __m128i lo = _mm_unpacklo_epi16(f16, zero);
+    __m128i hi = _mm_unpackhi_epi16(f16, zero);
+    __m128i fh = _mm_set1_epi32(transform2DNS::FLIP_HORIZONTAL);
+    __m128i fv = _mm_set1_epi32(transform2DNS::FLIP_VERTICAL);
+    h = _mm256_insertf128_ps(_mm256_castps128_ps256(
+            _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(lo, fh), fh))),
+            _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(hi, fh), fh)), 1);
+    v = _mm256_insertf128_ps(_mm256_castps128_ps256(
+            _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(lo, fv), fv))),
+            _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(hi, fv), fv)), 1);
+}
+
+// Affine transforms of sprites i to i+7, m holds m11,m12,m21,m22,dx,dy
+TARGET_AVX static inline void affine8(const TransformArrays &in, UINT i, __m256 m[6])
+{
+    __m256 scale = _mm256_loadu_ps(in.scale + i);
+    __m256 x = _mm256_loadu_ps(in.x + i);
+    __m256 y = _mm256_loadu_ps(in.y + i);
+    __m256 w = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(in.width + i)));
+    __m256 h = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(in.height + i)));
+    __m256 half = _mm256_set1_ps(0.5f);
+    // width/2 and height/2 are integer divisions in drawSprite
+    __m256 centerX = _mm256_mul_ps(_mm256_round_ps(_mm256_mul_ps(w, half), _MM_FROUND_TO_ZERO), scale);
+    __m256 centerY = _mm256_mul_ps(_mm256_round_ps(_mm256_mul_ps(h, half), _MM_FROUND_TO_ZERO), scale);
+    __m256 ws = _mm256_mul_ps(w, scale);
+    __m256 hs = _mm256_mul_ps(h, scale);
+    __m256 negScale = _mm256_sub_ps(_mm256_setzero_ps(), scale);
+
+    __m256 flipH, flipV;
+    flipMasks8(in.flip + i, flipH, flipV);
+    __m256 scaleX = select8(flipH, negScale, scale);
+    centerX = select8(flipH, _mm256_sub_ps(centerX, ws), centerX);
+    x = select8(flipH, _mm256_add_ps(x, ws), x);
+    __m256 scaleY = select8(flipV, negScale, scale);
+    centerY = select8(flipV, _mm256_sub_ps(centerY, hs), centerY);
+    y = select8(flipV, _mm256_add_ps(y, hs), y);
+
+    __m256 s, c;
+    sinCos8(_mm256_loadu_ps(in.angle + i), s, c);
+    m[0] = _mm256_mul_ps(scaleX, c);
+    m[1] = _mm256_mul_ps(scaleX, s);
+    m[2] = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_mul_ps(scaleY, s));
+    m[3] = _mm256_mul_ps(scaleY, c);
+    m[4] = _mm256_add_ps(_mm256_add_ps(_mm256_sub_ps(centerX, _mm256_mul_ps(centerX, c)),
+                         _mm256_mul_ps(centerY, s)), x);
+    m[5] = _mm256_add_ps(_mm256_sub_ps(_mm256_sub_ps(centerY, _mm256_mul_ps(centerX, s)),
+                         _mm256_mul_ps(centerY, c)), y);
+}
+
+TARGET_AVX static UINT sinCosAVX(const float *angle, float *sinOut, float *cosOut, UINT count)
+{
+    UINT i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 s, c;
+        sinCos8(_mm256_loadu_ps(angle + i), s, c);
+        _mm256_storeu_ps(sinOut + i, s);
+        _mm256_storeu_ps(cosOut + i, c);
+    }
+    _mm256_zeroupper();
+    return i;
+}
+
+TARGET_AVX static UINT affineAVX(const TransformArrays &in, Affine2D *out, UINT count)
+{
+    UINT i = 0;
+    float t[6][8];
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 m[6];
+        affine8(in, i, m);
+        for (int k = 0; k < 6; k++)
+            _mm256_storeu_ps(t[k], m[k]);
+        for (int n = 0; n < 8; n++)
+        {
+            Affine2D &a = out[i+n];
+            a.m11 = t[0][n]; a.m12 = t[1][n];
+            a.m21 = t[2][n]; a.m22 = t[3][n];
+            a.dx  = t[4][n]; a.dy  = t[5][n];
+        }
+    }
+    _mm256_zeroupper();
+    return i;
+}
+
+TARGET_AVX static UINT cornersAVX(const TransformArrays &in, Quad2D *out, UINT count)
+{
+    UINT i = 0;
+    float t[8][8];
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 m[6];
+        affine8(in, i, m);
+        __m256 w = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(in.width + i)));
+        __m256 h = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(in.height + i)));
+        __m256 rightX = _mm256_mul_ps(w, m[0]), rightY = _mm256_mul_ps(w, m[1]);
+        __m256 downX = _mm256_mul_ps(h, m[2]), downY = _mm256_mul_ps(h, m[3]);
+        _mm256_storeu_ps(t[0], m[4]);
+        _mm256_storeu_ps(t[1], _mm256_add_ps(m[4], rightX));
+        _mm256_storeu_ps(t[2], _mm256_add_ps(m[4], downX));
+        _mm256_storeu_ps(t[3], _mm256_add_ps(_mm256_add_ps(m[4], rightX), downX));
+        _mm256_storeu_ps(t[4], m[5]);
+        _mm256_storeu_ps(t[5], _mm256_add_ps(m[5], rightY));
+        _mm256_storeu_ps(t[6], _mm256_add_ps(m[5], downY));
+        _mm256_storeu_ps(t[7], _mm256_add_ps(_mm256_add_ps(m[5], rightY), downY));
+        for (int n = 0; n < 8; n++)
+            for (int k = 0; k < 4; k++)
+            {
+                out[i+n].x[k] = t[k][n];
+                out[i+n].y[k] = t[k+4][n];
+            }
+    }
+    _mm256_zeroupper();
+    return i;
+}
+
+#endif  // CPU_X86
+
+//=============================================================================
+// Best kernel supported by the CPU and operating system
+//=============================================================================
+static transform2DNS::KERNEL detectKernel()
+{
+    if (CpuFeatures::hasAVX())
+        return transform2DNS::AVX;
+    if (CpuFeatures::hasSSE2())
+        return transform2DNS::SSE2;
+    return transform2DNS::SCALAR;
+}
+
+//=============================================================================
+// Constructor
+//=============================================================================
+Transform2D::Transform2D()
+{
+    best = detectKernel();
+    kernel = best;
+}
+
+//=============================================================================
+// Sine and cosine of count angles
+//=============================================================================
+void Transform2D::sinCos(const float *angle, float *sinOut, float *cosOut, UINT count) const
+{
+    UINT i = 0;
+#ifdef CPU_X86
+    if (kernel == transform2DNS::AVX)
+        i = sinCosAVX(angle, sinOut, cosOut, count);
+    else if (kernel == transform2DNS::SSE2)
+        i = sinCosSSE2(angle, sinOut, cosOut, count);
+#endif
+    for (; i < count; i++)          // remaining angles
+        sinCos1(angle[i], sinOut[i], cosOut[i]);
+}
+
+//=============================================================================
+// Affine transforms of count sprites
+//=============================================================================
+void Transform2D::affine(const TransformArrays &in, Affine2D *out, UINT count) const
+{
+    UINT i = 0;
+#ifdef CPU_X86
+    if (kernel == transform2DNS::AVX)
+        i = affineAVX(in, out, count);
+    else if (kernel == transform2DNS::SSE2)
+        i = affineSSE2(in, out, count);
+#endif
+    for (; i < count; i++)          // remaining sprites
+        affine1(in.x[i], in.y[i], in.scale[i], in.angle[i],
+                in.width[i], in.height[i], in.flip[i], out[i]);
+}
+
+//=============================================================================
+// Corners of count sprites
+//=============================================================================
+void Transform2D::corners(const TransformArrays &in, Quad2D *out, UINT count) const
+{
+    UINT i = 0;
+#ifdef CPU_X86
+    if (kernel == transform2DNS::AVX)
+        i = cornersAVX(in, out, count);
+    else if (kernel == transform2DNS::SSE2)
+        i = cornersSSE2(in, out, count);
+#endif
+    for (; i < count; i++)          // remaining sprites
+    {
+        Affine2D t;
+        affine1(in.x[i], in.y[i], in.scale[i], in.angle[i],
+                in.width[i], in.height[i], in.flip[i], t);
+        affineCorners(t, (float)in.width[i], (float)in.height[i], out[i]);
+    }
+}
+
+//=============================================================================
+// Affine transform of one sprite
+//=============================================================================
+void Transform2D::spriteAffine(const SpriteData &spriteData, Affine2D &out)
+{
+    BYTE flip = 0;
+    if (spriteData.flipHorizontal)
+        flip |= transform2DNS::FLIP_HORIZONTAL;
+    if (spriteData.flipVertical)
+        flip |= transform2DNS::FLIP_VERTICAL;
+    affine1(spriteData.x, spriteData.y, spriteData.scale, spriteData.angle,
+            spriteData.width, spriteData.height, flip, out);
+}
+
+//=============================================================================
+// Corners of the transformed width x height sprite
+//=============================================================================
+void Transform2D::affineCorners(const Affine2D &t, float width, float height, Quad2D &out)
+{
+    out.x[0] = t.dx;
+    out.y[0] = t.dy;
+    out.x[1] = width*t.m11 + t.dx;
+    out.y[1] = width*t.m12 + t.dy;
+    out.x[2] = height*t.m21 + t.dx;
+    out.y[2] = height*t.m22 + t.dy;
+    out.x[3] = width*t.m11 + height*t.m21 + t.dx;
+    out.y[3] = width*t.m12 + height*t.m22 + t.dy;
+}
+
+//=============================================================================
+// One axis of the unrotated image, as drawSprite places it
+// size = pixels of spriteData.rect drawn, length = spriteData.width or height
+// Sets origin, where image pixel 0 is drawn before rotation, extent, the
+// signed scaled size of the image from origin, and center, the rotation
+// center relative to origin.
+//=============================================================================
+static inline void boundsAxis(float position, float scale, int size, int length, bool flip,
+                              float &origin, float &extent, float &center)
+{
+    origin = position;
+    extent = size*scale;
+    center = (float)(length/2*scale);
+    if (flip)
+    {
+        extent = -extent;
+        center -= length*scale;
+        origin += length*scale;
+    }
+}
+
+//=============================================================================
+// Screen rectangle that contains the sprite at any rotation
+// The drawn image is spriteData.rect scaled, placed and flipped the way
+// spriteAffine() does, with the rotation center from width and height.
+// A rotated sprite stays inside the circle around the rotation center
+// through its farthest corner.
+//=============================================================================
+void Transform2D::spriteBounds(const SpriteData &spriteData, float &left, float &top,
+                               float &right, float &bottom)
+{
+    float originX, extentX, centerX, originY, extentY, centerY;
+    boundsAxis(spriteData.x, spriteData.scale, spriteData.rect.right - spriteData.rect.left,
+               spriteData.width, spriteData.flipHorizontal, originX, extentX, centerX);
+    boundsAxis(spriteData.y, spriteData.scale, spriteData.rect.bottom - spriteData.rect.top,
+               spriteData.height, spriteData.flipVertical, originY, extentY, centerY);
+    if (spriteData.angle == 0)
+    {
+        left = originX + (extentX < 0 ? extentX : 0);
+        right = originX + (extentX > 0 ? extentX : 0);
+        top = originY + (extentY < 0 ? extentY : 0);
+        bottom = originY + (extentY > 0 ? extentY : 0);
+        return;
+    }
+    float dx = fmaxf(fabsf(centerX), fabsf(extentX - centerX));
+    float dy = fmaxf(fabsf(centerY), fabsf(extentY - centerY));
+    float radius = sqrtf(dx*dx + dy*dy);
+    left = originX + centerX - radius;
+    right = originX + centerX + radius;
+    top = originY + centerY - radius;
+    bottom = originY + centerY + radius;
+}
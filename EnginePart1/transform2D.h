@@ -0,0 +1,101 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// transform2D.h v1.0
+// Transform2D computes the sprite transforms used by Graphics::drawSprite for
+// many sprites at once. Sprite properties are passed as separate arrays
+// (structure of arrays) so 4 (SSE2) or 8 (AVX) sprites are transformed by
+// each instruction. The kernel is chosen at run time from the CPU features,
+// with a scalar version for other CPUs.
+
+#ifndef _TRANSFORM2D_H          // Prevent multiple definitions if this
+#define _TRANSFORM2D_H          // file is included in more than one place
+#define WIN32_LEAN_AND_MEAN
+
+#include "spriteData.h"
+
+namespace transform2DNS
+{
+    // flip bits
+    const BYTE FLIP_HORIZONTAL = 1;
+    const BYTE FLIP_VERTICAL   = 2;
+
+    enum KERNEL {SCALAR, SSE2, AVX};
+}
+
+// 2D affine transform, the 2x3 part of the D3DX sprite matrix.
+// A sprite pixel u,v is drawn at
+//   x = u*m11 + v*m21 + dx
+//   y = u*m12 + v*m22 + dy
+struct Affine2D
+{
+    float m11, m12;
+    float m21, m22;
+    float dx, dy;
+};
+
+// Screen position of the corners of a sprite.
+// Order is top left, top right, bottom left, bottom right of the unrotated image.
+struct Quad2D
+{
+    float x[4];
+    float y[4];
+};
+
+// Sprite properties for Transform2D, one array element per sprite.
+// Values have the same meaning as in SpriteData.
+struct TransformArrays
+{
+    const float *x;
+    const float *y;
+    const float *scale;
+    const float *angle;     // radians
+    const int   *width;
+    const int   *height;
+    const BYTE  *flip;      // FLIP_HORIZONTAL | FLIP_VERTICAL
+};
+
+class Transform2D
+{
+  private:
+    transform2DNS::KERNEL kernel;   // kernel in use
+    transform2DNS::KERNEL best;     // best kernel supported by this CPU
+
+  public:
+    // Constructor, selects the best kernel for this CPU.
+    Transform2D();
+
+    // Return the kernel in use.
+    transform2DNS::KERNEL getKernel() const {return kernel;}
+
+    // Return the best kernel supported by this CPU.
+    transform2DNS::KERNEL getBestKernel() const {return best;}
+
+    // Use kernel k, or the best supported kernel if the CPU does not support k.
+    // For comparing kernels in tests and benchmarks.
+    void setKernel(transform2DNS::KERNEL k) {kernel = (k > best) ? best : k;}
+
+    // Sine and cosine of count angles.
+    // Accurate to about 1e-6 for angles within a few thousand radians of 0.
+    void sinCos(const float *angle, float *sinOut, float *cosOut, UINT count) const;
+
+    // Affine transforms of count sprites, same result as the D3DX matrix
+    // built by Graphics::drawSprite.
+    void affine(const TransformArrays &in, Affine2D *out, UINT count) const;
+
+    // Corners of count sprites of size width x height.
+    void corners(const TransformArrays &in, Quad2D *out, UINT count) const;
+
+    // Affine transform of one sprite.
+    static void spriteAffine(const SpriteData &spriteData, Affine2D &out);
+
+    // Corners of the transformed width x height sprite.
+    static void affineCorners(const Affine2D &t, float width, float height, Quad2D &out);
+
+    // Screen rectangle that contains the spriteData.rect part of the
+    // sprite at any rotation. Exact when the sprite is not rotated.
+    static void spriteBounds(const SpriteData &spriteData, float &left, float &top,
+                             float &right, float &bottom);
+};
+
+#endif
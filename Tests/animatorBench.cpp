@@ -0,0 +1,135 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// animatorBench.cpp v1.0
+// Times Animator::update(), SSE2 and scalar, against Image::update() on
+// each Image, and checks every Image shows the same frame either way, also
+// when drawn with draw(SpriteData).
+// Usage: animatorBench [images]
+
+#include <vector>
+#include "test.h"
+#include "image.h"
+
+namespace
+{
+    const char *TEXTURE_FILE = "animatorBench.tga";
+    const int FRAME_SIZE = 64;
+    const int COLS = 8;
+    const int FRAMES = 600;             // frames timed
+    const int CHECK_EVERY = 50;         // frames between comparisons
+}
+
+// Start animation i the same way on every Image it is set up on.
+static void setup(Image &image, int i)
+{
+    srand(i*7 + 1);
+    int start = rand() % 8;
+    int end = start + rand() % 12 - 2;  // some not animated
+    image.setFrames(start, end);
+    image.setCurrentFrame(start);
+    image.setFrameDelay(0.02f + (rand() % 100) * 0.001f);
+    image.setLoop(rand() % 3 != 0);
+}
+
+// Return the rect image is drawn with, by draw() or draw(SpriteData).
+static RECT drawnRect(Graphics &graphics, Image &image, bool withSpriteData)
+{
+    RenderCommandList list;
+    graphics.setRecording(&list);
+    if (withSpriteData)
+        image.draw(image.getSpriteInfo());
+    else
+        image.draw();
+    graphics.setRecording(NULL);
+    RECT r = {0, 0, 0, 0};
+    if (list.getSize() == 1)
+        r = list.get(0).spriteData.rect;
+    return r;
+}
+
+static bool sameRect(const RECT &a, const RECT &b)
+{
+    return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = testCount(argc, argv, 100000);
+    std::vector<unsigned int> pixels(FRAME_SIZE*COLS * FRAME_SIZE*3, 0xff808080);
+    CHECK(testWriteTga(TEXTURE_FILE, FRAME_SIZE*COLS, FRAME_SIZE*3, &pixels[0]));
+    Graphics graphics;
+    graphics.initialize(NULL, 640, 480, false);
+    graphics.setCulling(false);
+    TextureManager texture;
+    CHECK(texture.initialize(&graphics, TEXTURE_FILE));
+
+    Animator simd, scalar;
+    scalar.setSimd(false);
+    Image *reference = new Image[count];
+    Image *simdImages = new Image[count];
+    Image *scalarImages = new Image[count];
+    for (int i = 0; i < count; i++)
+    {
+        Image *images[3] = {&reference[i], &simdImages[i], &scalarImages[i]};
+        for (int k = 0; k < 3; k++)
+        {
+            images[k]->initialize(&graphics, FRAME_SIZE, FRAME_SIZE, COLS, &texture);
+            setup(*images[k], i);
+        }
+        simdImages[i].setAnimator(&simd);
+        scalarImages[i].setAnimator(&scalar);
+    }
+
+    double referenceTime = 0, simdTime = 0, scalarTime = 0;
+    int frameDiffers = 0, rectDiffers = 0;
+    for (int f = 0; f < FRAMES; f++)
+    {
+        float frameTime = 0.008f + (f % 7) * 0.003f;
+        double t0 = testSeconds();
+        for (int i = 0; i < count; i++)
+            reference[i].update(frameTime);
+        double t1 = testSeconds();
+        simd.update(frameTime);
+        double t2 = testSeconds();
+        scalar.update(frameTime);
+        double t3 = testSeconds();
+        referenceTime += t1 - t0;
+        simdTime += t2 - t1;
+        scalarTime += t3 - t2;
+        if (f % CHECK_EVERY != 0)
+            continue;
+        for (int i = 0; i < count; i++)
+        {
+            int frame = reference[i].getCurrentFrame();
+            bool complete = reference[i].getAnimationComplete();
+            if (simdImages[i].getCurrentFrame() != frame || scalarImages[i].getCurrentFrame() != frame ||
+                simdImages[i].getAnimationComplete() != complete ||
+                scalarImages[i].getAnimationComplete() != complete)
+                frameDiffers++;
+            RECT r = drawnRect(graphics, reference[i], false);
+            if (!sameRect(drawnRect(graphics, simdImages[i], true), r) ||
+                !sameRect(drawnRect(graphics, scalarImages[i], false), r))
+                rectDiffers++;
+        }
+    }
+    CHECK(frameDiffers == 0);
+    CHECK(rectDiffers == 0);
+    printf("%d images, %d frames\n", count, FRAMES);
+    printf("Image::update %7.3f ms/frame, Animator SSE2 %7.3f ms/frame, scalar %7.3f ms/frame\n",
+           referenceTime * 1e3 / FRAMES, simdTime * 1e3 / FRAMES, scalarTime * 1e3 / FRAMES);
+
+    // Detached, an Image goes on from the same state
+    simdImages[0].setAnimator(NULL);
+    simdImages[0].update(0.5f);
+    reference[0].update(0.5f);
+    CHECK(simdImages[0].getCurrentFrame() == reference[0].getCurrentFrame());
+    CHECK(simd.getCount() == (UINT)count - 1);
+
+    delete[] reference;
+    delete[] simdImages;
+    delete[] scalarImages;
+    CHECK(simd.getCount() == 0 && scalar.getCount() == 0);
+    remove(TEXTURE_FILE);
+    return testResult();
+}
@@ -0,0 +1,185 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// assetPackTest.cpp v1.0
+// Tests AssetPack lookups and that damaged packs are rejected.
+
+#include <string.h>
+#include <vector>
+#include "test.h"
+#include "assetPack.h"
+
+namespace
+{
+    const char *PACK_FILE = "assetPackTest.pak";
+    const char *DAMAGED_FILE = "assetPackTestDamaged.pak";
+}
+
+static std::vector<BYTE> readFile(const char *file)
+{
+    std::vector<BYTE> bytes;
+    FILE *f = fopen(file, "rb");
+    if (f == NULL)
+        return bytes;
+    BYTE buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    fclose(f);
+    return bytes;
+}
+
+static bool writeFile(const char *file, const std::vector<BYTE> &bytes)
+{
+    FILE *f = fopen(file, "wb");
+    if (f == NULL)
+        return false;
+    bool ok = fwrite(&bytes[0], 1, bytes.size(), f) == bytes.size();
+    return fclose(f) == 0 && ok;
+}
+
+//=============================================================================
+// Assets are found by name in any case and with either slash, and by ID.
+//=============================================================================
+static void testFind()
+{
+    AssetPackWriter writer;
+    const BYTE orion[] = {1, 2, 3, 4, 5};
+    const BYTE planet[] = {9, 8, 7};
+    CHECK(writer.add("pictures\\Orion.tga", orion, sizeof(orion)));
+    CHECK(writer.add("pictures/planet.png", planet, sizeof(planet)));
+    CHECK(!writer.add("PICTURES/ORION.TGA", orion, sizeof(orion)));    // duplicate
+    CHECK(writer.write(PACK_FILE));
+
+    AssetPack pack;
+    CHECK(pack.open(PACK_FILE));
+    CHECK(pack.getAssetCount() == 2);
+    const BYTE *data = NULL;
+    size_t size = 0;
+    CHECK(pack.find("pictures\\orion.tga", data, size));
+    CHECK(size == sizeof(orion) && memcmp(data, orion, size) == 0);
+    CHECK(pack.find("PICTURES/Planet.PNG", data, size));
+    CHECK(size == sizeof(planet) && memcmp(data, planet, size) == 0);
+    CHECK(pack.find(AssetPack::getId("pictures/orion.tga"), data, size));
+    CHECK(!pack.find("pictures/orion.tg", data, size));
+    CHECK(!pack.find("missing.png", data, size));
+    CHECK(!pack.find((const char *)NULL, data, size));
+
+    // names are stored as packed, with '/', so unpacked files keep their case
+    int found = 0;
+    for (UINT i = 0; i < pack.getSlotCount(); i++)
+    {
+        const char *name;
+        if (!pack.getAsset(i, name, data, size))
+            continue;
+        CHECK(strcmp(name, "pictures/Orion.tga") == 0 || strcmp(name, "pictures/planet.png") == 0);
+        found++;
+    }
+    CHECK(found == 2);
+    pack.close();
+
+    CHECK(AssetPack::sameName("A\\B.PNG", "a/b.png"));
+    CHECK(AssetPack::sameName("a/b.png", "A\\B.PNG"));
+    CHECK(!AssetPack::sameName("a/b.png", "a/b.pn"));
+    CHECK(!AssetPack::sameName("a/b.pn", "a/b.png"));
+    CHECK(AssetPack::packedName("Sub\\B.txt") == "Sub/B.txt");
+    CHECK(AssetPack::normalizeName("Sub\\B.txt") == "sub/b.txt");
+}
+
+//=============================================================================
+// Version 1 packs, with lower case names, still open. Later versions do not.
+//=============================================================================
+static void testVersion()
+{
+    AssetPackWriter writer;
+    const BYTE orion[] = {1, 2, 3};
+    CHECK(writer.add("pictures/orion.tga", orion, sizeof(orion)));
+    CHECK(writer.write(DAMAGED_FILE));
+    std::vector<BYTE> bytes = readFile(DAMAGED_FILE);
+    PackHeader *header = (PackHeader *)&bytes[0];
+    header->version = 1;
+    CHECK(writeFile(DAMAGED_FILE, bytes));
+    AssetPack pack;
+    CHECK(pack.open(DAMAGED_FILE));
+    const BYTE *data;
+    size_t size;
+    CHECK(pack.find("Pictures\\Orion.TGA", data, size) && size == sizeof(orion));
+    header->version = assetPackNS::VERSION + 1;
+    CHECK(writeFile(DAMAGED_FILE, bytes));
+    CHECK(!pack.open(DAMAGED_FILE));
+}
+
+//=============================================================================
+// An entry with the ID of a name but another name is not that asset.
+//=============================================================================
+static void testNameMismatch()
+{
+    std::vector<BYTE> bytes = readFile(PACK_FILE);
+    CHECK(!bytes.empty());
+    const PackHeader *header = (const PackHeader *)&bytes[0];
+    char *names = (char *)&bytes[header->namesOffset];
+    char *orion = strstr(names, "Orion");
+    CHECK(orion != NULL);
+    if (orion == NULL)
+        return;
+    orion[0] = 'x';                     // "pictures/xrion.tga", the ID is not changed
+    CHECK(writeFile(DAMAGED_FILE, bytes));
+    AssetPack pack;
+    CHECK(pack.open(DAMAGED_FILE));
+    const BYTE *data;
+    size_t size;
+    CHECK(!pack.find("pictures/orion.tga", data, size));
+    CHECK(pack.find(AssetPack::getId("pictures/orion.tga"), data, size));
+    CHECK(pack.find("pictures/planet.png", data, size));
+}
+
+//=============================================================================
+// A pack with every table entry used, or a wrong asset count, is rejected.
+//=============================================================================
+static void testFullTable()
+{
+    std::vector<BYTE> bytes = readFile(PACK_FILE);
+    PackHeader *header = (PackHeader *)&bytes[0];
+    PackEntry *entries = (PackEntry *)&bytes[sizeof(PackHeader)];
+    UINT slots = header->slotCount;
+    CHECK(slots == 4);
+    UINT used = 0, usedEntry = 0;
+    for (UINT i = 0; i < slots; i++)
+        if (entries[i].offset != 0)
+        {
+            used++;
+            usedEntry = i;
+        }
+    CHECK(used == 2);
+
+    // wrong asset count
+    header->assetCount = 3;
+    CHECK(writeFile(DAMAGED_FILE, bytes));
+    AssetPack pack;
+    CHECK(!pack.open(DAMAGED_FILE));
+
+    // every entry used, a missing ID would probe forever
+    for (UINT i = 0; i < slots; i++)
+        if (entries[i].offset == 0)
+        {
+            entries[i] = entries[usedEntry];
+            entries[i].id = 0x12345678 + i;
+        }
+    header->assetCount = slots;
+    CHECK(writeFile(DAMAGED_FILE, bytes));
+    CHECK(!pack.open(DAMAGED_FILE));
+    const BYTE *data;
+    size_t size;
+    CHECK(!pack.find("missing.png", data, size));   // not open
+}
+
+int main()
+{
+    testFind();
+    testNameMismatch();
+    testFullTable();
+    testVersion();
+    remove(PACK_FILE);
+    remove(DAMAGED_FILE);
+    return testResult();
+}
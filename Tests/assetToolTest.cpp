@@ -0,0 +1,134 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// assetToolTest.cpp v1.0
+// Runs AssetTool, given as the first argument, to pack files and unpack
+// them again. The unpacked files have the names as packed, case and
+// folders kept, and the same bytes. A texture cooked by the tool and packed
+// under the name of its image loads from the pack like the image.
+
+#include <string.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include "test.h"
+#include "assetPack.h"
+#include "imageFile.h"
+
+namespace
+{
+    const char *IN_DIR = "assetToolTestIn";
+    const char *OUT_DIR = "assetToolTestOut";
+    const char *PACK_FILE = "assetToolTest.pak";
+    const UINT SIZE = 16;
+}
+
+static std::string tool;        // path of AssetTool
+
+// Run AssetTool with args, return its exit code.
+static int run(const std::string &args)
+{
+    std::string command = "\"" + tool + "\" " + args + " > assetToolTest.log";
+    return system(command.c_str());
+}
+
+static bool writeText(const std::string &file, const std::string &text)
+{
+    FILE *f = fopen(file.c_str(), "wb");
+    if (f == NULL)
+        return false;
+    bool ok = fwrite(text.data(), 1, text.size(), f) == text.size();
+    fclose(f);
+    return ok;
+}
+
+// Return the contents of file, "<missing>" if it can not be read.
+static std::string readText(const std::string &file)
+{
+    std::vector<BYTE> data;
+    if (!ImageFile::readFile(file.c_str(), data))
+        return "<missing>";
+    return std::string(data.begin(), data.end());
+}
+
+//=============================================================================
+// pack then unpack gives back the files with their names as packed
+//=============================================================================
+static void testRoundTrip()
+{
+    const std::string top = std::string(IN_DIR) + "/Top.TXT";
+    const std::string sub = std::string(IN_DIR) + "/Sub/B.txt";
+    CHECK(writeText(top, "top file\r\n"));
+    CHECK(writeText(sub, std::string("sub\0file", 8)));
+
+    // by path, and by a name with '\' given before '='
+    CHECK(run(std::string("pack ") + PACK_FILE + " " + top + " " + sub +
+              " \"Pictures\\\\Ship.Tga=" + top + "\"") == 0);
+    CHECK(run(std::string("list ") + PACK_FILE) == 0);
+    CHECK(run(std::string("unpack ") + PACK_FILE + " " + OUT_DIR) == 0);
+
+    const std::string out = std::string(OUT_DIR) + "/";
+    CHECK(readText(out + top) == "top file\r\n");
+    CHECK(readText(out + sub) == std::string("sub\0file", 8));
+    CHECK(readText(out + "Pictures/Ship.Tga") == "top file\r\n");
+
+    // found by any case, as the game loads them
+    AssetPack pack;
+    CHECK(pack.open(PACK_FILE) && pack.getAssetCount() == 3);
+    const BYTE *data;
+    size_t size;
+    CHECK(pack.find("assettooltestin\\sub\\b.TXT", data, size) && size == 8);
+
+    // a name packed twice, in another case, is refused
+    CHECK(run(std::string("pack assetToolTestTwice.pak ") + top + " \"assettooltestin/top.txt=" + sub + "\"") != 0);
+    remove("assetToolTestTwice.pak");
+}
+
+//=============================================================================
+// A cooked texture packed as its image loads from the pack
+//=============================================================================
+static void testCook()
+{
+    std::vector<unsigned int> pixels(SIZE * SIZE);
+    for (UINT n = 0; n < pixels.size(); n++)
+        pixels[n] = 0xFF000000 | (n * 0x010203);
+    const std::string image = std::string(IN_DIR) + "/Ship.tga";
+    const std::string texture = std::string(IN_DIR) + "/ship.tex";
+    CHECK(testWriteTga(image.c_str(), SIZE, SIZE, &pixels[0]));
+    CHECK(run("cook " + image + " " + texture + " -frame 8 8 -key none") == 0);
+    CHECK(run(std::string("pack ") + PACK_FILE + " \"pictures\\\\ship.tga=" + texture + "\"") == 0);
+
+    AssetPack pack;
+    CHECK(pack.open(PACK_FILE));
+    std::vector<BYTE> buffer;
+    const BYTE *data;
+    size_t size;
+    CHECK(ImageFile::read(&pack, "pictures\\ship.tga", buffer, data, size));
+    const CookedHeader *cooked = ImageFile::getCooked(data, size);
+    CHECK(cooked != NULL);
+    if (cooked == NULL)
+        return;
+    CHECK(cooked->width == SIZE && cooked->height == SIZE && cooked->frameCount == 4);
+    CHECK(memcmp(ImageFile::getCookedPixels(cooked), &pixels[0], pixels.size() * 4) == 0);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printf("usage: assetToolTest <AssetTool>\n");
+        return 1;
+    }
+    tool = argv[1];
+    system("rm -rf assetToolTestIn assetToolTestOut");
+    mkdir("assetToolTestIn", 0777);
+    mkdir("assetToolTestIn/Sub", 0777);
+
+    testRoundTrip();
+    testCook();
+
+    system("rm -rf assetToolTestIn assetToolTestOut");
+    remove(PACK_FILE);
+    remove("assetToolTest.log");
+    return testResult();
+}
@@ -0,0 +1,146 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// broadphaseBench.cpp v1.0
+// Times Broadphase::findPairs() against testing every pair, on moving
+// objects of mixed sizes with a few much larger ones, and checks both find
+// the same pairs. Bounds too large for the grid, infinite or not a number
+// are also checked.
+// Usage: broadphaseBench [objects], default 1000, 10000 and 100000
+
+#include <math.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "test.h"
+#include "broadphase.h"
+
+namespace
+{
+    const int FRAMES = 20;              // frames of the grid timed
+    const int LARGE_EVERY = 500;        // one object in this many is large
+}
+
+static bool pairLess(const BroadphasePair &x, const BroadphasePair &y)
+{
+    return x.a < y.a || (x.a == y.a && x.b < y.b);
+}
+
+// Objects moving in a square world with about the same density at any count.
+struct Scene
+{
+    std::vector<float> x, y, vx, vy, size;
+
+    Scene(int count) : x(count), y(count), vx(count), vy(count), size(count)
+    {
+        float world = sqrtf((float)count) * 40;
+        srand(1);
+        for (int i = 0; i < count; i++)
+        {
+            x[i] = rand() / (float)RAND_MAX * world;
+            y[i] = rand() / (float)RAND_MAX * world;
+            vx[i] = (float)(rand() % 200 - 100);
+            vy[i] = (float)(rand() % 200 - 100);
+            size[i] = i % LARGE_EVERY == 0 ? 400.0f : (float)(8 + rand() % 24);
+        }
+    }
+
+    void move()
+    {
+        for (size_t i = 0; i < x.size(); i++)
+        {
+            x[i] += vx[i] / 60;
+            y[i] += vy[i] / 60;
+        }
+    }
+};
+
+// Find the pairs by testing every pair, in a < b order.
+static void bruteForce(const Scene &s, std::vector<BroadphasePair> &pairs)
+{
+    pairs.clear();
+    UINT count = (UINT)s.x.size();
+    for (UINT i = 0; i < count; i++)
+    {
+        float l = s.x[i], t = s.y[i], r = l + s.size[i], b = t + s.size[i];
+        for (UINT j = i + 1; j < count; j++)
+            if (l < s.x[j] + s.size[j] && s.x[j] < r && t < s.y[j] + s.size[j] && s.y[j] < b)
+            {
+                BroadphasePair p = {i, j};
+                pairs.push_back(p);
+            }
+    }
+}
+
+static void run(int count)
+{
+    Scene scene(count);
+    Broadphase broadphase;
+    double gridTime = 1e9;
+    size_t pairCount = 0;
+    for (int f = 0; f < FRAMES; f++)
+    {
+        scene.move();
+        double t0 = testSeconds();
+        broadphase.clear();
+        for (int i = 0; i < count; i++)
+            broadphase.add(scene.x[i], scene.y[i], scene.x[i] + scene.size[i],
+                           scene.y[i] + scene.size[i], i);
+        pairCount = broadphase.findPairs().size();
+        double t = testSeconds() - t0;
+        if (t < gridTime)
+            gridTime = t;
+    }
+
+    std::vector<BroadphasePair> expected;
+    double t0 = testSeconds();
+    bruteForce(scene, expected);
+    double bruteTime = testSeconds() - t0;
+    std::vector<BroadphasePair> found(broadphase.getPairs());
+    std::sort(found.begin(), found.end(), pairLess);
+    bool same = found.size() == expected.size();
+    for (size_t i = 0; same && i < found.size(); i++)
+        same = found[i].a == expected[i].a && found[i].b == expected[i].b;
+    CHECK(same);
+    printf("%6d objects, %6u pairs: grid %8.3f ms, every pair %9.1f ms, %6.0fx\n", count,
+           (UINT)pairCount, gridTime * 1e3, bruteTime * 1e3, bruteTime / gridTime);
+}
+
+//=============================================================================
+// Huge, infinite and NaN bounds do not overflow the cell count or the int
+// conversion. Huge bounds are compared with every object, NaN never overlaps.
+//=============================================================================
+static void testExtremeBounds()
+{
+    const float INF = std::numeric_limits<float>::infinity();
+    const float NOT_A_NUMBER = std::numeric_limits<float>::quiet_NaN();
+    Broadphase bp;
+    bp.add(0, 0, 10, 10);                               // 0
+    bp.add(-1e30f, -1e30f, 1e30f, 1e30f);               // 1, 2^64 cells without the clamp
+    bp.add(0, 0, 65536.0f * 64 - 1, 65536.0f * 64 - 1); // 2, 2^32 cells, 0 in 32 bits
+    bp.add(-INF, -INF, INF, INF);                       // 3
+    bp.add(NOT_A_NUMBER, NOT_A_NUMBER, NOT_A_NUMBER, NOT_A_NUMBER);     // 4
+    bp.add(5, 5, 20, 20);                               // 5
+    std::vector<BroadphasePair> found = bp.findPairs();
+    std::sort(found.begin(), found.end(), pairLess);
+    const BroadphasePair expected[] = {{0,1}, {0,2}, {0,3}, {0,5}, {1,2}, {1,3}, {1,5},
+                                       {2,3}, {2,5}, {3,5}};
+    const size_t count = sizeof(expected) / sizeof(expected[0]);
+    CHECK(found.size() == count);
+    for (size_t i = 0; i < count && i < found.size(); i++)
+        CHECK(found[i].a == expected[i].a && found[i].b == expected[i].b);
+}
+
+int main(int argc, char *argv[])
+{
+    testExtremeBounds();
+    if (argc > 1)
+        run(testCount(argc, argv, 1000));
+    else
+    {
+        run(1000);
+        run(10000);
+        run(100000);
+    }
+    return testResult();
+}
@@ -0,0 +1,81 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// cullBench.cpp v1.0
+// Times Graphics::inViewport() against drawing, on an arena ten times the
+// size of the screen in each direction. Drawing is done by the software
+// Graphics class, so the draw time is a CPU cost and is only a guide to
+// what a device spends.
+// Usage: cullBench [sprites]
+
+#include <vector>
+#include "test.h"
+#include "graphics.h"
+
+namespace
+{
+    const int WIDTH = 640;
+    const int HEIGHT = 480;
+    const int ARENA = 10;               // arena size in screens, each direction
+    const int REPEAT = 20;
+}
+
+static double drawAll(Graphics &graphics, const std::vector<SpriteData> &sprites, bool cull)
+{
+    graphics.setCulling(cull);
+    double t0 = testSeconds();
+    graphics.beginScene();
+    graphics.spriteBegin();
+    for (size_t i = 0; i < sprites.size(); i++)
+        if (graphics.inViewport(sprites[i]))
+            graphics.drawSprite(sprites[i]);
+    graphics.spriteEnd();
+    graphics.endScene();
+    return testSeconds() - t0;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = testCount(argc, argv, 20000);
+    Graphics graphics;
+    graphics.initialize(NULL, WIDTH, HEIGHT, false);
+    std::vector<COLOR_ARGB> pixels(32 * 32, graphicsNS::RED);
+    LP_TEXTURE texture;
+    CHECK(SUCCEEDED(graphics.createTexture(&pixels[0], 32, 32, texture)));
+    std::vector<SpriteData> sprites(count);
+    srand(1);
+    for (int i = 0; i < count; i++)
+    {
+        SpriteData &sd = sprites[i];
+        sd = SpriteData();
+        sd.width = 32;
+        sd.height = 32;
+        sd.rect.right = 32;
+        sd.rect.bottom = 32;
+        sd.scale = 1;
+        sd.x = (float)(rand() % (WIDTH * ARENA) - WIDTH * ARENA / 2);
+        sd.y = (float)(rand() % (HEIGHT * ARENA) - HEIGHT * ARENA / 2);
+        sd.angle = (rand() % 628) / 100.0f;
+        sd.texture = texture;
+    }
+
+    int visible = 0;
+    double t0 = testSeconds();
+    for (int r = 0; r < REPEAT; r++)
+        for (int i = 0; i < count; i++)
+            visible += graphics.inViewport(sprites[i]);
+    double testTime = (testSeconds() - t0) / REPEAT;
+    visible /= REPEAT;
+
+    double drawTime = drawAll(graphics, sprites, false);
+    UINT drawn = graphics.getSpritesSubmitted();
+    double cullTime = drawAll(graphics, sprites, true);
+    CHECK(drawn == (UINT)count);
+    CHECK(graphics.getSpritesSubmitted() == (UINT)visible);
+    CHECK(graphics.getSpritesCulled() == (UINT)(count - visible));
+    printf("%d sprites, %d visible, %u culled\n", count, visible, graphics.getSpritesCulled());
+    printf("inViewport: %.1f ns/sprite\n", testTime * 1e9 / count);
+    printf("draw all %.2f ms, cull and draw %.2f ms\n", drawTime * 1e3, cullTime * 1e3);
+    texture->Release();
+    return testResult();
+}
@@ -0,0 +1,157 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// cullTest.cpp v1.0
+// Tests that Transform2D::spriteBounds contains the drawn part of every
+// sprite, and that culling by Graphics::inViewport does not change the
+// picture.
+
+#include <math.h>
+#include <vector>
+#include "test.h"
+#include "graphics.h"
+
+static SpriteData randomSprite()
+{
+    SpriteData sd = {};
+    sd.width = rand() % 301;
+    sd.height = rand() % 301;
+    sd.rect.left = rand() % 64;
+    sd.rect.top = rand() % 64;
+    if (rand() % 2)                     // the whole frame
+    {
+        sd.rect.right = sd.rect.left + sd.width;
+        sd.rect.bottom = sd.rect.top + sd.height;
+    }
+    else                                // a rect that is not width x height
+    {
+        sd.rect.right = sd.rect.left + rand() % 301;
+        sd.rect.bottom = sd.rect.top + rand() % 301;
+    }
+    sd.x = (float)(rand() % 2000 - 1000);
+    sd.y = (float)(rand() % 2000 - 1000);
+    sd.scale = (rand() % 500) / 100.0f + 0.01f;
+    sd.angle = rand() % 2 ? (rand() % 62832) / 10000.0f : 0;
+    sd.flipHorizontal = (rand() & 1) != 0;
+    sd.flipVertical = (rand() & 1) != 0;
+    return sd;
+}
+
+//=============================================================================
+// The corners of the drawn rect are inside the bounds, and on them when the
+// sprite is not rotated.
+//=============================================================================
+static void testBounds()
+{
+    srand(3);
+    int outside = 0, notExact = 0;
+    for (int i = 0; i < 200000; i++)
+    {
+        SpriteData sd = randomSprite();
+        Affine2D t;
+        Transform2D::spriteAffine(sd, t);
+        Quad2D q;
+        Transform2D::affineCorners(t, (float)(sd.rect.right - sd.rect.left),
+                                   (float)(sd.rect.bottom - sd.rect.top), q);
+        float left, top, right, bottom;
+        Transform2D::spriteBounds(sd, left, top, right, bottom);
+        float minX = q.x[0], maxX = q.x[0], minY = q.y[0], maxY = q.y[0];
+        for (int k = 0; k < 4; k++)
+        {
+            float e = 1e-3f * (1 + fabsf(q.x[k]) + fabsf(q.y[k]));
+            if (q.x[k] < left - e || q.x[k] > right + e || q.y[k] < top - e || q.y[k] > bottom + e)
+                outside++;
+            minX = fminf(minX, q.x[k]);
+            maxX = fmaxf(maxX, q.x[k]);
+            minY = fminf(minY, q.y[k]);
+            maxY = fmaxf(maxY, q.y[k]);
+        }
+        if (sd.angle == 0 && (fabsf(minX - left) > 1e-3f || fabsf(maxX - right) > 1e-3f ||
+                              fabsf(minY - top) > 1e-3f || fabsf(maxY - bottom) > 1e-3f))
+            notExact++;
+    }
+    CHECK(outside == 0);
+    CHECK(notExact == 0);
+}
+
+//=============================================================================
+// A sprite is culled by the size of its rect, not width and height.
+//=============================================================================
+static void testRect()
+{
+    Graphics graphics;
+    graphics.initialize(NULL, 640, 480, false);
+    SpriteData sd = {};
+    sd.scale = 2;
+    sd.x = -100;
+    sd.y = 10;
+    sd.width = 40;                      // ends 20 pixels left of the screen
+    sd.height = 40;
+    sd.rect.right = 64;                 // but 128 pixels are drawn
+    sd.rect.bottom = 64;
+    CHECK(graphics.inViewport(sd));
+    sd.width = 64;
+    sd.rect.right = 40;                 // 80 pixels drawn, 28 left of the screen
+    CHECK(!graphics.inViewport(sd));
+    CHECK(graphics.getSpritesCulled() == 1);
+}
+
+//=============================================================================
+// Drawing only the sprites inViewport() accepts makes the same picture.
+//=============================================================================
+static void drawScene(Graphics &graphics, const std::vector<SpriteData> &sprites)
+{
+    graphics.beginScene();
+    graphics.spriteBegin();
+    for (size_t i = 0; i < sprites.size(); i++)
+        if (graphics.inViewport(sprites[i]))
+            graphics.drawSprite(sprites[i]);
+    graphics.spriteEnd();
+    graphics.endScene();
+}
+
+static void testGraphics()
+{
+    Graphics graphics;
+    graphics.initialize(NULL, 320, 240, false);
+    std::vector<COLOR_ARGB> pixels(400 * 400, graphicsNS::WHITE);
+    for (size_t i = 0; i < pixels.size(); i++)
+        pixels[i] = SETCOLOR_ARGB(255, i & 0xff, (i >> 8) & 0xff, 128);
+    LP_TEXTURE texture;
+    CHECK(SUCCEEDED(graphics.createTexture(&pixels[0], 400, 400, texture)));
+    std::vector<SpriteData> sprites;
+    srand(5);
+    for (int i = 0; i < 2000; i++)
+    {
+        SpriteData sd = randomSprite();
+        sd.scale = sd.scale * 0.1f + 0.05f;
+        sd.x = sd.x * 0.5f + 160;
+        sd.y = sd.y * 0.5f + 120;
+        sd.texture = texture;
+        sd.layer = i;                   // keep the draw order when batched
+        sprites.push_back(sd);
+    }
+    graphics.setCulling(false);
+    drawScene(graphics, sprites);
+    CHECK(graphics.getSpritesCulled() == 0);
+    std::vector<COLOR_ARGB> all(graphics.getBackbuffer(), graphics.getBackbuffer() + 320 * 240);
+    graphics.setCulling(true);
+    drawScene(graphics, sprites);
+    UINT culled = graphics.getSpritesCulled();
+    CHECK(culled > 0 && culled < sprites.size());
+    CHECK(graphics.getSpritesSubmitted() + culled == sprites.size());
+    int differ = 0;
+    for (int i = 0; i < 320 * 240; i++)
+        if (graphics.getBackbuffer()[i] != all[i])
+            differ++;
+    CHECK(differ == 0);
+    texture->Release();
+}
+
+int main()
+{
+    testBounds();
+    testRect();
+    testGraphics();
+    return testResult();
+}
@@ -0,0 +1,132 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// entityStoreBench.cpp v1.0
+// Times moving count entities a frame with EntityStore::update() against
+// the same movement of count Images on the heap through their virtual
+// get and set functions, and checks both end at the same positions and
+// draw the same sprites. Also times creating and destroying entities.
+// Usage: entityStoreBench [entities]
+
+#include <vector>
+#include "test.h"
+#include "entityStore.h"
+
+using namespace entityStoreNS;
+
+namespace
+{
+    const char *TEXTURE_FILE = "entityStoreBench.tga";
+    const int SIZE = 8;
+    const int FRAMES = 100;             // frames timed
+    const float FRAME_TIME = 1 / 60.0f;
+}
+
+// Return the number of sprites drawn by images or by store.
+static UINT drawnSprites(Graphics &graphics, std::vector<Image*> *images, EntityStore *store,
+                         double &seconds)
+{
+    RenderCommandList list;
+    graphics.setRecording(&list);
+    double t0 = testSeconds();
+    graphics.spriteBegin();
+    if (images)
+        for (UINT i = 0; i < images->size(); i++)
+            (*images)[i]->draw();
+    else
+        store->draw();
+    graphics.spriteEnd();
+    seconds = testSeconds() - t0;
+    graphics.setRecording(NULL);
+    UINT sprites = 0;
+    for (UINT i = 0; i < list.getSize(); i++)
+        sprites += list.get(i).type == renderCommandNS::SPRITE;
+    return sprites;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = testCount(argc, argv, 50000);
+    std::vector<unsigned int> pixels(SIZE * SIZE, 0xffffffff);
+    CHECK(testWriteTga(TEXTURE_FILE, SIZE, SIZE, &pixels[0]));
+    Graphics graphics;
+    graphics.initialize(NULL, 640, 480, false);
+    TextureManager texture;
+    CHECK(texture.initialize(&graphics, TEXTURE_FILE));
+
+    // the same entities as Images and in the store
+    EntityStore store;
+    store.initialize(&graphics, NULL);
+    std::vector<Image*> images;
+    std::vector<float> vx, vy;
+    std::vector<EntityId> ids;
+    srand(3);
+    for (int i = 0; i < count; i++)
+    {
+        Image *image = new Image;
+        image->initialize(&graphics, SIZE, SIZE, 1, &texture);
+        image->setX((float)(rand() % 640));
+        image->setY((float)(rand() % 480));
+        images.push_back(image);
+        vx.push_back((float)(rand() % 200 - 100));
+        vy.push_back((float)(rand() % 200 - 100));
+        EntityId e = store.create(*image, VELOCITY);
+        VelocityComponent v = {vx[i], vy[i], 0};
+        store.setVelocity(e, v);
+        ids.push_back(e);
+    }
+    CHECK(store.getCount() == (UINT)count);
+    CHECK(store.getArchetypeCount() == 1);
+
+    double imageTime = 1e9, storeTime = 1e9;
+    for (int f = 0; f < FRAMES; f++)
+    {
+        double t0 = testSeconds();
+        for (int i = 0; i < count; i++)
+        {
+            images[i]->setX(images[i]->getX() + vx[i] * FRAME_TIME);
+            images[i]->setY(images[i]->getY() + vy[i] * FRAME_TIME);
+        }
+        double t1 = testSeconds();
+        store.update(FRAME_TIME);
+        double t2 = testSeconds();
+        imageTime = std::min(imageTime, t1 - t0);
+        storeTime = std::min(storeTime, t2 - t1);
+    }
+    int differ = 0;
+    for (int i = 0; i < count; i++)
+    {
+        TransformComponent t;
+        differ += !store.getTransform(ids[i], t) || t.x != images[i]->getX() || t.y != images[i]->getY();
+    }
+    CHECK(differ == 0);
+
+    double imageDraw, storeDraw;
+    UINT imageSprites = drawnSprites(graphics, &images, NULL, imageDraw);
+    UINT storeSprites = drawnSprites(graphics, NULL, &store, storeDraw);
+    CHECK(imageSprites == storeSprites);
+    CHECK(storeSprites > 0);
+
+    // destroy every other entity and create them again
+    double t0 = testSeconds();
+    for (int i = 0; i < count; i += 2)
+        store.destroy(ids[i]);
+    for (int i = 0; i < count; i += 2)
+        ids[i] = store.create(TRANSFORM | SPRITE | VELOCITY);
+    double churnTime = testSeconds() - t0;
+    CHECK(store.getCount() == (UINT)count);
+    TransformComponent t;
+    CHECK(store.getTransform(ids[count - 1], t) && t.x == images[count - 1]->getX());
+
+    printf("%d entities, %d frames\n", count, FRAMES);
+    printf("move: Images %7.3f ms/frame, EntityStore::update() %7.3f ms/frame\n",
+           imageTime * 1e3, storeTime * 1e3);
+    printf("draw: Images %7.3f ms (%u sprites), EntityStore::draw() %7.3f ms (%u sprites)\n",
+           imageDraw * 1e3, imageSprites, storeDraw * 1e3, storeSprites);
+    printf("destroy and create %d entities %7.3f ms\n", (count + 1) / 2, churnTime * 1e3);
+
+    for (int i = 0; i < count; i++)
+        delete images[i];
+    remove(TEXTURE_FILE);
+    return testResult();
+}
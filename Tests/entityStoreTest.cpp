@@ -0,0 +1,344 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// entityStoreTest.cpp v1.0
+// Tests EntityStore: ids of destroyed entities are not alive again when
+// their slot is reused, entities keep their components when they move
+// between Archetypes, the row moved into a removed row is still found by
+// its id, and an Image copied in with create(image) is drawn the same.
+
+#include <math.h>
+#include <vector>
+#include "test.h"
+#include "entityStore.h"
+
+using namespace entityStoreNS;
+
+namespace
+{
+    const char *TEXTURE_FILE = "entityStoreTest.tga";
+    const int FRAME_SIZE = 32;
+    const int COLS = 4;
+}
+
+// Return true if every row of every Archetype is found again by its id,
+// and every array of the Archetype has one element per row.
+static bool consistent(EntityStore &store)
+{
+    UINT rows = 0;
+    for (UINT n = 0; n < store.getArchetypeCount(); n++)
+    {
+        Archetype &a = store.getArchetype(n);
+        UINT t = a.has(TRANSFORM) ? a.count : 0;
+        UINT v = a.has(VELOCITY) ? a.count : 0;
+        if (a.ids.size() != a.count || a.flags.size() != a.count ||
+            a.x.size() != t || a.prevX.size() != t || a.vx.size() != v)
+            return false;
+        for (UINT i = 0; i < a.count; i++)
+        {
+            if (store.getMask(a.ids[i]) != a.mask)
+                return false;
+            TransformComponent tc;
+            if (a.has(TRANSFORM) && (!store.getTransform(a.ids[i], tc) || tc.x != a.x[i]))
+                return false;
+        }
+        rows += a.count;
+    }
+    return rows == store.getCount();
+}
+
+//=============================================================================
+// A destroyed id stays dead after its slot is reused.
+//=============================================================================
+static void testIds()
+{
+    EntityStore store;
+    EntityId none = {0, 0};
+    CHECK(!store.isAlive(none));
+
+    EntityId a = store.create(TRANSFORM);
+    CHECK(a.generation != 0);
+    CHECK(store.isAlive(a));
+    store.destroy(a);
+    CHECK(!store.isAlive(a));
+    CHECK(store.getCount() == 0);
+
+    EntityId b = store.create(TRANSFORM | VELOCITY);
+    CHECK(b.index == a.index);          // slot reused
+    CHECK(b.generation != a.generation);
+    CHECK(!store.isAlive(a));
+    CHECK(store.getMask(a) == 0);
+    TransformComponent t = {1, 2, 1, 0};
+    store.setTransform(a, t);           // ignored, a is not b
+    CHECK(store.getMask(b) == (TRANSFORM | VELOCITY));
+    CHECK(store.getTransform(b, t) && t.x == 0);
+    store.destroy(a);                   // does not destroy b
+    CHECK(store.isAlive(b));
+    CHECK(store.getCount() == 1);
+
+    // every id of a slot used many times is different
+    std::vector<EntityId> old;
+    for (int n = 0; n < 100; n++)
+    {
+        EntityId e = store.create(TRANSFORM);
+        for (UINT i = 0; i < old.size(); i++)
+            CHECK(e != old[i] && !store.isAlive(old[i]));
+        old.push_back(e);
+        store.destroy(e);
+    }
+    CHECK(store.getCount() == 1);
+    store.clear();
+    CHECK(!store.isAlive(b));
+    CHECK(store.getCount() == 0);
+}
+
+//=============================================================================
+// Components are kept when an entity moves between Archetypes.
+//=============================================================================
+static void testMove()
+{
+    EntityStore store;
+    EntityId e = store.create(TRANSFORM);
+    EntityId other = store.create(TRANSFORM);
+    TransformComponent t = {10, 20, 2, 0.5f};
+    store.setTransform(e, t);
+    TransformComponent ot = {-1, -2, 1, 0};
+    store.setTransform(other, ot);
+
+    VelocityComponent v = {3, 4, 0.25f};
+    store.setVelocity(e, v);            // adds VELOCITY
+    CHECK(store.getMask(e) == (TRANSFORM | VELOCITY));
+    CHECK(store.getArchetypeCount() == 2);
+    TransformComponent got;
+    CHECK(store.getTransform(e, got));
+    CHECK(got.x == 10 && got.y == 20 && got.scale == 2 && got.angle == 0.5f);
+    CHECK(store.getTransform(other, got) && got.x == -1);
+
+    ColliderComponent c = {BOX, 0, 5, 6};
+    store.setCollider(e, c);
+    store.removeComponents(e, TRANSFORM);
+    CHECK(store.getMask(e) == (VELOCITY | COLLIDER));
+    CHECK(!store.getTransform(e, got));
+    VelocityComponent gv;
+    CHECK(store.getVelocity(e, gv) && gv.x == 3 && gv.y == 4 && gv.spin == 0.25f);
+    ColliderComponent gc;
+    CHECK(store.getCollider(e, gc) && gc.type == BOX && gc.halfWidth == 5 && gc.halfHeight == 6);
+
+    store.addComponents(e, TRANSFORM);  // back with default values
+    CHECK(store.getTransform(e, got));
+    CHECK(got.x == 0 && got.y == 0 && got.scale == 1 && got.angle == 0);
+    CHECK(store.getVelocity(e, gv) && gv.x == 3);
+    CHECK(consistent(store));
+
+    // velocity moves only the entities that have it
+    store.setTransform(e, t);
+    store.beginTick();
+    store.update(0.5f);
+    CHECK(store.getTransform(e, got) && got.x == 11.5f && got.y == 22);
+    CHECK(store.getTransform(other, got) && got.x == -1);
+}
+
+//=============================================================================
+// The last row moved into a removed row is found by its id, after
+// destroy() and after a move out of the Archetype.
+//=============================================================================
+static void testSwapRemove()
+{
+    EntityStore store;
+    std::vector<EntityId> ids;
+    for (int n = 0; n < 10; n++)
+    {
+        ids.push_back(store.create(TRANSFORM));
+        TransformComponent t = {(float)n, 0, 1, 0};
+        store.setTransform(ids[n], t);
+    }
+    store.destroy(ids[2]);              // row 2 gets entity 9
+    TransformComponent got;
+    CHECK(store.getTransform(ids[9], got) && got.x == 9);
+    store.addComponents(ids[4], VELOCITY);  // row 4 gets entity 8
+    CHECK(store.getTransform(ids[8], got) && got.x == 8);
+    CHECK(store.getTransform(ids[4], got) && got.x == 4);
+    store.destroy(ids[9]);              // the moved row itself
+    CHECK(store.getTransform(ids[8], got) && got.x == 8);
+    CHECK(consistent(store));
+
+    // random creates, destroys and moves against a list of what is alive
+    store.clear();
+    srand(17);
+    std::vector<EntityId> alive;
+    std::vector<float> xs;
+    bool ok = true;
+    for (int step = 0; step < 5000 && ok; step++)
+    {
+        int op = rand() % 4;
+        if (op == 0 || alive.empty())
+        {
+            EntityId e = store.create(TRANSFORM | (rand() % 2 ? SPRITE : 0));
+            TransformComponent t = {(float)step, 0, 1, 0};
+            store.setTransform(e, t);
+            alive.push_back(e);
+            xs.push_back((float)step);
+        }
+        else
+        {
+            UINT i = rand() % alive.size();
+            if (op == 1)
+            {
+                store.destroy(alive[i]);
+                alive[i] = alive.back();
+                alive.pop_back();
+                xs[i] = xs.back();
+                xs.pop_back();
+            }
+            else if (op == 2)
+                store.addComponents(alive[i], 1 << (1 + rand() % 4));
+            else
+                store.removeComponents(alive[i], 1 << (1 + rand() % 4));
+        }
+        ok = consistent(store) && store.getCount() == alive.size();
+        for (UINT i = 0; i < alive.size() && ok; i++)
+        {
+            TransformComponent t;
+            ok = store.getTransform(alive[i], t) && t.x == xs[i];
+        }
+    }
+    CHECK(ok);
+}
+
+// Return the sprite drawn by the Image or by the store.
+static bool drawn(Graphics &graphics, Image *image, EntityStore *store, SpriteData &sd, COLOR_ARGB &color)
+{
+    RenderCommandList list;
+    graphics.setRecording(&list);
+    graphics.spriteBegin();
+    if (image)
+        image->draw(image->getColorFilter());
+    else
+        store->draw();
+    graphics.spriteEnd();
+    graphics.setRecording(NULL);
+    for (UINT i = 0; i < list.getSize(); i++)
+        if (list.get(i).type == renderCommandNS::SPRITE)
+        {
+            sd = list.get(i).spriteData;
+            color = list.get(i).color;
+            return true;
+        }
+    return false;
+}
+
+static bool sameSprite(const SpriteData &a, const SpriteData &b)
+{
+    return a.width == b.width && a.height == b.height && a.x == b.x && a.y == b.y &&
+           a.scale == b.scale && a.angle == b.angle && a.texture == b.texture &&
+           a.rect.left == b.rect.left && a.rect.top == b.rect.top &&
+           a.rect.right == b.rect.right && a.rect.bottom == b.rect.bottom &&
+           a.flipHorizontal == b.flipHorizontal && a.flipVertical == b.flipVertical &&
+           a.layer == b.layer;
+}
+
+//=============================================================================
+// An Image copied in with create(image) has the same SpriteData and
+// animation, and setSpriteData() changes the entity like the Image.
+//=============================================================================
+static void testImage(Graphics &graphics, TextureManager &texture)
+{
+    Animator animator;
+    EntityStore store;
+    store.initialize(&graphics, &animator);
+
+    Image image;
+    CHECK(image.initialize(&graphics, FRAME_SIZE, FRAME_SIZE, COLS, &texture));
+    image.setX(100);
+    image.setY(50);
+    image.setScale(1.5f);
+    image.setRadians(0.3f);
+    image.setFrames(1, 6);
+    image.setCurrentFrame(3);
+    image.setFrameDelay(0.1f);
+    image.flipHorizontal(true);
+    image.setLayer(2);
+    image.setColorFilter(0xff80ff40);
+
+    EntityId e = store.create(image, VELOCITY);
+    CHECK(store.getMask(e) == (TRANSFORM | SPRITE | ANIMATION | VELOCITY));
+    SpriteData sd;
+    CHECK(store.getSpriteData(e, sd));
+    CHECK(sameSprite(sd, image.getSpriteInfo()));
+    AnimationComponent an;
+    CHECK(store.getAnimation(e, an));
+    CHECK(an.cols == COLS && an.startFrame == 1 && an.endFrame == 6 && an.currentFrame == 3);
+    CHECK(an.frameDelay == 0.1f && an.loop && !an.complete);
+    SpriteData imageDrawn, storeDrawn;
+    COLOR_ARGB imageColor = 0, storeColor = 0;
+    CHECK(drawn(graphics, &image, NULL, imageDrawn, imageColor));
+    CHECK(drawn(graphics, NULL, &store, storeDrawn, storeColor));
+    CHECK(sameSprite(imageDrawn, storeDrawn));
+    CHECK(imageColor == storeColor);
+
+    // the same frames after both run for a while
+    animator.update(0.25f);
+    image.update(0.25f);
+    CHECK(store.getSpriteData(e, sd));
+    CHECK(sameSprite(sd, image.getSpriteInfo()));
+
+    // setSpriteData() moves and flips the entity, the texture is kept
+    sd.x = 7;
+    sd.y = 8;
+    sd.scale = 0.5f;
+    sd.angle = 0;
+    sd.flipHorizontal = false;
+    sd.flipVertical = true;
+    sd.layer = 5;
+    sd.texture = NULL;
+    store.setSpriteData(e, sd);
+    SpriteData back;
+    CHECK(store.getSpriteData(e, back));
+    sd.texture = texture.getTexture();
+    CHECK(sameSprite(back, sd));
+
+    // without an animation the rect is the one set
+    Image still;
+    CHECK(still.initialize(&graphics, FRAME_SIZE, FRAME_SIZE, COLS, &texture));
+    still.setCurrentFrame(5);
+    EntityId s = store.create(still);
+    CHECK(store.getMask(s) == (TRANSFORM | SPRITE));
+    CHECK(store.getSpriteData(s, sd));
+    CHECK(sameSprite(sd, still.getSpriteInfo()));
+    RECT r = {FRAME_SIZE, 0, 2*FRAME_SIZE, FRAME_SIZE/2};
+    sd.rect = r;
+    sd.height = FRAME_SIZE/2;
+    store.setSpriteData(s, sd);
+    CHECK(store.getSpriteData(s, back));
+    CHECK(sameSprite(back, sd));
+
+    // an entity not created from an Image gets a sprite
+    EntityId n = store.create(0);
+    store.setSpriteData(n, sd);
+    CHECK(store.getMask(n) == (TRANSFORM | SPRITE));
+    CHECK(store.getSpriteData(n, back));
+    sd.texture = NULL;
+    CHECK(sameSprite(back, sd));
+
+    store.destroy(e);                   // its animation is removed
+    CHECK(!store.getSpriteData(e, back));
+    CHECK(consistent(store));
+}
+
+int main()
+{
+    std::vector<unsigned int> pixels(FRAME_SIZE*COLS * FRAME_SIZE*2, 0xff808080);
+    CHECK(testWriteTga(TEXTURE_FILE, FRAME_SIZE*COLS, FRAME_SIZE*2, &pixels[0]));
+    Graphics graphics;
+    graphics.initialize(NULL, 640, 480, false);
+    TextureManager texture;
+    CHECK(texture.initialize(&graphics, TEXTURE_FILE));
+
+    testIds();
+    testMove();
+    testSwapRemove();
+    testImage(graphics, texture);
+
+    remove(TEXTURE_FILE);
+    return testResult();
+}
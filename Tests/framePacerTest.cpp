@@ -0,0 +1,142 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// framePacerTest.cpp v1.0
+// Tests FramePacer on the real clock: frames come at the target rate with
+// no drift over many frames, the sleep margin stays between MIN_MARGIN and
+// MAX_MARGIN of the period and settles, and a late frame starts at once
+// without the next frames catching up.
+// Usage: framePacerTest [frames]
+
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include "test.h"
+#include "framePacer.h"
+
+using namespace framePacerNS;
+
+namespace
+{
+    const float RATE = 200;             // frames per second, FRAME_RATE of constants.h
+    const double DRIFT = 0.02;          // most error of the total time, fraction
+}
+
+//=============================================================================
+// Frames at the target rate, the margin stays in range and settles.
+//=============================================================================
+static void testRate(int frames)
+{
+    FramePacer pacer;
+    pacer.initialize(RATE);
+    double period = 1.0 / RATE;
+    std::vector<float> margins;             // over the second half
+    int outOfRange = 0;
+    double t0 = testSeconds();
+    double sum = 0;
+    for (int f = 0; f < frames; f++)
+    {
+        sum += pacer.waitForFrame();
+        float margin = pacer.getSleepMargin();
+        if (margin > period * MAX_MARGIN + 1e-6 || margin < MIN_MARGIN - 1e-6)
+            outOfRange++;
+        if (f >= frames / 2)
+            margins.push_back(margin);
+    }
+    double elapsed = testSeconds() - t0;
+    CHECK(outOfRange == 0);
+    // the margin follows the sleep error of this machine, see
+    // testRaisedRate() for it settling
+    std::sort(margins.begin(), margins.end());
+    float median = margins[margins.size() / 2];
+    CHECK(pacer.getFrames() == (UINT)frames);
+    // deadlines are a period apart, so the total holds even if frames jitter
+    if (pacer.getMissed() == 0)
+    {
+        CHECK(fabs(elapsed - frames * period) < frames * period * DRIFT + period);
+        CHECK(fabs(sum - elapsed) < period);
+    }
+    printf("%d frames at %.0f fps: %.3f s (%.3f s target), %u missed, overshoot average %.3f ms, "
+           "max %.3f ms, margin median %.3f ms, max %.3f ms\n", frames, RATE, elapsed, frames * period,
+           pacer.getMissed(), pacer.getOvershootAverage() * 1000, pacer.getOvershootMax() * 1000,
+           median * 1000, margins.back() * 1000);
+}
+
+//=============================================================================
+// A raised rate clamps the margin to MAX_MARGIN of the new period, and
+// the margin settles to MIN_MARGIN when sleeps are not late.
+//=============================================================================
+static void testRaisedRate()
+{
+    FramePacer pacer;
+    pacer.initialize(10);
+    pacer.waitForFrame();
+    pacer.setTargetRate(2000);
+    pacer.waitForFrame();
+    CHECK(pacer.getSleepMargin() <= MAX_MARGIN / 2000 + 1e-6f);
+    CHECK(pacer.getSleepMargin() >= MIN_MARGIN - 1e-6f);
+
+    // a period shorter than a sleep only yields, so nothing raises the
+    // margin and it settles at MIN_MARGIN
+    for (int f = 0; f < 400; f++)
+        pacer.waitForFrame();
+    CHECK(pacer.getSleepMargin() < MIN_MARGIN + 1e-5f);
+}
+
+//=============================================================================
+// A frame more than a period late returns at once and the deadlines start
+// over from then, no frames are rushed to catch up.
+//=============================================================================
+static void testLate()
+{
+    FramePacer pacer;
+    pacer.initialize(RATE);
+    double period = 1.0 / RATE;
+    pacer.waitForFrame();
+    GameClock::sleep((UINT)(period * 4 * 1000));    // a stall of 4 frames
+    double t0 = testSeconds();
+    float late = pacer.waitForFrame();
+    double waited = testSeconds() - t0;
+    CHECK(waited < period / 2);             // no waiting
+    CHECK(late >= period * 4 * 0.9);        // the frameTime of the stall
+    CHECK(pacer.getMissed() == 1);
+
+    const int FRAMES = 20;
+    float shortest = 1e9f;
+    pacer.resetStats();
+    t0 = testSeconds();
+    for (int f = 0; f < FRAMES; f++)
+        shortest = std::min(shortest, pacer.waitForFrame());
+    double elapsed = testSeconds() - t0;
+    // no catching up, a frame is only shorter than a period by the time
+    // the frame before it started late
+    if (pacer.getMissed() == 0)
+    {
+        CHECK(shortest > period - pacer.getOvershootMax() - 1e-4);
+        CHECK(fabs(elapsed - FRAMES * period) < FRAMES * period * DRIFT + period);
+    }
+}
+
+//=============================================================================
+// Rate 0 does not wait.
+//=============================================================================
+static void testNoLimit()
+{
+    FramePacer pacer;
+    pacer.initialize(0);
+    double t0 = testSeconds();
+    for (int f = 0; f < 1000; f++)
+        pacer.waitForFrame();
+    CHECK(testSeconds() - t0 < 0.1);
+    CHECK(pacer.getMissed() == 0);
+}
+
+int main(int argc, char *argv[])
+{
+    int frames = testCount(argc, argv, 400);
+    testRate(frames);
+    testRaisedRate();
+    testLate();
+    testNoLimit();
+    return testResult();
+}
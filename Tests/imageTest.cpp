@@ -0,0 +1,133 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// imageTest.cpp v1.0
+// Tests Image drawing between simulation ticks. Drawing is recorded into a
+// RenderCommandList so the position each sprite is drawn at can be read.
+
+#include <math.h>
+#include <vector>
+#include "test.h"
+#include "image.h"
+
+namespace
+{
+    const char *TEXTURE_FILE = "imageTest.tga";
+}
+
+static bool near(float a, float b)
+{
+    return fabsf(a - b) < 1e-4f;
+}
+
+// Draw image recorded and return the x,y and angle it was drawn at.
+static SpriteData drawn(Graphics &graphics, Image &image, bool withSpriteData = false, float moveX = 0)
+{
+    RenderCommandList list;
+    graphics.setRecording(&list);
+    if (withSpriteData)
+    {
+        SpriteData sd = image.getSpriteInfo();
+        sd.x += moveX;
+        image.draw(sd);
+    }
+    else
+        image.draw();
+    graphics.setRecording(NULL);
+    CHECK(list.getSize() == 1);
+    if (list.getSize() != 1)
+        return SpriteData();
+    return list.get(0).spriteData;
+}
+
+//=============================================================================
+// Several ticks between two frames are drawn between the last two ticks.
+//=============================================================================
+static void testTicks(Graphics &graphics, TextureManager &texture)
+{
+    ImageTicks ticks;
+    graphics.setImageTicks(&ticks);
+    Image image;
+    CHECK(image.initialize(&graphics, 0, 0, 0, &texture));
+
+    // not interpolating, drawn where it is
+    image.setX(5);
+    CHECK(near(drawn(graphics, image).x, 5));
+    CHECK(ticks.getSize() == 0);
+
+    // first drawn interpolating, added, drawn where it is until a tick
+    graphics.setInterpolation(0, 0.5f);
+    CHECK(near(drawn(graphics, image).x, 5));
+    CHECK(ticks.getSize() == 1);
+
+    // three ticks in one frame, 10 pixels and 0.1 radians each
+    for (int t = 0; t < 3; t++)
+    {
+        ticks.beginTick();
+        image.setX(image.getX() + 10);
+        image.setRadians(image.getRadians() + 0.1f);
+    }
+    graphics.setInterpolation(3, 0.25f);
+    SpriteData sd = drawn(graphics, image);
+    CHECK(near(sd.x, 25 + 10 * 0.25f));
+    CHECK(near(sd.angle, 0.2f + 0.1f * 0.25f));
+    CHECK(near(drawn(graphics, image, true, 100).x, 125 + 10 * 0.25f));
+    CHECK(image.getX() == 35);          // the position itself is not changed
+
+    // no ticks in the next frame, still between the same two ticks
+    graphics.setInterpolation(3, 0.75f);
+    CHECK(near(drawn(graphics, image).x, 25 + 10 * 0.75f));
+
+    // moved to a new place, drawn there until the next tick
+    image.setX(500);
+    image.resetInterpolation();
+    CHECK(near(drawn(graphics, image).x, 500));
+
+    graphics.clearInterpolation();
+    CHECK(near(drawn(graphics, image).x, 500));
+    graphics.setImageTicks(NULL);
+}
+
+//=============================================================================
+// Images leave the list when deleted, and the other way round.
+//=============================================================================
+static void testLifetime(Graphics &graphics, TextureManager &texture)
+{
+    Image *images[3];
+    {
+        ImageTicks ticks;
+        graphics.setImageTicks(&ticks);
+        graphics.setInterpolation(0, 0.5f);
+        for (int i = 0; i < 3; i++)
+        {
+            images[i] = new Image;
+            images[i]->initialize(&graphics, 0, 0, 0, &texture);
+            images[i]->setX((float)i);
+            drawn(graphics, *images[i]);
+        }
+        CHECK(ticks.getSize() == 3);
+        delete images[0];
+        CHECK(ticks.getSize() == 2);
+        ticks.beginTick();
+        images[2]->setX(12);
+        CHECK(near(drawn(graphics, *images[2]).x, 7));
+        graphics.setImageTicks(NULL);
+    }
+    delete images[1];                   // after the list, nothing to remove from
+    delete images[2];
+    graphics.clearInterpolation();
+}
+
+int main()
+{
+    std::vector<unsigned int> pixels(16 * 16, 0xffff0000);
+    CHECK(testWriteTga(TEXTURE_FILE, 16, 16, &pixels[0]));
+    Graphics graphics;
+    graphics.initialize(NULL, 640, 480, false);
+    TextureManager texture;
+    CHECK(texture.initialize(&graphics, TEXTURE_FILE));
+    testTicks(graphics, texture);
+    testLifetime(graphics, texture);
+    remove(TEXTURE_FILE);
+    return testResult();
+}
@@ -0,0 +1,200 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// inputQueueBench.cpp v1.0
+// Injects synthetic input events into an InputQueue from a second thread,
+// the way Input posts them from the message thread, while this thread
+// drains them into an InputState once a frame like Game::run() does.
+// Checks that events arrive in order with their timestamps, that a full
+// queue drops and counts events instead of losing track, and that the
+// state made from the events is right. Prints events per second and the
+// time from post to drain.
+// Usage: inputQueueBench [events]
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "test.h"
+#include "inputQueue.h"
+#include "gameClock.h"
+
+using namespace inputNS;
+
+namespace
+{
+    const double FRAME_SECONDS = 0.001;     // drain interval of the paced run
+    const double RATE = 1000000;            // events per second of the paced run
+    const UINT PACED_EVENTS = 1000000;      // most events of the paced run
+}
+
+//=============================================================================
+// State made from a few events.
+//=============================================================================
+static void testState()
+{
+    InputState state;
+    InputQueue queue(8);
+    CHECK(queue.getSize() == 8);
+    InputEvent e = {0, KEY_DOWN, 'A', 0, 0};
+    CHECK(queue.push(e));
+    e.type = KEY_UP;                        // down and up in one frame
+    CHECK(queue.push(e));
+    e.type = MOUSE_RAW;
+    e.x = 3;
+    e.y = -1;
+    CHECK(queue.push(e));
+    e.x = 5;
+    CHECK(queue.push(e));
+    while (queue.pop(e))
+        state.apply(e);
+    CHECK(!state.isKeyDown('A'));
+    CHECK(state.wasKeyPressed('A'));        // the press is not lost
+    CHECK(state.getEvents().size() == 4);   // nor the first raw packet
+    CHECK(state.getMouseRawX() == 5);
+    state.clear(KEYS_PRESSED | EVENTS);
+    CHECK(!state.anyKeyPressed());
+    CHECK(state.getEvents().empty());
+
+    // full queue
+    for (UINT i = 0; i < 10; i++)
+    {
+        e.code = i;
+        queue.push(e);
+    }
+    CHECK(queue.getDropped() == 2);
+    CHECK(queue.getCount() == 8);
+    CHECK(queue.pop(e) && e.code == 0);     // the oldest kept
+
+    // text with a backspace
+    const char *typed = "hi\b!\r";
+    for (const char *p = typed; *p; p++)
+    {
+        InputEvent c = {0, CHAR_IN, (UINT)(unsigned char)*p, 0, 0};
+        state.apply(c);
+    }
+    CHECK(state.getTextIn() == "h!\r");
+}
+
+// Result of one injection run.
+struct Run
+{
+    UINT    received;
+    UINT    dropped;            // pushes that found the queue full
+    UINT    outOfOrder;         // codes not increasing
+    UINT    timeBackwards;      // timestamps decreasing
+    UINT    drains;
+    int     rawSum;             // sum of the raw mouse movement applied
+    double  seconds;
+    std::vector<double> latency;    // microseconds, a sample of the events
+};
+
+//=============================================================================
+// Inject count raw mouse events, each with code = its number. rate = 0
+// injects as fast as possible and waits when the queue is full, else
+// events are posted rate per second and dropped when the queue is full,
+// like Input does. The reader drains every frameSeconds, or as fast as it
+// can if 0.
+//=============================================================================
+static Run inject(UINT count, double rate, double frameSeconds)
+{
+    InputQueue queue;
+    Run run = {0, 0, 0, 0, 0, 0, 0, std::vector<double>()};
+    std::atomic<bool> done(false);
+    double t0 = testSeconds();
+    std::thread writer([&]()
+    {
+        LONGLONG start = GameClock::ticks();
+        double perTick = rate / GameClock::frequency();
+        for (UINT i = 0; i < count; )
+        {
+            LONGLONG now = GameClock::ticks();
+            if (rate > 0 && i >= (now - start) * perTick)
+            {
+                std::this_thread::yield();  // ahead of the rate
+                continue;
+            }
+            InputEvent e = {now, MOUSE_RAW, i, 1, 0};
+            if (queue.push(e) || rate > 0)
+                i++;
+            else
+                std::this_thread::yield();
+        }
+        done.store(true);
+    });
+
+    InputState state;
+    LONGLONG frame = GameClock::fromSeconds(frameSeconds);
+    double toMicroseconds = 1e6 / GameClock::frequency();
+    LONGLONG lastTime = 0;
+    UINT next = 0;
+    int rawSum = 0;
+    for (;;)
+    {
+        bool finished = done.load();        // read before the last drain
+        LONGLONG drainTime = GameClock::ticks();
+        InputEvent e;
+        while (queue.pop(e))
+        {
+            if (e.code < next)
+                run.outOfOrder++;
+            if (e.time < lastTime)
+                run.timeBackwards++;
+            next = e.code + 1;
+            lastTime = e.time;
+            if ((run.received & 63) == 0)
+                run.latency.push_back((GameClock::ticks() - e.time) * toMicroseconds);
+            run.received++;
+            state.apply(e);
+            rawSum += state.getMouseRawX();
+        }
+        state.clear(EVENTS);
+        run.drains++;
+        if (finished)
+            break;
+        if (frame)
+            while (GameClock::ticks() - drainTime < frame)
+                std::this_thread::yield();
+        else
+            std::this_thread::yield();
+    }
+    writer.join();
+    run.seconds = testSeconds() - t0;
+    run.dropped = queue.getDropped();
+    run.rawSum = rawSum;
+    std::sort(run.latency.begin(), run.latency.end());
+    return run;
+}
+
+static void report(const char *name, UINT count, const Run &run)
+{
+    double p50 = run.latency.empty() ? 0 : run.latency[run.latency.size() / 2];
+    double p99 = run.latency.empty() ? 0 : run.latency[run.latency.size() * 99 / 100];
+    printf("%-22s %u events, %.1f M events/s, %u drains, full %u times, latency p50 %.1f us, p99 %.1f us\n",
+           name, count, count / run.seconds / 1e6, run.drains, run.dropped, p50, p99);
+}
+
+int main(int argc, char *argv[])
+{
+    UINT count = (UINT)testCount(argc, argv, 20000000);
+    testState();
+
+    // lossless: the writer waits for room, every event arrives in order,
+    // getDropped() counts the pushes that found the queue full
+    Run run = inject(count, 0, 0);
+    CHECK(run.received == count);
+    CHECK(run.outOfOrder == 0);
+    CHECK(run.timeBackwards == 0);
+    CHECK(run.rawSum == (int)count);        // every packet applied, none merged
+    report("writer waits:", count, run);
+
+    // paced: the writer never waits, the reader drains once a frame, what
+    // does not fit is dropped and counted
+    UINT paced = std::min(count, PACED_EVENTS);
+    run = inject(paced, RATE, FRAME_SECONDS);
+    CHECK(run.received + run.dropped == paced);
+    CHECK(run.outOfOrder == 0);
+    CHECK(run.timeBackwards == 0);
+    CHECK(run.rawSum == (int)run.received);
+    report("1M/s, drained each ms:", paced, run);
+    return testResult();
+}
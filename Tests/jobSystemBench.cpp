@@ -0,0 +1,238 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// jobSystemBench.cpp v1.0
+// Times a frame split into jobs by a JobSystem with 1 to N threads. Each
+// frame moves the entities in an update phase, then runs an ai phase and a
+// collisions phase that wait for it, like Game::run() does with
+// getFrameJobs(). The results must be the same as running the frame on one
+// thread, and jobs that add jobs or wait on other jobs must all run, also
+// before the JobSystem is started, when they run as they are added.
+// Usage: jobSystemBench [entities] [threads], threads defaults to the cores
+
+#include <math.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "test.h"
+#include "jobSystem.h"
+
+namespace
+{
+    const UINT GRAIN = 1024;            // entities per job
+    const int FRAMES = 10;              // timed frames per thread count
+    const int WORK = 16;                // iterations per entity, the cost of one update
+}
+
+// Entities of the benchmark frame.
+struct World
+{
+    std::vector<float> x, y, vx, vy;
+    std::vector<float> heading;         // written by ai
+    std::vector<UINT> cell;             // written by collisions
+
+    void reset(UINT count)
+    {
+        x.resize(count); y.resize(count);
+        vx.resize(count); vy.resize(count);
+        heading.assign(count, 0);
+        cell.assign(count, 0);
+        for (UINT i = 0; i < count; i++)
+        {
+            x[i] = (float)(i % 1000);
+            y[i] = (float)(i / 1000);
+            vx[i] = sinf((float)i);
+            vy[i] = cosf((float)i);
+        }
+    }
+};
+
+// Move the entities.
+struct Update
+{
+    World *world;
+    void operator()(UINT begin, UINT end)
+    {
+        for (UINT i = begin; i < end; i++)
+        {
+            float vx = world->vx[i], vy = world->vy[i];
+            for (int k = 0; k < WORK; k++)              // stands in for game logic
+            {
+                float t = vx;
+                vx = vx * 0.99f - vy * 0.01f;
+                vy = vy * 0.99f + t * 0.01f;
+            }
+            world->vx[i] = vx;
+            world->vy[i] = vy;
+            world->x[i] += vx;
+            world->y[i] += vy;
+        }
+    }
+};
+
+// Turn toward the origin, reads the positions update wrote.
+struct Ai
+{
+    World *world;
+    void operator()(UINT begin, UINT end)
+    {
+        for (UINT i = begin; i < end; i++)
+            world->heading[i] = atan2f(-world->y[i], -world->x[i]);
+    }
+};
+
+// Find the grid cell of each entity, reads the positions update wrote.
+struct Collisions
+{
+    World *world;
+    void operator()(UINT begin, UINT end)
+    {
+        for (UINT i = begin; i < end; i++)
+            world->cell[i] = ((UINT)(world->x[i] + 4096) >> 6) * 131 + ((UINT)(world->y[i] + 4096) >> 6);
+    }
+};
+
+// Run one frame: update, then ai and collisions at the same time, then a
+// barrier. jobs = NULL runs it on the calling thread.
+static void runFrame(JobSystem *jobs, World &world)
+{
+    Update update = {&world};
+    Ai ai = {&world};
+    Collisions collisions = {&world};
+    UINT count = (UINT)world.x.size();
+    if (!jobs)
+    {
+        update(0, count);
+        ai(0, count);
+        collisions(0, count);
+        return;
+    }
+    JobCounter moved, frame;
+    jobs->parallelFor(count, GRAIN, update, &moved);
+    jobs->parallelFor(count, GRAIN, ai, &frame, &moved);
+    jobs->parallelFor(count, GRAIN, collisions, &frame, &moved);
+    jobs->wait(&frame);                 // the barrier before renderGame()
+}
+
+static bool sameWorld(const World &a, const World &b)
+{
+    size_t n = a.x.size() * sizeof(float);
+    return memcmp(&a.x[0], &b.x[0], n) == 0 && memcmp(&a.y[0], &b.y[0], n) == 0 &&
+           memcmp(&a.heading[0], &b.heading[0], n) == 0 &&
+           memcmp(&a.cell[0], &b.cell[0], a.cell.size() * sizeof(UINT)) == 0;
+}
+
+//=============================================================================
+// Jobs that add more jobs to the counter being waited on.
+//=============================================================================
+struct Spawn
+{
+    JobSystem *jobs;
+    JobCounter *counter;
+    std::vector<int> *hits;
+    void operator()(UINT begin, UINT end)
+    {
+        if (end - begin > 16)           // split in two until small
+        {
+            UINT mid = (begin + end) / 2;
+            Spawn *self = this;
+            jobs->add(&spawnJob, self, begin, mid, counter);
+            jobs->add(&spawnJob, self, mid, end, counter);
+            return;
+        }
+        for (UINT i = begin; i < end; i++)
+            (*hits)[i]++;
+    }
+    static void spawnJob(void *data, UINT begin, UINT end)
+    {
+        (*(Spawn*)data)(begin, end);
+    }
+};
+
+static void testNested(JobSystem &jobs)
+{
+    std::vector<int> hits(100000, 0);
+    JobCounter counter;
+    Spawn spawn = {&jobs, &counter, &hits};
+    jobs.add(&Spawn::spawnJob, &spawn, 0, (UINT)hits.size(), &counter);
+    jobs.wait(&counter);
+    int wrong = 0;
+    for (size_t i = 0; i < hits.size(); i++)
+        wrong += hits[i] != 1;
+    CHECK(wrong == 0);
+    CHECK(counter.done());
+}
+
+//=============================================================================
+// Before initialize() jobs run when they are added or when the counter they
+// wait for is done. A waiting job that adds a job to that counter must not
+// deadlock on the counter.
+//=============================================================================
+struct Chain
+{
+    JobSystem *jobs;
+    JobCounter *first;
+    JobCounter *second;
+    int runs[3];
+    static void job(void *data, UINT begin, UINT)
+    {
+        Chain *c = (Chain*)data;
+        c->runs[begin]++;
+        if (begin == 0)                 // job 1 waits for job 0
+            c->jobs->add(&job, c, 1, 2, c->second, c->first);
+        else if (begin == 1)            // job 2 counts on the counter job 1 waited for
+            c->jobs->add(&job, c, 2, 3, c->first);
+    }
+};
+
+static void testNotStarted()
+{
+    JobSystem jobs;
+    JobCounter first, second;
+    Chain chain = {&jobs, &first, &second, {0, 0, 0}};
+    jobs.add(&Chain::job, &chain, 0, 1, &first);
+    jobs.wait(&first);
+    jobs.wait(&second);
+    CHECK(chain.runs[0] == 1 && chain.runs[1] == 1 && chain.runs[2] == 1);
+    CHECK(first.done() && second.done() && jobs.getExecuted() == 3);
+}
+
+int main(int argc, char *argv[])
+{
+    testNotStarted();
+
+    UINT count = (UINT)testCount(argc, argv, 1 << 20);
+    UINT cores = std::thread::hardware_concurrency();
+    UINT maxThreads = argc > 2 ? (UINT)atoi(argv[2]) : (cores > 1 ? cores : 2);
+    printf("%u entities, %u cores\n", count, cores);
+
+    // the frames on one thread, the reference
+    World reference;
+    reference.reset(count);
+    double t0 = testSeconds();
+    for (int f = 0; f < FRAMES; f++)
+        runFrame(NULL, reference);
+    double serial = (testSeconds() - t0) / FRAMES;
+    printf("no jobs:    %7.2f ms/frame\n", serial * 1000);
+
+    World world;
+    for (UINT threads = 1; threads <= maxThreads; threads = threads < maxThreads &&
+         threads * 2 > maxThreads ? maxThreads : threads * 2)
+    {
+        JobSystem jobs;
+        CHECK(jobs.initialize(threads - 1));
+        CHECK(jobs.getThreadCount() == threads);
+        world.reset(count);
+        t0 = testSeconds();
+        for (int f = 0; f < FRAMES; f++)
+            runFrame(&jobs, world);
+        double t = (testSeconds() - t0) / FRAMES;
+        CHECK(sameWorld(world, reference));
+        testNested(jobs);
+        printf("%2u threads: %7.2f ms/frame, speedup %.2f, %u jobs, %u stolen\n", threads,
+               t * 1000, serial / t, jobs.getExecuted(), jobs.getSteals());
+        if (threads == maxThreads)
+            break;
+    }
+    return testResult();
+}
@@ -0,0 +1,139 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// mipmapBench.cpp v1.0
+// Times what mip levels cost and save with the software Graphics:
+//   building the levels, SSE2 and scalar, and creating a texture with the
+//   levels made at load or taken from a cooked file
+//   drawing a zoomed out scene with and without mip levels, and the texture
+//   memory of the scene
+// Only the software Graphics is timed. Direct3D samples the levels in
+// hardware and its texture bandwidth is not measured here.
+// Usage: mipmapBench [sprites]
+
+#include <string.h>
+#include <vector>
+#include "test.h"
+#include "graphics.h"
+#include "textureManager.h"
+#include "image.h"
+#include "textureResidency.h"
+
+namespace
+{
+    const UINT SIZE = 1024;             // texture created at load
+    const UINT SPRITE_SIZE = 256;       // textures drawn
+    const int TEXTURES = 16;
+    const int REPEAT = 5;               // best of
+}
+
+// Return the best seconds of REPEAT calls of f.
+template <class F> static double best(F f)
+{
+    double result = 1e9;
+    for (int r = 0; r < REPEAT; r++)
+    {
+        double t0 = testSeconds();
+        f();
+        double t = testSeconds() - t0;
+        if (t < result)
+            result = t;
+    }
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = testCount(argc, argv, 4000);
+
+    // Building the levels
+    std::vector<COLOR_ARGB> pixels(SIZE * SIZE);
+    srand(1);
+    for (size_t i = 0; i < pixels.size(); i++)
+        pixels[i] = premultiplyColor(0xff000000 | (rand() << 8) | rand() % 256);
+    UINT levels = Mipmap::getLevelCount(SIZE, SIZE);
+    std::vector<COLOR_ARGB> simd(Mipmap::getChainSize(SIZE, SIZE, levels)), scalar(simd.size());
+    double simdTime = best([&] {Mipmap::build(&pixels[0], SIZE, SIZE, levels, &simd[0]);});
+    Mipmap::setSimd(false);
+    double scalarTime = best([&] {Mipmap::build(&pixels[0], SIZE, SIZE, levels, &scalar[0]);});
+    Mipmap::setSimd(true);
+    CHECK(simd == scalar);
+
+    Graphics graphics;
+    graphics.initialize(NULL, 1280, 720, false);
+    LP_TEXTURE texture = NULL;
+    double noMipsLoad, builtLoad, cookedLoad;
+    graphics.setMipmaps(false);
+    noMipsLoad = best([&] {graphics.createTexture(&pixels[0], SIZE, SIZE, texture); SAFE_RELEASE(texture);});
+    graphics.setMipmaps(true);
+    builtLoad = best([&] {graphics.createTexture(&pixels[0], SIZE, SIZE, texture); SAFE_RELEASE(texture);});
+    cookedLoad = best([&] {graphics.createTexture(&pixels[0], SIZE, SIZE, texture, levels, &simd[0]);
+                           SAFE_RELEASE(texture);});
+    graphics.createTexture(&pixels[0], SIZE, SIZE, texture, levels, &simd[0]);
+    CHECK(texture->mips == scalar);
+    SAFE_RELEASE(texture);
+
+    printf("%ux%u, %u levels, chain %.1f MB, %.1f%% of the texture\n", SIZE, SIZE, levels,
+           simd.size() * 4 / 1048576.0, 100.0 * simd.size() / pixels.size());
+    printf("Mipmap::build          SSE2 %6.2f ms, scalar %6.2f ms\n", simdTime * 1e3, scalarTime * 1e3);
+    printf("createTexture          no mips %6.2f ms, levels made %6.2f ms, cooked levels %6.2f ms\n",
+           noMipsLoad * 1e3, builtLoad * 1e3, cookedLoad * 1e3);
+
+    // A zoomed out scene
+    char name[32];
+    std::vector<unsigned int> image(SPRITE_SIZE * SPRITE_SIZE);
+    for (int t = 0; t < TEXTURES; t++)
+    {
+        for (size_t i = 0; i < image.size(); i++)
+            image[i] = 0xff000000 | (rand() << 8) | rand() % 256;
+        sprintf(name, "mipmapBench%d.tga", t);
+        CHECK(testWriteTga(name, SPRITE_SIZE, SPRITE_SIZE, &image[0]));
+    }
+    double frameTime[2];
+    UINT64 textureBytes[2];
+    for (int mode = 0; mode < 2; mode++)
+    {
+        graphics.setMipmaps(mode == 1);
+        graphics.setBatching(true);
+        TextureResidency residency;
+        TextureManager textures[TEXTURES];
+        for (int t = 0; t < TEXTURES; t++)
+        {
+            sprintf(name, "mipmapBench%d.tga", t);
+            textures[t].setResidency(&residency);
+            CHECK(textures[t].initialize(&graphics, name));
+        }
+        textureBytes[mode] = residency.getStats().bytes;
+        Image *images = new Image[count];
+        srand(2);
+        for (int i = 0; i < count; i++)
+        {
+            images[i].initialize(&graphics, 0, 0, 0, &textures[i % TEXTURES]);
+            float scale = 0.03f + 0.05f * (rand() % 100) / 100;
+            images[i].setScale(scale);
+            images[i].setX((float)(rand() % 1260));
+            images[i].setY((float)(rand() % 700));
+            images[i].setDegrees((float)(rand() % 360));
+        }
+        frameTime[mode] = best([&] {
+            graphics.beginScene();
+            graphics.spriteBegin();
+            for (int i = 0; i < count; i++)
+                images[i].draw();
+            graphics.spriteEnd();
+            graphics.endScene();
+        });
+        delete[] images;
+    }
+    for (int t = 0; t < TEXTURES; t++)
+    {
+        sprintf(name, "mipmapBench%d.tga", t);
+        remove(name);
+    }
+    printf("%d sprites %ux%u at scale 0.03 to 0.08\n", count, SPRITE_SIZE, SPRITE_SIZE);
+    printf("frame                  no mips %6.2f ms, mips %6.2f ms, %.1fx\n",
+           frameTime[0] * 1e3, frameTime[1] * 1e3, frameTime[0] / frameTime[1]);
+    printf("texture memory         no mips %6.2f MB, mips %6.2f MB\n",
+           textureBytes[0] / 1048576.0, textureBytes[1] / 1048576.0);
+    return testResult();
+}
@@ -0,0 +1,138 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// mipmapTest.cpp v1.0
+// Tests that cooked textures carry their mip levels to the texture, through
+// Graphics::loadTexture() and the TextureLoader, that createTexture() keeps
+// to the level limit it is given, and that atlas pages only get the levels
+// their padding allows.
+
+#include <string.h>
+#include <vector>
+#include "test.h"
+#include "graphics.h"
+#include "textureManager.h"
+#include "textureAtlas.h"
+#include "textureLoader.h"
+#include "textureResidency.h"
+
+namespace
+{
+    const UINT SIZE = 64;
+    const char *IMAGE_FILE = "mipmapTest.tga";
+    const char *COOKED_FILE = "mipmapTest.tex";
+    const char *PLAIN_FILE = "mipmapTestNoMips.tex";
+    const char *DAMAGED_FILE = "mipmapTestDamaged.tex";
+    const COLOR_ARGB MARKER = 0x12345678;   // written into the cooked chain
+}
+
+static std::vector<BYTE> readFile(const char *file)
+{
+    std::vector<BYTE> bytes;
+    ImageFile::readFile(file, bytes);
+    return bytes;
+}
+
+static bool writeFile(const char *file, const std::vector<BYTE> &bytes)
+{
+    FILE *f = fopen(file, "wb");
+    if (f == NULL)
+        return false;
+    bool ok = fwrite(&bytes[0], 1, bytes.size(), f) == bytes.size();
+    return fclose(f) == 0 && ok;
+}
+
+int main()
+{
+    std::vector<unsigned int> image(SIZE * SIZE);
+    srand(1);
+    for (UINT i = 0; i < SIZE * SIZE; i++)
+        image[i] = 0xff000000 | (rand() << 8) | rand() % 256;
+    CHECK(testWriteTga(IMAGE_FILE, SIZE, SIZE, &image[0]));
+    UINT w, h;
+    std::vector<COLOR_ARGB> pixels;
+    CHECK(ImageFile::load(IMAGE_FILE, TRANSCOLOR, w, h, pixels));
+    UINT levels = Mipmap::getLevelCount(SIZE, SIZE);
+    std::vector<COLOR_ARGB> chain(Mipmap::getChainSize(SIZE, SIZE, levels));
+    Mipmap::build(&pixels[0], SIZE, SIZE, levels, &chain[0]);
+
+    // The cooked file holds the chain, without mips it holds none
+    CHECK(ImageFile::writeCooked(COOKED_FILE, w, h, pixels, NULL));
+    CHECK(ImageFile::writeCooked(PLAIN_FILE, w, h, pixels, NULL, false));
+    std::vector<BYTE> cookedFile = readFile(COOKED_FILE);
+    const CookedHeader *cooked = ImageFile::getCooked(&cookedFile[0], cookedFile.size());
+    CHECK(cooked && cooked->levels == levels);
+    CHECK(cooked && memcmp(ImageFile::getCookedMips(cooked), &chain[0],
+                           chain.size()*sizeof(COLOR_ARGB)) == 0);
+    std::vector<BYTE> plainFile = readFile(PLAIN_FILE);
+    const CookedHeader *plain = ImageFile::getCooked(&plainFile[0], plainFile.size());
+    CHECK(plain && plain->levels == 1 && ImageFile::getCookedMips(plain) == NULL);
+
+    // A chain cut short or more levels than the size has are rejected
+    std::vector<BYTE> damaged(cookedFile.begin(), cookedFile.end() - 4);
+    CHECK(ImageFile::getCooked(&damaged[0], damaged.size()) == NULL);
+    damaged = cookedFile;
+    ((CookedHeader*)&damaged[0])->levels = levels + 1;
+    CHECK(ImageFile::getCooked(&damaged[0], damaged.size()) == NULL);
+
+    // Mark the last level, a texture made from the file keeps the marker,
+    // one made from the pixels would not
+    ((COLOR_ARGB*)&cookedFile[0])[cookedFile.size()/sizeof(COLOR_ARGB) - 1] = MARKER;
+    CHECK(writeFile(DAMAGED_FILE, cookedFile));
+
+    Graphics graphics;
+    graphics.initialize(NULL, 64, 64, false);
+    LP_TEXTURE texture;
+    CHECK(SUCCEEDED(graphics.loadTexture(DAMAGED_FILE, TRANSCOLOR, w, h, texture)));
+    CHECK(texture->levels == levels && texture->mips.back() == MARKER);
+    SAFE_RELEASE(texture);
+    CHECK(SUCCEEDED(graphics.loadTexture(PLAIN_FILE, TRANSCOLOR, w, h, texture)));
+    CHECK(texture->levels == levels && texture->mips == chain);
+    SAFE_RELEASE(texture);
+
+    TextureLoader loader;
+    CHECK(loader.initialize(&graphics, 1));
+    TextureManager loaded;
+    CHECK(loaded.initialize(&graphics, DAMAGED_FILE, &loader));
+    loader.finish();
+    texture = loaded.getTexture();
+    CHECK(texture && texture->levels == levels && texture->mips.back() == MARKER);
+    loader.stop();
+
+    // Level limits
+    CHECK(SUCCEEDED(graphics.createTexture(&pixels[0], SIZE, SIZE, texture, 3)));
+    CHECK(texture->levels == 3 && texture->mips.size() == Mipmap::getChainSize(SIZE, SIZE, 3));
+    SAFE_RELEASE(texture);
+    graphics.setMipmaps(false);
+    CHECK(graphics.getMipLevels(SIZE, SIZE) == 1);
+    CHECK(SUCCEEDED(graphics.loadTexture(COOKED_FILE, TRANSCOLOR, w, h, texture)));
+    CHECK(texture->levels == 1 && texture->mips.empty());
+    SAFE_RELEASE(texture);
+    graphics.setMipmaps(true);
+    TextureResidency residency;
+    TextureManager counted;
+    counted.setResidency(&residency);
+    CHECK(counted.initialize(&graphics, IMAGE_FILE));
+    CHECK(residency.getStats().bytes == (SIZE*SIZE + chain.size()) * sizeof(COLOR_ARGB));
+
+    // Atlas pages get floor(log2(2*padding))+1 levels
+    const UINT padding[] = {0, 1, 2, 3, 4, 8};
+    const UINT pageLevels[] = {1, 2, 3, 3, 4, 5};
+    for (int i = 0; i < 6; i++)
+    {
+        TextureAtlas atlas;
+        CHECK(atlas.initialize(&graphics, 256, 256, padding[i]));
+        CHECK(atlas.getMaxLevels() == pageLevels[i]);
+        TextureManager a, b;
+        CHECK(a.initialize(&graphics, IMAGE_FILE, &atlas));
+        CHECK(b.initialize(&graphics, IMAGE_FILE, &atlas));
+        CHECK(atlas.build());
+        CHECK(atlas.getPage(0) && atlas.getPage(0)->levels == pageLevels[i]);
+    }
+
+    remove(IMAGE_FILE);
+    remove(COOKED_FILE);
+    remove(PLAIN_FILE);
+    remove(DAMAGED_FILE);
+    return testResult();
+}
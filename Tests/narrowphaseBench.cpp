@@ -0,0 +1,291 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// narrowphaseBench.cpp v1.0
+// Checks Narrowphase contacts against a double precision reference: the
+// separating axis test with the box corners projected on each edge
+// direction, the distance between circles, and the closest point of a box
+// to a circle. The SSE2 and scalar contacts must be the same bit for bit.
+// Times each kind of test, SSE2, scalar and the reference.
+// Usage: narrowphaseBench [objects]
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "test.h"
+#include "narrowphase.h"
+
+using namespace entityStoreNS;
+
+namespace
+{
+    const double TOLERANCE = 1e-3;      // of depths near 0 and of ties between axes
+    const int REPEAT = 10;              // best of
+}
+
+// An object as added, in double precision.
+struct Shape
+{
+    COLLISION_TYPE type;
+    double x, y, w, h, angle;
+};
+
+// The result of a reference test.
+struct RefContact
+{
+    bool    hit;
+    double  depth;
+    double  nx, ny;                     // unit normal from a to b
+    double  margin;                     // how much larger the next best axis is
+};
+
+// Separating axis test on the 4 edge directions, projecting every corner.
+static RefContact refBoxes(const Shape &a, const Shape &b)
+{
+    const Shape *box[2] = {&a, &b};
+    double px[2][4], py[2][4];
+    for (int k = 0; k < 2; k++)
+    {
+        const Shape &s = *box[k];
+        double angle = s.type == ROTATED_BOX ? s.angle : 0;
+        double c = cos(angle), sn = sin(angle);
+        const int sx[4] = {-1, 1, 1, -1}, sy[4] = {-1, -1, 1, 1};
+        for (int j = 0; j < 4; j++)
+        {
+            px[k][j] = s.x + sx[j]*s.w*c - sy[j]*s.h*sn;
+            py[k][j] = s.y + sx[j]*s.w*sn + sy[j]*s.h*c;
+        }
+    }
+    RefContact r = {true, 1e30, 0, 0, 1e30};
+    for (int k = 0; k < 2; k++)
+        for (int e = 0; e < 2; e++)
+        {
+            double angle = box[k]->type == ROTATED_BOX ? box[k]->angle : 0;
+            double ax = e ? -sin(angle) : cos(angle);
+            double ay = e ? cos(angle) : sin(angle);
+            double lo[2] = {1e30, 1e30}, hi[2] = {-1e30, -1e30};
+            for (int q = 0; q < 2; q++)
+                for (int j = 0; j < 4; j++)
+                {
+                    double p = px[q][j]*ax + py[q][j]*ay;
+                    lo[q] = std::min(lo[q], p);
+                    hi[q] = std::max(hi[q], p);
+                }
+            // distance to move either way until the projections separate
+            double overlap = std::min(hi[0] - lo[1], hi[1] - lo[0]);
+            if (overlap <= 0)
+                r.hit = false;
+            if (overlap < r.depth)
+            {
+                r.margin = r.depth - overlap;
+                r.depth = overlap;
+                double toB = (b.x - a.x)*ax + (b.y - a.y)*ay;
+                r.nx = toB < 0 ? -ax : ax;
+                r.ny = toB < 0 ? -ay : ay;
+            }
+            else
+                r.margin = std::min(r.margin, overlap - r.depth);
+        }
+    return r;
+}
+
+// Distance between the centers against the sum of the radii.
+static RefContact refCircles(const Shape &a, const Shape &b)
+{
+    double dx = b.x - a.x, dy = b.y - a.y;
+    double dist = sqrt(dx*dx + dy*dy);
+    RefContact r = {dist < a.w + b.w, a.w + b.w - dist, 1, 0, 1e30};
+    if (dist > 0)
+    {
+        r.nx = dx / dist;
+        r.ny = dy / dist;
+    }
+    else
+        r.margin = 0;                   // any normal
+    return r;
+}
+
+// Closest point of the box to the circle center, or the nearest edge when
+// the center is inside.
+static RefContact refCircleBox(const Shape &a, const Shape &b)
+{
+    const Shape &circle = a.type == CIRCLE ? a : b;
+    const Shape &box = a.type == CIRCLE ? b : a;
+    double angle = box.type == ROTATED_BOX ? box.angle : 0;
+    double ux = cos(angle), uy = sin(angle);        // box axes
+    double vx = -uy, vy = ux;
+    double dx = circle.x - box.x, dy = circle.y - box.y;
+    double lx = dx*ux + dy*uy, ly = dx*vx + dy*vy;
+    double qx = std::max(-box.w, std::min(box.w, lx));
+    double qy = std::max(-box.h, std::min(box.h, ly));
+    RefContact r = {false, 0, 0, 0, 1e30};
+    double nx, ny;                                  // box to circle, box frame
+    if (qx == lx && qy == ly)
+    {
+        double ox = box.w - fabs(lx), oy = box.h - fabs(ly);
+        r.hit = true;
+        r.depth = circle.w + std::min(ox, oy);
+        r.margin = fabs(ox - oy);
+        nx = ox < oy ? (lx < 0 ? -1 : 1) : 0;
+        ny = ox < oy ? 0 : (ly < 0 ? -1 : 1);
+    }
+    else
+    {
+        double ex = lx - qx, ey = ly - qy;
+        double dist = sqrt(ex*ex + ey*ey);
+        r.hit = dist < circle.w;
+        r.depth = circle.w - dist;
+        nx = ex / dist;
+        ny = ey / dist;
+    }
+    r.nx = nx*ux + ny*vx;
+    r.ny = nx*uy + ny*vy;
+    if (&circle == &a)                              // from a to b
+    {
+        r.nx = -r.nx;
+        r.ny = -r.ny;
+    }
+    return r;
+}
+
+static RefContact reference(const Shape &a, const Shape &b)
+{
+    if (a.type == CIRCLE && b.type == CIRCLE)
+        return refCircles(a, b);
+    if (a.type == CIRCLE || b.type == CIRCLE)
+        return refCircleBox(a, b);
+    return refBoxes(a, b);
+}
+
+static bool contactLess(const Contact &x, const Contact &y)
+{
+    return x.a < y.a || (x.a == y.a && x.b < y.b);
+}
+
+// Return the best seconds to test pairs.
+static double timeContacts(Narrowphase &narrowphase, const std::vector<BroadphasePair> &pairs)
+{
+    double best = 1e9;
+    for (int r = 0; r < REPEAT; r++)
+    {
+        double t0 = testSeconds();
+        narrowphase.findContacts(pairs);
+        double t = testSeconds() - t0;
+        if (t < best)
+            best = t;
+    }
+    return best;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = testCount(argc, argv, 100000);
+    float world = sqrtf((float)count) * 30;
+    std::vector<Shape> shapes(count);
+    Broadphase broadphase;
+    Narrowphase simd, scalar;
+    scalar.setSimd(false);
+    srand(3);
+    for (int i = 0; i < count; i++)
+    {
+        COLLISION_TYPE t = (COLLISION_TYPE)(rand() % 3);
+        float x = rand() / (float)RAND_MAX * world;
+        float y = rand() / (float)RAND_MAX * world;
+        float w = 4 + rand() / (float)RAND_MAX * 14;
+        float h = t == CIRCLE ? w : 4 + rand() / (float)RAND_MAX * 14;
+        float angle = t == ROTATED_BOX ? rand() / (float)RAND_MAX * 6.28f : 0;
+        Shape s = {t, x, y, w, h, angle};
+        shapes[i] = s;
+        simd.add(t, x, y, w, h, angle);
+        scalar.add(t, x, y, w, h, angle);
+        float ex = w, ey = h;                       // bounds
+        if (t == ROTATED_BOX)
+        {
+            ex = w*fabsf(cosf(angle)) + h*fabsf(sinf(angle));
+            ey = w*fabsf(sinf(angle)) + h*fabsf(cosf(angle));
+        }
+        broadphase.add(x - ex, y - ey, x + ex, y + ey, i);
+    }
+    std::vector<BroadphasePair> pairs(broadphase.findPairs());
+
+    // SSE2 and scalar agree bit for bit
+    std::vector<Contact> fast(simd.findContacts(pairs)), slow(scalar.findContacts(pairs));
+    std::sort(fast.begin(), fast.end(), contactLess);
+    std::sort(slow.begin(), slow.end(), contactLess);
+    CHECK(fast.size() == slow.size());
+    CHECK(fast.empty() || (fast.size() == slow.size() &&
+                           memcmp(&fast[0], &slow[0], fast.size()*sizeof(Contact)) == 0));
+
+    // Every pair against the reference
+    int hitDiffers = 0, depthDiffers = 0, normalDiffers = 0, hits = 0;
+    size_t next = 0;
+    std::vector<BroadphasePair> sorted(pairs);
+    for (size_t k = 0; k < sorted.size(); k++)
+        if (sorted[k].a > sorted[k].b)
+            std::swap(sorted[k].a, sorted[k].b);
+    std::sort(sorted.begin(), sorted.end(), [](const BroadphasePair &x, const BroadphasePair &y)
+              {return x.a < y.a || (x.a == y.a && x.b < y.b);});
+    for (size_t k = 0; k < sorted.size(); k++)
+    {
+        UINT a = sorted[k].a, b = sorted[k].b;
+        RefContact r = reference(shapes[a], shapes[b]);
+        while (next < slow.size() && contactLess(slow[next], Contact{a, b, 0, 0, 0}))
+            next++;
+        const Contact *c = next < slow.size() && slow[next].a == a && slow[next].b == b ?
+                           &slow[next] : NULL;
+        if (r.hit != (c != NULL))
+        {
+            if (fabs(r.depth) > TOLERANCE)          // not just touching
+                hitDiffers++;
+            continue;
+        }
+        if (!c)
+            continue;
+        hits++;
+        if (fabs(c->depth - r.depth) > TOLERANCE * (1 + r.depth))
+            depthDiffers++;
+        if (r.margin > TOLERANCE && c->normalX*r.nx + c->normalY*r.ny < 0.999)
+            normalDiffers++;
+    }
+    CHECK(hitDiffers == 0);
+    CHECK(depthDiffers == 0);
+    CHECK(normalDiffers == 0);
+    printf("%d objects, %u pairs, %d contacts checked against the reference\n",
+           count, (UINT)pairs.size(), hits);
+
+    // Time each kind of test
+    const char *names[4] = {"circle", "box", "rotated box", "circle-box"};
+    for (int kind = 0; kind < 4; kind++)
+    {
+        std::vector<BroadphasePair> kindPairs;
+        for (size_t k = 0; k < pairs.size(); k++)
+        {
+            COLLISION_TYPE ta = shapes[pairs[k].a].type, tb = shapes[pairs[k].b].type;
+            int pairKind = ta == CIRCLE && tb == CIRCLE ? 0 :
+                           ta == CIRCLE || tb == CIRCLE ? 3 :
+                           ta == ROTATED_BOX || tb == ROTATED_BOX ? 2 : 1;
+            if (pairKind == kind)
+                kindPairs.push_back(pairs[k]);
+        }
+        if (kindPairs.empty())
+            continue;
+        double simdTime = timeContacts(simd, kindPairs);
+        double scalarTime = timeContacts(scalar, kindPairs);
+        double refTime = 1e9;
+        int refHits = 0;
+        for (int r = 0; r < REPEAT; r++)
+        {
+            double t0 = testSeconds();
+            int n = 0;
+            for (size_t k = 0; k < kindPairs.size(); k++)
+                n += reference(shapes[kindPairs[k].a], shapes[kindPairs[k].b]).hit;
+            refHits = n;
+            refTime = std::min(refTime, testSeconds() - t0);
+        }
+        double m = kindPairs.size() / 1e6;
+        printf("%-12s %7u pairs, %6u hit: SSE2 %6.1f, scalar %6.1f, reference %6.1f Mpairs/s\n", names[kind],
+               (UINT)kindPairs.size(), (UINT)refHits, m / simdTime, m / scalarTime, m / refTime);
+    }
+    return testResult();
+}
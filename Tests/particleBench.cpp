@@ -0,0 +1,188 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// particleBench.cpp v1.0
+// Checks ParticleEmitter: SSE2 and scalar updates give the same particles,
+// an emitter stays within its capacity and memory, and every live particle
+// is drawn. Times update() and draw() of one emitter with count particles
+// per frame, against the same update written with one struct per particle.
+// Usage: particleBench [particles]
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include "test.h"
+#include "particles.h"
+#include "renderCommand.h"
+
+namespace
+{
+    const char *TEXTURE_FILE = "particleBench.tga";
+    const float FRAME_TIME = 1 / 60.0f;
+    const int FRAMES = 20;              // timed frames
+}
+
+// A particle as one struct, the layout ParticleEmitter does not use.
+struct StructParticle
+{
+    float x, y, vx, vy, r, g, b, a, dr, dg, db, da, life;
+};
+
+static void setup(ParticleEmitter &e)
+{
+    e.setPosition(320, 240);
+    e.setRate(3000);
+    e.setLife(0.2f, 1.5f);
+    e.setGravity(0, 98);
+    e.setColors(0xffff8000, 0x20ff0000);
+    e.setSeed(7);
+}
+
+static float clamp01(float v)
+{
+    return v < 0 ? 0 : (v > 1 ? 1 : v);
+}
+
+//=============================================================================
+// SSE2 and scalar emitters stay the same over many frames.
+//=============================================================================
+static void testSimd(Graphics &graphics, TextureManager &texture)
+{
+    ParticleEmitter simd, scalar;
+    CHECK(simd.initialize(&graphics, 8, 8, 0, &texture, 10000));
+    CHECK(scalar.initialize(&graphics, 8, 8, 0, &texture, 10000));
+    scalar.setSimd(false);
+    setup(simd);
+    setup(scalar);
+    size_t memory = simd.getMemory();
+    int differ = 0, dead = 0;
+    for (int f = 0; f < 300; f++)
+    {
+        simd.update(FRAME_TIME);
+        scalar.update(FRAME_TIME);
+        CHECK(simd.getCount() == scalar.getCount());
+        CHECK(simd.getCount() <= simd.getCapacity());
+        for (UINT i = 0; i < simd.getCount() && i < scalar.getCount(); i++)
+        {
+            differ += simd.getX(i) != scalar.getX(i) || simd.getY(i) != scalar.getY(i) ||
+                      simd.getColor(i) != scalar.getColor(i) || simd.getLife(i) != scalar.getLife(i);
+            dead += !(simd.getLife(i) > 0);
+        }
+    }
+    CHECK(differ == 0);
+    CHECK(dead == 0);
+    CHECK(simd.getCount() > 0);
+    CHECK(simd.getMemory() == memory);
+}
+
+//=============================================================================
+// An emitter never holds more than its capacity.
+//=============================================================================
+static void testCapacity(Graphics &graphics, TextureManager &texture)
+{
+    ParticleEmitter e;
+    CHECK(e.initialize(&graphics, 8, 8, 0, &texture, 100));
+    CHECK(e.emit(500) == 100);
+    CHECK(!e.add(0, 0, 0, 0, 1));
+    e.update(2.0f);                     // longer than any life
+    CHECK(e.getCount() == 0);
+
+    // one particle half way through its life
+    ParticleEmitter one;
+    CHECK(one.initialize(&graphics, 8, 8, 0, &texture, 4));
+    one.setColors(0xffffffff, 0x00000000);
+    CHECK(one.add(0, 0, 10, 0, 1.0f));
+    one.update(0.5f);
+    CHECK(fabsf(one.getX(0) - 5) < 1e-4f);
+    CHECK(fabsf(one.getLife(0) - 0.5f) < 1e-6f);
+    CHECK(one.getColor(0) == 0x80808080);
+}
+
+// Draw the emitter into list and return the seconds it took.
+static double drawRecorded(Graphics &graphics, ParticleEmitter &e, RenderCommandList &list)
+{
+    list.clear();
+    graphics.setRecording(&list);
+    double t0 = testSeconds();
+    graphics.spriteBegin();
+    e.draw();
+    graphics.spriteEnd();
+    double t = testSeconds() - t0;
+    graphics.setRecording(NULL);
+    return t;
+}
+
+int main(int argc, char *argv[])
+{
+    UINT count = (UINT)testCount(argc, argv, 1000000);
+    std::vector<unsigned int> pixels(8 * 8, 0xffffffff);
+    CHECK(testWriteTga(TEXTURE_FILE, 8, 8, &pixels[0]));
+    Graphics graphics;
+    graphics.initialize(NULL, 640, 480, false);
+    TextureManager texture;
+    CHECK(texture.initialize(&graphics, TEXTURE_FILE));
+    testSimd(graphics, texture);
+    testCapacity(graphics, texture);
+
+    // count particles that live through the timed frames
+    RenderCommandList list;
+    for (int s = 1; s >= 0; s--)
+    {
+        ParticleEmitter e;
+        CHECK(e.initialize(&graphics, 4, 4, 0, &texture, count));
+        e.setSimd(s != 0);
+        e.setLife(1000, 1000);
+        e.setSpeed(10, 50);
+        e.setPosition(320, 240);
+        CHECK(e.emit(count) == count);
+        double update = 1e9, draw = 1e9;
+        for (int f = 0; f < FRAMES; f++)
+        {
+            double t0 = testSeconds();
+            e.update(FRAME_TIME);
+            update = std::min(update, testSeconds() - t0);
+            draw = std::min(draw, drawRecorded(graphics, e, list));
+        }
+        CHECK(e.getCount() == count);
+        UINT sprites = 0;
+        for (UINT i = 0; i < list.getSize(); i++)
+            sprites += list.get(i).type == renderCommandNS::SPRITE;
+        CHECK(sprites + list.getSpritesCulled() == count);
+        printf("%-6s %u particles, %.1f MB: update %.2f ms, draw %.2f ms\n", s ? "SSE2" : "scalar",
+               count, e.getMemory() / 1048576.0, update * 1000, draw * 1000);
+    }
+
+    // the same update with one struct per particle
+    std::vector<StructParticle> p(count);
+    std::vector<COLOR_ARGB> color(count);
+    for (UINT i = 0; i < count; i++)
+    {
+        StructParticle q = {320, 240, (float)(i % 50), 0, 1, 1, 1, 1, 0, 0, 0, -0.001f, 1000};
+        p[i] = q;
+    }
+    double update = 1e9;
+    for (int f = 0; f < FRAMES; f++)
+    {
+        double t0 = testSeconds();
+        UINT n = count;
+        for (UINT i = 0; i < n; i++)
+        {
+            StructParticle &q = p[i];
+            q.x += q.vx * FRAME_TIME;
+            q.y += q.vy * FRAME_TIME;
+            q.r = clamp01(q.r + q.dr * FRAME_TIME);
+            q.g = clamp01(q.g + q.dg * FRAME_TIME);
+            q.b = clamp01(q.b + q.db * FRAME_TIME);
+            q.a = clamp01(q.a + q.da * FRAME_TIME);
+            q.life -= FRAME_TIME;
+            color[i] = ((UINT)(q.a * 255 + 0.5f) << 24) | ((UINT)(q.r * 255 + 0.5f) << 16) |
+                       ((UINT)(q.g * 255 + 0.5f) << 8) | (UINT)(q.b * 255 + 0.5f);
+            if (q.life <= 0)
+                p[i--] = p[--n];
+        }
+        update = std::min(update, testSeconds() - t0);
+    }
+    printf("struct per particle: update %.2f ms\n", update * 1000);
+    remove(TEXTURE_FILE);
+    return testResult();
+}
@@ -0,0 +1,130 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// renderQueueBench.cpp v1.0
+// Times frames drawn directly against frames recorded for the RenderQueue
+// render thread, with a CPU load standing in for update(), ai() and
+// collisions(). The load is set to take as long as drawing, the case where
+// the render thread helps most: a frame takes the longer of the two
+// instead of the sum, near 2x faster with two free cores. With one core
+// there is no speedup to see. Both ways must draw the same picture.
+// Drawing is done by the software Graphics class, so the draw time is a
+// CPU cost and is only a guide to what a device spends.
+// Usage: renderQueueBench [sprites]
+
+#include <math.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "test.h"
+#include "renderQueue.h"
+
+namespace
+{
+    const int WIDTH = 640;
+    const int HEIGHT = 480;
+    const int FRAMES = 30;
+    const int CALIBRATE = 200000;       // simulate() steps timed to set the load
+}
+
+volatile float simulated;               // keeps simulate() from being removed
+
+// CPU work standing in for update(), ai() and collisions().
+static void simulate(int steps, int frame)
+{
+    float sum = 0;
+    for (int k = 0; k < steps; k++)
+        sum += sinf(k*0.001f + frame);
+    simulated = sum;
+}
+
+// Draw count sprites with Graphics calls, recorded or not.
+static void render(Graphics &graphics, LP_TEXTURE texture, int count, int frame)
+{
+    graphics.spriteBegin();
+    for (int i = 0; i < count; i++)
+    {
+        SpriteData sd = {};
+        sd.width = 32;
+        sd.height = 32;
+        sd.rect.right = 32;
+        sd.rect.bottom = 32;
+        sd.scale = 1;
+        sd.x = (float)((i*37 + frame*3) % (WIDTH + 64) - 32);
+        sd.y = (float)((i*53 + frame*2) % (HEIGHT + 64) - 32);
+        sd.angle = (frame + i) * 0.01f;
+        sd.texture = texture;
+        sd.layer = i;
+        if (graphics.inViewport(sd))
+            graphics.drawSprite(sd);
+    }
+    graphics.spriteEnd();
+}
+
+// Run FRAMES frames of count sprites and steps of simulation, on the render
+// thread if threaded. Returns seconds per frame, last = the last frame.
+static double runFrames(bool threaded, int count, int steps, std::vector<COLOR_ARGB> &last)
+{
+    Graphics graphics;
+    graphics.initialize(NULL, WIDTH, HEIGHT, false);
+    graphics.setBatching(true);
+    std::vector<COLOR_ARGB> pixels(32 * 32);
+    for (int i = 0; i < 32 * 32; i++)
+        pixels[i] = SETCOLOR_ARGB(255, i & 0xff, 128, 255 - (i & 0xff));
+    LP_TEXTURE texture;
+    CHECK(SUCCEEDED(graphics.createTexture(&pixels[0], 32, 32, texture)));
+    RenderQueue queue;
+    if (threaded)
+        CHECK(queue.start(&graphics));
+    double t0 = testSeconds();
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+        simulate(steps, frame);
+        if (threaded)
+        {
+            graphics.setRecording(&queue.beginFrame());
+            graphics.setBackColor(graphicsNS::BLACK);
+            render(graphics, texture, count, frame);
+            graphics.setRecording(NULL);
+            queue.endFrame();
+        }
+        else
+        {
+            graphics.setBackColor(graphicsNS::BLACK);
+            graphics.beginScene();
+            render(graphics, texture, count, frame);
+            graphics.endScene();
+            graphics.showBackbuffer();
+        }
+    }
+    queue.stop();
+    double seconds = (testSeconds() - t0) / FRAMES;
+    CHECK(graphics.getFrameCount() == (UINT)FRAMES);
+    last.assign(graphics.getBackbuffer(), graphics.getBackbuffer() + WIDTH * HEIGHT);
+    texture->Release();
+    return seconds;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = testCount(argc, argv, 5000);
+    UINT cores = std::thread::hardware_concurrency();
+
+    // set the simulation to take as long as drawing a frame
+    std::vector<COLOR_ARGB> direct, threaded;
+    double drawTime = runFrames(false, count, 0, direct);
+    double t0 = testSeconds();
+    simulate(CALIBRATE, 0);
+    double stepTime = (testSeconds() - t0) / CALIBRATE;
+    int steps = (int)(drawTime / stepTime);
+
+    double directTime = runFrames(false, count, steps, direct);
+    double threadedTime = runFrames(true, count, steps, threaded);
+    CHECK(direct.size() == threaded.size() &&
+          memcmp(&direct[0], &threaded[0], direct.size() * sizeof(COLOR_ARGB)) == 0);
+    printf("%d sprites, %u cores, draw %.2f ms, simulate %.2f ms\n", count, cores,
+           drawTime * 1e3, steps * stepTime * 1e3);
+    printf("direct %.2f ms/frame, render thread %.2f ms/frame, speedup %.2f\n",
+           directTime * 1e3, threadedTime * 1e3, directTime / threadedTime);
+    return testResult();
+}
@@ -0,0 +1,179 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// renderQueueTest.cpp v1.0
+// Tests RenderQueue with the software Graphics class as the backend.
+// Frames recorded and drawn by the render thread must be the same as frames
+// drawn directly, and a texture released by the game thread must live until
+// the render thread has drawn the last frame that uses it.
+
+#include <math.h>
+#include <vector>
+#include "test.h"
+#include "renderQueue.h"
+
+namespace
+{
+    const int WIDTH = 320;
+    const int HEIGHT = 240;
+    const int SPRITES = 300;
+    const int FRAMES = 60;
+}
+
+volatile float simulated;               // keeps simulate() from being removed
+
+// CPU work standing in for update(), ai() and collisions().
+static void simulate(int frame)
+{
+    float sum = 0;
+    for (int k = 0; k < 100000; k++)
+        sum += sinf(k*0.001f + frame);
+    simulated = sum;
+}
+
+// Draw frame with Graphics calls, recorded or not.
+static void render(Graphics &graphics, LP_TEXTURE *textures, int frame)
+{
+    graphics.spriteBegin();
+    for (int i = 0; i < SPRITES; i++)
+    {
+        SpriteData sd = {};
+        sd.width = 16;
+        sd.height = 16;
+        sd.rect.right = 16;
+        sd.rect.bottom = 16;
+        sd.scale = 1.5f;
+        sd.x = (float)((i*37 + frame*3) % (WIDTH + 40) - 20);
+        sd.y = (float)((i*53 + frame*2) % (HEIGHT + 40) - 20);
+        sd.angle = (frame + i) * 0.05f;
+        sd.texture = textures[i % 2];
+        sd.layer = i;
+        if (graphics.inViewport(sd))
+            graphics.drawSprite(sd);
+    }
+    graphics.spriteEnd();
+}
+
+// Draw FRAMES frames, on the render thread if threaded.
+// Returns the last frame and the seconds taken.
+static double run(bool threaded, std::vector<COLOR_ARGB> &last)
+{
+    Graphics graphics;
+    graphics.initialize(NULL, WIDTH, HEIGHT, false);
+    graphics.setBatching(true);
+    LP_TEXTURE textures[2];
+    for (int t = 0; t < 2; t++)
+    {
+        std::vector<COLOR_ARGB> pixels(16 * 16);
+        for (int i = 0; i < 16 * 16; i++)
+            pixels[i] = SETCOLOR_ARGB(255, i, t * 200, 255 - i);
+        graphics.createTexture(&pixels[0], 16, 16, textures[t]);
+    }
+    RenderQueue queue;
+    if (threaded)
+        CHECK(queue.start(&graphics));
+    double t0 = testSeconds();
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+        simulate(frame);
+        COLOR_ARGB backColor = SETCOLOR_ARGB(255, frame & 0xff, 0, 64);
+        if (threaded)
+        {
+            graphics.setRecording(&queue.beginFrame());
+            graphics.setBackColor(backColor);   // recorded, used when the frame is drawn
+            render(graphics, textures, frame);
+            graphics.setRecording(NULL);
+            queue.endFrame();
+        }
+        else
+        {
+            graphics.setBackColor(backColor);
+            graphics.beginScene();
+            render(graphics, textures, frame);
+            graphics.endScene();
+            graphics.showBackbuffer();
+        }
+    }
+    queue.stop();
+    double seconds = testSeconds() - t0;
+    CHECK(graphics.getFrameCount() == (UINT)FRAMES);
+    if (threaded)
+    {
+        CHECK(queue.getFramesRecorded() == (UINT)FRAMES);
+        CHECK(queue.getFramesDrawn() == (UINT)FRAMES);
+    }
+    CHECK(graphics.getSpritesSubmitted() + graphics.getSpritesCulled() == (UINT)SPRITES);
+    last.assign(graphics.getBackbuffer(), graphics.getBackbuffer() + WIDTH * HEIGHT);
+    for (int t = 0; t < 2; t++)
+        textures[t]->Release();
+    return seconds;
+}
+
+//=============================================================================
+// Recorded frames draw the same picture as direct drawing.
+//=============================================================================
+static void testSamePicture()
+{
+    std::vector<COLOR_ARGB> direct, threaded;
+    double directTime = run(false, direct);
+    double threadedTime = run(true, threaded);
+    int differ = 0;
+    for (size_t i = 0; i < direct.size(); i++)
+        if (direct[i] != threaded[i])
+            differ++;
+    CHECK(differ == 0);
+    printf("%d frames: direct %.2f ms/frame, render thread %.2f ms/frame\n",
+           FRAMES, directTime * 1e3 / FRAMES, threadedTime * 1e3 / FRAMES);
+}
+
+//=============================================================================
+// A texture released after recording lives until its frame is drawn and the
+// list is cleared.
+//=============================================================================
+static void testTextureLifetime()
+{
+    Graphics graphics;
+    graphics.initialize(NULL, 64, 64, false);
+    std::vector<COLOR_ARGB> pixels(16 * 16, graphicsNS::RED);
+    LP_TEXTURE texture;
+    CHECK(SUCCEEDED(graphics.createTexture(&pixels[0], 16, 16, texture)));
+    RenderQueue queue;
+    CHECK(queue.start(&graphics));
+
+    RenderCommandList &list = queue.beginFrame();
+    graphics.setRecording(&list);
+    graphics.setBackColor(graphicsNS::BLACK);
+    graphics.spriteBegin();
+    SpriteData sd = {};
+    sd.width = sd.height = 16;
+    sd.rect.right = sd.rect.bottom = 16;
+    sd.scale = 1;
+    sd.texture = texture;
+    for (int i = 0; i < 3; i++)         // one reference for the run
+        graphics.drawSprite(sd);
+    graphics.spriteEnd();
+    graphics.setRecording(NULL);
+    CHECK(list.getTextureRefs() == 1);
+    CHECK(texture->AddRef() == 3);      // creator, list and this one
+    CHECK(texture->Release() == 2);
+    texture->Release();                 // the game is done with it, the list is not
+    queue.endFrame();
+    queue.finish();
+    CHECK(graphics.getBackbuffer()[0] == graphicsNS::RED);
+
+    // the list is cleared, releasing the texture, when it is used again
+    for (int frame = 0; frame < 2; frame++)
+    {
+        queue.beginFrame();
+        queue.endFrame();
+    }
+    CHECK(list.getTextureRefs() == 0);
+    queue.stop();
+}
+
+int main()
+{
+    testSamePicture();
+    testTextureLifetime();
+    return testResult();
+}
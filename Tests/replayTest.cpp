@@ -0,0 +1,234 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// replayTest.cpp v1.0
+// Records a game run through Game::run() with synthetic key, mouse and
+// controller input, then replays the log in a second game without a window
+// and checks that every frame sees the same frameTime, input and game
+// state, bit for bit. Live input posted while replaying must be ignored.
+// Run with a log file to replay it and time the frames, for comparing
+// two builds of the engine on the same input.
+// Usage: replayTest [frames] [log file]
+
+#include <string.h>
+#include <vector>
+#include "test.h"
+#include "game.h"
+
+namespace
+{
+    const char *LOG_FILE = "replayTest.inp";
+}
+
+// A game whose state depends on everything a frame gets: frameTime, key,
+// mouse and text events and controller state. Its hash is saved after
+// every frame.
+class ReplayGame : public Game
+{
+  private:
+    float   x, y, vx, vy;
+    UINT    hash;                   // of every input seen
+    std::vector<UINT> frameHashes;
+
+    void mix(const void *data, size_t size)
+    {
+        const BYTE *p = (const BYTE*)data;
+        for (size_t i = 0; i < size; i++)
+            hash = (hash ^ p[i]) * 16777619u;
+    }
+
+  public:
+    ReplayGame() : x(0), y(0), vx(0), vy(0), hash(2166136261u) {}
+
+    void update()
+    {
+        mix(&frameTime, sizeof(frameTime));
+        const std::vector<InputEvent> &events = input->getEvents();
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            const InputEvent &e = events[i];
+            UINT fields[4] = {e.type, e.code, (UINT)e.x, (UINT)e.y};    // not the time
+            mix(fields, sizeof(fields));
+        }
+        if (input->isKeyDown('D'))
+            vx += 100 * frameTime;
+        if (input->wasKeyPressed('A'))
+            vx -= 10;
+        vx += input->getMouseRawX() * frameTime;
+        vy += input->getGamepadThumbLY(0) / 32767.0f * frameTime;
+        if (input->getGamepadA(0))
+            vy = -vy;
+        WORD buttons = input->getGamepadButtons(0);
+        BYTE trigger = input->getGamepadRightTrigger(0);
+        mix(&buttons, sizeof(buttons));
+        mix(&trigger, sizeof(trigger));
+        x += vx * frameTime;
+        y += vy * frameTime;
+        mix(input->getTextIn().c_str(), input->getTextIn().size());
+    }
+    void ai()           {}
+    void collisions()   {}
+    void render()
+    {
+        graphics->spriteBegin();
+        graphics->spriteEnd();
+    }
+
+    // Save the state after a frame.
+    void endFrame()
+    {
+        UINT h = hash;
+        float state[4] = {x, y, vx, vy};
+        mix(state, sizeof(state));
+        frameHashes.push_back(hash);
+        hash = h;
+    }
+
+    const std::vector<UINT>& getFrameHashes() const {return frameHashes;}
+};
+
+// Controller 0 state of frame f of the recording.
+static void controllerInput(int f, ControllerInput *c)
+{
+    memset(c, 0, sizeof(ControllerInput) * inputRecorderNS::CONTROLLERS);
+    c[0].connected = f >= 10;       // plugged in at frame 10
+    if (!c[0].connected)
+        return;
+    c[0].packet = f / 3;
+    c[0].buttons = (f / 7) % 2 ? GAMEPAD_A : 0;
+    c[0].rightTrigger = (BYTE)(f * 5);
+    c[0].thumbLY = (SHORT)((f * 997) % 65536 - 32768);
+}
+
+//=============================================================================
+// Run frames frames with synthetic input, save the log and return the
+// seconds taken.
+//=============================================================================
+static double record(ReplayGame &game, int frames, float tickRate)
+{
+    game.initialize(NULL);
+    game.setTickRate(tickRate);
+    Input *input = game.getInput();
+    game.startRecording();
+    double t0 = testSeconds();
+    for (int f = 0; f < frames; f++)
+    {
+        if (f % 5 == 0)
+            input->postEvent(inputNS::KEY_DOWN, 'D');
+        if (f % 5 == 3)
+            input->postEvent(inputNS::KEY_UP, 'D');
+        if (f % 11 == 0)                        // down and up in one frame
+        {
+            input->postEvent(inputNS::KEY_DOWN, 'A');
+            input->postEvent(inputNS::KEY_UP, 'A');
+        }
+        for (int k = 0; k < f % 4; k++)         // several raw packets a frame
+            input->postEvent(inputNS::MOUSE_RAW, 0, f - k * 7, -k);
+        if (f % 13 == 0)
+            input->postEvent(inputNS::CHAR_IN, 'a' + f % 26);
+        ControllerInput controllers[inputRecorderNS::CONTROLLERS];
+        controllerInput(f, controllers);
+        input->setControllerInput(controllers);
+        game.run(NULL);
+        game.endFrame();
+    }
+    double seconds = testSeconds() - t0;
+    CHECK(game.stopRecording(LOG_FILE));
+    return seconds;
+}
+
+//=============================================================================
+// Replay file and return the seconds taken.
+// spoil = true posts live input that must be ignored.
+//=============================================================================
+static double replay(ReplayGame &game, const char *file, float tickRate, bool spoil)
+{
+    game.initialize(NULL);
+    game.setTickRate(tickRate);
+    Input *input = game.getInput();
+    CHECK(game.startReplay(file));
+    InputRecorder *recorder = game.getInputRecorder();
+    ControllerInput live[inputRecorderNS::CONTROLLERS];
+    controllerInput(50, live);
+    live[0].buttons = GAMEPAD_B;
+    double t0 = testSeconds();
+    while (game.getReplaying())
+    {
+        if (spoil)
+        {
+            input->postEvent(inputNS::KEY_DOWN, 'D');
+            input->postEvent(inputNS::MOUSE_RAW, 0, 1000, 1000);
+            input->setControllerInput(live);
+        }
+        UINT frame = recorder->getFrame();
+        game.run(NULL);
+        if (recorder->getFrame() != frame)      // a frame of the log was run
+            game.endFrame();
+    }
+    return testSeconds() - t0;
+}
+
+//=============================================================================
+// A version 1 log, without controllers, replays with none connected.
+//=============================================================================
+static void testVersion1()
+{
+    const BYTE log[] = {'P', '2', 'D', 'I', 1,
+                        0x00, 0x00, 0x80, 0x3f, 1,      // frameTime 1.0, one event
+                        inputNS::KEY_DOWN, 'D', 0, 0, 0,
+                        0x00, 0x00, 0x00, 0x3f, 0};     // frameTime 0.5, no events
+    FILE *f = fopen(LOG_FILE, "wb");
+    CHECK(f != NULL);
+    if (f == NULL)
+        return;
+    fwrite(log, 1, sizeof(log), f);
+    fclose(f);
+    InputRecorder recorder;
+    CHECK(recorder.load(LOG_FILE));
+    CHECK(recorder.getFrameCount() == 2);
+    float frameTime;
+    std::vector<InputEvent> events;
+    ControllerInput controllers[inputRecorderNS::CONTROLLERS];
+    memset(controllers, 0xff, sizeof(controllers));
+    CHECK(recorder.replayFrame(frameTime, events, controllers, 0));
+    CHECK(frameTime == 1.0f && events.size() == 1 && events[0].code == 'D');
+    CHECK(!controllers[0].connected && controllers[0].buttons == 0);
+    CHECK(recorder.replayFrame(frameTime, events, controllers, 0));
+    CHECK(frameTime == 0.5f && events.empty());
+    CHECK(!recorder.replayFrame(frameTime, events, controllers, 0));
+    CHECK(!recorder.getReplaying());
+}
+
+int main(int argc, char *argv[])
+{
+    int frames = testCount(argc, argv, 200);
+    if (argc > 2)                               // time a log
+    {
+        ReplayGame game;
+        double seconds = replay(game, argv[2], 0, false);
+        UINT n = (UINT)game.getFrameHashes().size();
+        printf("%s: %u frames in %.3f s, %.3f ms/frame, last state %08x\n", argv[2], n,
+               seconds, n ? seconds * 1000 / n : 0.0, n ? game.getFrameHashes()[n - 1] : 0);
+        return testResult();
+    }
+
+    float tickRates[2] = {0, 60};               // variable and fixed time step
+    for (int t = 0; t < 2; t++)
+    {
+        ReplayGame recorded, replayed, spoiled;
+        double recordSeconds = record(recorded, frames, tickRates[t]);
+        UINT logSize = (UINT)recorded.getInputRecorder()->getLog().size();
+        double seconds = replay(replayed, LOG_FILE, tickRates[t], false);
+        replay(spoiled, LOG_FILE, tickRates[t], true);
+        CHECK(replayed.getFrameHashes().size() == (size_t)frames);
+        CHECK(replayed.getFrameHashes() == recorded.getFrameHashes());
+        CHECK(spoiled.getFrameHashes() == recorded.getFrameHashes());
+        CHECK(replayed.getTick() == recorded.getTick());
+        printf("%s: %d frames, %u byte log, recorded %.2f s, replayed in %.3f s\n",
+               tickRates[t] ? "fixed time step" : "variable time step", frames, logSize,
+               recordSeconds, seconds);
+    }
+    testVersion1();
+    remove(LOG_FILE);
+    return testResult();
+}
@@ -0,0 +1,269 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// softGraphicsTest.cpp v1.0
+// Tests the software Graphics class against reference images: sprites
+// drawn with scale, rotation, flips, a rect of the texture and a color
+// filter are compared pixel by pixel with the image computed here from
+// the Direct3D sprite transform, D3DXMatrixTransformation2D with the
+// scale, rotation center and translation Graphics::drawSprite gives it.
+// A few pixels are also checked by hand, and saveBackbuffer() is read back.
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include "test.h"
+#include "graphics.h"
+
+namespace
+{
+    const char *SAVE_FILE = "softGraphicsTest.tga";
+    const int TEX = 8;                  // texture size
+    const int WIDTH = 64;               // backbuffer size
+    const int HEIGHT = 48;
+    const double EDGE = 0.01;           // texels, samples this close to a texel edge are not compared
+}
+
+// Texel x,y, every texel a different opaque color.
+static COLOR_ARGB texel(int x, int y)
+{
+    return SETCOLOR_ARGB(255, 20 + x*30, 20 + y*30, 200 - x*10 - y*10);
+}
+
+// Return a*b/255 rounded.
+static UINT mul(UINT a, UINT b)
+{
+    return (UINT)floor(a*b/255.0 + 0.5);
+}
+
+//=============================================================================
+// Return the color of the backbuffer pixel with its center at px,py after
+// sd is drawn with filter over back. edge is set if the pixel center is
+// too close to a texel edge to tell which texel the rasterizer samples.
+// The sprite transform is the one of Graphics::drawSprite in the book:
+//   screen = R(angle) * (S * local - center) + center + translate
+// with S, center and translate changed by the flips.
+//=============================================================================
+static COLOR_ARGB reference(const SpriteData &sd, COLOR_ARGB filter, double px, double py,
+                            COLOR_ARGB back, bool &edge)
+{
+    double scale = sd.scale;
+    double sx = scale, sy = scale;
+    double cx = (double)(float)(sd.width/2*scale), cy = (double)(float)(sd.height/2*scale);
+    double tx = sd.x, ty = sd.y;
+    if (sd.flipHorizontal)
+    {
+        sx = -sx;
+        cx -= sd.width*scale;
+        tx += sd.width*scale;
+    }
+    if (sd.flipVertical)
+    {
+        sy = -sy;
+        cy -= sd.height*scale;
+        ty += sd.height*scale;
+    }
+    double c = cos((double)sd.angle), s = sin((double)sd.angle);
+    double dx = px - cx - tx, dy = py - cy - ty;
+    double u = (dx*c + dy*s + cx) / sx;         // rotate back, unscale
+    double v = (-dx*s + dy*c + cy) / sy;
+    int srcWidth = sd.rect.right - sd.rect.left;
+    int srcHeight = sd.rect.bottom - sd.rect.top;
+    edge = (fabs(u - floor(u + 0.5)) < EDGE || fabs(v - floor(v + 0.5)) < EDGE) &&
+           u > -1 && v > -1 && u < srcWidth + 1 && v < srcHeight + 1;
+    if (u < 0 || v < 0 || u >= srcWidth || v >= srcHeight)
+        return back;
+    COLOR_ARGB t = texel(sd.rect.left + (int)floor(u), sd.rect.top + (int)floor(v));
+    UINT fa = filter >> 24;                     // filter premultiplied by its alpha
+    UINT fr = mul((filter >> 16) & 0xff, fa), fg = mul((filter >> 8) & 0xff, fa), fb = mul(filter & 0xff, fa);
+    UINT a = mul(t >> 24, fa);
+    UINT r = mul((t >> 16) & 0xff, fr), g = mul((t >> 8) & 0xff, fg), b = mul(t & 0xff, fb);
+    if (a == 0)
+        return back;
+    r += mul((back >> 16) & 0xff, 255 - a);     // premultiplied over
+    g += mul((back >> 8) & 0xff, 255 - a);
+    b += mul(back & 0xff, 255 - a);
+    return SETCOLOR_ARGB(255, r, g, b);
+}
+
+// Draw sd in a new frame.
+static void draw(Graphics &graphics, const SpriteData &sd, COLOR_ARGB filter)
+{
+    graphics.beginScene();
+    graphics.spriteBegin();
+    graphics.drawSprite(sd, filter);
+    graphics.spriteEnd();
+    graphics.endScene();
+}
+
+// Return the backbuffer pixel x,y.
+static COLOR_ARGB pixel(Graphics &graphics, int x, int y)
+{
+    return graphics.getBackbuffer()[y*WIDTH + x];
+}
+
+//=============================================================================
+// Draw sd and compare the backbuffer with the reference image.
+// Returns the number of pixels of the sprite compared.
+//=============================================================================
+static int compare(Graphics &graphics, const SpriteData &sd, COLOR_ARGB filter, const char *name)
+{
+    const COLOR_ARGB back = graphicsNS::BACK_COLOR;
+    draw(graphics, sd, filter);
+    int differ = 0, compared = 0, skipped = 0;
+    for (int y = 0; y < HEIGHT; y++)
+        for (int x = 0; x < WIDTH; x++)
+        {
+            bool edge;
+            COLOR_ARGB want = reference(sd, filter, x + 0.5, y + 0.5, back, edge);
+            if (edge)
+            {
+                skipped++;
+                continue;
+            }
+            if (want != back)
+                compared++;
+            if (pixel(graphics, x, y) != want)
+            {
+                if (differ < 4)
+                    printf("%s: pixel %d,%d is %08x, expected %08x\n", name, x, y,
+                           pixel(graphics, x, y), want);
+                differ++;
+            }
+        }
+    CHECK(differ == 0);
+    CHECK(skipped < compared / 10);
+    return compared;
+}
+
+int main()
+{
+    Graphics graphics;
+    graphics.initialize(NULL, WIDTH, HEIGHT, false);
+    graphics.setMipmaps(false);
+    std::vector<COLOR_ARGB> pixels(TEX*TEX);
+    for (int y = 0; y < TEX; y++)
+        for (int x = 0; x < TEX; x++)
+            pixels[y*TEX + x] = texel(x, y);
+    LP_TEXTURE texture = NULL;
+    CHECK(SUCCEEDED(graphics.createTexture(&pixels[0], TEX, TEX, texture)));
+
+    SpriteData sd;
+    sd.width = TEX;
+    sd.height = TEX;
+    sd.x = 10;
+    sd.y = 20;
+    sd.scale = 1;
+    sd.angle = 0;
+    sd.rect.left = 0;
+    sd.rect.top = 0;
+    sd.rect.right = TEX;
+    sd.rect.bottom = TEX;
+    sd.texture = texture;
+    sd.flipHorizontal = false;
+    sd.flipVertical = false;
+    sd.layer = 0;
+    const COLOR_ARGB WHITE = graphicsNS::WHITE;
+
+    // by hand: one pixel per texel, then 2x2 pixels per texel
+    draw(graphics, sd, WHITE);
+    CHECK(pixel(graphics, 10, 20) == texel(0, 0));
+    CHECK(pixel(graphics, 17, 27) == texel(7, 7));
+    CHECK(pixel(graphics, 13, 21) == texel(3, 1));
+    CHECK(pixel(graphics, 9, 20) == graphicsNS::BACK_COLOR);
+    CHECK(pixel(graphics, 18, 27) == graphicsNS::BACK_COLOR);
+    sd.scale = 2;
+    draw(graphics, sd, WHITE);
+    CHECK(pixel(graphics, 10, 20) == texel(0, 0) && pixel(graphics, 11, 21) == texel(0, 0));
+    CHECK(pixel(graphics, 12, 21) == texel(1, 0));
+    CHECK(pixel(graphics, 25, 35) == texel(7, 7) && pixel(graphics, 26, 36) == graphicsNS::BACK_COLOR);
+    // flipped, the left column shows the right of the texture
+    sd.flipHorizontal = true;
+    draw(graphics, sd, WHITE);
+    CHECK(pixel(graphics, 10, 20) == texel(7, 0));
+    CHECK(pixel(graphics, 25, 35) == texel(0, 7));
+    sd.flipHorizontal = false;
+    sd.flipVertical = true;
+    draw(graphics, sd, WHITE);
+    CHECK(pixel(graphics, 10, 20) == texel(0, 7));
+    sd.flipVertical = false;
+    // a quarter turn clockwise about the center, the bottom left corner
+    // goes to the top left
+    sd.angle = (float)(PI / 2);
+    draw(graphics, sd, WHITE);
+    CHECK(pixel(graphics, 10, 20) == texel(0, 7));
+    CHECK(pixel(graphics, 25, 20) == texel(0, 0));
+    CHECK(pixel(graphics, 25, 35) == texel(7, 0));
+    sd.angle = 0;
+    // a rect of the texture
+    sd.rect.left = 2;
+    sd.rect.top = 3;
+    sd.rect.right = 6;
+    sd.rect.bottom = 7;
+    sd.width = 4;
+    sd.height = 4;
+    draw(graphics, sd, WHITE);
+    CHECK(pixel(graphics, 10, 20) == texel(2, 3));
+    CHECK(pixel(graphics, 17, 27) == texel(5, 6));
+    CHECK(pixel(graphics, 18, 28) == graphicsNS::BACK_COLOR);
+    // color filter
+    draw(graphics, sd, SETCOLOR_ARGB(255, 255, 0, 128));
+    COLOR_ARGB t = texel(2, 3);
+    CHECK(pixel(graphics, 10, 20) == SETCOLOR_ARGB(255, (t >> 16) & 0xff, 0, mul(t & 0xff, 128)));
+
+    // every pixel against the reference image
+    struct Case
+    {
+        const char *name;
+        float scale, angle;
+        bool flipH, flipV;
+        int left, top, right, bottom;
+        COLOR_ARGB filter;
+    } cases[] = {
+        {"plain",          1,     0,    false, false, 0, 0, 8, 8, WHITE},
+        {"scale",          3,     0,    false, false, 0, 0, 8, 8, WHITE},
+        {"fraction scale", 1.6f,  0,    false, false, 0, 0, 8, 8, WHITE},
+        {"rotate",         2,     0.6f, false, false, 0, 0, 8, 8, WHITE},
+        {"rotate back",    1.5f, -2.2f, false, false, 0, 0, 8, 8, WHITE},
+        {"flip h",         2,     0,    true,  false, 0, 0, 8, 8, WHITE},
+        {"flip v",         2,     0,    false, true,  0, 0, 8, 8, WHITE},
+        {"flip both",      2,     0,    true,  true,  0, 0, 8, 8, WHITE},
+        {"flip rotate",    2.5f,  1.0f, true,  false, 0, 0, 8, 8, WHITE},
+        {"rect",           3,     0,    false, false, 2, 3, 6, 7, WHITE},
+        {"rect flip",      3,     0.3f, false, true,  1, 0, 6, 4, WHITE},
+        {"filter",         2,     0.4f, false, false, 0, 0, 8, 8, SETCOLOR_ARGB(255, 128, 200, 64)},
+        {"half alpha",     2,     0,    true,  false, 0, 0, 8, 8, SETCOLOR_ARGB(128, 255, 255, 255)},
+        {"off edge",       4,     0.8f, false, false, 0, 0, 8, 8, WHITE},
+    };
+    for (UINT n = 0; n < sizeof(cases) / sizeof(cases[0]); n++)
+    {
+        const Case &c = cases[n];
+        sd.scale = c.scale;
+        sd.angle = c.angle;
+        sd.flipHorizontal = c.flipH;
+        sd.flipVertical = c.flipV;
+        sd.rect.left = c.left;
+        sd.rect.top = c.top;
+        sd.rect.right = c.right;
+        sd.rect.bottom = c.bottom;
+        sd.width = c.right - c.left;
+        sd.height = c.bottom - c.top;
+        sd.x = n == sizeof(cases) / sizeof(cases[0]) - 1 ? 40.0f : 12.0f;
+        sd.y = 9;
+        int compared = compare(graphics, sd, c.filter, c.name);
+        CHECK(compared > 0);
+    }
+
+    // the saved backbuffer reads back the same
+    CHECK(graphics.saveBackbuffer(SAVE_FILE));
+    UINT w = 0, h = 0;
+    std::vector<COLOR_ARGB> saved;
+    CHECK(SUCCEEDED(graphics.loadTextureData(SAVE_FILE, 0, w, h, saved)));
+    CHECK(w == (UINT)WIDTH && h == (UINT)HEIGHT);
+    if (saved.size() == (size_t)WIDTH*HEIGHT)
+        CHECK(memcmp(&saved[0], graphics.getBackbuffer(), saved.size()*sizeof(COLOR_ARGB)) == 0);
+
+    SAFE_RELEASE(texture);
+    remove(SAVE_FILE);
+    return testResult();
+}
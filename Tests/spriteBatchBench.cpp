@@ -0,0 +1,100 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// spriteBatchBench.cpp v1.0
+// Times SpriteBatch against drawing sprites one at a time in the order
+// they arrive, with a backend that only counts texture switches, so the
+// time is the CPU cost of the batch and not of a device.
+// Usage: spriteBatchBench [sprites]
+
+#include <vector>
+#include "test.h"
+#include "spriteBatch.h"
+#include "graphics.h"
+
+namespace
+{
+    const int TEXTURES = 8;
+    const int LAYERS = 3;
+    const int FRAMES = 20;
+}
+
+// Backend that counts texture switches and sprites.
+class NullBackend : public SpriteBatchBackend
+{
+  public:
+    UINT switches, sprites;
+    float sum;                          // keeps the transforms used
+    NullBackend() : switches(0), sprites(0), sum(0) {}
+    void setBatchTexture(LP_TEXTURE) {switches++;}
+    void submitSprite(const SpriteData &, COLOR_ARGB, const Affine2D &transform)
+    {
+        sprites++;
+        sum += transform.dx;
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    int count = testCount(argc, argv, 100000);
+    std::vector<SoftTexture*> textures;
+    for (int t = 0; t < TEXTURES; t++)
+        textures.push_back(new SoftTexture(1, 1));
+    std::vector<SpriteData> sprites(count);
+    srand(1);
+    for (int i = 0; i < count; i++)
+    {
+        SpriteData &sd = sprites[i];
+        sd = SpriteData();
+        sd.width = 32;
+        sd.height = 32;
+        sd.x = (float)(rand() % 1280);
+        sd.y = (float)(rand() % 720);
+        sd.scale = 1;
+        sd.angle = (rand() % 628) / 100.0f;
+        sd.texture = textures[rand() % TEXTURES];
+        sd.layer = rand() % LAYERS;
+    }
+
+    // one at a time in arrival order, what drawSprite() does unbatched
+    NullBackend direct;
+    double t0 = testSeconds();
+    for (int f = 0; f < FRAMES; f++)
+    {
+        LP_TEXTURE last = NULL;
+        for (int i = 0; i < count; i++)
+        {
+            if (sprites[i].texture != last)
+                direct.setBatchTexture(last = sprites[i].texture);
+            Affine2D transform;
+            Transform2D::spriteAffine(sprites[i], transform);
+            direct.submitSprite(sprites[i], graphicsNS::WHITE, transform);
+        }
+    }
+    double directTime = testSeconds() - t0;
+
+    SpriteBatch batch;
+    NullBackend batched;
+    t0 = testSeconds();
+    for (int f = 0; f < FRAMES; f++)
+    {
+        batch.resetStats();
+        for (int i = 0; i < count; i++)
+            batch.add(sprites[i], graphicsNS::WHITE);
+        batch.flush(batched);
+    }
+    double batchTime = testSeconds() - t0;
+
+    CHECK(batched.sprites == direct.sprites);
+    CHECK(batch.getSpritesDrawn() == (UINT)count);
+    CHECK(batch.getTextureSwitches() <= (UINT)(TEXTURES * LAYERS));
+    CHECK(batch.getSwitchesSaved() == (int)(direct.switches / FRAMES - batch.getTextureSwitches()));
+    printf("%d sprites, %d textures, %d layers\n", count, TEXTURES, LAYERS);
+    printf("unbatched: %.1f ns/sprite, %u texture switches a frame\n",
+           directTime * 1e9 / FRAMES / count, direct.switches / FRAMES);
+    printf("batched:   %.1f ns/sprite, %u texture switches a frame (%d saved)\n",
+           batchTime * 1e9 / FRAMES / count, batch.getTextureSwitches(), batch.getSwitchesSaved());
+    for (int t = 0; t < TEXTURES; t++)
+        textures[t]->Release();
+    return testResult();
+}
@@ -0,0 +1,200 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// spriteBatchTest.cpp v1.0
+// Tests SpriteBatch with a backend that records what it is given, and
+// checks batched and unbatched drawing by Graphics make the same picture.
+
+#include <math.h>
+#include <vector>
+#include "test.h"
+#include "spriteBatch.h"
+#include "graphics.h"
+
+// Backend that records the texture runs and sprites it is given.
+class RecordingBackend : public SpriteBatchBackend
+{
+  public:
+    std::vector<LP_TEXTURE> runs;       // texture of each setBatchTexture()
+    std::vector<SpriteData> sprites;    // sprites in submit order
+    std::vector<Affine2D>   transforms;
+
+    void setBatchTexture(LP_TEXTURE texture)
+    {
+        runs.push_back(texture);
+    }
+    void submitSprite(const SpriteData &spriteData, COLOR_ARGB, const Affine2D &transform)
+    {
+        CHECK(!runs.empty() && runs.back() == spriteData.texture);
+        sprites.push_back(spriteData);
+        transforms.push_back(transform);
+    }
+};
+
+// Backend that takes the texture from spriteData, setBatchTexture() is not
+// overridden.
+class CountingBackend : public SpriteBatchBackend
+{
+  public:
+    UINT count;
+    CountingBackend() : count(0) {}
+    void submitSprite(const SpriteData &, COLOR_ARGB, const Affine2D &) {count++;}
+};
+
+static SpriteData makeSprite(LP_TEXTURE texture, int layer, float x)
+{
+    SpriteData sd = {};
+    sd.width = 16;
+    sd.height = 8;
+    sd.x = x;
+    sd.y = x * 0.5f;
+    sd.scale = 1.5f;
+    sd.angle = x * 0.01f;
+    sd.texture = texture;
+    sd.layer = layer;
+    sd.rect.right = 16;
+    sd.rect.bottom = 8;
+    return sd;
+}
+
+//=============================================================================
+// Sprites are sorted by layer, then texture, and keep their order within a
+// texture. Switches are counted against the order they were added in.
+//=============================================================================
+static void testSort()
+{
+    LP_TEXTURE a = new SoftTexture(1, 1);
+    LP_TEXTURE b = new SoftTexture(1, 1);
+    SpriteBatch batch;
+    RecordingBackend backend;
+    for (int i = 0; i < 10; i++)        // a b a b ... on layer 0
+        batch.add(makeSprite(i % 2 ? a : b, 0, (float)i), graphicsNS::WHITE);
+    batch.add(makeSprite(a, -1, 100), graphicsNS::WHITE);
+    batch.add(makeSprite(NULL, 0, 200), graphicsNS::WHITE);    // not drawn
+    CHECK(batch.getSize() == 11);
+
+    CHECK(batch.flush(backend) == 11);
+    CHECK(batch.getSize() == 0);
+    CHECK(backend.sprites.size() == 11);
+    CHECK(backend.sprites[0].layer == -1);
+    // layer 0 is two runs, the texture with the lower address first, and
+    // a run that goes on from layer -1 does not set the texture again
+    LP_TEXTURE first = a < b ? a : b;
+    UINT runs = first == a ? 2 : 3;
+    CHECK(backend.runs.size() == runs);
+    CHECK(backend.runs[0] == a && backend.runs[runs - 2] == first);
+    float lastX = -1;
+    for (size_t i = 1; i < backend.sprites.size(); i++)
+    {
+        const SpriteData &sd = backend.sprites[i];
+        CHECK(sd.layer == 0);
+        if (i > 1 && sd.texture == backend.sprites[i-1].texture)
+            CHECK(sd.x > lastX);        // stable
+        lastX = sd.x;
+    }
+    CHECK(batch.getTextureSwitches() == runs);
+    CHECK(batch.getSwitchesSaved() == 10 - (int)runs);  // b a b a ... a unsorted
+    CHECK(batch.getSpritesDrawn() == 11);
+
+    batch.resetStats();
+    CHECK(batch.getTextureSwitches() == 0 && batch.getSpritesDrawn() == 0);
+    CHECK(batch.flush(backend) == 0);   // empty
+    a->Release();
+    b->Release();
+}
+
+//=============================================================================
+// Each transform is the one Graphics computes for a single sprite.
+//=============================================================================
+static void testTransforms()
+{
+    LP_TEXTURE a = new SoftTexture(1, 1);
+    SpriteBatch batch;
+    RecordingBackend backend;
+    for (int i = 0; i < 37; i++)        // not a multiple of the SIMD width
+    {
+        SpriteData sd = makeSprite(a, i % 3, (float)(i * 7));
+        sd.flipHorizontal = (i & 1) != 0;
+        sd.flipVertical = (i & 2) != 0;
+        batch.add(sd, graphicsNS::WHITE);
+    }
+    batch.flush(backend);
+    for (size_t i = 0; i < backend.sprites.size(); i++)
+    {
+        Affine2D expected;
+        Transform2D::spriteAffine(backend.sprites[i], expected);
+        const float *p = &expected.m11;
+        const float *q = &backend.transforms[i].m11;
+        for (int j = 0; j < 6; j++)
+            CHECK(fabs(p[j] - q[j]) <= 1e-4f * (1 + fabs(p[j])));
+    }
+    a->Release();
+}
+
+//=============================================================================
+// A backend without setBatchTexture() gets every sprite.
+//=============================================================================
+static void testDefaultBackend()
+{
+    LP_TEXTURE a = new SoftTexture(1, 1);
+    LP_TEXTURE b = new SoftTexture(1, 1);
+    SpriteBatch batch;
+    CountingBackend backend;
+    for (int i = 0; i < 5; i++)
+        batch.add(makeSprite(i & 1 ? a : b, 0, (float)i), graphicsNS::WHITE);
+    CHECK(batch.flush(backend) == 5);
+    CHECK(backend.count == 5);
+    a->Release();
+    b->Release();
+}
+
+//=============================================================================
+// Draw the same sprites batched and unbatched, layers keep the overlaps in
+// the same order, so the pictures are the same.
+//=============================================================================
+static void drawScene(Graphics &graphics, LP_TEXTURE *textures)
+{
+    graphics.beginScene();
+    graphics.spriteBegin();
+    for (int i = 0; i < 200; i++)
+    {
+        SpriteData sd = makeSprite(textures[i % 3], i, (float)(i * 3 % 150));
+        graphics.drawSprite(sd, graphicsNS::WHITE);
+    }
+    graphics.spriteEnd();
+    graphics.endScene();
+}
+
+static void testGraphics()
+{
+    Graphics graphics;
+    graphics.initialize(NULL, 160, 120, false);
+    LP_TEXTURE textures[3];
+    for (int t = 0; t < 3; t++)
+    {
+        std::vector<COLOR_ARGB> pixels(16 * 8, SETCOLOR_ARGB(255, 80 * t, 255 - 80 * t, 40));
+        CHECK(SUCCEEDED(graphics.createTexture(&pixels[0], 16, 8, textures[t])));
+    }
+    graphics.setBatching(false);
+    drawScene(graphics, textures);
+    std::vector<COLOR_ARGB> unbatched(graphics.getBackbuffer(), graphics.getBackbuffer() + 160 * 120);
+    graphics.setBatching(true);
+    drawScene(graphics, textures);
+    CHECK(graphics.getSpriteBatch().getSpritesDrawn() == 200);
+    int differ = 0;
+    for (int i = 0; i < 160 * 120; i++)
+        if (graphics.getBackbuffer()[i] != unbatched[i])
+            differ++;
+    CHECK(differ == 0);
+    for (int t = 0; t < 3; t++)
+        textures[t]->Release();
+}
+
+int main()
+{
+    testSort();
+    testTransforms();
+    testDefaultBackend();
+    testGraphics();
+    return testResult();
+}
@@ -0,0 +1,75 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// test.h v1.0
+// Checks and timing used by the engine tests and benchmarks.
+// A test is a program that returns 0 when every CHECK passed. A failed
+// CHECK prints the file, line and condition and the test goes on, so one
+// run shows every failure.
+// A benchmark takes the number of objects as its first argument, times
+// the engine against a simple reference, and CHECKs they agree. ctest runs
+// it with a small count so the comparison is tested on every build.
+
+#ifndef _TEST_H                 // Prevent multiple definitions if this 
+#define _TEST_H                 // file is included in more than one place
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+static int testFailures = 0;    // failed CHECKs
+
+// Count and print a failure if cond is false.
+#define CHECK(cond) \
+    do { if (!(cond)) { \
+        printf("%s(%d): CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        testFailures++; } } while (0)
+
+// Return the exit code of the test, 0 if every CHECK passed.
+inline int testResult()
+{
+    if (testFailures)
+        printf("%d checks failed\n", testFailures);
+    return testFailures ? 1 : 0;
+}
+
+// Return the first argument as a count, or def if there is none.
+inline int testCount(int argc, char *argv[], int def)
+{
+    int n = argc > 1 ? atoi(argv[1]) : 0;
+    return n > 0 ? n : def;
+}
+
+// Write a w x h 32 bit uncompressed .tga file from ARGB pixels, top row
+// first. Returns false on error.
+inline bool testWriteTga(const char *file, int w, int h, const unsigned int *pixels)
+{
+    FILE *f = fopen(file, "wb");
+    if (f == NULL)
+        return false;
+    unsigned char header[18] = {0};
+    header[2] = 2;                      // uncompressed true color
+    header[12] = (unsigned char)w;
+    header[13] = (unsigned char)(w >> 8);
+    header[14] = (unsigned char)h;
+    header[15] = (unsigned char)(h >> 8);
+    header[16] = 32;
+    header[17] = 0x28;                  // 8 alpha bits, top row first
+    bool ok = fwrite(header, 1, 18, f) == 18;
+    for (int i = 0; i < w*h && ok; i++)
+    {
+        unsigned char bgra[4] = {(unsigned char)pixels[i], (unsigned char)(pixels[i] >> 8),
+                                 (unsigned char)(pixels[i] >> 16), (unsigned char)(pixels[i] >> 24)};
+        ok = fwrite(bgra, 1, 4, f) == 4;
+    }
+    return fclose(f) == 0 && ok;
+}
+
+// Return seconds since some fixed time.
+inline double testSeconds()
+{
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif
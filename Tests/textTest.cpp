@@ -0,0 +1,239 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// textTest.cpp v1.0
+// Tests Text: proportional widths measured from the font pixels, the
+// sprites print() draws, layouts looked up instead of made again,
+// layouts made again after setSpacing(), setProportional() or a new font,
+// unused layouts removed after MAX_LAYOUTS, and tabs with any spacing.
+
+#include <math.h>
+#include <string>
+#include <vector>
+#include "test.h"
+#include "text.h"
+#include "renderCommand.h"
+
+using namespace textNS;
+
+namespace
+{
+    const char *FONT_FILE = "textTest.tga";
+    const char *BIG_FILE = "textTestBig.tga";
+    const int CELL = 8;                 // character cell size
+    const int COLS = 16;                // cells in a row of the font
+    const int SPACE = CELL / 2;         // width of an empty cell
+    const int CHARS = MAX_CHAR - MIN_CHAR + 1;
+}
+
+// A font image of cell x cell characters, cols in a row
+struct Font
+{
+    int cell;
+    int cols;
+    std::vector<unsigned int> pixels;
+
+    Font(int c, int n) : cell(c), cols(n), pixels(c * n * c * ((CHARS + n - 1) / n), 0) {}
+
+    // Fill columns left to right of the cell of ch.
+    void fill(char ch, int left, int right)
+    {
+        int n = (BYTE)ch - MIN_CHAR;
+        for (int row = 0; row < cell; row++)
+            for (int col = left; col <= right; col++)
+                pixels[((n / cols) * cell + row) * cols * cell + (n % cols) * cell + col] = 0xffffffff;
+    }
+
+    bool write(const char *file)
+    {
+        return testWriteTga(file, cols * cell, (int)pixels.size() / (cols * cell), &pixels[0]);
+    }
+};
+
+// Return the sprites drawn by print(str, x, y).
+static std::vector<RenderCommand> printed(Graphics &graphics, Text &text, const std::string &str,
+                                          float x, float y)
+{
+    RenderCommandList list;
+    graphics.setRecording(&list);
+    graphics.spriteBegin();
+    text.print(str, x, y);
+    graphics.spriteEnd();
+    graphics.setRecording(NULL);
+    std::vector<RenderCommand> sprites;
+    for (UINT i = 0; i < list.getSize(); i++)
+        if (list.get(i).type == renderCommandNS::SPRITE)
+            sprites.push_back(list.get(i));
+    return sprites;
+}
+
+//=============================================================================
+// Widths come from the columns of each character that have pixels.
+//=============================================================================
+static void testMeasure(Graphics &graphics, TextureManager &font)
+{
+    Text text;
+    CHECK(text.initialize(&graphics, CELL, CELL, COLS, &font));
+    CHECK(text.getProportional());
+    int gap = PROPORTIONAL_SPACING;
+    CHECK(text.getWidth("A") == 5);
+    CHECK(text.getWidth("AA") == 5 + gap + 5);
+    CHECK(text.getWidth("iA") == 1 + gap + 5);
+    CHECK(text.getWidth("W") == CELL);
+    CHECK(text.getWidth("A A") == 5 + gap + SPACE + gap + 5);
+    CHECK(text.getWidth("") == 0 && text.getHeight("") == 0);
+    CHECK(text.getHeight("A") == CELL);
+    CHECK(text.getHeight("A\nA\n") == 3 * CELL);
+    CHECK(text.getWidth("AAA\nA") == 3 * 5 + 2 * gap);
+    CHECK(text.getWidth("A\tA") == (SPACE + gap) * TAB_SIZE + 5);
+    CHECK(text.getWidth("AAAAAA\tA") == 2 * (SPACE + gap) * TAB_SIZE + 5);
+    text.setScale(2);
+    CHECK(text.getWidth("AA") == 2 * (5 + gap + 5));
+
+    text.setProportional(false);
+    text.setScale(1);
+    CHECK(text.getWidth("iA") == 2 * CELL);
+    CHECK(text.getWidth("A\tA") == CELL * TAB_SIZE + CELL);
+
+    // the sprites drawn, spaces are not drawn
+    text.setProportional(true);
+    std::vector<RenderCommand> s = printed(graphics, text, "A i", 10, 20);
+    CHECK(s.size() == 2);
+    if (s.size() == 2)
+    {
+        int a = 'A' - MIN_CHAR;
+        CHECK(s[0].spriteData.x == 10 && s[0].spriteData.y == 20);
+        CHECK(s[0].spriteData.width == 5 && s[0].spriteData.height == CELL);
+        CHECK(s[0].spriteData.rect.left == (a % COLS) * CELL + 1);
+        CHECK(s[0].spriteData.rect.right == (a % COLS) * CELL + 6);
+        CHECK(s[0].spriteData.rect.top == (a / COLS) * CELL);
+        CHECK(s[0].spriteData.rect.bottom == (a / COLS) * CELL + CELL);
+        CHECK(s[0].color == text.getFontColor());
+        int i = 'i' - MIN_CHAR;
+        CHECK(s[1].spriteData.x == 10 + 5 + gap + SPACE + gap);
+        CHECK(s[1].spriteData.width == 1);
+        CHECK(s[1].spriteData.rect.left == (i % COLS) * CELL + 3);
+    }
+}
+
+//=============================================================================
+// Layouts are looked up, and made again only when they change.
+//=============================================================================
+static void testCache(Graphics &graphics, TextureManager &font, TextureManager &otherFont)
+{
+    Text text;
+    CHECK(text.initialize(&graphics, CELL, CELL, COLS, &font));
+    for (int f = 0; f < 100; f++)
+    {
+        printed(graphics, text, "Score 100", 0, 0);
+        printed(graphics, text, "FPS 60", 0, 20);
+    }
+    CHECK(text.getLayoutsBuilt() == 2);
+    CHECK(text.getLayoutCount() == 2);
+    float width = text.getWidth("Score 100");
+    CHECK(text.getLayoutsBuilt() == 2);
+
+    text.setSpacing(0);
+    CHECK(text.getLayoutCount() == 0);
+    CHECK(text.getWidth("AA") == 10);
+    CHECK(text.getWidth("Score 100") < width);
+    CHECK(text.getLayoutsBuilt() == 4);
+
+    text.setProportional(false);
+    CHECK(text.getWidth("AA") == 2 * CELL);
+    CHECK(text.getLayoutsBuilt() == 5);
+
+    // a new font, with cells twice as large, is measured again
+    CHECK(text.initialize(&graphics, 2 * CELL, 2 * CELL, COLS / 2, &otherFont));
+    CHECK(text.getLayoutCount() == 0);
+    CHECK(text.getLayoutsBuilt() == 0);
+    text.setProportional(true);
+    CHECK(text.getWidth("AA") == 10 + 10);
+    CHECK(text.getHeight("AA") == 2 * CELL);
+    CHECK(text.getLayoutsBuilt() == 1);
+}
+
+//=============================================================================
+// At MAX_LAYOUTS the layouts not used since the last removal are removed.
+//=============================================================================
+static void testTrim(Graphics &graphics, TextureManager &font)
+{
+    Text text;
+    CHECK(text.initialize(&graphics, CELL, CELL, COLS, &font));
+    for (UINT n = 0; n < MAX_LAYOUTS; n++)
+        text.getWidth(std::to_string(n));
+    CHECK(text.getLayoutCount() == MAX_LAYOUTS);
+    text.getWidth("new 1");             // starts a new generation
+    CHECK(text.getLayoutCount() == MAX_LAYOUTS + 1);
+    text.getWidth("5");                 // used in the new generation
+    text.getWidth("new 2");             // removes the others
+    CHECK(text.getLayoutCount() == 3);
+    UINT built = text.getLayoutsBuilt();
+    text.getWidth("5");
+    text.getWidth("new 1");
+    CHECK(text.getLayoutsBuilt() == built);
+    text.getWidth("6");
+    CHECK(text.getLayoutsBuilt() == built + 1);
+
+    // printed every frame with a new string each frame, the count stays
+    // bounded and the repeated string is never made again
+    for (UINT f = 0; f < 5 * MAX_LAYOUTS; f++)
+    {
+        text.getWidth("FPS");
+        text.getWidth("frame " + std::to_string(f));
+        CHECK(text.getLayoutCount() <= MAX_LAYOUTS + 1);
+    }
+    built = text.getLayoutsBuilt();
+    text.getWidth("FPS");
+    CHECK(text.getLayoutsBuilt() == built);
+}
+
+//=============================================================================
+// Tabs lay out with any spacing, also one that leaves spaces no width.
+//=============================================================================
+static void testSpacing(Graphics &graphics, TextureManager &font)
+{
+    Text text;
+    CHECK(text.initialize(&graphics, CELL, CELL, COLS, &font));
+    for (int s = 4; s >= -3 * CELL; s--)
+    {
+        text.setSpacing(s);
+        float w = text.getWidth("A\tA\t\tA");
+        CHECK(w == w && fabsf(w) < 1000);   // not NaN
+        CHECK(printed(graphics, text, "A\tA\t\tA", 0, 0).size() == 3);
+    }
+    text.setSpacing(-SPACE);            // a space is 0 wide
+    CHECK(text.getWidth("A A") == 5 - SPACE + 0 + 5);
+}
+
+int main()
+{
+    Font small(CELL, COLS);
+    small.fill('A', 1, 5);
+    small.fill('i', 3, 3);
+    small.fill('W', 0, CELL - 1);
+    for (char c = '0'; c <= '9'; c++)
+        small.fill(c, 1, 4);
+    for (char c = 'a'; c <= 'z'; c++)
+        if (c != 'i')
+            small.fill(c, 1, 4);
+    CHECK(small.write(FONT_FILE));
+    Font big(2 * CELL, COLS / 2);
+    big.fill('A', 2, 11);
+    CHECK(big.write(BIG_FILE));
+
+    Graphics graphics;
+    graphics.initialize(NULL, 640, 480, false);
+    TextureManager font, bigFont;
+    CHECK(font.initialize(&graphics, FONT_FILE));
+    CHECK(bigFont.initialize(&graphics, BIG_FILE));
+
+    testMeasure(graphics, font);
+    testCache(graphics, font, bigFont);
+    testTrim(graphics, font);
+    testSpacing(graphics, font);
+
+    remove(FONT_FILE);
+    remove(BIG_FILE);
+    return testResult();
+}
@@ -0,0 +1,239 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// textureAtlasTest.cpp v1.0
+// Tests AtlasPacker placement, determinism and occupancy, and TextureAtlas
+// pages: every image is copied to its rect with transparent padding on all
+// four sides, the same images give the same pages, and pages are no larger
+// than the largest texture of the device.
+
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "test.h"
+#include "textureAtlas.h"
+#include "textureManager.h"
+
+namespace
+{
+    const UINT PAGE = 256;
+    const int RECTS = 400;
+    const int IMAGES = 24;
+    const UINT PAD = 2;
+}
+
+static std::string fileName(int n)
+{
+    char name[64];
+    sprintf(name, "textureAtlasTest%d.tga", n);
+    return name;
+}
+
+// Size and color of test image n
+static UINT imageWidth(int n)           {return 3 + (n * 37) % 61;}
+static UINT imageHeight(int n)          {return 2 + (n * 23) % 47;}
+static COLOR_ARGB imageColor(int n)     {return SETCOLOR_ARGB(255, 10 + n * 9, 255 - n * 9, 100);}
+
+// Return true if rects a and b overlap.
+static bool overlap(const AtlasRect &a, const AtlasRect &b)
+{
+    return a.page == b.page && a.x < b.x + b.width && b.x < a.x + a.width &&
+           a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+// Pack RECTS random rects, the same ones every call.
+static void pack(AtlasPacker &packer, std::vector<AtlasRect> &rects)
+{
+    srand(7);
+    packer.reset(PAGE, PAGE);
+    rects.resize(RECTS);
+    for (int n = 0; n < RECTS; n++)
+    {
+        UINT w = 1 + rand() % 64, h = 1 + rand() % 64;
+        CHECK(packer.insert(w, h, rects[n]));
+        CHECK(rects[n].width == w && rects[n].height == h);
+    }
+}
+
+//=============================================================================
+// Packer placement, determinism and occupancy
+//=============================================================================
+static void testPacker()
+{
+    AtlasPacker packer;
+    AtlasRect r;
+    packer.reset(PAGE, PAGE);
+    CHECK(!packer.insert(0, 10, r) && !packer.insert(10, 0, r));
+    CHECK(packer.getPageCount() == 0);
+
+    // a row of equal rects left to right, then the next row above it
+    for (UINT n = 0; n < 4; n++)
+    {
+        CHECK(packer.insert(PAGE / 4, 32, r));
+        CHECK(r.page == 0 && r.x == n * PAGE / 4 && r.y == 0);
+    }
+    CHECK(packer.insert(PAGE / 4, 32, r) && r.x == 0 && r.y == 32);
+    // the lowest place wins, not the first
+    CHECK(packer.insert(PAGE / 2, 8, r) && r.x == PAGE / 4 && r.y == 32);
+    // a rect larger than the page starts a page of its own size
+    CHECK(packer.insert(PAGE + 10, 16, r) && r.page == 1 && r.x == 0 && r.y == 0);
+    CHECK(packer.getPageWidth(1) == PAGE + 10 && packer.getPageHeight(1) == PAGE);
+    CHECK(packer.insert(PAGE, PAGE, r) && r.page == 2);
+    CHECK(packer.getOccupancy(2) == 1.0f);
+
+    // random rects stay in their page, do not overlap and pack the same
+    // way every time
+    std::vector<AtlasRect> rects, again;
+    pack(packer, rects);
+    UINT64 area = 0;
+    for (int n = 0; n < RECTS; n++)
+    {
+        const AtlasRect &a = rects[n];
+        CHECK(a.page < packer.getPageCount());
+        CHECK(a.x + a.width <= PAGE && a.y + a.height <= PAGE);
+        for (int m = 0; m < n; m++)
+            CHECK(!overlap(a, rects[m]));
+        area += a.width * a.height;
+    }
+    UINT pages = packer.getPageCount();
+    float covered = 0;
+    for (UINT pg = 0; pg < pages; pg++)
+        covered += packer.getOccupancy(pg) * PAGE * PAGE;
+    CHECK(covered > area - 1.0f && covered < area + 1.0f);
+    // every page but the last is well filled, unsorted rects included
+    for (UINT pg = 0; pg + 1 < pages; pg++)
+        CHECK(packer.getOccupancy(pg) > 0.6f);
+    printf("%d rects in %u pages, occupancy", RECTS, pages);
+    for (UINT pg = 0; pg < pages; pg++)
+        printf(" %.2f", packer.getOccupancy(pg));
+    printf("\n");
+
+    AtlasPacker other;
+    pack(other, again);
+    CHECK(other.getPageCount() == pages);
+    for (int n = 0; n < RECTS; n++)
+        CHECK(again[n].page == rects[n].page && again[n].x == rects[n].x && again[n].y == rects[n].y);
+}
+
+//=============================================================================
+// Build an atlas of the test images, return false on error.
+//=============================================================================
+static bool buildAtlas(Graphics &graphics, TextureAtlas &atlas, TextureManager *textures,
+                       UINT pageSize, UINT padding)
+{
+    if (!atlas.initialize(&graphics, pageSize, pageSize, padding))
+        return false;
+    for (int n = 0; n < IMAGES; n++)
+        if (!textures[n].initialize(&graphics, fileName(n).c_str(), &atlas))
+            return false;
+    return atlas.build();
+}
+
+//=============================================================================
+// Atlas pages hold the images with padding on all four sides.
+//=============================================================================
+static void testAtlas(Graphics &graphics)
+{
+    TextureAtlas atlas;
+    TextureManager textures[IMAGES];
+    CHECK(buildAtlas(graphics, atlas, textures, PAGE, PAD));
+    CHECK(atlas.getImageCount() == (UINT)IMAGES);
+    CHECK(atlas.getPageCount() >= 1);
+    CHECK(atlas.getMaxLevels() == 3);               // floor(log2(2*PAD))+1
+    for (int n = 0; n < IMAGES; n++)
+    {
+        const TextureManager &t = textures[n];
+        LP_TEXTURE page = t.getTexture();
+        CHECK(page != NULL && t.getAtlas() == &atlas);
+        if (page == NULL)
+            continue;
+        CHECK(page->levels == atlas.getMaxLevels());
+        UINT x0 = t.getOffsetX(), y0 = t.getOffsetY();
+        UINT w = t.getWidth(), h = t.getHeight();
+        CHECK(w == imageWidth(n) && h == imageHeight(n));
+        // the padding is inside the page, also at the left and top edges
+        CHECK(x0 >= PAD && y0 >= PAD);
+        CHECK(x0 + w + PAD <= page->width && y0 + h + PAD <= page->height);
+        if (x0 < PAD || y0 < PAD || x0 + w + PAD > page->width || y0 + h + PAD > page->height)
+            continue;
+        int wrong = 0, bleed = 0;
+        for (UINT y = y0 - PAD; y < y0 + h + PAD; y++)
+            for (UINT x = x0 - PAD; x < x0 + w + PAD; x++)
+            {
+                COLOR_ARGB c = page->pixels[y * page->width + x];
+                bool inside = x >= x0 && x < x0 + w && y >= y0 && y < y0 + h;
+                if (inside && c != imageColor(n))
+                    wrong++;
+                if (!inside && c != 0)
+                    bleed++;
+            }
+        CHECK(wrong == 0 && bleed == 0);
+    }
+
+    // the same images give the same pages
+    TextureAtlas atlas2;
+    TextureManager textures2[IMAGES];
+    CHECK(buildAtlas(graphics, atlas2, textures2, PAGE, PAD));
+    CHECK(atlas2.getPageCount() == atlas.getPageCount());
+    for (int n = 0; n < IMAGES; n++)
+        CHECK(textures2[n].getOffsetX() == textures[n].getOffsetX() &&
+              textures2[n].getOffsetY() == textures[n].getOffsetY() &&
+              (textures2[n].getTexture() == atlas2.getPage(0)) ==
+              (textures[n].getTexture() == atlas.getPage(0)));
+    for (UINT pg = 0; pg < atlas.getPageCount(); pg++)
+        CHECK(atlas.getPage(pg)->pixels == atlas2.getPage(pg)->pixels);
+}
+
+//=============================================================================
+// Pages are no larger than the largest texture of the device.
+//=============================================================================
+static void testMaxSize(Graphics &graphics)
+{
+    const UINT MAX = 128;
+    graphics.setMaxTextureSize(MAX);
+    std::vector<COLOR_ARGB> pixels((MAX + 1) * (MAX + 1), 0);
+    LP_TEXTURE texture = NULL;
+    CHECK(FAILED(graphics.createTexture(&pixels[0], MAX + 1, MAX, texture)));
+    CHECK(SUCCEEDED(graphics.createTexture(&pixels[0], MAX, MAX, texture)));
+    SAFE_RELEASE(texture);
+
+    TextureAtlas atlas;
+    TextureManager textures[IMAGES];
+    CHECK(buildAtlas(graphics, atlas, textures, 4 * MAX, 1));
+    CHECK(atlas.getPageWidth() == MAX && atlas.getPageHeight() == MAX);
+    CHECK(atlas.getPageCount() > 1);
+    for (UINT pg = 0; pg < atlas.getPageCount(); pg++)
+        CHECK(atlas.getPage(pg) && atlas.getPage(pg)->width <= MAX && atlas.getPage(pg)->height <= MAX);
+
+    // an image that does not fit in a page with its padding is refused
+    CHECK(testWriteTga("textureAtlasTestWide.tga", MAX - 1, 4, (unsigned int*)&pixels[0]));
+    CHECK(testWriteTga("textureAtlasTestFits.tga", MAX - 2, 4, (unsigned int*)&pixels[0]));
+    TextureAtlas small;
+    CHECK(small.initialize(&graphics, MAX, MAX, 1));
+    TextureManager wide, fits;
+    CHECK(!wide.initialize(&graphics, "textureAtlasTestWide.tga", &small));
+    CHECK(fits.initialize(&graphics, "textureAtlasTestFits.tga", &small));
+    CHECK(small.build() && small.getPageCount() == 1);
+    remove("textureAtlasTestWide.tga");
+    remove("textureAtlasTestFits.tga");
+    graphics.setMaxTextureSize(graphicsNS::MAX_TEXTURE_SIZE);
+}
+
+int main()
+{
+    for (int n = 0; n < IMAGES; n++)
+    {
+        std::vector<unsigned int> pixels(imageWidth(n) * imageHeight(n), imageColor(n));
+        CHECK(testWriteTga(fileName(n).c_str(), imageWidth(n), imageHeight(n), &pixels[0]));
+    }
+    Graphics graphics;
+    graphics.initialize(NULL, 640, 480, false);
+
+    testPacker();
+    testAtlas(graphics);
+    testMaxSize(graphics);
+
+    for (int n = 0; n < IMAGES; n++)
+        remove(fileName(n).c_str());
+    return testResult();
+}
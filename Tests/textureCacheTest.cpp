@@ -0,0 +1,191 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// textureCacheTest.cpp v1.0
+// Tests TextureCache hits, misses, invalidation and the least recently
+// used removal, and that a TextureManager with a cache is reset from the
+// cached pixels, loaded directly, by a TextureLoader or by a TextureRegistry
+// the way Game uses it.
+
+#include <vector>
+#include "test.h"
+#include "textureCache.h"
+#include "textureLoader.h"
+#include "textureRegistry.h"
+
+namespace
+{
+    const char *FILE_A = "textureCacheTestA.tga";
+    const char *FILE_B = "textureCacheTestB.tga";
+    const UINT SIZE = 8;
+    const size_t BYTES = SIZE * SIZE * sizeof(COLOR_ARGB);     // of one image
+    const COLOR_ARGB OLD_COLOR = SETCOLOR_ARGB(255, 200, 0, 0);
+    const COLOR_ARGB NEW_COLOR = SETCOLOR_ARGB(255, 0, 200, 0);
+}
+
+static bool writeFile(const char *file, COLOR_ARGB c)
+{
+    std::vector<unsigned int> pixels(SIZE * SIZE, c);
+    return testWriteTga(file, SIZE, SIZE, &pixels[0]);
+}
+
+// Return the first pixel of the texture of tm, 0 if it has none.
+static COLOR_ARGB firstPixel(const TextureManager &tm)
+{
+    LP_TEXTURE t = tm.getTexture();
+    return t ? t->pixels[0] : 0;
+}
+
+// Lose and reset the device of tm.
+static void reset(TextureManager &tm)
+{
+    tm.onLostDevice();
+    CHECK(tm.getTexture() == NULL);
+    tm.onResetDevice();
+}
+
+//=============================================================================
+// find() and add() without a device
+//=============================================================================
+static void testCache()
+{
+    TextureCache cache(3 * BYTES);
+    UINT w = 0, h = 0;
+    const COLOR_ARGB *p = NULL;
+    CHECK(!cache.find(FILE_A, TRANSCOLOR, w, h, p));
+    CHECK(cache.getMisses() == 1 && cache.getHits() == 0);
+
+    std::vector<COLOR_ARGB> pixels(SIZE * SIZE, OLD_COLOR);
+    cache.add(FILE_A, TRANSCOLOR, SIZE, SIZE, pixels);
+    CHECK(pixels.empty());                          // moved into the cache
+    CHECK(cache.getCount() == 1 && cache.getBytes() == BYTES);
+    CHECK(cache.find(FILE_A, TRANSCOLOR, w, h, p));
+    CHECK(w == SIZE && h == SIZE && p[0] == OLD_COLOR && p[SIZE * SIZE - 1] == OLD_COLOR);
+    CHECK(cache.getHits() == 1);
+    CHECK(!cache.find(FILE_A, graphicsNS::BLACK, w, h, p));     // other color key
+    CHECK(!cache.find(NULL, TRANSCOLOR, w, h, p));
+
+    // adding again replaces the image
+    pixels.assign(SIZE * SIZE, NEW_COLOR);
+    cache.add(FILE_A, TRANSCOLOR, SIZE, SIZE, pixels);
+    CHECK(cache.getCount() == 1 && cache.getBytes() == BYTES);
+    CHECK(cache.find(FILE_A, TRANSCOLOR, w, h, p) && p[0] == NEW_COLOR);
+
+    // invalidation
+    cache.remove(FILE_A);
+    CHECK(cache.getCount() == 0 && cache.getBytes() == 0);
+    CHECK(!cache.find(FILE_A, TRANSCOLOR, w, h, p));
+    cache.remove(FILE_A);                           // not there, ignored
+
+    // the least recently used image is removed to stay in budget
+    const char *names[] = {"a", "b", "c", "d"};
+    for (int n = 0; n < 3; n++)
+    {
+        pixels.assign(SIZE * SIZE, (COLOR_ARGB)n);
+        cache.add(names[n], TRANSCOLOR, SIZE, SIZE, pixels);
+    }
+    CHECK(cache.getCount() == 3 && cache.getEvictions() == 0);
+    CHECK(cache.find("a", TRANSCOLOR, w, h, p));    // b is now the oldest
+    pixels.assign(SIZE * SIZE, 3);
+    cache.add("d", TRANSCOLOR, SIZE, SIZE, pixels);
+    CHECK(cache.getCount() == 3 && cache.getEvictions() == 1);
+    CHECK(!cache.find("b", TRANSCOLOR, w, h, p));
+    CHECK(cache.find("a", TRANSCOLOR, w, h, p) && p[0] == 0);
+    CHECK(cache.find("c", TRANSCOLOR, w, h, p) && p[0] == 2);
+    CHECK(cache.find("d", TRANSCOLOR, w, h, p) && p[0] == 3);
+    CHECK(cache.getBytes() <= cache.getBudget());
+
+    // an image over the budget is not kept, a smaller budget removes images
+    pixels.assign(4 * SIZE * SIZE, 0);
+    cache.add("big", TRANSCOLOR, 2 * SIZE, 2 * SIZE, pixels);
+    CHECK(!cache.find("big", TRANSCOLOR, w, h, p));
+    cache.setBudget(BYTES);
+    CHECK(cache.getCount() == 1 && cache.getBytes() == BYTES);
+    CHECK(cache.find("d", TRANSCOLOR, w, h, p));    // the last one used is kept
+    cache.clear();
+    CHECK(cache.getCount() == 0 && cache.getBytes() == 0);
+}
+
+//=============================================================================
+// A TextureManager loaded from the file is reset from the cache. The file is
+// changed after the load, the reset still shows the cached pixels until the
+// image is removed from the cache.
+//=============================================================================
+static void testReset(Graphics &graphics)
+{
+    CHECK(writeFile(FILE_A, OLD_COLOR));
+    TextureCache cache;
+    TextureManager tm;
+    tm.setCache(&cache);
+    CHECK(tm.initialize(&graphics, FILE_A));
+    CHECK(cache.getCount() == 1 && cache.getMisses() == 1);
+    CHECK(firstPixel(tm) == OLD_COLOR);
+
+    CHECK(writeFile(FILE_A, NEW_COLOR));
+    reset(tm);
+    CHECK(tm.getResetFromCache() && cache.getHits() == 1);
+    CHECK(firstPixel(tm) == OLD_COLOR);
+    CHECK(tm.getWidth() == SIZE && tm.getHeight() == SIZE);
+
+    cache.remove(FILE_A);
+    reset(tm);
+    CHECK(!tm.getResetFromCache());
+    CHECK(firstPixel(tm) == NEW_COLOR);
+    CHECK(cache.getCount() == 0);   // a reset miss does not add, see TextureManager::load()
+
+    // without a cache the file is read every time
+    TextureManager plain;
+    CHECK(plain.initialize(&graphics, FILE_A));
+    reset(plain);
+    CHECK(!plain.getResetFromCache() && firstPixel(plain) == NEW_COLOR);
+}
+
+//=============================================================================
+// A texture loaded by a TextureLoader, and one acquired from a
+// TextureRegistry set up like the one of Game, keep their pixels in the cache.
+//=============================================================================
+static void testLoader(Graphics &graphics)
+{
+    CHECK(writeFile(FILE_A, OLD_COLOR));
+    CHECK(writeFile(FILE_B, OLD_COLOR));
+    TextureCache cache;
+    TextureLoader loader;
+    CHECK(loader.initialize(&graphics, 1));
+    TextureManager tm;
+    tm.setCache(&cache);
+    CHECK(tm.initialize(&graphics, FILE_A, &loader));
+    loader.finish();
+    CHECK(!tm.isLoading() && firstPixel(tm) == OLD_COLOR);
+    CHECK(cache.getCount() == 1 && cache.getBytes() == BYTES);
+    CHECK(writeFile(FILE_A, NEW_COLOR));
+    reset(tm);
+    CHECK(tm.getResetFromCache() && firstPixel(tm) == OLD_COLOR);
+
+    TextureResidency residency;
+    residency.setTextureLoader(&loader);
+    TextureRegistry registry;
+    registry.initialize(&graphics, &loader, &residency, &cache);
+    TextureManager *t = registry.acquire(FILE_B);
+    CHECK(t != NULL);
+    loader.finish();
+    CHECK(cache.getCount() == 2);
+    CHECK(writeFile(FILE_B, NEW_COLOR));
+    registry.onLostDevice();
+    registry.onResetDevice();
+    CHECK(t->getResetFromCache() && firstPixel(*t) == OLD_COLOR);
+    registry.release(t);
+}
+
+int main()
+{
+    Graphics graphics;
+    graphics.initialize(NULL, 640, 480, false);
+
+    testCache();
+    testReset(graphics);
+    testLoader(graphics);
+
+    remove(FILE_A);
+    remove(FILE_B);
+    return testResult();
+}
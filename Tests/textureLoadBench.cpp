@@ -0,0 +1,113 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// textureLoadBench.cpp v1.0
+// Times loading textures from .tga files, decoded with the color key and
+// premultiplied at load, against loading the same textures cooked by
+// ImageFile::writeCooked, the format AssetTool cook writes.
+// Usage: textureLoadBench [textures]
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include "test.h"
+#include "graphics.h"
+
+namespace
+{
+    const UINT SIZE = 512;              // width and height of each texture
+    const int REPEAT = 5;               // best of
+}
+
+static std::string fileName(int n, const char *extension)
+{
+    char name[64];
+    sprintf(name, "textureLoadBench%d.%s", n, extension);
+    return name;
+}
+
+// Return the best seconds to load count files with ImageFile::load.
+static double timeImageFile(int count, const char *extension, std::vector<COLOR_ARGB> *first)
+{
+    double best = 1e9;
+    std::vector<COLOR_ARGB> pixels;
+    for (int r = 0; r < REPEAT; r++)
+    {
+        double t0 = testSeconds();
+        for (int n = 0; n < count; n++)
+        {
+            UINT w, h;
+            CHECK(ImageFile::load(fileName(n, extension).c_str(), TRANSCOLOR, w, h, pixels));
+            if (n == 0 && first)
+                *first = pixels;
+        }
+        double t = testSeconds() - t0;
+        if (t < best)
+            best = t;
+    }
+    return best;
+}
+
+// Return the best seconds to load count files with Graphics::loadTexture.
+static double timeGraphics(Graphics &graphics, int count, const char *extension)
+{
+    double best = 1e9;
+    std::vector<LP_TEXTURE> textures(count);
+    for (int r = 0; r < REPEAT; r++)
+    {
+        double t0 = testSeconds();
+        for (int n = 0; n < count; n++)
+        {
+            UINT w, h;
+            CHECK(SUCCEEDED(graphics.loadTexture(fileName(n, extension).c_str(), TRANSCOLOR,
+                                                 w, h, textures[n])));
+        }
+        double t = testSeconds() - t0;
+        if (t < best)
+            best = t;
+        for (int n = 0; n < count; n++)
+            SAFE_RELEASE(textures[n]);
+    }
+    return best;
+}
+
+int main(int argc, char *argv[])
+{
+    int count = testCount(argc, argv, 16);
+    std::vector<unsigned int> image(SIZE * SIZE);
+    for (int n = 0; n < count; n++)
+    {
+        srand(n);
+        for (UINT i = 0; i < SIZE * SIZE; i++)  // a quarter magenta, the color key
+            image[i] = rand() % 4 ? 0xff000000 | (rand() << 8) | rand() % 256 : TRANSCOLOR;
+        CHECK(testWriteTga(fileName(n, "tga").c_str(), SIZE, SIZE, &image[0]));
+        UINT w, h;
+        std::vector<COLOR_ARGB> pixels;
+        CHECK(ImageFile::load(fileName(n, "tga").c_str(), TRANSCOLOR, w, h, pixels));
+        CHECK(ImageFile::writeCooked(fileName(n, "tex").c_str(), w, h, pixels, NULL));
+    }
+    double mb = count * SIZE * SIZE * 4 / 1048576.0;
+
+    std::vector<COLOR_ARGB> decoded, cooked;
+    double decodeTime = timeImageFile(count, "tga", &decoded);
+    double cookedTime = timeImageFile(count, "tex", &cooked);
+    CHECK(decoded == cooked);
+
+    Graphics graphics;
+    graphics.initialize(NULL, 64, 64, false);
+    graphics.setMipmaps(false);
+    double decodeTexture = timeGraphics(graphics, count, "tga");
+    double cookedTexture = timeGraphics(graphics, count, "tex");
+
+    printf("%d textures %ux%u, %.1f MB of pixels\n", count, SIZE, SIZE, mb);
+    printf("ImageFile::load        .tga %6.2f ms/MB, cooked %6.2f ms/MB, %.1fx\n",
+           decodeTime * 1e3 / mb, cookedTime * 1e3 / mb, decodeTime / cookedTime);
+    printf("Graphics::loadTexture  .tga %6.2f ms/MB, cooked %6.2f ms/MB, %.1fx\n",
+           decodeTexture * 1e3 / mb, cookedTexture * 1e3 / mb, decodeTexture / cookedTexture);
+    for (int n = 0; n < count; n++)
+    {
+        remove(fileName(n, "tga").c_str());
+        remove(fileName(n, "tex").c_str());
+    }
+    return testResult();
+}
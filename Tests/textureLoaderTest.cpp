@@ -0,0 +1,226 @@
+// Programming 2D Games
+// Copyright (c) 2011 by:
+// Charles Kelly
+// textureLoaderTest.cpp v1.0
+// Tests TextureLoader on the software backend: files load in priority
+// order, a cancelled file is never loaded, an Image draws its placeholder
+// until its texture is loaded, and a TextureManager is ready only after
+// update() has uploaded it. getEvicted() may be read on another thread
+// while the texture is evicted and loaded again.
+// The one worker thread is held on a named pipe while the files are
+// queued, so the order the worker takes them in does not depend on when
+// it starts.
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "test.h"
+#include "textureLoader.h"
+#include "textureManager.h"
+#include "image.h"
+#include "renderCommand.h"
+
+namespace
+{
+    const char *GATE_FILE = "textureLoaderTestGate";    // named pipe holding the worker
+    const char *PLACEHOLDER_FILE = "textureLoaderTestPlaceholder.tga";
+    const int FILES = 6;
+    const int PRIORITY[FILES] = {0, 5, 0, 5, 10, -1};
+    const int CANCELLED = 2;            // cancelled, so never loaded
+    const int ORDER[FILES - 1] = {4, 1, 3, 0, 5};       // order the others load in
+    const double TIMEOUT = 10;          // seconds
+}
+
+static std::string fileName(int n)
+{
+    char name[64];
+    sprintf(name, "textureLoaderTest%d.tga", n);
+    return name;
+}
+
+// Write a w x h .tga of color c.
+static bool writeFile(const char *file, int w, int h, COLOR_ARGB c)
+{
+    std::vector<unsigned int> pixels(w * h, c);
+    return testWriteTga(file, w, h, &pixels[0]);
+}
+
+// Return the sprites drawn by image.draw().
+static std::vector<RenderCommand> drawn(Graphics &graphics, Image &image)
+{
+    RenderCommandList list;
+    graphics.setRecording(&list);
+    graphics.spriteBegin();
+    image.draw();
+    graphics.spriteEnd();
+    graphics.setRecording(NULL);
+    std::vector<RenderCommand> sprites;
+    for (UINT i = 0; i < list.getSize(); i++)
+        if (list.get(i).type == renderCommandNS::SPRITE)
+            sprites.push_back(list.get(i));
+    return sprites;
+}
+
+int main()
+{
+    // file n is 4+n pixels wide, to tell the textures apart
+    for (int n = 0; n < FILES; n++)
+        CHECK(writeFile(fileName(n).c_str(), 4 + n, 8, SETCOLOR_ARGB(255, 40 * n, 0, 0)));
+    CHECK(writeFile(PLACEHOLDER_FILE, 2, 2, graphicsNS::WHITE));
+    remove(GATE_FILE);
+    CHECK(mkfifo(GATE_FILE, 0600) == 0);
+
+    Graphics graphics;
+    graphics.initialize(NULL, 640, 480, false);
+    TextureManager placeholder;
+    CHECK(placeholder.initialize(&graphics, PLACEHOLDER_FILE));
+
+    TextureLoader loader;
+    TextureManager notStarted;
+    CHECK(!notStarted.initialize(&graphics, fileName(0).c_str(), &loader));
+    CHECK(!notStarted.isLoading());
+    CHECK(loader.initialize(&graphics, 1));
+    CHECK(!loader.initialize(&graphics, 1));
+
+    // the worker takes the gate first, at any priority it is the only file
+    // or the highest, and waits in fopen() until the pipe is opened below
+    TextureManager gate;
+    CHECK(gate.initialize(&graphics, GATE_FILE, &loader, 100));
+    TextureManager textures[FILES];
+    for (int n = 0; n < FILES; n++)
+        CHECK(textures[n].initialize(&graphics, fileName(n).c_str(), &loader, PRIORITY[n]));
+    TextureManager *deleted = new TextureManager;
+    CHECK(deleted->initialize(&graphics, fileName(0).c_str(), &loader, 50));
+    CHECK(loader.getPending() == FILES + 2);
+
+    // cancel a pending file, and delete a TextureManager before it is loaded
+    loader.cancel(&textures[CANCELLED]);
+    delete deleted;
+    CHECK(loader.getPending() == FILES);
+
+    // an Image of a loading texture draws the placeholder at its own size
+    Image image;
+    CHECK(image.initialize(&graphics, 32, 16, 1, &textures[0]));
+    image.setPlaceholder(&placeholder);
+    image.setX(100);
+    image.setY(50);
+    CHECK(textures[0].isLoading() && textures[0].getTexture() == NULL);
+    CHECK(textures[0].getWidth() == 0);
+    std::vector<RenderCommand> s = drawn(graphics, image);
+    CHECK(s.size() == 1);
+    if (s.size() == 1)
+    {
+        CHECK(s[0].spriteData.texture == placeholder.getTexture());
+        CHECK(s[0].spriteData.width == 2 && s[0].spriteData.height == 2);
+        CHECK(s[0].spriteData.x == 100 && s[0].spriteData.y == 50);
+    }
+    image.setPlaceholder(NULL);
+    CHECK(drawn(graphics, image).empty());
+    image.setPlaceholder(&placeholder);
+
+    // nothing is ready before update()
+    loader.update();
+    CHECK(loader.getLoaded() == 0);
+    for (int n = 0; n < FILES; n++)
+        CHECK(textures[n].isLoading());
+
+    // open the gate, the pipe has no size so the gate file fails
+    int fd = open(GATE_FILE, O_WRONLY);
+    CHECK(fd >= 0);
+    close(fd);
+
+    // update(0) uploads one texture per call, in the order decoded
+    int ready = 0;
+    double start = testSeconds();
+    while (ready < FILES - 1 && testSeconds() - start < TIMEOUT)
+    {
+        UINT before = loader.getLoaded();
+        loader.update(0);
+        CHECK(loader.getLoaded() <= before + 1);
+        int count = 0;
+        for (int n = 0; n < FILES; n++)
+            if (!textures[n].isLoading())
+                count++;
+        for (int i = 0; i < count; i++)     // the first count of ORDER are the ones ready
+            CHECK(!textures[ORDER[i]].isLoading());
+        ready = count;
+        if (ready < FILES - 1)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(ready == FILES - 1);
+    CHECK(loader.getLoaded() == FILES - 1);
+    CHECK(loader.getFailed() == 1);
+    CHECK(gate.getLoadFailed());
+    CHECK(loader.getPending() == 0);
+
+    // loaded textures have their size and texture, the cancelled one is
+    // never loaded
+    for (int n = 0; n < FILES; n++)
+    {
+        if (n == CANCELLED)
+        {
+            CHECK(textures[n].isLoading() && textures[n].getTexture() == NULL);
+            continue;
+        }
+        CHECK(!textures[n].getLoadFailed());
+        CHECK(textures[n].getTexture() != NULL);
+        CHECK(textures[n].getWidth() == (UINT)(4 + n) && textures[n].getHeight() == 8);
+    }
+
+    // the Image now draws its texture at the size asked for
+    s = drawn(graphics, image);
+    CHECK(s.size() == 1);
+    if (s.size() == 1)
+    {
+        CHECK(s[0].spriteData.texture == textures[0].getTexture());
+        CHECK(s[0].spriteData.width == 32 && s[0].spriteData.height == 16);
+    }
+
+    // finish() waits for the files to be decoded
+    TextureManager last, missing;
+    CHECK(last.initialize(&graphics, fileName(1).c_str(), &loader));
+    CHECK(missing.initialize(&graphics, "textureLoaderTestMissing.tga", &loader));
+    loader.finish();
+    CHECK(!last.isLoading() && last.getWidth() == 5);
+    CHECK(missing.getLoadFailed() && missing.getTexture() == NULL);
+    CHECK(loader.getLoaded() == FILES);
+
+    // the game thread reads getEvicted() while the device thread evicts
+    // the texture and the loader sets it loaded again
+    std::atomic<bool> polling(true);
+    std::thread reader([&]() {
+        while (polling.load())
+            last.getEvicted();
+    });
+    std::vector<COLOR_ARGB> pixels(5 * 8, graphicsNS::RED);
+    for (int i = 0; i < 1000; i++)
+    {
+        last.evict();
+        CHECK(last.getEvicted() && last.getTexture() == NULL);
+        LP_TEXTURE t = NULL;
+        CHECK(SUCCEEDED(graphics.createTexture(&pixels[0], 5, 8, t)));
+        SpriteSheet sheet;
+        last.setLoaded(t, 5, 8, sheet);
+    }
+    polling.store(false);
+    reader.join();
+    CHECK(!last.getEvicted() && last.getTexture() != NULL);
+
+    // files queued when the loader stops fail
+    TextureManager stopped;
+    CHECK(stopped.initialize(&graphics, fileName(1).c_str(), &loader));
+    loader.stop();
+    CHECK(stopped.getLoadFailed() || !stopped.isLoading());
+    CHECK(!loader.load(&stopped, fileName(1).c_str(), TRANSCOLOR, 0));
+
+    for (int n = 0; n < FILES; n++)
+        remove(fileName(n).c_str());
+    remove(PLACEHOLDER_FILE);
+    remove(GATE_FILE);
+    return testResult();
+}
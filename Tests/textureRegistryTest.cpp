@@ -0,0 +1,116 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// textureRegistryTest.cpp v1.0
+// Tests TextureRegistry sharing and release, and that a texture released
+// by the game thread is still drawn by the render thread in the frames
+// recorded before the release.
+
+#include <vector>
+#include "test.h"
+#include "textureRegistry.h"
+#include "renderQueue.h"
+
+namespace
+{
+    const int FILES = 200;
+    const UINT SIZE = 16;
+}
+
+static const char* fileName(int n)
+{
+    static char name[64];
+    sprintf(name, "textureRegistryTest%d.tga", n);
+    return name;
+}
+
+//=============================================================================
+// Users of one file share a TextureManager, it is deleted with the last one.
+//=============================================================================
+static void testSharing(Graphics &graphics)
+{
+    TextureRegistry registry;
+    registry.initialize(&graphics);
+    std::vector<TextureManager*> textures(FILES);
+    for (int n = 0; n < FILES; n++)
+    {
+        textures[n] = registry.acquire(fileName(n));
+        CHECK(textures[n] != NULL);
+    }
+    CHECK(registry.getCount() == (UINT)FILES && registry.getMisses() == (UINT)FILES);
+    for (int n = 0; n < FILES; n += 2)                  // a second user of half
+        CHECK(registry.acquire(fileName(n)) == textures[n]);
+    CHECK(registry.getHits() == (UINT)FILES/2);
+    CHECK(registry.getRefCount(fileName(0)) == 2 && registry.getRefCount(fileName(1)) == 1);
+    CHECK(registry.acquire("TEXTUREREGISTRYTEST0.TGA") == textures[0]);    // same normalized name
+    registry.release(textures[0]);
+    CHECK(registry.acquire("missing.tga") == NULL);
+    CHECK(registry.getCount() == (UINT)FILES);
+
+    registry.release(NULL);                             // ignored
+    TextureManager stranger;
+    registry.release(&stranger);
+    for (int n = 0; n < FILES; n++)
+        registry.release(textures[n]);
+    CHECK(registry.getCount() == (UINT)FILES/2);
+    CHECK(registry.getRefCount(fileName(0)) == 1 && registry.getRefCount(fileName(1)) == 0);
+    for (int n = 0; n < FILES; n += 2)
+        registry.release(textures[n]);
+    CHECK(registry.getCount() == 0);
+    registry.release(textures[0]);                      // already deleted, ignored
+}
+
+//=============================================================================
+// A recorded frame draws a registry texture deleted after recording.
+//=============================================================================
+static void testReleaseWhileDrawing(Graphics &graphics)
+{
+    std::vector<unsigned int> red(SIZE * SIZE, graphicsNS::RED);
+    CHECK(testWriteTga("textureRegistryTestRed.tga", SIZE, SIZE, &red[0]));
+    TextureRegistry registry;
+    registry.initialize(&graphics);
+    RenderQueue queue;
+    CHECK(queue.start(&graphics));
+    for (int frame = 0; frame < 20; frame++)
+    {
+        TextureManager *texture = registry.acquire("textureRegistryTestRed.tga");
+        CHECK(texture != NULL);
+        graphics.setRecording(&queue.beginFrame());
+        graphics.setBackColor(graphicsNS::BLACK);
+        graphics.spriteBegin();
+        SpriteData sd = {};
+        sd.width = sd.height = SIZE;
+        sd.rect.right = sd.rect.bottom = SIZE;
+        sd.scale = 1;
+        sd.texture = texture->getTexture();
+        graphics.drawSprite(sd);
+        graphics.spriteEnd();
+        graphics.setRecording(NULL);
+        registry.release(texture);                      // deleted, the frame is not drawn yet
+        CHECK(registry.getCount() == 0);
+        queue.endFrame();
+    }
+    queue.finish();
+    CHECK(queue.getFramesDrawn() == 20);
+    CHECK(graphics.getBackbuffer()[0] == graphicsNS::RED);
+    queue.stop();
+    remove("textureRegistryTestRed.tga");
+}
+
+int main()
+{
+    std::vector<unsigned int> pixels(SIZE * SIZE);
+    for (int n = 0; n < FILES; n++)
+    {
+        for (UINT i = 0; i < SIZE * SIZE; i++)
+            pixels[i] = 0xff000000 | (n << 8) | i;
+        CHECK(testWriteTga(fileName(n), SIZE, SIZE, &pixels[0]));
+    }
+    Graphics graphics;
+    graphics.initialize(NULL, 64, 64, false);
+    testSharing(graphics);
+    testReleaseWhileDrawing(graphics);
+    for (int n = 0; n < FILES; n++)
+        remove(fileName(n));
+    return testResult();
+}
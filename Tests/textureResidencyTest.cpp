@@ -0,0 +1,153 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// textureResidencyTest.cpp v1.0
+// Tests the TextureResidency eviction policy with Residents that count
+// their evictions, no graphics device or texture is needed.
+
+#include <vector>
+#include "test.h"
+#include "textureResidency.h"
+
+namespace
+{
+    const UINT64 SIZE = 100;            // bytes of each test texture
+}
+
+// A texture that only counts how often it was released.
+class CountingResident : public Resident
+{
+  public:
+    int evictions;
+    CountingResident() : evictions(0) {}
+    virtual void evict() {evictions++;}
+};
+
+int main()
+{
+    // Under the budget nothing is evicted
+    {
+        TextureResidency residency(4 * SIZE);
+        CountingResident r[4];
+        for (int i = 0; i < 4; i++)
+            residency.add(&r[i], SIZE);
+        for (int f = 0; f < 5; f++)
+        {
+            residency.beginFrame();
+            residency.update();
+        }
+        ResidencyStats stats = residency.getStats();
+        CHECK(stats.bytes == 4 * SIZE && stats.resident == 4 && stats.evicted == 0);
+        CHECK(residency.getTotalEvictions() == 0);
+        for (int i = 0; i < 4; i++)
+            CHECK(r[i].evictions == 0);
+    }
+
+    // Over the budget the least recently drawn go first, only until it fits
+    {
+        TextureResidency residency(2 * SIZE);
+        CountingResident r[4];
+        for (int i = 0; i < 4; i++)
+            residency.add(&r[i], SIZE);
+        residency.beginFrame();                         // frame 1
+        CHECK(residency.touch(&r[3]));
+        residency.beginFrame();                         // frame 2
+        CHECK(residency.touch(&r[2]));
+        residency.beginFrame();                         // frame 3
+        residency.update();
+        // r[0] and r[1] were last drawn in frame 0, r[3] in frame 1 and
+        // r[2] in frame 2, less than MIN_AGE frames ago
+        CHECK(r[0].evictions == 1 && r[1].evictions == 1);
+        CHECK(r[2].evictions == 0 && r[3].evictions == 0);
+        ResidencyStats stats = residency.getStats();
+        CHECK(stats.bytes == 2 * SIZE && stats.resident == 2 && stats.evicted == 2);
+        CHECK(stats.evictions == 2 && stats.reloads == 0);
+        CHECK(!residency.touch(&r[0]));                 // must be loaded again
+        CHECK(residency.touch(&r[2]));
+
+        // A reload is counted and the bytes come back
+        residency.add(&r[0], SIZE);
+        stats = residency.getStats();
+        CHECK(stats.bytes == 3 * SIZE && stats.evicted == 1 && stats.reloads == 1);
+        residency.beginFrame();
+        CHECK(residency.getStats().reloads == 0);      // per frame
+
+        // A lower budget evicts by the next update()
+        residency.setBudget(SIZE);
+        CHECK(residency.getBudget() == SIZE);
+        residency.beginFrame();
+        residency.beginFrame();
+        residency.update();
+        CHECK(residency.getStats().bytes <= SIZE);
+        CHECK(residency.getTotalEvictions() == 4);
+
+        // Removing forgets the texture, resident or not
+        residency.remove(&r[1]);                        // evicted
+        residency.remove(&r[0]);
+        stats = residency.getStats();
+        CHECK(stats.resident + stats.evicted == 2);
+        CHECK(residency.touch(&r[1]));                  // not registered
+    }
+
+    // Textures drawn in the last MIN_AGE frames are kept over the budget
+    {
+        TextureResidency residency(SIZE);
+        CountingResident r[3];
+        for (int i = 0; i < 3; i++)
+            residency.add(&r[i], SIZE);
+        for (int f = 0; f < 4; f++)
+        {
+            residency.beginFrame();
+            for (int i = 0; i < 3; i++)
+                residency.touch(&r[i]);
+            residency.update();
+        }
+        ResidencyStats stats = residency.getStats();
+        CHECK(stats.bytes == 3 * SIZE && stats.evicted == 0);
+        for (int i = 0; i < 3; i++)
+            CHECK(r[i].evictions == 0);
+    }
+
+    // Adding a resident texture again replaces its size
+    {
+        TextureResidency residency;
+        CountingResident r;
+        residency.add(&r, SIZE);
+        residency.add(&r, 3 * SIZE);
+        ResidencyStats stats = residency.getStats();
+        CHECK(stats.bytes == 3 * SIZE && stats.resident == 1 && stats.reloads == 0);
+        residency.add(NULL, SIZE);
+        CHECK(residency.getStats().resident == 1);
+    }
+
+    // Two scenes of 4 textures take turns every 8 frames with room for one:
+    // each texture is evicted once per turn away, never while it is drawn
+    {
+        TextureResidency residency(4 * SIZE);
+        CountingResident r[8];
+        for (int i = 0; i < 8; i++)
+            residency.add(&r[i], SIZE);
+        int drawnEvictions = 0;
+        for (int f = 0; f < 64; f++)
+        {
+            residency.beginFrame();
+            int scene = (f / 8) % 2;
+            for (int i = scene*4; i < scene*4 + 4; i++)
+            {
+                if (!residency.touch(&r[i]))
+                    residency.add(&r[i], SIZE);         // loaded again
+            }
+            std::vector<int> before(8);
+            for (int i = 0; i < 8; i++)
+                before[i] = r[i].evictions;
+            residency.update();
+            for (int i = scene*4; i < scene*4 + 4; i++)
+                drawnEvictions += r[i].evictions - before[i];
+        }
+        CHECK(drawnEvictions == 0);
+        for (int i = 0; i < 8; i++)
+            CHECK(r[i].evictions >= 3 && r[i].evictions <= 4);
+        CHECK(residency.getStats().bytes == 4 * SIZE);      // back in budget
+    }
+    return testResult();
+}
@@ -0,0 +1,82 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// tileMapBench.cpp v1.0
+// Times TileMap::draw() of maps from 64x64 tiles up to count x count tiles
+// with the same 640x480 view scrolling over each, inside the smallest map
+// so every map draws the same tiles. The sprites drawn and the time a frame
+// takes must not grow with the map.
+// Usage: tileMapBench [largest map side in tiles]
+
+#include <algorithm>
+#include <vector>
+#include "test.h"
+#include "tileMap.h"
+
+namespace
+{
+    const char *TEXTURE_FILE = "tileMapBench.tga";
+    const int TILE = 16;                // tile size in pixels
+    const int FRAMES = 200;             // timed frames per map
+    const int SCROLL = 4;               // pixels per frame on each axis
+    const int RANGE = 64 * TILE - 640;  // scroll range that keeps the 64x64 map on screen
+}
+
+// Return the sprites drawn by one frame of map.
+static UINT drawFrame(Graphics &graphics, TileMap &map, RenderCommandList &list)
+{
+    list.clear();
+    graphics.setRecording(&list);
+    graphics.spriteBegin();
+    map.draw();
+    graphics.spriteEnd();
+    graphics.setRecording(NULL);
+    return list.getSize() - 2;          // not SPRITE_BEGIN and SPRITE_END
+}
+
+int main(int argc, char *argv[])
+{
+    int largest = testCount(argc, argv, 4096);
+    std::vector<unsigned int> pixels(4 * TILE * 4 * TILE, 0xff808080);
+    CHECK(testWriteTga(TEXTURE_FILE, 4 * TILE, 4 * TILE, &pixels[0]));
+    Graphics graphics;
+    graphics.initialize(NULL, 640, 480, false);
+    TextureManager texture;
+    CHECK(texture.initialize(&graphics, TEXTURE_FILE));
+    RenderCommandList list;
+
+    std::vector<UINT> firstSprites;     // of each frame of the 64x64 map
+    double firstTime = 0;
+    for (int side = 64; side <= largest; side = side < largest && side * 4 > largest ? largest : side * 4)
+    {
+        TileMap map;
+        CHECK(map.initialize(&graphics, TILE, TILE, 4, &texture, side, side));
+        std::vector<int> tiles((size_t)side * side);
+        for (size_t n = 0; n < tiles.size(); n++)
+            tiles[n] = (int)(n * 7 % 16);
+        map.setTiles(&tiles[0]);
+        std::vector<UINT> sprites(FRAMES);
+        UINT chunks = 0;
+        double t0 = testSeconds();
+        for (int f = 0; f < FRAMES; f++)
+        {
+            map.setX(-(float)(f * SCROLL % RANGE));
+            map.setY(-(float)(f * SCROLL % RANGE));
+            sprites[f] = drawFrame(graphics, map, list);
+            chunks = std::max(chunks, map.getChunksDrawn());
+        }
+        double t = (testSeconds() - t0) / FRAMES;
+        if (firstSprites.empty())
+        {
+            firstSprites = sprites;
+            firstTime = t;
+        }
+        CHECK(sprites == firstSprites);     // the view, not the map
+        printf("%5d x %-5d tiles: %u sprites, up to %u chunks a frame, %.3f ms/frame (%.2fx the 64x64 map)\n",
+               side, side, sprites[0], chunks, t * 1000, t / firstTime);
+        if (side == largest)
+            break;
+    }
+    remove(TEXTURE_FILE);
+    return testResult();
+}
@@ -0,0 +1,175 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// tileMapTest.cpp v1.0
+// Tests TileMap: frame numbers of any size, moveBox() against solid tiles
+// at speeds of many tiles a frame, and chunks built again only after one
+// of their tiles changes.
+
+#include <math.h>
+#include <vector>
+#include "test.h"
+#include "tileMap.h"
+
+using namespace tileMapNS;
+
+namespace
+{
+    const char *TEXTURE_FILE = "tileMapTest.tga";
+    const int TILE = 16;                // tile size in pixels
+}
+
+static bool near(float a, float b)
+{
+    return fabsf(a - b) < 1e-3f;
+}
+
+//=============================================================================
+// Frame numbers are kept as set, large ones too.
+//=============================================================================
+static void testTiles(Graphics &graphics, TextureManager &texture)
+{
+    TileMap map;
+    CHECK(map.initialize(&graphics, TILE, TILE, 4, &texture, 40, 20));
+    CHECK(map.getTile(0, 0) == EMPTY);
+    map.setTile(3, 2, 40000);           // more than a short holds
+    CHECK(map.getTile(3, 2) == 40000);
+    map.setTile(4, 2, 7);
+    CHECK(map.getTile(4, 2) == 7);
+    map.setTile(4, 2, -5);
+    CHECK(map.getTile(4, 2) == EMPTY);
+    map.setTile(40, 0, 1);              // outside, ignored
+    CHECK(map.getTile(40, 0) == EMPTY);
+    map.setSolid(40000, true);
+    CHECK(map.isSolid(3, 2));
+    CHECK(map.isSolidAt(3 * TILE + 1.0f, 2 * TILE + 1.0f));
+}
+
+//=============================================================================
+// A fast box stops against a one tile wall on either axis.
+//=============================================================================
+static void testMoveBox(Graphics &graphics, TextureManager &texture)
+{
+    TileMap map;
+    CHECK(map.initialize(&graphics, TILE, TILE, 4, &texture, 200, 200));
+    map.setX(100);                      // the map is not at 0,0
+    map.setY(-50);
+    map.setSolid(1, true);
+    for (int n = 0; n < 200; n++)
+    {
+        map.setTile(150, n, 1);         // a wall one tile thick
+        map.setTile(n, 150, 1);         // a floor
+    }
+    float wallX = 100.0f + 150 * TILE;
+    float floorY = -50.0f + 150 * TILE;
+
+    // right, 300 tiles in one move
+    float bx = 100.0f + 10 * TILE, by = -50.0f + 20 * TILE;
+    CHECK(map.moveBox(bx, by, 12, 12, 300.0f * TILE, 0));
+    CHECK(near(bx, wallX - 12));
+    CHECK(!map.overlapsSolid(bx, by, bx + 12, by + 12));
+    CHECK(!map.moveBox(bx, by, 12, 12, 0, 0));
+    CHECK(map.moveBox(bx, by, 12, 12, 5, 0));   // already against it
+    CHECK(near(bx, wallX - 12));
+
+    // left from past the wall
+    bx = wallX + 40 * TILE;
+    CHECK(map.moveBox(bx, by, 12, 12, -1e5f, 0));
+    CHECK(near(bx, wallX + TILE));
+
+    // down and up through the floor
+    bx = 100.0f + 20 * TILE;
+    by = -50.0f + 10 * TILE;
+    CHECK(map.moveBox(bx, by, 12, 12, 0, 300.0f * TILE));
+    CHECK(near(by, floorY - 12));
+    by = floorY + 30 * TILE;
+    CHECK(map.moveBox(bx, by, 12, 12, 0, -1e5f));
+    CHECK(near(by, floorY + TILE));
+
+    // both at once, stopped on x and on y
+    bx = 100.0f + 140 * TILE;
+    by = -50.0f + 140 * TILE;
+    CHECK(map.moveBox(bx, by, 12, 12, 50.0f * TILE, 50.0f * TILE));
+    CHECK(near(bx, wallX - 12));
+    CHECK(near(by, floorY - 12));
+
+    // nothing in the way, moves the whole distance, also off the map
+    bx = 100.0f + 10 * TILE;
+    by = -50.0f + 10 * TILE;
+    CHECK(!map.moveBox(bx, by, 12, 12, 20.0f * TILE, -1e6f));
+    CHECK(near(bx, 100.0f + 30 * TILE));
+    CHECK(near(by, -50.0f + 10 * TILE - 1e6f));
+}
+
+// Draw map recorded and return the sprites drawn.
+static std::vector<SpriteData> drawn(Graphics &graphics, TileMap &map)
+{
+    RenderCommandList list;
+    graphics.setRecording(&list);
+    graphics.spriteBegin();
+    map.draw();
+    graphics.spriteEnd();
+    graphics.setRecording(NULL);
+    std::vector<SpriteData> sprites;
+    for (UINT i = 0; i < list.getSize(); i++)
+        if (list.get(i).type == renderCommandNS::SPRITE)
+            sprites.push_back(list.get(i).spriteData);
+    return sprites;
+}
+
+//=============================================================================
+// Only the chunk of a changed tile is built again, and draws the change.
+//=============================================================================
+static void testChunks(Graphics &graphics, TextureManager &texture)
+{
+    TileMap map;
+    CHECK(map.initialize(&graphics, TILE, TILE, 4, &texture, 100, 100));
+    std::vector<int> tiles(100 * 100, 0);
+    map.setTiles(&tiles[0]);
+    std::vector<SpriteData> sprites = drawn(graphics, map);
+    UINT visible = (640 / TILE) * (480 / TILE);
+    CHECK(sprites.size() == visible);
+    UINT built = map.getChunksBuilt();
+    CHECK(built == map.getChunksDrawn());   // each chunk on screen built once
+    drawn(graphics, map);
+    CHECK(map.getChunksBuilt() == built);   // nothing changed
+
+    map.setTile(5, 5, 0);                   // the same frame, no change
+    drawn(graphics, map);
+    CHECK(map.getChunksBuilt() == built);
+    map.setTile(5, 5, 6);                   // frame 6 is column 2, row 1
+    sprites = drawn(graphics, map);
+    CHECK(map.getChunksBuilt() == built + 1);
+    bool found = false;
+    for (size_t i = 0; i < sprites.size(); i++)
+        if (sprites[i].x == 5 * TILE && sprites[i].y == 5 * TILE)
+        {
+            found = true;
+            CHECK(sprites[i].rect.left == 2 * TILE && sprites[i].rect.top == TILE);
+        }
+    CHECK(found);
+    map.setTile(6, 5, EMPTY);
+    CHECK(drawn(graphics, map).size() == visible - 1);
+
+    map.setTile(99, 99, 3);                 // off screen, built when scrolled to
+    drawn(graphics, map);
+    CHECK(map.getChunksBuilt() == built + 2);
+    map.invalidate();
+    drawn(graphics, map);
+    CHECK(map.getChunksBuilt() == built * 2 + 2);
+}
+
+int main()
+{
+    std::vector<unsigned int> pixels(4 * TILE * 4 * TILE, 0xff00ff00);
+    CHECK(testWriteTga(TEXTURE_FILE, 4 * TILE, 4 * TILE, &pixels[0]));
+    Graphics graphics;
+    graphics.initialize(NULL, 640, 480, false);
+    TextureManager texture;
+    CHECK(texture.initialize(&graphics, TEXTURE_FILE));
+    testTiles(graphics, texture);
+    testMoveBox(graphics, texture);
+    testChunks(graphics, texture);
+    remove(TEXTURE_FILE);
+    return testResult();
+}
@@ -0,0 +1,80 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// transform2DBench.cpp v1.0
+// Times the Transform2D kernels against transforming one sprite at a time
+// with spriteAffine(), the way unbatched drawSprite() does.
+// Usage: transform2DBench [sprites]
+
+#include <math.h>
+#include <vector>
+#include "test.h"
+#include "transform2D.h"
+
+namespace
+{
+    const int REPEAT = 20;
+    const char *KERNEL_NAME[] = {"scalar", "SSE2", "AVX"};
+}
+
+int main(int argc, char *argv[])
+{
+    int count = testCount(argc, argv, 100000);
+    std::vector<float> x(count), y(count), scale(count), angle(count);
+    std::vector<int> width(count), height(count);
+    std::vector<BYTE> flip(count);
+    std::vector<SpriteData> sprites(count);
+    srand(1);
+    for (int i = 0; i < count; i++)
+    {
+        SpriteData &sd = sprites[i];
+        sd = SpriteData();
+        sd.x = x[i] = (float)(rand() % 1280);
+        sd.y = y[i] = (float)(rand() % 720);
+        sd.scale = scale[i] = 0.5f + (rand() % 100) / 50.0f;
+        sd.angle = angle[i] = (rand() % 628) / 100.0f;
+        sd.width = width[i] = 16 + rand() % 64;
+        sd.height = height[i] = 16 + rand() % 64;
+        flip[i] = (BYTE)(rand() & 3);
+        sd.flipHorizontal = (flip[i] & transform2DNS::FLIP_HORIZONTAL) != 0;
+        sd.flipVertical = (flip[i] & transform2DNS::FLIP_VERTICAL) != 0;
+    }
+    TransformArrays in = {&x[0], &y[0], &scale[0], &angle[0], &width[0], &height[0], &flip[0]};
+    std::vector<Affine2D> single(count), out(count);
+    std::vector<Quad2D> quads(count);
+
+    double t0 = testSeconds();
+    for (int r = 0; r < REPEAT; r++)
+        for (int i = 0; i < count; i++)
+            Transform2D::spriteAffine(sprites[i], single[i]);
+    double singleTime = testSeconds() - t0;
+    printf("%d sprites\n", count);
+    printf("spriteAffine, one at a time: %6.2f ns/sprite\n", singleTime * 1e9 / REPEAT / count);
+
+    Transform2D transform;
+    for (int k = transform2DNS::SCALAR; k <= transform.getBestKernel(); k++)
+    {
+        transform.setKernel((transform2DNS::KERNEL)k);
+        t0 = testSeconds();
+        for (int r = 0; r < REPEAT; r++)
+            transform.affine(in, &out[0], count);
+        double affineTime = testSeconds() - t0;
+        t0 = testSeconds();
+        for (int r = 0; r < REPEAT; r++)
+            transform.corners(in, &quads[0], count);
+        double cornersTime = testSeconds() - t0;
+        double maxError = 0;
+        for (int i = 0; i < count; i++)
+        {
+            const float *p = &out[i].m11;
+            const float *q = &single[i].m11;
+            for (int j = 0; j < 6; j++)
+                maxError = fmax(maxError, fabs(p[j] - q[j]) / (1 + fabs(q[j])));
+        }
+        CHECK(maxError < 1e-4);
+        printf("%-6s affine %6.2f ns/sprite, corners %6.2f ns/sprite, %.1fx, max difference %.1e\n",
+               KERNEL_NAME[k], affineTime * 1e9 / REPEAT / count, cornersTime * 1e9 / REPEAT / count,
+               singleTime / affineTime, maxError);
+    }
+    return testResult();
+}
@@ -0,0 +1,172 @@
+// Programming 2D Games
+// Copyright (c) 2011 by: 
+// Charles Kelly
+// transform2DTest.cpp v1.0
+// Tests every Transform2D kernel the CPU supports against the matrix
+// Graphics::drawSprite built with D3DXMatrixTransformation2D, computed
+// here in double.
+
+#include <math.h>
+#include <vector>
+#include "test.h"
+#include "transform2D.h"
+
+// Sprites in structure of arrays form.
+struct Sprites
+{
+    std::vector<float> x, y, scale, angle;
+    std::vector<int>   width, height;
+    std::vector<BYTE>  flip;
+
+    void add(float px, float py, float s, float a, int w, int h, BYTE f)
+    {
+        x.push_back(px); y.push_back(py); scale.push_back(s); angle.push_back(a);
+        width.push_back(w); height.push_back(h); flip.push_back(f);
+    }
+    TransformArrays arrays() const
+    {
+        TransformArrays in = {&x[0], &y[0], &scale[0], &angle[0], &width[0], &height[0], &flip[0]};
+        return in;
+    }
+    UINT size() const {return (UINT)x.size();}
+};
+
+//=============================================================================
+// D3DXMatrixTransformation2D(&m, NULL, 0, &scaling, &center, angle, &translate)
+// with the scaling, center and translate drawSprite used, including flips.
+// m = scale * (move center to 0) * rotate * (move back) * translate
+//=============================================================================
+static void reference(float x, float y, float scale, float angle, int width, int height,
+                      BYTE flip, double m[6])
+{
+    double cx = (float)(width/2*scale);         // drawSprite's center
+    double cy = (float)(height/2*scale);
+    double sx = scale, sy = scale;
+    double tx = x, ty = y;
+    if (flip & transform2DNS::FLIP_HORIZONTAL)
+    {
+        sx = -sx;
+        cx -= width*scale;
+        tx += width*scale;
+    }
+    if (flip & transform2DNS::FLIP_VERTICAL)
+    {
+        sy = -sy;
+        cy -= height*scale;
+        ty += height*scale;
+    }
+    double c = cos((double)angle);
+    double s = sin((double)angle);
+    m[0] = sx*c;
+    m[1] = sx*s;
+    m[2] = -sy*s;
+    m[3] = sy*c;
+    m[4] = cx - cx*c + cy*s + tx;
+    m[5] = cy - cx*s - cy*c + ty;
+}
+
+static bool near(double a, double b, double tolerance)
+{
+    return fabs(a - b) <= tolerance * (1 + fabs(b));
+}
+
+static Sprites makeSprites()
+{
+    Sprites s;
+    // edge cases
+    s.add(0, 0, 1, 0, 0, 0, 0);
+    s.add(10, 20, 0, 1, 64, 64, 3);             // scale 0
+    s.add(-5, 7, 1, 0, 33, 17, 1);              // odd size, no rotation
+    s.add(100, 100, 2, -3.14159265f, 64, 32, 2);
+    s.add(100, 100, 2, 1.57079633f, 64, 32, 0);
+    s.add(0, 0, 1, -1000.0f, 16, 16, 0);        // large angles
+    s.add(0, 0, 1, 1000.0f, 16, 16, 3);
+    // random sprites, the count is not a multiple of 4 or 8 so the scalar
+    // tail of the SIMD kernels is tested
+    srand(1);
+    for (int i = 0; i < 1001; i++)
+        s.add((float)(rand() % 2000 - 500), (float)(rand() % 2000 - 500),
+              0.1f + (rand() % 300) / 100.0f, (rand() % 200000 - 100000) / 1000.0f,
+              rand() % 257, rand() % 129, (BYTE)(rand() & 3));
+    return s;
+}
+
+//=============================================================================
+// Each kernel matches the reference matrix, corners and sine and cosine.
+//=============================================================================
+static void testKernels(const Sprites &s)
+{
+    TransformArrays in = s.arrays();
+    UINT n = s.size();
+    std::vector<Affine2D> out(n);
+    std::vector<Quad2D> quads(n);
+    std::vector<float> sinOut(n), cosOut(n);
+    Transform2D transform;
+    for (int k = transform2DNS::SCALAR; k <= transform.getBestKernel(); k++)
+    {
+        transform.setKernel((transform2DNS::KERNEL)k);
+        CHECK(transform.getKernel() == k);
+        transform.affine(in, &out[0], n);
+        transform.corners(in, &quads[0], n);
+        transform.sinCos(in.angle, &sinOut[0], &cosOut[0], n);
+        int bad = 0;
+        for (UINT i = 0; i < n; i++)
+        {
+            double m[6];
+            reference(s.x[i], s.y[i], s.scale[i], s.angle[i], s.width[i], s.height[i], s.flip[i], m);
+            const float *p = &out[i].m11;
+            for (int j = 0; j < 6; j++)
+                if (!near(p[j], m[j], 1e-4))
+                    bad++;
+            Quad2D q;
+            Transform2D::affineCorners(out[i], (float)s.width[i], (float)s.height[i], q);
+            for (int j = 0; j < 4; j++)
+                if (!near(quads[i].x[j], q.x[j], 1e-5) || !near(quads[i].y[j], q.y[j], 1e-5))
+                    bad++;
+            if (fabs(sinOut[i] - sin((double)s.angle[i])) > 1e-6 ||
+                fabs(cosOut[i] - cos((double)s.angle[i])) > 1e-6)
+                bad++;
+        }
+        if (bad)
+            printf("kernel %d: %d values differ\n", k, bad);
+        CHECK(bad == 0);
+    }
+}
+
+//=============================================================================
+// spriteAffine() of a SpriteData matches the reference, and the corners of
+// an unrotated sprite are its rectangle.
+//=============================================================================
+static void testSprite()
+{
+    SpriteData sd = {};
+    sd.width = 40;
+    sd.height = 20;
+    sd.x = 10;
+    sd.y = 30;
+    sd.scale = 2;
+    sd.angle = 0.7f;
+    sd.flipHorizontal = true;
+    Affine2D t;
+    Transform2D::spriteAffine(sd, t);
+    double m[6];
+    reference(sd.x, sd.y, sd.scale, sd.angle, sd.width, sd.height, transform2DNS::FLIP_HORIZONTAL, m);
+    const float *p = &t.m11;
+    for (int j = 0; j < 6; j++)
+        CHECK(near(p[j], m[j], 1e-5));
+
+    sd.angle = 0;
+    sd.flipHorizontal = false;
+    Transform2D::spriteAffine(sd, t);
+    Quad2D q;
+    Transform2D::affineCorners(t, (float)sd.width, (float)sd.height, q);
+    CHECK(q.x[0] == 10 && q.y[0] == 30);
+    CHECK(q.x[3] == 90 && q.y[3] == 70);
+}
+
+int main()
+{
+    testKernels(makeSprites());
+    testSprite();
+    return testResult();
+}